@@ -61,6 +61,16 @@
     assert.commandFailed(db.adminCommand({applyOps: [{op: 'c', ns: t.getFullName(), o: {a: 1}}]}),
                          'applyOps should fail on command operation on unknown key in "o" field');
 
+    // Array 'o' field value in an operation of type 'u' (update) or 'd' (delete). Such grouped
+    // operations are only built internally by oplog application.
+    assert.commandFailed(
+        db.adminCommand(
+            {applyOps: [{op: 'u', ns: t.getFullName(), o: [{$set: {a: 1}}], o2: [{_id: 1}]}]}),
+        'applyOps should fail on update operation with array "o" field');
+    assert.commandFailed(
+        db.adminCommand({applyOps: [{op: 'd', ns: t.getFullName(), o: [{_id: 1}]}]}),
+        'applyOps should fail on delete operation with array "o" field');
+
     // Empty 'ns' field value in operation type other than 'n'.
     assert.commandFailed(
         db.adminCommand({applyOps: [{op: 'c', ns: ''}]}),
@@ -0,0 +1,67 @@
+/**
+ * Tests that a new member started with the fileCopyInitialSyncSource parameter copies the data
+ * files of its sync source through a backup, then catches up on later writes through steady state
+ * replication instead of running a logical initial sync.
+ */
+(function() {
+    "use strict";
+    load("jstests/libs/check_log.js");
+
+    var storageEngine = jsTest.options().storageEngine;
+    if (storageEngine && storageEngine !== "wiredTiger") {
+        jsTestLog("Skipping test because file copy initial sync requires wiredTiger");
+        return;
+    }
+
+    // Compress with dictionaries, which are kept in files of their own outside of WiredTiger.
+    var rst = new ReplSetTest({
+        name: "file_copy_initial_sync",
+        nodes: 1,
+        nodeOptions: {wiredTigerCollectionBlockCompressor: "dictionary"}
+    });
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var coll = primary.getDB("test").copied;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, x: i});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.createIndex({x: 1}));
+
+    // Only one backup can be open at a time, and only the files it lists can be read.
+    var admin = primary.getDB("admin");
+    var backup = assert.commandWorked(admin.runCommand({replSetBeginFileCopyBackup: 1}));
+    assert.gt(backup.files.length, 0, tojson(backup));
+    assert(backup.files.some(file => file.filename.startsWith("compressionDictionaries/")),
+           tojson(backup));
+    assert.commandFailedWithCode(admin.runCommand({replSetBeginFileCopyBackup: 1}),
+                                 ErrorCodes.IllegalOperation);
+    assert.commandFailedWithCode(
+        admin.runCommand(
+            {replSetReadBackupFile: backup.backupId, filename: "../mongod.lock", offset: 0}),
+        ErrorCodes.BadValue);
+    assert.commandWorked(admin.runCommand({replSetEndFileCopyBackup: backup.backupId}));
+
+    var secondary = rst.add({
+        rsConfig: {priority: 0},
+        setParameter: {fileCopyInitialSyncSource: primary.host, fileCopyInitialSyncConnections: 2}
+    });
+    checkLog.contains(secondary, "Copied the data files from " + primary.host);
+    rst.reInitiate();
+    rst.awaitSecondaryNodes();
+
+    assert.writeOK(coll.insert({_id: 1000, x: 1000}, {writeConcern: {w: 2}}));
+
+    var secondaryColl = secondary.getDB("test").copied;
+    assert.eq(1001, secondaryColl.find().itcount());
+    assert.eq(2, secondaryColl.getIndexes().length);
+    var log = assert.commandWorked(secondary.adminCommand({getLog: "global"})).log;
+    assert(!log.some(line => line.indexOf("Starting initial sync") !== -1),
+           "expected the copied member to skip logical initial sync");
+
+    rst.checkReplicatedDataHashes();
+    rst.stopSet();
+}());
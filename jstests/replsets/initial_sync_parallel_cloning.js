@@ -0,0 +1,47 @@
+/**
+ * Tests that initial sync clones several collections of a database at the same time, and clones
+ * large collections over several _id ranges, when configured to do so. The ranges cover _id values
+ * of mixed types to check that no document falls between two of them.
+ */
+(function() {
+    "use strict";
+
+    var rst = new ReplSetTest({name: "initial_sync_parallel_cloning", nodes: 1});
+    rst.startSet();
+    rst.initiate();
+
+    var primaryDB = rst.getPrimary().getDB("test");
+    for (var c = 0; c < 4; c++) {
+        var bulk = primaryDB["coll" + c].initializeUnorderedBulkOp();
+        for (var i = 0; i < 2000; i++) {
+            bulk.insert({_id: i, x: c});
+            bulk.insert({_id: "str" + i, x: c});
+        }
+        bulk.insert({_id: {sub: c}, x: c});
+        assert.writeOK(bulk.execute());
+    }
+    assert.commandWorked(primaryDB.createCollection("capped", {capped: true, size: 1024 * 1024}));
+    assert.writeOK(primaryDB.capped.insert({_id: 1}));
+
+    var secondary = rst.add({
+        rsConfig: {priority: 0},
+        setParameter: {
+            initialSyncCollectionClonerConcurrency: 3,
+            initialSyncCollectionClonerRanges: 4,
+            initialSyncCollectionClonerRangeMinDocuments: 1000
+        }
+    });
+    rst.reInitiate();
+    rst.awaitSecondaryNodes();
+    rst.awaitReplication();
+
+    var secondaryDB = secondary.getDB("test");
+    for (var c = 0; c < 4; c++) {
+        assert.eq(4001, secondaryDB["coll" + c].find().itcount());
+        assert.eq(4001, secondaryDB["coll" + c].find({x: c}).itcount());
+    }
+    assert.eq(1, secondaryDB.capped.find().itcount());
+
+    rst.checkReplicatedDataHashes();
+    rst.stopSet();
+}());
@@ -71,6 +71,7 @@
     assert.eq(res.initialSyncStatus.databases.test["test.foo"].documentsCopied, 4);
     assert.eq(res.initialSyncStatus.databases.test["test.foo"].indexes, 1);
     assert.eq(res.initialSyncStatus.databases.test["test.foo"].fetchedBatches, 1);
+    assert.eq(res.initialSyncStatus.databases.test["test.foo"].cursors, 1);
 
     // Let initial sync finish and get into secondary state.
     assert.commandWorked(secondary.getDB('admin').runCommand(
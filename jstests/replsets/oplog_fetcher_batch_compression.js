@@ -0,0 +1,50 @@
+/**
+ * Tests that a secondary tailing its sync source's oplog with compressed getMore batches, as
+ * enabled by the oplogFetcherBatchCompression server parameter, replicates the same data as the
+ * primary, and that compressed batches may hold more than fits in an uncompressed reply.
+ */
+(function() {
+    "use strict";
+
+    var rst = new ReplSetTest({
+        name: "oplog_fetcher_batch_compression",
+        nodes: [{}, {rsConfig: {priority: 0}, setParameter: {oplogFetcherBatchCompression: true}}]
+    });
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var secondary = rst.getSecondary();
+    var coll = primary.getDB("test").compressed;
+
+    // Read a compressed batch directly off the primary's oplog; it is returned alongside an empty
+    // 'nextBatch'.
+    assert.writeOK(coll.insert({_id: 0}, {writeConcern: {w: 2}}));
+    var oplog = primary.getDB("local");
+    var res = assert.commandWorked(oplog.runCommand({find: "oplog.rs", batchSize: 0}));
+    res = assert.commandWorked(oplog.runCommand(
+        {getMore: res.cursor.id, collection: "oplog.rs", batchCompressor: "snappy"}));
+    assert.eq([], res.cursor.nextBatch, tojson(res));
+    assert.eq("snappy", res.cursor.compressedBatch.compressor, tojson(res));
+    assert.gt(res.cursor.compressedBatch.count, 0, tojson(res));
+    assert.commandFailedWithCode(
+        oplog.runCommand({getMore: NumberLong(123), collection: "oplog.rs", batchCompressor: "lz"}),
+        ErrorCodes.BadValue);
+
+    // Pause the secondary while the primary accepts more than 16MB of highly compressible writes.
+    assert.commandWorked(
+        secondary.adminCommand({configureFailPoint: "stopReplProducer", mode: "alwaysOn"}));
+
+    var padding = "x".repeat(1024 * 1024);
+    for (var i = 1; i <= 40; i++) {
+        assert.writeOK(coll.insert({_id: i, padding: padding}));
+    }
+
+    assert.commandWorked(
+        secondary.adminCommand({configureFailPoint: "stopReplProducer", mode: "off"}));
+    rst.awaitReplication();
+
+    assert.eq(41, secondary.getDB("test").compressed.find().itcount());
+    rst.checkReplicatedDataHashes();
+    rst.stopSet();
+}());
@@ -0,0 +1,62 @@
+/**
+ * Tests that a secondary which applies several batches under a single PBWM acquisition, as enabled
+ * by the replBatchPipelineDepth server parameter, ends up with the same data as the primary.
+ *
+ * The secondary is paused while the primary accepts a burst of writes which repeatedly touch the
+ * same documents, so that once it resumes it has many small batches ready to apply back to back.
+ * A command in the middle of the burst checks that batches which must be applied alone still drain
+ * the pipeline first.
+ */
+(function() {
+    "use strict";
+
+    var rst = new ReplSetTest({
+        name: "pipelined_batch_application",
+        nodes: [
+            {},
+            {
+              rsConfig: {priority: 0},
+              setParameter: {replBatchPipelineDepth: 8, replBatchLimitOperations: 50}
+            }
+        ]
+    });
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var secondary = rst.getSecondary();
+    var coll = primary.getDB("test").pipelined;
+
+    assert.writeOK(coll.insert({_id: -1}, {writeConcern: {w: 2}}));
+
+    assert.commandWorked(
+        secondary.adminCommand({configureFailPoint: "rsSyncApplyStop", mode: "alwaysOn"}));
+
+    for (var round = 0; round < 10; round++) {
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 100; i++) {
+            bulk.find({_id: i}).upsert().updateOne({$inc: {x: 1}, $push: {rounds: round}});
+        }
+        assert.writeOK(bulk.execute());
+
+        if (round === 5) {
+            assert.commandWorked(coll.createIndex({x: 1}));
+        }
+    }
+    assert.writeOK(coll.remove({_id: {$gte: 90}}));
+
+    assert.commandWorked(
+        secondary.adminCommand({configureFailPoint: "rsSyncApplyStop", mode: "off"}));
+    rst.awaitReplication();
+
+    var secondaryColl = secondary.getDB("test").pipelined;
+    assert.eq(91, secondaryColl.find().itcount());
+    secondaryColl.find({_id: {$gte: 0}}).forEach(function(doc) {
+        assert.eq(10, doc.x, tojson(doc));
+        assert.eq([0, 1, 2, 3, 4, 5, 6, 7, 8, 9], doc.rounds, tojson(doc));
+    });
+    assert.eq(2, secondaryColl.getIndexes().length);
+
+    rst.checkReplicatedDataHashes();
+    rst.stopSet();
+}());
@@ -0,0 +1,61 @@
+/**
+ * Tests that a secondary which prefetches each batch while the one before it is applied, as
+ * enabled by the replPrefetchNextBatch server parameter, looks up the documents its updates and
+ * deletes touch, and ends up with the same data as the primary.
+ */
+(function() {
+    "use strict";
+
+    var rst = new ReplSetTest({
+        name: "prefetch_next_batch",
+        nodes: [
+            {},
+            {
+              rsConfig: {priority: 0},
+              setParameter: {replPrefetchNextBatch: true, replBatchLimitOperations: 100}
+            }
+        ]
+    });
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var secondary = rst.getSecondary();
+    var coll = primary.getDB("test").prefetch;
+
+    assert.commandWorked(coll.createIndex({x: 1}));
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, x: i});
+    }
+    assert.writeOK(bulk.execute({w: 2}));
+
+    var preloadedDocs = function() {
+        var status = assert.commandWorked(secondary.adminCommand({serverStatus: 1}));
+        return status.metrics.repl.preload.docs.num;
+    };
+    var preloadedDocsBefore = preloadedDocs();
+
+    assert.commandWorked(
+        secondary.adminCommand({configureFailPoint: "rsSyncApplyStop", mode: "alwaysOn"}));
+    for (var round = 0; round < 5; round++) {
+        bulk = coll.initializeUnorderedBulkOp();
+        for (var j = 0; j < 1000; j++) {
+            bulk.find({_id: j}).updateOne({$inc: {x: 1}});
+        }
+        assert.writeOK(bulk.execute());
+    }
+    assert.writeOK(coll.remove({_id: {$gte: 900}}));
+    assert.commandWorked(
+        secondary.adminCommand({configureFailPoint: "rsSyncApplyStop", mode: "off"}));
+    rst.awaitReplication();
+
+    assert.gt(preloadedDocs(), preloadedDocsBefore);
+
+    var secondaryColl = secondary.getDB("test").prefetch;
+    assert.eq(900, secondaryColl.find().itcount());
+    assert.eq(900, secondaryColl.find({$expr: {$eq: ["$x", {$add: ["$_id", 5]}]}}).itcount());
+
+    rst.checkReplicatedDataHashes();
+    rst.stopSet();
+}());
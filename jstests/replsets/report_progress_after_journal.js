@@ -0,0 +1,36 @@
+/**
+ * Tests that "majority" writes are acknowledged when secondaries report their progress once per
+ * batch after journaling it, as enabled by the replReportProgressAfterJournal server parameter,
+ * and that the secondaries' applied and durable OpTimes both keep up with the primary.
+ */
+(function() {
+    "use strict";
+
+    var rst = new ReplSetTest({
+        name: "report_progress_after_journal",
+        nodes: 3,
+        nodeOptions: {setParameter: {replReportProgressAfterJournal: true}}
+    });
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var coll = primary.getDB("test").report_progress;
+
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(
+            coll.insert({_id: i}, {writeConcern: {w: "majority", j: true, wtimeout: 60 * 1000}}));
+    }
+    assert.writeOK(coll.insert({_id: "w3"}, {writeConcern: {w: 3, wtimeout: 60 * 1000}}));
+
+    var lastOpTime = primary.getDB("admin").runCommand({replSetGetStatus: 1}).optimes.appliedOpTime;
+    rst.getSecondaries().forEach(function(secondary) {
+        assert.soon(function() {
+            var optimes = secondary.adminCommand({replSetGetStatus: 1}).optimes;
+            return bsonWoCompare(optimes.appliedOpTime, lastOpTime) >= 0 &&
+                bsonWoCompare(optimes.durableOpTime, lastOpTime) >= 0;
+        }, "secondary " + secondary.host + " did not catch up to " + tojson(lastOpTime));
+    });
+
+    rst.stopSet();
+}());
@@ -0,0 +1,58 @@
+/**
+ * Tests that a secondary configured with the spilling steady state oplog buffer keeps fetching
+ * while its applier is stopped, spilling the entries which do not fit in memory to a collection,
+ * and that it applies them in order once the applier resumes.
+ */
+(function() {
+    "use strict";
+
+    var rst = new ReplSetTest({
+        name: "steady_state_oplog_buffer_spilling",
+        nodes: [
+            {},
+            {
+              rsConfig: {priority: 0},
+              setParameter: {
+                  steadyStateOplogBuffer: "inMemorySpillingToCollection",
+                  steadyStateOplogBufferMaxMemorySizeMB: 1
+              }
+            }
+        ]
+    });
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var secondary = rst.getSecondary();
+    var coll = primary.getDB("test").spilling;
+
+    assert.writeOK(coll.insert({_id: -1}, {writeConcern: {w: 2}}));
+
+    assert.commandWorked(
+        secondary.adminCommand({configureFailPoint: "rsSyncApplyStop", mode: "alwaysOn"}));
+
+    var padding = "x".repeat(10 * 1024);
+    for (var i = 0; i < 500; i++) {
+        assert.writeOK(
+            coll.update({_id: i % 50}, {$set: {padding: padding, i: i}}, {upsert: true}));
+    }
+
+    // The fetcher keeps going while the applier is stopped.
+    assert.soon(function() {
+        var status = assert.commandWorked(secondary.adminCommand({serverStatus: 1}));
+        return status.metrics.repl.buffer.spill.ops > 0;
+    }, "secondary did not spill fetched oplog entries");
+
+    assert.commandWorked(
+        secondary.adminCommand({configureFailPoint: "rsSyncApplyStop", mode: "off"}));
+    rst.awaitReplication();
+
+    var secondaryColl = secondary.getDB("test").spilling;
+    assert.eq(51, secondaryColl.find().itcount());
+    for (var id = 0; id < 50; id++) {
+        assert.eq(450 + id, secondaryColl.findOne({_id: id}).i);
+    }
+
+    rst.checkReplicatedDataHashes();
+    rst.stopSet();
+}());
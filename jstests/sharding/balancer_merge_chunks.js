@@ -0,0 +1,47 @@
+/**
+ * Tests that a balancer configured with balancerMaxChunkMergesPerRound merges the adjacent chunks,
+ * which reside on the same shard, once the cluster is balanced, and that the data stays reachable.
+ */
+(function() {
+    'use strict';
+
+    var st = new ShardingTest(
+        {shards: 2, other: {configOptions: {setParameter: "balancerMaxChunkMergesPerRound=10"}}});
+
+    var ns = 'TestDB.TestColl';
+    assert.commandWorked(st.s0.adminCommand({enableSharding: 'TestDB'}));
+    st.ensurePrimaryShard('TestDB', st.shard0.shardName);
+    assert.commandWorked(st.s0.adminCommand({shardCollection: ns, key: {Key: 1}}));
+
+    var coll = st.s0.getCollection(ns);
+    for (var i = -5; i < 40; i++) {
+        assert.writeOK(coll.insert({Key: i, Value: 'Test value ' + i}));
+    }
+
+    assert.commandWorked(st.splitAt(ns, {Key: 0}));
+    assert.commandWorked(st.splitAt(ns, {Key: 10}));
+    assert.commandWorked(st.splitAt(ns, {Key: 20}));
+    assert.commandWorked(st.splitAt(ns, {Key: 30}));
+    assert.commandWorked(st.moveChunk(ns, {Key: 20}, st.shard1.shardName));
+    assert.commandWorked(st.moveChunk(ns, {Key: 30}, st.shard1.shardName));
+
+    var configDB = st.s0.getDB('config');
+    assert.eq(3, configDB.chunks.find({ns: ns, shard: st.shard0.shardName}).itcount());
+    assert.eq(2, configDB.chunks.find({ns: ns, shard: st.shard1.shardName}).itcount());
+
+    // The chunk counts are within the migration threshold, so the balancer only merges
+    st.startBalancer();
+    assert.soon(function() {
+        st.awaitBalancerRound();
+        return configDB.chunks.find({ns: ns}).itcount() == 2;
+    }, 'chunks were not merged: ' + tojson(configDB.chunks.find({ns: ns}).toArray()));
+    st.stopBalancer();
+
+    assert.eq(1, configDB.chunks.find({ns: ns, shard: st.shard0.shardName}).itcount());
+    assert.eq(1, configDB.chunks.find({ns: ns, shard: st.shard1.shardName}).itcount());
+
+    assert.eq(45, coll.find().itcount());
+    assert.eq(20, coll.find({Key: {$gte: 20}}).itcount());
+
+    st.stop();
+})();
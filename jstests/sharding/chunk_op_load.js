@@ -0,0 +1,62 @@
+/**
+ * Tests that a shard with trackChunkOpLoad enabled counts the writes to each of its chunks and
+ * reports the hottest ones, along with the median of their recently written keys, through the
+ * internal _getChunkOpLoad command used by the balancer.
+ */
+(function() {
+    "use strict";
+
+    var st = new ShardingTest({
+        shards: 2,
+        other: {shardOptions: {setParameter: {trackChunkOpLoad: true}}}
+    });
+
+    var mongos = st.s0;
+    var coll = mongos.getCollection("test.chunk_op_load");
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: "test"}));
+    st.ensurePrimaryShard("test", st.shard0.shardName);
+    assert.commandWorked(mongos.adminCommand({shardCollection: coll.getFullName(), key: {x: 1}}));
+    assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {x: 0}}));
+    assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {x: 1000}}));
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: coll.getFullName(), find: {x: 1000}, to: st.shard1.shardName}));
+
+    // Writes go mostly to [0, 1000), with a few to (-inf, 0) and none to the chunk on shard1
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 500; i++) {
+        bulk.insert({x: i});
+    }
+    for (var i = 0; i < 10; i++) {
+        bulk.insert({x: -1 - i});
+    }
+    assert.writeOK(bulk.execute());
+    assert.writeOK(coll.update({x: {$lt: 100, $gte: 0}}, {$set: {y: 1}}, {multi: true}));
+    assert.writeOK(coll.remove({x: {$gte: 400}}));
+
+    var res = assert.commandWorked(st.shard0.adminCommand({_getChunkOpLoad: 1}));
+    var collEntry = res.collections.find(function(entry) {
+        return entry.ns === coll.getFullName();
+    });
+    assert(collEntry, tojson(res));
+    assert.eq(2, collEntry.chunks.length, tojson(collEntry));
+
+    // Hottest chunk first
+    var hot = collEntry.chunks[0];
+    assert.eq({x: 0}, hot.min, tojson(hot));
+    assert.eq({x: 1000}, hot.max, tojson(hot));
+    assert.eq(500 + 100 + 100, hot.ops, tojson(hot));
+    assert.gt(hot.bytes, 0, tojson(hot));
+    assert.gte(hot.medianKey.x, 0, tojson(hot));
+    assert.lt(hot.medianKey.x, 1000, tojson(hot));
+
+    assert.eq(10, collEntry.chunks[1].ops, tojson(collEntry));
+
+    // The chunk owned by shard1 was never written to
+    res = assert.commandWorked(st.shard1.adminCommand({_getChunkOpLoad: 1}));
+    res.collections.forEach(function(entry) {
+        assert.neq(coll.getFullName(), entry.ns, tojson(res));
+    });
+
+    st.stop();
+}());
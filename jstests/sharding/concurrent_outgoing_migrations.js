@@ -0,0 +1,75 @@
+/**
+ * Tests that a shard, which is allowed to donate chunks of several collections at the same time
+ * through the maxConcurrentOutgoingMigrations server parameter, runs these migrations concurrently
+ * and that each recipient clones from the migration it belongs to.
+ */
+load('./jstests/libs/chunk_manipulation_util.js');
+
+(function() {
+    'use strict';
+
+    var staticMongod = MongoRunner.runMongod({});  // For startParallelOps.
+
+    var st = new ShardingTest({
+        shards: 4,
+        other: {shardOptions: {setParameter: {maxConcurrentOutgoingMigrations: 2}}}
+    });
+
+    assert.commandWorked(st.s0.adminCommand({enableSharding: 'TestDB'}));
+    st.ensurePrimaryShard('TestDB', st.shard0.shardName);
+
+    var testDB = st.s0.getDB('TestDB');
+
+    ['Coll0', 'Coll1', 'Coll2'].forEach(function(collName) {
+        assert.commandWorked(
+            st.s0.adminCommand({shardCollection: 'TestDB.' + collName, key: {Key: 1}}));
+
+        var bulk = testDB[collName].initializeUnorderedBulkOp();
+        for (var i = 0; i < 100; i++) {
+            bulk.insert({Key: i, Value: collName + i});
+        }
+        assert.writeOK(bulk.execute());
+    });
+
+    function numMigrationsAtStep(stepNumber) {
+        return st.shard0.getDB('admin').currentOp().inprog.filter(function(op) {
+            return op.command && op.command.moveChunk && op.msg &&
+                op.msg.startsWith('step ' + stepNumber);
+        }).length;
+    }
+
+    // Pause both migrations once their recipients have cloned all the documents
+    pauseMoveChunkAtStep(st.shard0, moveChunkStepNames.reachedSteadyState);
+
+    var joinMoveChunk0 = moveChunkParallel(
+        staticMongod, st.s0.host, {Key: 0}, null, 'TestDB.Coll0', st.shard1.shardName);
+    var joinMoveChunk1 = moveChunkParallel(
+        staticMongod, st.s0.host, {Key: 0}, null, 'TestDB.Coll1', st.shard2.shardName);
+
+    assert.soon(function() {
+        return numMigrationsAtStep(moveChunkStepNames.reachedSteadyState) === 2;
+    }, 'Both migrations should have reached the steady state at the same time');
+
+    // The donor is at its limit, so a migration of a third collection must fail
+    assert.commandFailed(st.s0.adminCommand(
+        {moveChunk: 'TestDB.Coll2', find: {Key: 0}, to: st.shard3.shardName}));
+
+    unpauseMoveChunkAtStep(st.shard0, moveChunkStepNames.reachedSteadyState);
+
+    joinMoveChunk0();
+    joinMoveChunk1();
+
+    var configDB = st.s0.getDB('config');
+    assert.eq(st.shard1.shardName, configDB.chunks.findOne({ns: 'TestDB.Coll0'}).shard);
+    assert.eq(st.shard2.shardName, configDB.chunks.findOne({ns: 'TestDB.Coll1'}).shard);
+    assert.eq(100, testDB.Coll0.find().itcount());
+    assert.eq(100, testDB.Coll1.find().itcount());
+
+    // Once the migrations have completed, the third collection can be migrated too
+    assert.commandWorked(st.s0.adminCommand(
+        {moveChunk: 'TestDB.Coll2', find: {Key: 0}, to: st.shard3.shardName}));
+    assert.eq(100, testDB.Coll2.find().itcount());
+
+    st.stop();
+    MongoRunner.stopMongod(staticMongod);
+})();
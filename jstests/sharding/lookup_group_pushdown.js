@@ -0,0 +1,56 @@
+/**
+ * Tests that a $group keyed on the 'localField' of a preceding $lookup, and which only carries the
+ * joined array through a final $first accumulator, is partially aggregated on the shards ahead of
+ * the $lookup, and that the rewritten pipeline returns the same results as the original.
+ */
+(function() {
+    "use strict";
+
+    const st = new ShardingTest({shards: 2, mongos: 1});
+    const testDB = st.s.getDB("test");
+    const orders = testDB.orders;
+    const customers = testDB.customers;
+
+    assert.commandWorked(st.s.adminCommand({enableSharding: testDB.getName()}));
+    st.ensurePrimaryShard(testDB.getName(), st.shard0.shardName);
+    assert.commandWorked(
+        st.s.adminCommand({shardCollection: orders.getFullName(), key: {_id: 1}}));
+    assert.commandWorked(st.s.adminCommand({split: orders.getFullName(), middle: {_id: 0}}));
+    assert.commandWorked(st.s.adminCommand(
+        {moveChunk: orders.getFullName(), find: {_id: 1}, to: st.shard1.shardName}));
+
+    const bulk = orders.initializeUnorderedBulkOp();
+    for (let i = -50; i < 50; i++) {
+        bulk.insert({_id: i, customer: Math.abs(i) % 5, amount: 1});
+    }
+    assert.writeOK(bulk.execute());
+    for (let i = 0; i < 5; i++) {
+        assert.writeOK(customers.insert({_id: i, name: "customer" + i}));
+    }
+
+    const pipeline = [
+        {
+          $lookup:
+              {from: customers.getName(), localField: "customer", foreignField: "_id", as: "info"}
+        },
+        {$group: {_id: "$customer", total: {$sum: "$amount"}, info: {$first: "$info"}}},
+        {$sort: {_id: 1}}
+    ];
+
+    const explain = assert.commandWorked(orders.explain().aggregate(pipeline));
+    assert(explain.hasOwnProperty("splitPipeline"), tojson(explain));
+    assert(explain.splitPipeline.shardsPart[0].hasOwnProperty("$group"), tojson(explain));
+    assert(explain.splitPipeline.mergerPart.some((stage) => stage.hasOwnProperty("$lookup")),
+           tojson(explain));
+
+    const results = orders.aggregate(pipeline).toArray();
+    assert.eq(5, results.length, tojson(results));
+    results.forEach((doc, i) => {
+        assert.eq(Object.keys(doc), ["_id", "total", "info"], tojson(doc));
+        assert.eq(i, doc._id, tojson(doc));
+        assert.eq(20, doc.total, tojson(doc));
+        assert.eq([{_id: i, name: "customer" + i}], doc.info, tojson(doc));
+    });
+
+    st.stop();
+}());
@@ -0,0 +1,49 @@
+/**
+ * Tests that a chunk migration whose recipient keeps several initial clone batches in flight, as
+ * enabled by the migrateCloneConcurrency server parameter, moves every document of the chunk, and
+ * that the recipient reports the clone throughput in the changelog.
+ */
+(function() {
+    "use strict";
+
+    var st = new ShardingTest({
+        shards: 2,
+        other: {shardOptions: {setParameter: {migrateCloneConcurrency: 4}}}
+    });
+
+    var mongos = st.s0;
+    var coll = mongos.getCollection("test.concurrent_clone");
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: "test"}));
+    st.ensurePrimaryShard("test", st.shard0.shardName);
+    assert.commandWorked(mongos.adminCommand({shardCollection: coll.getFullName(), key: {x: 1}}));
+
+    // Documents large enough to fill several clone batches
+    var padding = new Array(64 * 1024).join("x");
+    var numDocs = 400;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({x: i, padding: padding});
+    }
+    assert.writeOK(bulk.execute());
+
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: coll.getFullName(), find: {x: 0}, to: st.shard1.shardName}));
+
+    assert.eq(0, st.shard0.getCollection(coll.getFullName()).find().itcount());
+    assert.eq(numDocs, st.shard1.getCollection(coll.getFullName()).find().itcount());
+    assert.eq(numDocs, coll.find().itcount());
+
+    // The recipient logs the migration once its migration thread finishes, which may be after
+    // moveChunk returns
+    var changelog;
+    assert.soon(function() {
+        changelog = mongos.getDB("config").changelog.findOne(
+            {what: "moveChunk.to", ns: coll.getFullName(), "details.note": "success"});
+        return changelog !== null;
+    });
+    assert.eq(numDocs, changelog.details.clonedDocs, tojson(changelog));
+    assert.lt(0, changelog.details.clonedBytesPerSecond, tojson(changelog));
+
+    st.stop();
+}());
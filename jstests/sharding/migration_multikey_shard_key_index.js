@@ -0,0 +1,38 @@
+/**
+ * Tests that a chunk migration whose only shard key prefixed index is multikey, so that the donor
+ * scan meets the same document once per array element, clones every document exactly once.
+ */
+(function() {
+    "use strict";
+
+    var st = new ShardingTest({
+        shards: 2,
+        other: {shardOptions: {setParameter: {migrateCloneConcurrency: 4}}}
+    });
+
+    var mongos = st.s0;
+    var coll = mongos.getCollection("test.multikey_clone");
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: "test"}));
+    st.ensurePrimaryShard("test", st.shard0.shardName);
+
+    assert.commandWorked(coll.createIndex({x: 1, tags: 1}));
+    assert.commandWorked(mongos.adminCommand({shardCollection: coll.getFullName(), key: {x: 1}}));
+
+    // Each document has several index keys, which the donor scan walks one after the other
+    var numDocs = 200;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, x: i, tags: [i, -i, "a" + i, "b" + i]});
+    }
+    assert.writeOK(bulk.execute());
+
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: coll.getFullName(), find: {x: 0}, to: st.shard1.shardName}));
+
+    assert.eq(0, st.shard0.getCollection(coll.getFullName()).find().itcount());
+    assert.eq(numDocs, st.shard1.getCollection(coll.getFullName()).find().itcount());
+    assert.eq(numDocs, coll.find().itcount());
+
+    st.stop();
+}());
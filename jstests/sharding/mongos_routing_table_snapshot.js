@@ -0,0 +1,53 @@
+/**
+ * Tests that a mongos configured with routingTableSnapshotPath persists the routing table of each
+ * sharded collection it loads, and that after a restart it resumes from the snapshot and still
+ * routes correctly to chunks which were split and moved while it was down.
+ */
+(function() {
+    "use strict";
+
+    const snapshotPath = MongoRunner.dataPath + "mongos_routing_table_snapshot";
+    resetDbpath(snapshotPath);
+
+    const st = new ShardingTest({
+        shards: 2,
+        mongos: {s0: {setParameter: {routingTableSnapshotPath: snapshotPath}}, s1: {}}
+    });
+
+    const ns = "test.coll";
+    assert.commandWorked(st.s1.adminCommand({enableSharding: "test"}));
+    st.ensurePrimaryShard("test", st.shard0.shardName);
+    assert.commandWorked(st.s1.adminCommand({shardCollection: ns, key: {x: 1}}));
+    assert.commandWorked(st.s1.adminCommand({split: ns, middle: {x: 0}}));
+
+    const bulk = st.s1.getCollection(ns).initializeUnorderedBulkOp();
+    for (let x = -100; x < 100; x++) {
+        bulk.insert({x: x});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Loading the routing table on the first mongos writes its snapshot in the background.
+    assert.eq(200, st.s0.getCollection(ns).find().itcount());
+    assert.soon(() => listFiles(snapshotPath).length === 1,
+                () => tojson(listFiles(snapshotPath)));
+
+    // Change the routing table while the first mongos is down, so that it has to combine its
+    // snapshot with the chunks which changed since.
+    st.stopMongos(0);
+    assert.commandWorked(st.s1.adminCommand({split: ns, middle: {x: 50}}));
+    assert.commandWorked(
+        st.s1.adminCommand({moveChunk: ns, find: {x: 50}, to: st.shard1.shardName}));
+    st.restartMongos(0, {restart: true});
+
+    const coll = st.s0.getCollection(ns);
+    assert.eq(200, coll.find().itcount());
+    assert.eq(50, coll.find({x: {$gte: 50}}).itcount());
+    assert.writeOK(coll.insert({x: 75}));
+    assert.eq(2, st.shard1.getCollection(ns).find({x: 75}).itcount());
+
+    // flushRouterConfig also resumes from the snapshot.
+    assert.commandWorked(st.s0.adminCommand({flushRouterConfig: 1}));
+    assert.eq(201, coll.find().itcount());
+
+    st.stop();
+}());
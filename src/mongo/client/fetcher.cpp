@@ -36,6 +36,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/query/compressed_batch.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/destructor_guard.h"
@@ -161,6 +162,26 @@ Status parseCursorResponse(const BSONObj& obj,
         doc.shareOwnershipWith(obj);
     }
 
+    // A batch requested with a 'batchCompressor' arrives as compressed blocks alongside an empty
+    // batch array.
+    BSONElement compressedBatchElement = cursorObj.getField(CompressedBatchBuilder::kFieldName);
+    if (!compressedBatchElement.eoo()) {
+        if (!compressedBatchElement.isABSONObj()) {
+            return Status(ErrorCodes::FailedToParse,
+                          str::stream() << "'" << kCursorFieldName << "."
+                                        << CompressedBatchBuilder::kFieldName
+                                        << "' field must be an object: "
+                                        << obj);
+        }
+        auto decompressed = decompressBatch(compressedBatchElement.Obj());
+        if (!decompressed.isOK()) {
+            return decompressed.getStatus();
+        }
+        for (auto& doc : decompressed.getValue()) {
+            batchData->documents.push_back(std::move(doc));
+        }
+    }
+
     return Status::OK();
 }
 
@@ -350,6 +350,15 @@ private:
                                    << e.fieldName();
             return false;
         }
+
+        // o - operation object
+        // Updates and deletes with an array of objects are only built by oplog application, when
+        // it groups consecutive oplog entries.
+        if ((*opType == 'u' || *opType == 'd') && obj.getField("o").type() == mongo::Array) {
+            errmsg = str::stream() << "\"o\" field cannot be an array when op type is '"
+                                   << opType << "': " << e.fieldName();
+            return false;
+        }
         return true;
     }
 
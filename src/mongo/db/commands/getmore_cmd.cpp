@@ -321,6 +321,9 @@ public:
 
         CursorId respondWithId = 0;
         CursorResponseBuilder nextBatch(/*isInitialResponse*/ false, &result);
+        if (request.batchCompressor) {
+            nextBatch.compressBatch();
+        }
         BSONObj obj;
         // generateBatch() will not initialize 'state' if it exceeds the time limiting generating
         // the next batch for an awaitData cursor. In this case, 'state' should be
@@ -436,7 +439,12 @@ public:
                    PlanExecutor::ADVANCED == (*state = exec->getNext(&obj, NULL))) {
                 // If adding this object will cause us to exceed the message size limit, then we
                 // stash it for later.
-                if (!FindCommon::haveSpaceForNext(obj, *numResults, nextBatch->bytesUsed())) {
+                const auto compressedBatch = nextBatch->compressedBatch();
+                const bool haveSpace = compressedBatch
+                    ? compressedBatch->haveSpaceForNext(
+                          obj, *numResults, FindCommon::kMaxBytesToReturnToClientAtOnce)
+                    : FindCommon::haveSpaceForNext(obj, *numResults, nextBatch->bytesUsed());
+                if (!haveSpace) {
                     exec->enqueue(obj);
                     break;
                 }
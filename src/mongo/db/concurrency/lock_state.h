@@ -228,6 +228,10 @@ private:
     // Mode for which the Locker acquired a ticket, or MODE_NONE if no ticket was acquired.
     LockMode _modeForTicket = MODE_NONE;
 
+    // Holder of the ticket acquired for '_modeForTicket', or nullptr if the acquisition did not
+    // take a ticket.
+    TicketHolder* _ticketHolder = nullptr;
+
     // Indicates whether the client is active reader/writer or is queued.
     AtomicWord<ClientState> _clientState{kInactive};
 
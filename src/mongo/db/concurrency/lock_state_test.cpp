@@ -38,7 +38,9 @@
 #include "mongo/db/concurrency/lock_manager_test_help.h"
 #include "mongo/db/concurrency/locker.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -132,6 +134,41 @@ TEST(LockerImpl, ReadTransaction) {
     locker.unlockGlobal();
 }
 
+TEST(LockerImpl, LockerWhichShouldNotAcquireTicketBypassesThrottling) {
+    TicketHolder reading(5);
+    TicketHolder writing(5);
+    Locker::setGlobalThrottling(&reading, &writing);
+    ON_BLOCK_EXIT([] {
+        Locker::setGlobalThrottling(nullptr, nullptr);
+        Locker::setTicketBypassEnabled(false);
+    });
+
+    DefaultLockerImpl user;
+    ASSERT_EQUALS(LOCK_OK, user.lockGlobal(MODE_IX));
+    ASSERT_EQUALS(1, writing.used());
+    user.unlockGlobal();
+    ASSERT_EQUALS(0, writing.used());
+
+    // Opting out has no effect unless bypassing tickets is enabled.
+    DefaultLockerImpl internal;
+    internal.setShouldAcquireTicket(false);
+    ASSERT_EQUALS(LOCK_OK, internal.lockGlobal(MODE_IX));
+    ASSERT_EQUALS(1, writing.used());
+
+    // Changing the setting while locked must not leak the ticket.
+    Locker::setTicketBypassEnabled(true);
+    internal.unlockGlobal();
+    ASSERT_EQUALS(0, writing.used());
+
+    ASSERT_EQUALS(LOCK_OK, internal.lockGlobal(MODE_IX));
+    ASSERT_EQUALS(0, writing.used());
+    ASSERT_EQUALS(LOCK_OK, internal.lockGlobal(MODE_IS));
+    ASSERT_EQUALS(0, reading.used());
+    internal.unlockGlobal();
+    internal.unlockGlobal();
+    ASSERT_EQUALS(5, writing.available());
+}
+
 /**
  * Test that saveMMAPV1LockerImpl works by examining the output.
  */
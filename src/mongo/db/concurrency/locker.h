@@ -70,6 +70,13 @@ public:
      */
     static void setGlobalThrottling(class TicketHolder* reading, class TicketHolder* writing);
 
+    /**
+     * Allows lockers which opted out through setShouldAcquireTicket(false) to bypass the tickets
+     * installed by setGlobalThrottling. Disabled by default. Storage engines which shrink their
+     * ticket pools under load enable it, since only then can user load starve internal operations.
+     */
+    static void setTicketBypassEnabled(bool enabled);
+
     /**
      * State for reporting the number of active and queued reader and writer clients.
      */
@@ -327,11 +334,27 @@ public:
         return _shouldConflictWithSecondaryBatchApplication;
     }
 
+    /**
+     * If set to false, and bypassing tickets is enabled through setTicketBypassEnabled, global lock
+     * acquisitions by this locker bypass the tickets installed by setGlobalThrottling. Internal
+     * operations which user load must not be able to starve, such as replication and the balancer,
+     * opt out so that they are never queued behind user operations when the storage engine shrinks
+     * its ticket pools. Must not change while locked.
+     */
+    void setShouldAcquireTicket(bool newValue) {
+        invariant(!isLocked());
+        _shouldAcquireTicket = newValue;
+    }
+    bool shouldAcquireTicket() const {
+        return _shouldAcquireTicket;
+    }
+
 protected:
     Locker() {}
 
 private:
     bool _shouldConflictWithSecondaryBatchApplication = true;
+    bool _shouldAcquireTicket = true;
 };
 
 }  // namespace mongo
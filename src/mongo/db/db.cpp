@@ -89,6 +89,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repair_database.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
+#include "mongo/db/repl/file_copy_initial_syncer.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_consistency_markers_impl.h"
@@ -544,6 +545,8 @@ ExitCode _initAndListen(int listenPort) {
     }
     globalServiceContext->setTransportLayer(std::move(tl));
 
+    uassertStatusOK(repl::copyDataFilesFromSyncSourceIfRequested());
+
     globalServiceContext->initializeGlobalStorageEngine();
 
 #ifdef MONGO_CONFIG_WIREDTIGER_ENABLED
@@ -43,6 +43,7 @@
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_geo_near.h"
+#include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_merge_cursors.h"
 #include "mongo/db/pipeline/document_source_out.h"
@@ -302,6 +303,7 @@ std::unique_ptr<Pipeline, Pipeline::Deleter> Pipeline::splitForSharded() {
 
     // The order in which optimizations are applied can have significant impact on the
     // efficiency of the final pipeline. Be Careful!
+    Optimizations::Sharded::moveGroupAheadOfKeyedLookUp(shardPipeline.get(), this);
     Optimizations::Sharded::findSplitPoint(shardPipeline.get(), this);
     Optimizations::Sharded::moveFinalUnwindFromShardsToMerger(shardPipeline.get(), this);
     Optimizations::Sharded::limitFieldsSentFromShardsToMerger(shardPipeline.get(), this);
@@ -361,6 +363,98 @@ void Pipeline::Optimizations::Sharded::findSplitPoint(Pipeline* shardPipe, Pipel
     }
 }
 
+void Pipeline::Optimizations::Sharded::moveGroupAheadOfKeyedLookUp(Pipeline* shardPipe,
+                                                                   Pipeline* mergePipe) {
+    auto& sources = mergePipe->_sources;
+    auto lookUpItr = std::find_if(sources.begin(), sources.end(), [](const auto& stage) {
+        return dynamic_cast<SplittableDocumentSource*>(stage.get()) != nullptr;
+    });
+    if (lookUpItr == sources.end() || std::next(lookUpItr) == sources.end())
+        return;
+
+    // $lookup is not part of the 'pipeline' library, so it is recognized by name and rebuilt
+    // through the stage parser map.
+    auto groupItr = std::next(lookUpItr);
+    auto group = dynamic_cast<DocumentSourceGroup*>(groupItr->get());
+    if (StringData((*lookUpItr)->getSourceName()) != "$lookup"_sd || !group)
+        return;
+
+    // A $lookup which has absorbed an $unwind or a $match serializes to more than one stage. Both
+    // change which documents reach the $group, so the pair cannot be reordered.
+    std::vector<Value> serializedLookUp;
+    (*lookUpItr)->serializeToArray(serializedLookUp);
+    std::vector<Value> serializedGroup;
+    group->serializeToArray(serializedGroup);
+    if (serializedLookUp.size() != 1u || serializedGroup.size() != 1u)
+        return;
+
+    const Document lookUpSpec = serializedLookUp[0].getDocument()["$lookup"].getDocument();
+    const Document groupSpec = serializedGroup[0].getDocument()["$group"].getDocument();
+    if (lookUpSpec["localField"].missing())
+        return;  // The $lookup was specified with the 'pipeline' syntax.
+
+    const std::string localField = lookUpSpec["localField"].getString();
+    const std::string as = lookUpSpec["as"].getString();
+
+    // Dotted paths may traverse nested arrays, which $lookup and the $group key expression
+    // flatten differently.
+    if (FieldPath(localField).getPathLength() != 1u || FieldPath(as).getPathLength() != 1u ||
+        localField == as || as == "_id") {
+        return;
+    }
+
+    const Value groupId = groupSpec["_id"];
+    if (groupId.getType() != BSONType::String || groupId.getString() != "$" + localField)
+        return;
+
+    // The joined array must be the last output field, since the $lookup will append it after the
+    // remaining accumulators.
+    boost::optional<std::string> lastFieldName;
+    for (auto it = groupSpec.fieldIterator(); it.more();) {
+        lastFieldName = it.next().first.toString();
+    }
+    if (*lastFieldName != as)
+        return;
+
+    const Value asAccumulator = groupSpec[as];
+    if (asAccumulator.getType() != BSONType::Object || asAccumulator.getDocument().size() != 1u)
+        return;
+
+    const auto accumulatorField = asAccumulator.getDocument().fieldIterator().next();
+    if ((accumulatorField.first != "$first" && accumulatorField.first != "$last") ||
+        accumulatorField.second.getType() != BSONType::String ||
+        accumulatorField.second.getString() != "$" + as) {
+        return;
+    }
+
+    MutableDocument newGroupSpec(groupSpec);
+    newGroupSpec.remove(as);
+    auto newGroup = DocumentSourceGroup::createFromBson(
+        BSON("$group" << newGroupSpec.freeze().toBson()).firstElement(), mergePipe->pCtx);
+
+    // Any other use of the 'as' field, including through $$ROOT, would observe a value the
+    // $lookup has not yet produced.
+    DepsTracker newGroupDeps;
+    newGroup->getDependencies(&newGroupDeps);
+    if (newGroupDeps.needWholeDocument ||
+        std::any_of(newGroupDeps.fields.begin(),
+                    newGroupDeps.fields.end(),
+                    [&as](const std::string& field) {
+                        return field == as || str::startsWith(field, as + ".");
+                    })) {
+        return;
+    }
+
+    MutableDocument newLookUpSpec(lookUpSpec);
+    newLookUpSpec["localField"] = Value("_id"_sd);
+    auto newLookUp = DocumentSource::parse(mergePipe->pCtx,
+                                           BSON("$lookup" << newLookUpSpec.freeze().toBson()));
+    invariant(newLookUp.size() == 1u);
+
+    *lookUpItr = std::move(newGroup);
+    *groupItr = std::move(newLookUp.front());
+}
+
 void Pipeline::Optimizations::Sharded::moveFinalUnwindFromShardsToMerger(Pipeline* shardPipe,
                                                                          Pipeline* mergePipe) {
     while (!shardPipe->_sources.empty() &&
@@ -53,6 +53,23 @@ public:
      */
     static void findSplitPoint(Pipeline* shardPipe, Pipeline* mergePipe);
 
+    /**
+     * If the first splittable stage is a $lookup whose only consumer is an immediately following
+     * $group keyed on the $lookup's 'localField', rewrites the pair so that the $group comes first
+     * and the $lookup joins on the group key instead. This allows the $group to be split and
+     * partially aggregated on the shards rather than running the $lookup on every matching
+     * document on the merging shard.
+     *
+     * The rewrite only applies when 'localField' and 'as' are top-level fields, the $lookup has not
+     * absorbed an $unwind or $match, and the 'as' field is consumed by the $group solely through a
+     * final {$first: '$<as>'} or {$last: '$<as>'} accumulator of the same name. Every document in
+     * a group then carries the same joined array, so the result is unchanged, including the order
+     * of fields in the output documents.
+     *
+     * Must be called before findSplitPoint().
+     */
+    static void moveGroupAheadOfKeyedLookUp(Pipeline* shardPipe, Pipeline* mergePipe);
+
     /**
      * If the final stage on shards is to unwind an array, move that stage to the merger. This
      * cuts down on network traffic and allows us to take advantage of reduced copying in
@@ -1333,6 +1333,70 @@ class ShouldNotCoalesceUnwindNotOnAs : public Base {
 
 }  // namespace coalesceLookUpAndUnwind
 
+namespace moveGroupAheadOfKeyedLookUp {
+
+class GroupOnLocalFieldMovesAheadOfLookUp : public Base {
+    string inputPipeJson() {
+        return "[{$lookup: {from : 'lookupColl', as : 'joined', localField: 'left', foreignField: "
+               "'right'}}"
+               ",{$group: {_id: '$left', total: {$sum: '$amount'}, joined: {$first: '$joined'}}}"
+               "]";
+    }
+    string shardPipeJson() {
+        return "[{$group: {_id: '$left', total: {$sum: '$amount'}}}]";
+    }
+    string mergePipeJson() {
+        return "[{$group: {_id: '$$ROOT._id', total: {$sum: '$$ROOT.total'}, $doingMerge: true}}"
+               ",{$lookup: {from : 'lookupColl', as : 'joined', localField: '_id', foreignField: "
+               "'right'}}"
+               "]";
+    }
+};
+
+// The leading $project keeps limitFieldsSentFromShardsToMerger() from adding a multi-field
+// projection, whose serialized field order is unspecified.
+class GroupWithOtherUseOfAsDoesNotMove : public Base {
+    string inputPipeJson() {
+        return "[{$project: {left: true}}"
+               ",{$lookup: {from : 'lookupColl', as : 'joined', localField: 'left', foreignField: "
+               "'right'}}"
+               ",{$group: {_id: '$left', names: {$push: '$joined.name'}, joined: {$first: "
+               "'$joined'}}}"
+               "]";
+    }
+    string shardPipeJson() {
+        return "[{$project: {_id: true, left: true}}]";
+    }
+    string mergePipeJson() {
+        return "[{$lookup: {from : 'lookupColl', as : 'joined', localField: 'left', foreignField: "
+               "'right'}}"
+               ",{$group: {_id: '$left', names: {$push: '$joined.name'}, joined: {$first: "
+               "'$joined'}}}"
+               "]";
+    }
+};
+
+class GroupNotKeyedOnLocalFieldDoesNotMove : public Base {
+    string inputPipeJson() {
+        return "[{$project: {left: true}}"
+               ",{$lookup: {from : 'lookupColl', as : 'joined', localField: 'left', foreignField: "
+               "'right'}}"
+               ",{$group: {_id: '$_id', joined: {$first: '$joined'}}}"
+               "]";
+    }
+    string shardPipeJson() {
+        return "[{$project: {_id: true, left: true}}]";
+    }
+    string mergePipeJson() {
+        return "[{$lookup: {from : 'lookupColl', as : 'joined', localField: 'left', foreignField: "
+               "'right'}}"
+               ",{$group: {_id: '$_id', joined: {$first: '$joined'}}}"
+               "]";
+    }
+};
+
+}  // namespace moveGroupAheadOfKeyedLookUp
+
 namespace needsPrimaryShardMerger {
 class needsPrimaryShardMergerBase : public Base {
 public:
@@ -1713,6 +1777,12 @@ public:
         add<Optimizations::Sharded::coalesceLookUpAndUnwind::
                 ShouldCoalesceUnwindOnAsWithIncludeArrayIndex>();
         add<Optimizations::Sharded::coalesceLookUpAndUnwind::ShouldNotCoalesceUnwindNotOnAs>();
+        add<Optimizations::Sharded::moveGroupAheadOfKeyedLookUp::
+                GroupOnLocalFieldMovesAheadOfLookUp>();
+        add<Optimizations::Sharded::moveGroupAheadOfKeyedLookUp::
+                GroupWithOtherUseOfAsDoesNotMove>();
+        add<Optimizations::Sharded::moveGroupAheadOfKeyedLookUp::
+                GroupNotKeyedOnLocalFieldDoesNotMove>();
         add<Optimizations::Sharded::moveFinalUnwindFromShardsToMerger::OneUnwind>();
         add<Optimizations::Sharded::moveFinalUnwindFromShardsToMerger::TwoUnwind>();
         add<Optimizations::Sharded::moveFinalUnwindFromShardsToMerger::UnwindNotFinal>();
@@ -37,6 +37,7 @@
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/jsobj.h"
@@ -214,6 +215,57 @@ void prefetchPagesForReplicatedOp(OperationContext* opCtx, Database* db, const B
     }
 }
 
+void prefetchForReplicatedOp(OperationContext* opCtx, const BSONObj& op) {
+    const char* opType = op.getStringField("op");
+    const char* idField;
+    switch (*opType) {
+        case 'i':  // insert
+            idField = nullptr;
+            break;
+        case 'd':  // delete
+            idField = "o";
+            break;
+        case 'u':  // update
+            idField = "o2";
+            break;
+        default:
+            // prefetch ignores other ops
+            return;
+    }
+
+    try {
+        AutoGetCollection autoColl(opCtx, NamespaceString(op.getStringField("ns")), MODE_IS);
+        Collection* collection = autoColl.getCollection();
+        if (!collection) {
+            return;
+        }
+
+        // An insert only touches the index entries of the new document. Updates and deletes look
+        // up the existing document by _id, and then remove or update its index entries. Capped
+        // collections typically do not have an _id index to look documents up with.
+        BSONObj doc;
+        if (!idField) {
+            doc = op.getObjectField("o");
+        } else if (!collection->isCapped()) {
+            TimerHolder timer(&prefetchDocStats);
+            RecordId loc = Helpers::findById(opCtx, collection, op.getObjectField(idField));
+            if (loc.isNull()) {
+                return;
+            }
+            doc = collection->docFor(opCtx, loc).value();
+        } else {
+            return;
+        }
+
+        prefetchIndexPages(opCtx,
+                           collection,
+                           getGlobalReplicationCoordinator()->getIndexPrefetchConfig(),
+                           doc);
+    } catch (const DBException& e) {
+        LOG(2) << "ignoring exception in prefetchForReplicatedOp(): " << redact(e);
+    }
+}
+
 class ReplIndexPrefetch : public ServerParameter {
 public:
     ReplIndexPrefetch() : ServerParameter(ServerParameterSet::getGlobal(), "replIndexPrefetch") {}
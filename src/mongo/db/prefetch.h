@@ -35,5 +35,12 @@ namespace repl {
 
 // page in possible index and/or data pages for an op from the oplog
 void prefetchPagesForReplicatedOp(OperationContext* opCtx, Database* db, const BSONObj& op);
+
+/**
+ * Reads the document an op from the oplog will modify, and the index entries it will touch, into
+ * the storage engine's cache. Only point lookups are used, so this helps any storage engine, and
+ * only intent locks are taken, so this may run while an earlier batch is being applied.
+ */
+void prefetchForReplicatedOp(OperationContext* opCtx, const BSONObj& op);
 }  // namespace repl
 }  // namespace mongo
@@ -0,0 +1,176 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/compressed_batch.h"
+
+#include "mongo/base/data_view.h"
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/shared_buffer.h"
+
+#include "third_party/snappy-1.1.3/snappy.h"
+
+namespace mongo {
+
+namespace {
+
+const char kCompressorField[] = "compressor";
+const char kCountField[] = "count";
+const char kBlocksField[] = "blocks";
+
+}  // namespace
+
+const StringData CompressedBatchBuilder::kFieldName = "compressedBatch"_sd;
+const StringData CompressedBatchBuilder::kSnappyCompressor = "snappy"_sd;
+
+CompressedBatchBuilder::CompressedBatchBuilder(BSONObjBuilder* compressedBatch)
+    : _compressedBatch(compressedBatch),
+      _blocks(compressedBatch->subarrayStart(kBlocksField)),
+      _pending(kBlockSize) {}
+
+bool CompressedBatchBuilder::haveSpaceForNext(const BSONObj& nextDoc,
+                                              long long numDocs,
+                                              int maxBytes) const {
+    invariant(numDocs >= 0);
+    if (!numDocs) {
+        return true;
+    }
+
+    if (_rawBytes + nextDoc.objsize() > kMaxRawBytes) {
+        return false;
+    }
+
+    const size_t worstCase =
+        _blocks.len() + snappy::MaxCompressedLength(_pending.len() + nextDoc.objsize());
+    return worstCase <= static_cast<size_t>(maxBytes);
+}
+
+int CompressedBatchBuilder::bytesUsed() const {
+    return _blocks.len() + snappy::MaxCompressedLength(_pending.len());
+}
+
+void CompressedBatchBuilder::append(const BSONObj& obj) {
+    _pending.appendBuf(obj.objdata(), obj.objsize());
+    _rawBytes += obj.objsize();
+    _count++;
+
+    if (_pending.len() >= kBlockSize) {
+        _flushBlock();
+    }
+}
+
+void CompressedBatchBuilder::done() {
+    if (_pending.len()) {
+        _flushBlock();
+    }
+    _blocks.doneFast();
+    _compressedBatch->append(kCompressorField, kSnappyCompressor);
+    _compressedBatch->append(kCountField, _count);
+}
+
+void CompressedBatchBuilder::_flushBlock() {
+    _scratch.resize(snappy::MaxCompressedLength(_pending.len()));
+    size_t compressedLength;
+    snappy::RawCompress(_pending.buf(), _pending.len(), &_scratch[0], &compressedLength);
+    _blocks.appendBinData(compressedLength, BinDataGeneral, _scratch.data());
+    _pending.reset();
+}
+
+StatusWith<std::vector<BSONObj>> decompressBatch(const BSONObj& compressedBatch) {
+    std::string compressor;
+    Status status = bsonExtractStringField(compressedBatch, kCompressorField, &compressor);
+    if (!status.isOK()) {
+        return status;
+    }
+    if (compressor != CompressedBatchBuilder::kSnappyCompressor) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Unsupported batch compressor '" << compressor << "'"};
+    }
+
+    long long count;
+    status = bsonExtractIntegerField(compressedBatch, kCountField, &count);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    BSONElement blocksElement;
+    status = bsonExtractTypedField(compressedBatch, kBlocksField, Array, &blocksElement);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    std::vector<BSONObj> documents;
+    for (const auto& block : blocksElement.Obj()) {
+        if (block.type() != BinData || block.binDataType() != BinDataGeneral) {
+            return {ErrorCodes::TypeMismatch,
+                    str::stream() << "Compressed batch block must be of type BinData: " << block};
+        }
+
+        int compressedLength;
+        const char* compressed = block.binData(compressedLength);
+        size_t rawLength;
+        if (!snappy::GetUncompressedLength(compressed, compressedLength, &rawLength) ||
+            rawLength > static_cast<size_t>(CompressedBatchBuilder::kMaxRawBytes)) {
+            return {ErrorCodes::BadValue, "Compressed batch block was invalid or corrupted"};
+        }
+
+        auto raw = SharedBuffer::allocate(rawLength);
+        if (!snappy::RawUncompress(compressed, compressedLength, raw.get())) {
+            return {ErrorCodes::BadValue, "Compressed batch block was invalid or corrupted"};
+        }
+
+        ConstSharedBuffer rawBlock(raw);
+        size_t offset = 0;
+        while (offset < rawLength) {
+            if (rawLength - offset < static_cast<size_t>(BSONObj::kMinBSONLength)) {
+                return {ErrorCodes::BadValue, "Compressed batch block holds a truncated document"};
+            }
+            const char* data = rawBlock.get() + offset;
+            const int size = ConstDataView(data).read<LittleEndian<int>>();
+            if (size < BSONObj::kMinBSONLength || static_cast<size_t>(size) > rawLength - offset) {
+                return {ErrorCodes::BadValue, "Compressed batch block holds a truncated document"};
+            }
+            documents.push_back(BSONObj(data).shareOwnershipWith(rawBlock));
+            offset += size;
+        }
+    }
+
+    if (documents.size() != static_cast<size_t>(count)) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Compressed batch holds " << documents.size()
+                              << " documents, expected "
+                              << count};
+    }
+
+    return std::move(documents);
+}
+
+}  // namespace mongo
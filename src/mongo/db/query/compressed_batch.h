@@ -0,0 +1,109 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+
+namespace mongo {
+
+/**
+ * Builds a cursor batch as a sequence of snappy-compressed blocks, each holding whole BSON
+ * documents laid end to end, instead of as an array of documents. The result is appended to the
+ * cursor object of a reply under the field name kFieldName, in the following format:
+ *
+ *   compressedBatch: {compressor: "snappy", count: <int>, blocks: [<BinData>, ...]}
+ *
+ * Since the documents are only accounted for at their compressed size, a compressed batch may
+ * carry up to kMaxRawBytes of documents in a reply no larger than an uncompressed one.
+ */
+class CompressedBatchBuilder {
+    MONGO_DISALLOW_COPYING(CompressedBatchBuilder);
+
+public:
+    static const StringData kFieldName;
+    static const StringData kSnappyCompressor;
+
+    // Uncompressed size at which the pending block is compressed and a new one is started. This
+    // matches snappy's own block size, so splitting the batch costs nothing in compression ratio.
+    static const int kBlockSize = 64 * 1024;
+
+    // Upper bound on the total uncompressed size of the documents in a single batch.
+    static const int kMaxRawBytes = 4 * BSONObjMaxUserSize;
+
+    /**
+     * Builds the compressed batch into 'compressedBatch', which must remain valid and otherwise
+     * unused until done() is called.
+     */
+    explicit CompressedBatchBuilder(BSONObjBuilder* compressedBatch);
+
+    /**
+     * Returns whether 'nextDoc' can be added to a batch already holding 'numDocs' documents without
+     * the compressed batch growing past 'maxBytes' or its documents past kMaxRawBytes. The first
+     * document is always accepted so that callers can always make progress.
+     */
+    bool haveSpaceForNext(const BSONObj& nextDoc, long long numDocs, int maxBytes) const;
+
+    /**
+     * Returns an upper bound on the number of bytes the batch will occupy once done() is called.
+     */
+    int bytesUsed() const;
+
+    void append(const BSONObj& obj);
+
+    /**
+     * Compresses any pending documents and completes the batch object.
+     */
+    void done();
+
+private:
+    void _flushBlock();
+
+    BSONObjBuilder* const _compressedBatch;
+    BSONArrayBuilder _blocks;
+    BufBuilder _pending;
+    std::string _scratch;
+    int _rawBytes = 0;
+    int _count = 0;
+};
+
+/**
+ * Decompresses a batch built by CompressedBatchBuilder, returning its documents in order. The
+ * returned documents own their memory.
+ */
+StatusWith<std::vector<BSONObj>> decompressBatch(const BSONObj& compressedBatch);
+
+}  // namespace mongo
@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/compressed_batch.h"
+
+#include <string>
+
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * Builds a getMore reply holding 'docs' in a compressed batch and returns the 'compressedBatch'
+ * object from its cursor field.
+ */
+BSONObj buildCompressedBatch(const std::vector<BSONObj>& docs) {
+    BSONObjBuilder reply;
+    CursorResponseBuilder nextBatch(/*isInitialResponse*/ false, &reply);
+    nextBatch.compressBatch();
+    for (const auto& doc : docs) {
+        nextBatch.append(doc);
+    }
+    nextBatch.done(CursorId(123), "db.coll");
+    BSONObj cursor = reply.obj()["cursor"].Obj().getOwned();
+
+    ASSERT_EQ(0, cursor["nextBatch"].Obj().nFields());
+    ASSERT_EQ(CursorId(123), cursor["id"].numberLong());
+    return cursor[CompressedBatchBuilder::kFieldName].Obj().getOwned();
+}
+
+std::vector<BSONObj> makeDocs(int numDocs, int paddingSize) {
+    std::vector<BSONObj> docs;
+    for (int i = 0; i < numDocs; ++i) {
+        docs.push_back(BSON("_id" << i << "padding" << std::string(paddingSize, 'x')));
+    }
+    return docs;
+}
+
+TEST(CompressedBatchTest, RoundTrip) {
+    auto docs = makeDocs(10, 10);
+    BSONObj compressedBatch = buildCompressedBatch(docs);
+    ASSERT_EQ(10, compressedBatch["count"].numberInt());
+    ASSERT_EQ(1, compressedBatch["blocks"].Obj().nFields());
+
+    auto decompressed = decompressBatch(compressedBatch);
+    ASSERT_OK(decompressed.getStatus());
+    ASSERT_EQ(docs.size(), decompressed.getValue().size());
+    for (size_t i = 0; i < docs.size(); ++i) {
+        ASSERT_BSONOBJ_EQ(docs[i], decompressed.getValue()[i]);
+        ASSERT(decompressed.getValue()[i].isOwned());
+    }
+}
+
+TEST(CompressedBatchTest, EmptyBatch) {
+    BSONObj compressedBatch = buildCompressedBatch({});
+    ASSERT_EQ(0, compressedBatch["blocks"].Obj().nFields());
+
+    auto decompressed = decompressBatch(compressedBatch);
+    ASSERT_OK(decompressed.getStatus());
+    ASSERT(decompressed.getValue().empty());
+}
+
+TEST(CompressedBatchTest, LargeBatchIsSplitIntoBlocksAndCompressed) {
+    auto docs = makeDocs(1000, 1000);
+    BSONObj compressedBatch = buildCompressedBatch(docs);
+    ASSERT_GT(compressedBatch["blocks"].Obj().nFields(), 1);
+    ASSERT_LT(compressedBatch.objsize(), 1000 * 1000 / 2);
+
+    auto decompressed = decompressBatch(compressedBatch);
+    ASSERT_OK(decompressed.getStatus());
+    ASSERT_EQ(docs.size(), decompressed.getValue().size());
+    ASSERT_BSONOBJ_EQ(docs.back(), decompressed.getValue().back());
+}
+
+TEST(CompressedBatchTest, HaveSpaceForNextBoundsCompressedSize) {
+    BSONObjBuilder bob;
+    CompressedBatchBuilder builder(&bob);
+    BSONObj doc = BSON("padding" << std::string(1000, 'x'));
+
+    ASSERT(builder.haveSpaceForNext(doc, 0, 0));
+    builder.append(doc);
+    ASSERT_FALSE(builder.haveSpaceForNext(doc, 1, doc.objsize()));
+    ASSERT(builder.haveSpaceForNext(doc, 1, BSONObjMaxUserSize));
+    builder.done();
+}
+
+TEST(CompressedBatchTest, HaveSpaceForNextBoundsUncompressedSize) {
+    BSONObjBuilder bob;
+    CompressedBatchBuilder builder(&bob);
+    BSONObj doc = BSON("padding" << std::string(BSONObjMaxUserSize / 2, 'x'));
+
+    int numDocs = 0;
+    while (builder.haveSpaceForNext(doc, numDocs, BSONObjMaxUserSize)) {
+        builder.append(doc);
+        ++numDocs;
+    }
+    ASSERT_EQ(CompressedBatchBuilder::kMaxRawBytes / doc.objsize(), numDocs);
+    ASSERT_LTE(builder.bytesUsed(), BSONObjMaxUserSize);
+    builder.done();
+}
+
+TEST(CompressedBatchTest, UnsupportedCompressor) {
+    auto decompressed = decompressBatch(BSON("compressor"
+                                             << "zlib"
+                                             << "count"
+                                             << 0
+                                             << "blocks"
+                                             << BSONArray()));
+    ASSERT_EQ(ErrorCodes::BadValue, decompressed.getStatus());
+}
+
+TEST(CompressedBatchTest, CorruptBlock) {
+    const char garbage[] = "not a snappy block";
+    BSONArrayBuilder blocks;
+    blocks.appendBinData(sizeof(garbage), BinDataGeneral, garbage);
+    auto decompressed = decompressBatch(BSON("compressor"
+                                             << "snappy"
+                                             << "count"
+                                             << 1
+                                             << "blocks"
+                                             << blocks.arr()));
+    ASSERT_EQ(ErrorCodes::BadValue, decompressed.getStatus());
+}
+
+TEST(CompressedBatchTest, CountMismatch) {
+    BSONObj compressedBatch = buildCompressedBatch(makeDocs(3, 10));
+    BSONObjBuilder bob;
+    bob.appendElements(compressedBatch.removeField("count"));
+    bob.append("count", 4);
+
+    auto decompressed = decompressBatch(bob.obj());
+    ASSERT_EQ(ErrorCodes::BadValue, decompressed.getStatus());
+}
+
+}  // namespace
+
+}  // namespace mongo
@@ -55,9 +55,27 @@ CursorResponseBuilder::CursorResponseBuilder(bool isInitialResponse,
       _cursorObject(commandResponse->subobjStart(kCursorField)),
       _batch(_cursorObject.subarrayStart(isInitialResponse ? kBatchFieldInitial : kBatchField)) {}
 
-void CursorResponseBuilder::done(CursorId cursorId, StringData cursorNamespace) {
+void CursorResponseBuilder::compressBatch() {
     invariant(_active);
+    invariant(!_compressedBatch);
+    invariant(_batch.arrSize() == 0);
     _batch.doneFast();
+    _compressedBatchObject.emplace(_cursorObject.subobjStart(CompressedBatchBuilder::kFieldName));
+    _compressedBatch.emplace(_compressedBatchObject.get_ptr());
+}
+
+void CursorResponseBuilder::_doneBatch() {
+    if (_compressedBatch) {
+        _compressedBatch->done();
+        _compressedBatchObject->doneFast();
+    } else {
+        _batch.doneFast();
+    }
+}
+
+void CursorResponseBuilder::done(CursorId cursorId, StringData cursorNamespace) {
+    invariant(_active);
+    _doneBatch();
     _cursorObject.append(kIdField, cursorId);
     _cursorObject.append(kNsField, cursorNamespace);
     _cursorObject.doneFast();
@@ -66,7 +84,7 @@ void CursorResponseBuilder::done(CursorId cursorId, StringData cursorNamespace)
 
 void CursorResponseBuilder::abandon() {
     invariant(_active);
-    _batch.doneFast();
+    _doneBatch();
     _cursorObject.doneFast();
     _commandResponse->bb().setlen(_responseInitialLen);  // Removes everything we've added.
     _active = false;
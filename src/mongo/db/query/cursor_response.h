@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
@@ -35,6 +36,7 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/query/compressed_batch.h"
 
 namespace mongo {
 
@@ -62,12 +64,30 @@ public:
 
     size_t bytesUsed() const {
         invariant(_active);
-        return _batch.len();
+        return _compressedBatch ? _compressedBatch->bytesUsed() : _batch.len();
     }
 
     void append(const BSONObj& obj) {
         invariant(_active);
-        _batch.append(obj);
+        if (_compressedBatch) {
+            _compressedBatch->append(obj);
+        } else {
+            _batch.append(obj);
+        }
+    }
+
+    /**
+     * Makes the documents appended from now on go into a snappy-compressed batch, as described in
+     * compressed_batch.h, and leaves the ordinary batch array empty. Must be called before any
+     * document is appended.
+     */
+    void compressBatch();
+
+    /**
+     * Returns the builder of the compressed batch, or nullptr if compressBatch() was not called.
+     */
+    const CompressedBatchBuilder* compressedBatch() const {
+        return _compressedBatch.get_ptr();
     }
 
     /**
@@ -84,11 +104,15 @@ public:
     void abandon();
 
 private:
+    void _doneBatch();
+
     const int _responseInitialLen;  // Must be the first member so its initializer runs first.
     bool _active = true;
     BSONObjBuilder* const _commandResponse;
     BSONObjBuilder _cursorObject;
     BSONArrayBuilder _batch;
+    boost::optional<BSONObjBuilder> _compressedBatchObject;
+    boost::optional<CompressedBatchBuilder> _compressedBatch;
 };
 
 /**
@@ -36,6 +36,7 @@
 
 #include "mongo/db/commands.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/query/compressed_batch.h"
 #include "mongo/db/repl/bson_extract_optime.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/stringutils.h"
@@ -49,6 +50,7 @@ const char kBatchSizeField[] = "batchSize";
 const char kAwaitDataTimeoutField[] = "maxTimeMS";
 const char kTermField[] = "term";
 const char kLastKnownCommittedOpTimeField[] = "lastKnownCommittedOpTime";
+const char kBatchCompressorField[] = "batchCompressor";
 
 }  // namespace
 
@@ -61,13 +63,15 @@ GetMoreRequest::GetMoreRequest(NamespaceString namespaceString,
                                boost::optional<long long> sizeOfBatch,
                                boost::optional<Milliseconds> awaitDataTimeout,
                                boost::optional<long long> term,
-                               boost::optional<repl::OpTime> lastKnownCommittedOpTime)
+                               boost::optional<repl::OpTime> lastKnownCommittedOpTime,
+                               boost::optional<std::string> batchCompressor)
     : nss(std::move(namespaceString)),
       cursorid(id),
       batchSize(sizeOfBatch),
       awaitDataTimeout(awaitDataTimeout),
       term(term),
-      lastKnownCommittedOpTime(lastKnownCommittedOpTime) {}
+      lastKnownCommittedOpTime(lastKnownCommittedOpTime),
+      batchCompressor(std::move(batchCompressor)) {}
 
 Status GetMoreRequest::isValid() const {
     if (!nss.isValid()) {
@@ -86,6 +90,12 @@ Status GetMoreRequest::isValid() const {
                                     << *batchSize);
     }
 
+    if (batchCompressor && *batchCompressor != CompressedBatchBuilder::kSnappyCompressor) {
+        return Status(ErrorCodes::BadValue,
+                      str::stream() << "Unsupported batch compressor for getMore: "
+                                    << *batchCompressor);
+    }
+
     return Status::OK();
 }
 
@@ -111,6 +121,7 @@ StatusWith<GetMoreRequest> GetMoreRequest::parseFromBSON(const std::string& dbna
     boost::optional<Milliseconds> awaitDataTimeout;
     boost::optional<long long> term;
     boost::optional<repl::OpTime> lastKnownCommittedOpTime;
+    boost::optional<std::string> batchCompressor;
 
     for (BSONElement el : cmdObj) {
         const auto fieldName = el.fieldNameStringData();
@@ -158,6 +169,13 @@ StatusWith<GetMoreRequest> GetMoreRequest::parseFromBSON(const std::string& dbna
                 return status;
             }
             lastKnownCommittedOpTime = ot;
+        } else if (fieldName == kBatchCompressorField) {
+            if (el.type() != BSONType::String) {
+                return {ErrorCodes::TypeMismatch,
+                        str::stream() << "Field 'batchCompressor' must be of type string in: "
+                                      << cmdObj};
+            }
+            batchCompressor = el.String();
         } else if (!Command::isGenericArgument(fieldName)) {
             return {ErrorCodes::FailedToParse,
                     str::stream() << "Failed to parse: " << cmdObj << ". "
@@ -177,8 +195,13 @@ StatusWith<GetMoreRequest> GetMoreRequest::parseFromBSON(const std::string& dbna
                 str::stream() << "Field 'collection' missing in: " << cmdObj};
     }
 
-    GetMoreRequest request(
-        std::move(*nss), *cursorid, batchSize, awaitDataTimeout, term, lastKnownCommittedOpTime);
+    GetMoreRequest request(std::move(*nss),
+                           *cursorid,
+                           batchSize,
+                           awaitDataTimeout,
+                           term,
+                           lastKnownCommittedOpTime,
+                           std::move(batchCompressor));
     Status validStatus = request.isValid();
     if (!validStatus.isOK()) {
         return validStatus;
@@ -209,6 +232,10 @@ BSONObj GetMoreRequest::toBSON() const {
         lastKnownCommittedOpTime->append(&builder, kLastKnownCommittedOpTimeField);
     }
 
+    if (batchCompressor) {
+        builder.append(kBatchCompressorField, *batchCompressor);
+    }
+
     return builder.obj();
 }
 
@@ -55,7 +55,8 @@ struct GetMoreRequest {
                    boost::optional<long long> sizeOfBatch,
                    boost::optional<Milliseconds> awaitDataTimeout,
                    boost::optional<long long> term,
-                   boost::optional<repl::OpTime> lastKnownCommittedOpTime);
+                   boost::optional<repl::OpTime> lastKnownCommittedOpTime,
+                   boost::optional<std::string> batchCompressor = boost::none);
 
     /**
      * Construct a GetMoreRequest from the command specification and db name.
@@ -87,6 +88,10 @@ struct GetMoreRequest {
     // Only internal queries from replication will have a last known committed optime.
     const boost::optional<repl::OpTime> lastKnownCommittedOpTime;
 
+    // Asks for the batch to be returned compressed with the named compressor rather than as an
+    // array of documents. Only internal queries from replication will typically set this.
+    const boost::optional<std::string> batchCompressor;
+
 private:
     /**
      * Returns a non-OK status if there are semantic errors in the parsed request
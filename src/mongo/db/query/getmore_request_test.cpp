@@ -280,4 +280,42 @@ TEST(GetMoreRequestTest, toBSONHasMaxTimeMS) {
     ASSERT_BSONOBJ_EQ(requestObj, expectedRequest);
 }
 
+TEST(GetMoreRequestTest, parseFromBSONBatchCompressor) {
+    StatusWith<GetMoreRequest> result = GetMoreRequest::parseFromBSON(
+        "db",
+        BSON("getMore" << CursorId(123) << "collection"
+                       << "coll"
+                       << "batchCompressor"
+                       << "snappy"));
+    ASSERT_OK(result.getStatus());
+    ASSERT(result.getValue().batchCompressor);
+    ASSERT_EQUALS("snappy", *result.getValue().batchCompressor);
+}
+
+TEST(GetMoreRequestTest, parseFromBSONUnsupportedBatchCompressor) {
+    StatusWith<GetMoreRequest> result = GetMoreRequest::parseFromBSON(
+        "db",
+        BSON("getMore" << CursorId(123) << "collection"
+                       << "coll"
+                       << "batchCompressor"
+                       << "zlib"));
+    ASSERT_EQUALS(ErrorCodes::BadValue, result.getStatus());
+}
+
+TEST(GetMoreRequestTest, toBSONHasBatchCompressor) {
+    GetMoreRequest request(NamespaceString("testdb.testcoll"),
+                           123,
+                           boost::none,
+                           boost::none,
+                           boost::none,
+                           boost::none,
+                           std::string("snappy"));
+    BSONObj requestObj = request.toBSON();
+    BSONObj expectedRequest = BSON("getMore" << CursorId(123) << "collection"
+                                             << "testcoll"
+                                             << "batchCompressor"
+                                             << "snappy");
+    ASSERT_BSONOBJ_EQ(requestObj, expectedRequest);
+}
+
 }  // namespace
@@ -87,19 +87,17 @@ private:
 
 CollectionBulkLoaderImpl::CollectionBulkLoaderImpl(ServiceContext::UniqueClient&& client,
                                                    ServiceContext::UniqueOperationContext&& opCtx,
-                                                   std::unique_ptr<AutoGetCollection>&& autoColl,
+                                                   Collection* collection,
                                                    const BSONObj& idIndexSpec)
     : _client{std::move(client)},
       _opCtx{std::move(opCtx)},
-      _autoColl{std::move(autoColl)},
-      _nss{_autoColl->getCollection()->ns()},
-      _idIndexBlock(stdx::make_unique<MultiIndexBlock>(_opCtx.get(), _autoColl->getCollection())),
-      _secondaryIndexesBlock(
-          stdx::make_unique<MultiIndexBlock>(_opCtx.get(), _autoColl->getCollection())),
+      _nss{collection->ns()},
+      _uuid{collection->uuid()},
+      _idIndexBlock(stdx::make_unique<MultiIndexBlock>(_opCtx.get(), collection)),
+      _secondaryIndexesBlock(stdx::make_unique<MultiIndexBlock>(_opCtx.get(), collection)),
       _idIndexSpec(idIndexSpec.getOwned()) {
 
     invariant(_opCtx);
-    invariant(_autoColl->getCollection());
 }
 
 CollectionBulkLoaderImpl::~CollectionBulkLoaderImpl() {
@@ -109,7 +107,7 @@ CollectionBulkLoaderImpl::~CollectionBulkLoaderImpl() {
 
 Status CollectionBulkLoaderImpl::init(const std::vector<BSONObj>& secondaryIndexSpecs) {
     return _runTaskReleaseResourcesOnFailure(
-        [ coll = _autoColl->getCollection(), &secondaryIndexSpecs, this ]()->Status {
+        [&secondaryIndexSpecs, this](Collection* collection)->Status {
             // All writes in CollectionBulkLoaderImpl should be unreplicated.
             // The opCtx is accessed indirectly through _secondaryIndexesBlock.
             UnreplicatedWritesBlock uwb(_opCtx.get());
@@ -141,7 +139,7 @@ Status CollectionBulkLoaderImpl::init(const std::vector<BSONObj>& secondaryIndex
 Status CollectionBulkLoaderImpl::insertDocuments(const std::vector<BSONObj>::const_iterator begin,
                                                  const std::vector<BSONObj>::const_iterator end) {
     int count = 0;
-    return _runTaskReleaseResourcesOnFailure([&]() -> Status {
+    return _runTaskReleaseResourcesOnFailure([&](Collection* collection) -> Status {
         UnreplicatedWritesBlock uwb(_opCtx.get());
 
         for (auto iter = begin; iter != end; ++iter) {
@@ -159,15 +157,15 @@ Status CollectionBulkLoaderImpl::insertDocuments(const std::vector<BSONObj>::con
                     if (!indexers.empty()) {
                         // This flavor of insertDocument will not update any pre-existing indexes,
                         // only the indexers passed in.
-                        const auto status = _autoColl->getCollection()->insertDocument(
-                            _opCtx.get(), *iter, indexers, false);
+                        const auto status =
+                            collection->insertDocument(_opCtx.get(), *iter, indexers, false);
                         if (!status.isOK()) {
                             return status;
                         }
                     } else {
                         // For capped collections, we use regular insertDocument, which will update
                         // pre-existing indexes.
-                        const auto status = _autoColl->getCollection()->insertDocument(
+                        const auto status = collection->insertDocument(
                             _opCtx.get(), InsertStatement(*iter), nullptr, false);
                         if (!status.isOK()) {
                             return status;
@@ -190,7 +188,7 @@ Status CollectionBulkLoaderImpl::insertDocuments(const std::vector<BSONObj>::con
 }
 
 Status CollectionBulkLoaderImpl::commit() {
-    return _runTaskReleaseResourcesOnFailure([this]() -> Status {
+    return _runTaskReleaseResourcesOnFailure([this](Collection* collection) -> Status {
         _stats.startBuildingIndexes = Date_t::now();
         LOG(2) << "Creating indexes for ns: " << _nss.ns();
         UnreplicatedWritesBlock uwb(_opCtx.get());
@@ -227,14 +225,14 @@ Status CollectionBulkLoaderImpl::commit() {
 
             for (auto&& it : dups) {
                 writeConflictRetry(
-                    _opCtx.get(), "CollectionBulkLoaderImpl::commit", _nss.ns(), [this, &it] {
+                    _opCtx.get(), "CollectionBulkLoaderImpl::commit", _nss.ns(), [&] {
                         WriteUnitOfWork wunit(_opCtx.get());
-                        _autoColl->getCollection()->deleteDocument(_opCtx.get(),
-                                                                   kUninitializedStmtId,
-                                                                   it,
-                                                                   nullptr /** OpDebug **/,
-                                                                   false /* fromMigrate */,
-                                                                   true /* noWarn */);
+                        collection->deleteDocument(_opCtx.get(),
+                                                   kUninitializedStmtId,
+                                                   it,
+                                                   nullptr /** OpDebug **/,
+                                                   false /* fromMigrate */,
+                                                   true /* noWarn */);
                         wunit.commit();
                     });
             }
@@ -256,6 +254,24 @@ Status CollectionBulkLoaderImpl::commit() {
 
 void CollectionBulkLoaderImpl::_releaseResources() {
     invariant(&cc() == _opCtx->getClient());
+    if (!_secondaryIndexesBlock && !_idIndexBlock) {
+        return;
+    }
+
+    // Dropping unfinished indexes requires the collection lock.
+    AutoGetCollection autoColl(_opCtx.get(), _nss, MODE_IX);
+
+    // The unfinished indexes went away with the collection if it was dropped or renamed, in which
+    // case the index blocks must not touch it.
+    if (!_getCollection(autoColl).isOK()) {
+        if (_secondaryIndexesBlock) {
+            _secondaryIndexesBlock->abortWithoutCleanup();
+        }
+        if (_idIndexBlock) {
+            _idIndexBlock->abortWithoutCleanup();
+        }
+    }
+
     if (_secondaryIndexesBlock) {
         // A valid Client is required to drop unfinished indexes.
         Client::initThreadIfNotAlready();
@@ -267,19 +283,21 @@ void CollectionBulkLoaderImpl::_releaseResources() {
         Client::initThreadIfNotAlready();
         _idIndexBlock.reset();
     }
-
-    // release locks.
-    _autoColl.reset();
 }
 
 template <typename F>
 Status CollectionBulkLoaderImpl::_runTaskReleaseResourcesOnFailure(F task) noexcept {
 
     AlternativeClientRegion acr(_client);
+    AutoGetCollection autoColl(_opCtx.get(), _nss, MODE_IX);
     ScopeGuard guard = MakeGuard(&CollectionBulkLoaderImpl::_releaseResources, this);
     try {
-        const auto status = [&task]() noexcept {
-            return task();
+        const auto status = [&task, &autoColl, this ]() noexcept {
+            auto swCollection = _getCollection(autoColl);
+            if (!swCollection.isOK()) {
+                return swCollection.getStatus();
+            }
+            return task(swCollection.getValue());
         }
         ();
         if (status.isOK()) {
@@ -291,6 +309,18 @@ Status CollectionBulkLoaderImpl::_runTaskReleaseResourcesOnFailure(F task) noexc
     }
 }
 
+StatusWith<Collection*> CollectionBulkLoaderImpl::_getCollection(
+    const AutoGetCollection& autoColl) const {
+    Collection* const collection = autoColl.getCollection();
+    if (!collection || collection->uuid() != _uuid) {
+        return {ErrorCodes::NamespaceNotFound,
+                str::stream() << "Collection " << _nss.ns()
+                              << " was dropped or renamed while it was being loaded"};
+    }
+
+    return collection;
+}
+
 CollectionBulkLoaderImpl::Stats CollectionBulkLoaderImpl::getStats() const {
     return _stats;
 }
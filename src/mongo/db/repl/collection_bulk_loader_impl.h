@@ -33,6 +33,7 @@
 #include "mongo/base/status.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/catalog/index_create.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/namespace_string.h"
@@ -45,6 +46,9 @@ namespace repl {
 /**
  * Class in charge of building a collection during data loading (like initial sync).
  *
+ * The collection lock is only held while the loader is inserting documents or building indexes,
+ * so that other collections in the same database can be created while it is in use.
+ *
  * Note: Call commit when done inserting documents.
  */
 class CollectionBulkLoaderImpl : public CollectionBulkLoader {
@@ -61,7 +65,7 @@ public:
 
     CollectionBulkLoaderImpl(ServiceContext::UniqueClient&& client,
                              ServiceContext::UniqueOperationContext&& opCtx,
-                             std::unique_ptr<AutoGetCollection>&& autoColl,
+                             Collection* collection,
                              const BSONObj& idIndexSpec);
     virtual ~CollectionBulkLoaderImpl();
 
@@ -79,13 +83,23 @@ public:
 private:
     void _releaseResources();
 
+    /**
+     * Runs 'task' with the collection being loaded, under the collection lock, which is only held
+     * for the duration of the task. Releases the resources of the loader if the task fails.
+     */
     template <typename F>
     Status _runTaskReleaseResourcesOnFailure(F task) noexcept;
 
+    /**
+     * Returns the collection being loaded, locked by 'autoColl', or NamespaceNotFound if it was
+     * dropped or renamed since the loader last held the lock.
+     */
+    StatusWith<Collection*> _getCollection(const AutoGetCollection& autoColl) const;
+
     ServiceContext::UniqueClient _client;
     ServiceContext::UniqueOperationContext _opCtx;
-    std::unique_ptr<AutoGetCollection> _autoColl;
     NamespaceString _nss;
+    OptionalCollectionUUID _uuid;
     std::unique_ptr<MultiIndexBlock> _idIndexBlock;
     std::unique_ptr<MultiIndexBlock> _secondaryIndexesBlock;
     BSONObj _idIndexSpec;
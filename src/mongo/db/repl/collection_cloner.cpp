@@ -32,6 +32,7 @@
 
 #include "mongo/db/repl/collection_cloner.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "mongo/base/string_data.h"
@@ -68,6 +69,66 @@ MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncCollectionCountAttempts, int, 3);
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListIndexesAttempts, int, 3);
 // The number of attempts for the find command, which gets the data.
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncCollectionFindAttempts, int, 3);
+
+// The number of _id ranges a collection is split into so that each range can be fetched over its
+// own cursor. Only used when cloning with a single 'find' cursor per collection. 1 disables it.
+MONGO_EXPORT_SERVER_PARAMETER(initialSyncCollectionClonerRanges, int, 1);
+
+// The number of documents a collection must have for it to be cloned in _id ranges.
+MONGO_EXPORT_SERVER_PARAMETER(initialSyncCollectionClonerRangeMinDocuments, long long, 100000);
+
+const int kMaxCollectionClonerRanges = 64;
+
+// The number of _id values sampled for each range when picking the range boundaries.
+const int kIdSamplesPerRange = 16;
+
+/**
+ * Sorts and deduplicates the sampled '{_id: <value>}' documents and returns up to 'numRanges - 1'
+ * of them, evenly spaced, to be used as the boundaries between consecutive _id ranges.
+ */
+std::vector<BSONObj> selectRangeSplitPoints(std::vector<BSONObj> sampledIds, int numRanges) {
+    std::sort(sampledIds.begin(), sampledIds.end(), [](const BSONObj& lhs, const BSONObj& rhs) {
+        return lhs.woCompare(rhs) < 0;
+    });
+    sampledIds.erase(std::unique(sampledIds.begin(),
+                                 sampledIds.end(),
+                                 [](const BSONObj& lhs, const BSONObj& rhs) {
+                                     return lhs.woCompare(rhs) == 0;
+                                 }),
+                     sampledIds.end());
+
+    std::vector<BSONObj> splitPoints;
+    if (sampledIds.size() < 2) {
+        return splitPoints;
+    }
+    for (int i = 1; i < numRanges; ++i) {
+        const auto& splitPoint = sampledIds[i * sampledIds.size() / numRanges];
+        if (splitPoints.empty() || splitPoints.back().woCompare(splitPoint) < 0) {
+            splitPoints.push_back(splitPoint);
+        }
+    }
+    return splitPoints;
+}
+
+/**
+ * Returns a 'find' command over the _id index range ['min', 'max'). An empty bound leaves that
+ * side of the range open.
+ */
+BSONObj makeRangeFindCommand(const NamespaceString& nss, const BSONObj& min, const BSONObj& max) {
+    BSONObjBuilder cmdObj;
+    cmdObj.append("find", nss.coll());
+    cmdObj.append("noCursorTimeout", true);
+    cmdObj.append("batchSize", 0);
+    cmdObj.append("hint", BSON("_id" << 1));
+    if (!min.isEmpty()) {
+        cmdObj.append("min", min);
+    }
+    if (!max.isEmpty()) {
+        cmdObj.append("max", max);
+    }
+    return cmdObj.obj();
+}
+
 }  // namespace
 
 // Failpoint which causes initial sync to hang when it has cloned 'numDocsToClone' documents to
@@ -140,7 +201,9 @@ CollectionCloner::CollectionCloner(executor::TaskExecutor* executor,
                      "documents copied",
                      str::stream() << _sourceNss.toString() << " collection clone progress"),
       _collectionCloningBatchSize(batchSize),
-      _maxNumClonerCursors(maxNumClonerCursors) {
+      _maxNumClonerCursors(maxNumClonerCursors),
+      _numClonerRanges(initialSyncCollectionClonerRanges.load()),
+      _minDocumentsForClonerRanges(initialSyncCollectionClonerRangeMinDocuments.load()) {
     // Fetcher throws an exception on null executor.
     invariant(executor);
     uassert(ErrorCodes::BadValue,
@@ -229,12 +292,27 @@ void CollectionCloner::_cancelRemainingWork_inlock() {
     if (_establishCollectionCursorsScheduler) {
         _establishCollectionCursorsScheduler->shutdown();
     }
+    if (_sampleIdsScheduler) {
+        _sampleIdsScheduler->shutdown();
+    }
+    for (auto&& scheduler : _rangeCursorSchedulers) {
+        scheduler->shutdown();
+    }
     _dbWorkTaskRunner.cancel();
 }
 
 CollectionCloner::Stats CollectionCloner::getStats() const {
     stdx::unique_lock<stdx::mutex> lk(_mutex);
-    return _stats;
+    auto stats = _stats;
+    if (stats.start != Date_t() && stats.end == Date_t() && stats.documentsCopied > 0 &&
+        stats.documentToCopy > stats.documentsCopied) {
+        const auto elapsed = duration_cast<Milliseconds>(_executor->now() - stats.start);
+        const double remainingRatio =
+            double(stats.documentToCopy - stats.documentsCopied) / stats.documentsCopied;
+        stats.estimatedTimeRemaining =
+            Milliseconds(static_cast<long long>(elapsed.count() * remainingRatio));
+    }
+    return stats;
 }
 
 void CollectionCloner::join() {
@@ -262,6 +340,12 @@ std::vector<BSONObj> CollectionCloner::getDocumentsToInsert_forTest() {
     return _documentsToInsert;
 }
 
+void CollectionCloner::setRangePartitioning_forTest(int numRanges, long long minDocuments) {
+    LockGuard lk(_mutex);
+    _numClonerRanges = numRanges;
+    _minDocumentsForClonerRanges = minDocuments;
+}
+
 void CollectionCloner::_countCallback(
     const executor::TaskExecutor::RemoteCommandCallbackArgs& args) {
 
@@ -429,6 +513,50 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
 
     _collLoader = std::move(collectionBulkLoader.getValue());
 
+    const int numRanges = [this] {
+        LockGuard lk(_mutex);
+        return _getNumRangesToClone_inlock();
+    }();
+    if (numRanges > 1) {
+        // Sample the _id index to pick the range boundaries. The sample stays well under the 5% of
+        // the collection above which '$sample' falls back on sorting a collection scan.
+        const int sampleSize = numRanges * kIdSamplesPerRange;
+        auto cmdObj = BSON("aggregate" << _sourceNss.coll() << "pipeline"
+                                       << BSON_ARRAY(BSON("$sample" << BSON("size" << sampleSize))
+                                                     << BSON("$project" << BSON("_id" << 1)))
+                                       << "cursor"
+                                       << BSON("batchSize" << sampleSize));
+
+        Client::initThreadIfNotAlready();
+        auto opCtx = cc().getOperationContext();
+
+        UniqueLock lk(_mutex);
+        _sampleIdsScheduler = stdx::make_unique<RemoteCommandRetryScheduler>(
+            _executor,
+            RemoteCommandRequest(_source,
+                                 _sourceNss.db().toString(),
+                                 cmdObj,
+                                 ReadPreferenceSetting::secondaryPreferredMetadata(),
+                                 opCtx,
+                                 RemoteCommandRequest::kNoTimeout),
+            stdx::bind(
+                &CollectionCloner::_sampleIdsCallback, this, stdx::placeholders::_1, numRanges),
+            RemoteCommandRetryScheduler::makeRetryPolicy(
+                numInitialSyncCollectionFindAttempts.load(),
+                executor::RemoteCommandRequest::kNoTimeout,
+                RemoteCommandRetryScheduler::kAllRetriableErrors));
+        auto scheduleStatus = _sampleIdsScheduler->startup();
+        LOG(1) << "Sampling _id values to clone " << _sourceNss.ns() << " in " << numRanges
+               << " ranges";
+
+        if (!scheduleStatus.isOK()) {
+            _sampleIdsScheduler.reset();
+            lk.unlock();
+            _finishCallback(scheduleStatus);
+        }
+        return;
+    }
+
     BSONObjBuilder cmdObj;
     EstablishCursorsCommand cursorCommand;
     // The 'find' command is used when the number of cloning cursors is 1 to ensure
@@ -446,7 +574,11 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
         cmdObj.append("numCursors", _maxNumClonerCursors);
         cursorCommand = ParallelCollScan;
     }
+    _scheduleEstablishCollectionCursors(cmdObj.obj(), cursorCommand);
+}
 
+void CollectionCloner::_scheduleEstablishCollectionCursors(BSONObj cmdObj,
+                                                           EstablishCursorsCommand cursorCommand) {
     Client::initThreadIfNotAlready();
     auto opCtx = cc().getOperationContext();
 
@@ -454,7 +586,7 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
         _executor,
         RemoteCommandRequest(_source,
                              _sourceNss.db().toString(),
-                             cmdObj.obj(),
+                             cmdObj,
                              ReadPreferenceSetting::secondaryPreferredMetadata(),
                              opCtx,
                              RemoteCommandRequest::kNoTimeout),
@@ -476,6 +608,181 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
     }
 }
 
+int CollectionCloner::_getNumRangesToClone_inlock() const {
+    // Range partitioning relies on the _id index ordering values the same way as a simple
+    // comparison of the sampled _id values, so collections with a collation are cloned whole.
+    if (_maxNumClonerCursors != 1 || _numClonerRanges <= 1 || _options.capped ||
+        _idIndexSpec.isEmpty() || !_options.collation.isEmpty() ||
+        _idIndexSpec.hasField("collation")) {
+        return 1;
+    }
+    if (_stats.documentToCopy < static_cast<size_t>(std::max(0LL, _minDocumentsForClonerRanges))) {
+        return 1;
+    }
+    return std::min(_numClonerRanges, kMaxCollectionClonerRanges);
+}
+
+void CollectionCloner::_sampleIdsCallback(const RemoteCommandCallbackArgs& rcbd, int numRanges) {
+    if (_isShuttingDown()) {
+        Status shuttingDownStatus{ErrorCodes::CallbackCanceled, "Cloner shutting down."};
+        _finishCallback(shuttingDownStatus);
+        return;
+    }
+
+    auto status = rcbd.response.status;
+    if (status.isOK()) {
+        status = getStatusFromCommandResult(rcbd.response.data);
+    }
+    std::vector<BSONObj> sampledIds;
+    if (status.isOK()) {
+        auto cursorResponse = CursorResponse::parseFromBSON(rcbd.response.data);
+        status = cursorResponse.getStatus();
+        if (status.isOK()) {
+            for (auto&& doc : cursorResponse.getValue().getBatch()) {
+                auto idElement = doc["_id"];
+                if (!idElement.eoo()) {
+                    sampledIds.push_back(BSON("_id" << idElement));
+                }
+            }
+        }
+    }
+
+    std::vector<BSONObj> splitPoints;
+    if (status.isOK()) {
+        splitPoints = selectRangeSplitPoints(std::move(sampledIds), numRanges);
+    } else {
+        // The ranges only spread the fetching over several cursors, so the collection can still
+        // be cloned over a single one.
+        warning() << "Failed to sample _id values of " << _sourceNss.ns()
+                  << ", cloning it over a single cursor: " << redact(status);
+    }
+    _establishRangeCursors(splitPoints);
+}
+
+void CollectionCloner::_establishRangeCursors(const std::vector<BSONObj>& splitPoints) {
+    Client::initThreadIfNotAlready();
+    auto opCtx = cc().getOperationContext();
+
+    const size_t numRanges = splitPoints.size() + 1;
+    UniqueLock lk(_mutex);
+    _rangeCursorResponses.resize(numRanges);
+    _pendingRangeCursors = numRanges;
+    for (size_t i = 0; i < numRanges; ++i) {
+        const BSONObj min = i == 0 ? BSONObj() : splitPoints[i - 1];
+        const BSONObj max = i + 1 == numRanges ? BSONObj() : splitPoints[i];
+        auto scheduler = stdx::make_unique<RemoteCommandRetryScheduler>(
+            _executor,
+            RemoteCommandRequest(_source,
+                                 _sourceNss.db().toString(),
+                                 makeRangeFindCommand(_sourceNss, min, max),
+                                 ReadPreferenceSetting::secondaryPreferredMetadata(),
+                                 opCtx,
+                                 RemoteCommandRequest::kNoTimeout),
+            stdx::bind(
+                &CollectionCloner::_establishRangeCursorCallback, this, stdx::placeholders::_1, i),
+            RemoteCommandRetryScheduler::makeRetryPolicy(
+                numInitialSyncCollectionFindAttempts.load(),
+                executor::RemoteCommandRequest::kNoTimeout,
+                RemoteCommandRetryScheduler::kAllRetriableErrors));
+        auto scheduleStatus = scheduler->startup();
+        if (!scheduleStatus.isOK()) {
+            // The ranges that were not scheduled will never respond.
+            _pendingRangeCursors -= numRanges - i;
+            _rangeCursorsStatus = scheduleStatus;
+            for (auto&& scheduled : _rangeCursorSchedulers) {
+                scheduled->shutdown();
+            }
+            break;
+        }
+        _rangeCursorSchedulers.push_back(std::move(scheduler));
+    }
+    LOG(1) << "Attempting to establish cursors over " << numRanges << " _id ranges of "
+           << _sourceNss.ns();
+
+    if (_pendingRangeCursors == 0) {
+        auto status = _rangeCursorsStatus;
+        lk.unlock();
+        _finishCallback(status);
+    }
+}
+
+void CollectionCloner::_establishRangeCursorCallback(const RemoteCommandCallbackArgs& rcbd,
+                                                     size_t rangeIndex) {
+    auto status = rcbd.response.status;
+    if (status.isOK()) {
+        Status commandStatus = getStatusFromCommandResult(rcbd.response.data);
+        if (!commandStatus.isOK()) {
+            status = {commandStatus.code(),
+                      str::stream() << "While querying collection '" << _sourceNss.ns()
+                                    << "' there was an error '"
+                                    << commandStatus.reason()
+                                    << "'"};
+        }
+    }
+    std::vector<CursorResponse> cursors;
+    if (status.isOK()) {
+        status = _parseCursorResponse(rcbd.response.data, &cursors, Find);
+    }
+
+    UniqueLock lk(_mutex);
+    if (status.isOK() && _state == State::kShuttingDown) {
+        status = {ErrorCodes::CallbackCanceled, "Cloner shutting down."};
+    }
+    if (status.isOK()) {
+        _rangeCursorResponses[rangeIndex] = std::move(cursors.front());
+    } else if (_rangeCursorsStatus.isOK()) {
+        _rangeCursorsStatus = status;
+        for (size_t i = 0; i < _rangeCursorSchedulers.size(); ++i) {
+            if (i != rangeIndex) {
+                _rangeCursorSchedulers[i]->shutdown();
+            }
+        }
+    }
+
+    invariant(_pendingRangeCursors > 0);
+    if (--_pendingRangeCursors > 0) {
+        return;
+    }
+
+    std::vector<CursorResponse> cursorResponses;
+    std::vector<CursorId> cursorIds;
+    for (auto&& cursorResponse : _rangeCursorResponses) {
+        if (!cursorResponse) {
+            continue;
+        }
+        if (cursorResponse->getCursorId() != 0) {
+            cursorIds.push_back(cursorResponse->getCursorId());
+        }
+        cursorResponses.push_back(std::move(*cursorResponse));
+    }
+    _rangeCursorResponses.clear();
+
+    if (!_rangeCursorsStatus.isOK()) {
+        // The cursors were opened with 'noCursorTimeout', so kill the ones that were established
+        // rather than leave them open on the sync source.
+        if (!cursorIds.empty()) {
+            auto killCursors = _executor->scheduleRemoteCommand(
+                RemoteCommandRequest(_source,
+                                     _sourceNss.db().toString(),
+                                     BSON("killCursors" << _sourceNss.coll() << "cursors"
+                                                        << cursorIds),
+                                     nullptr),
+                [](const RemoteCommandCallbackArgs&) {});
+            if (!killCursors.isOK()) {
+                warning() << "Failed to kill the cursors established on " << _sourceNss.ns()
+                          << ": " << redact(killCursors.getStatus());
+            }
+        }
+        auto finalStatus = _rangeCursorsStatus;
+        lk.unlock();
+        _finishCallback(finalStatus);
+        return;
+    }
+    lk.unlock();
+
+    _startFetchingFromCursors(std::move(cursorResponses));
+}
+
 Status CollectionCloner::_parseCursorResponse(BSONObj response,
                                               std::vector<CursorResponse>* cursors,
                                               EstablishCursorsCommand cursorCommand) {
@@ -561,6 +868,10 @@ void CollectionCloner::_establishCollectionCursorsCallback(const RemoteCommandCa
         _finishCallback(parseResponseStatus);
         return;
     }
+    _startFetchingFromCursors(std::move(cursorResponses));
+}
+
+void CollectionCloner::_startFetchingFromCursors(std::vector<CursorResponse> cursorResponses) {
     LOG(1) << "Collection cloner running with " << cursorResponses.size()
            << " cursors established.";
 
@@ -589,6 +900,7 @@ void CollectionCloner::_establishCollectionCursorsCallback(const RemoteCommandCa
     // that will cause the destructor of the completion guard to run, the destructor must be run
     // outside the mutex. This is a necessary condition to invoke _finishCallback.
     stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _stats.cursors = _clusterClientCursorParams->remotes.size();
     Status scheduleStatus = _scheduleNextARMResultsCallback(onCompletionGuard);
     if (!scheduleStatus.isOK()) {
         onCompletionGuard->setResultAndCancelRemainingWork_inlock(lock, scheduleStatus);
@@ -835,6 +1147,11 @@ void CollectionCloner::Stats::append(BSONObjBuilder* builder) const {
     builder->appendNumber(kDocumentsCopiedFieldName, documentsCopied);
     builder->appendNumber("indexes", indexes);
     builder->appendNumber("fetchedBatches", fetchBatches);
+    builder->appendNumber("cursors", cursors);
+    if (estimatedTimeRemaining) {
+        builder->appendNumber("estimatedRemainingMillis",
+                              durationCount<Milliseconds>(*estimatedTimeRemaining));
+    }
     if (start != Date_t()) {
         builder->appendDate("start", start);
         if (end != Date_t()) {
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <memory>
 #include <string>
 #include <vector>
@@ -83,6 +84,9 @@ public:
         size_t documentsCopied{0};
         size_t indexes{0};
         size_t fetchBatches{0};
+        size_t cursors{0};
+        // Projected from the copy rate so far while the collection is being cloned.
+        boost::optional<Milliseconds> estimatedTimeRemaining;
 
         std::string toString() const;
         BSONObj toBSON() const;
@@ -156,6 +160,14 @@ public:
      */
     std::vector<BSONObj> getDocumentsToInsert_forTest();
 
+    /**
+     * Overrides the 'initialSyncCollectionClonerRanges' and
+     * 'initialSyncCollectionClonerRangeMinDocuments' server parameters read at construction.
+     *
+     * For testing only.
+     */
+    void setRangePartitioning_forTest(int numRanges, long long minDocuments);
+
 private:
     bool _isActive_inlock() const;
 
@@ -199,6 +211,11 @@ private:
      */
     enum EstablishCursorsCommand { Find, ParallelCollScan };
 
+    /**
+     * Schedules 'cmdObj' to establish the cursor or set of cursors on the remote collection.
+     */
+    void _scheduleEstablishCollectionCursors(BSONObj cmdObj, EstablishCursorsCommand cursorCommand);
+
     /**
      * Parses the cursor responses from the 'find' or 'parallelCollectionScan' command
      * and passes them into the 'AsyncResultsMerger'.
@@ -206,6 +223,36 @@ private:
     void _establishCollectionCursorsCallback(const RemoteCommandCallbackArgs& rcbd,
                                              EstablishCursorsCommand cursorCommand);
 
+    /**
+     * Returns the number of _id ranges to clone the collection in. Returns 1 if the collection
+     * is too small or cannot be partitioned on _id.
+     */
+    int _getNumRangesToClone_inlock() const;
+
+    /**
+     * Picks the boundaries of 'numRanges' _id ranges from the sampled _id values in the
+     * '$sample' aggregation response and establishes a 'find' cursor over each range. Falls back
+     * on a single range if sampling failed.
+     */
+    void _sampleIdsCallback(const RemoteCommandCallbackArgs& rcbd, int numRanges);
+
+    /**
+     * Schedules a 'find' command bounded by consecutive 'splitPoints' for each _id range.
+     */
+    void _establishRangeCursors(const std::vector<BSONObj>& splitPoints);
+
+    /**
+     * Records the cursor established on the range at 'rangeIndex'. Once all ranges have
+     * responded, passes the cursors into the 'AsyncResultsMerger'.
+     */
+    void _establishRangeCursorCallback(const RemoteCommandCallbackArgs& rcbd, size_t rangeIndex);
+
+    /**
+     * Initializes the 'AsyncResultsMerger' with the established 'cursorResponses' and starts
+     * fetching documents from it.
+     */
+    void _startFetchingFromCursors(std::vector<CursorResponse> cursorResponses);
+
     /**
      * Parses the response from a 'parallelCollectionScan' command into a vector of cursor
      * elements.
@@ -304,6 +351,21 @@ private:
     // (M) Scheduler used to establish the initial cursor or set of cursors.
     std::unique_ptr<RemoteCommandRetryScheduler> _establishCollectionCursorsScheduler;
 
+    // (RT) The number of _id ranges to clone the collection in over separate cursors, and the
+    // number of documents the collection must have for it to be worth partitioning.
+    int _numClonerRanges;
+    long long _minDocumentsForClonerRanges;
+
+    // (M) Scheduler for the '$sample' aggregation used to pick the _id range boundaries.
+    std::unique_ptr<RemoteCommandRetryScheduler> _sampleIdsScheduler;
+
+    // (M) Schedulers, cursors and outstanding request count for the per-range 'find' commands.
+    // '_rangeCursorsStatus' holds the first error returned by any of them.
+    std::vector<std::unique_ptr<RemoteCommandRetryScheduler>> _rangeCursorSchedulers;
+    std::vector<boost::optional<CursorResponse>> _rangeCursorResponses;
+    size_t _pendingRangeCursors = 0;
+    Status _rangeCursorsStatus = Status::OK();
+
     // State transitions:
     // PreStart --> Running --> ShuttingDown --> Complete
     // It is possible to skip intermediate states. For example,
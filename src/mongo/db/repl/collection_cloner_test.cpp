@@ -1185,6 +1185,117 @@ TEST_F(CollectionClonerTest, MiddleBatchContainsNoDocuments) {
     ASSERT_FALSE(collectionCloner->isActive());
 }
 
+TEST_F(CollectionClonerTest, CollectionClonerClonesIdRangesOverSeparateCursors) {
+    collectionCloner->setRangePartitioning_forTest(2, 10);
+    ASSERT_OK(collectionCloner->startup());
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCountResponse(100));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+    collectionCloner->waitForDbWorker();
+    ASSERT_TRUE(collectionStats.initCalled);
+
+    // The boundary between the two ranges is picked from the sampled _id values.
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        auto noi = getNet()->getNextReadyRequest();
+        auto&& cmdObj = noi->getRequest().cmdObj;
+        ASSERT_EQUALS("aggregate", std::string(cmdObj.firstElementFieldName()));
+        ASSERT_EQUALS(nss.coll().toString(), cmdObj.firstElement().valuestrsafe());
+        scheduleNetworkResponse(noi,
+                                createCursorResponse(0,
+                                                     BSON_ARRAY(BSON("_id" << 30)
+                                                                << BSON("_id" << 10)
+                                                                << BSON("_id" << 40)
+                                                                << BSON("_id" << 20))));
+        finishProcessingNetworkResponse();
+    }
+
+    BSONArray emptyArray;
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        auto firstRange = getNet()->getNextReadyRequest();
+        auto&& firstCmdObj = firstRange->getRequest().cmdObj;
+        ASSERT_EQUALS("find", std::string(firstCmdObj.firstElementFieldName()));
+        ASSERT_BSONOBJ_EQ(BSON("_id" << 1), firstCmdObj["hint"].Obj());
+        ASSERT_FALSE(firstCmdObj.hasField("min"));
+        ASSERT_BSONOBJ_EQ(BSON("_id" << 30), firstCmdObj["max"].Obj());
+        ASSERT_TRUE(firstCmdObj["noCursorTimeout"].trueValue());
+        scheduleNetworkResponse(firstRange, createCursorResponse(1, emptyArray));
+
+        auto secondRange = getNet()->getNextReadyRequest();
+        auto&& secondCmdObj = secondRange->getRequest().cmdObj;
+        ASSERT_EQUALS("find", std::string(secondCmdObj.firstElementFieldName()));
+        ASSERT_BSONOBJ_EQ(BSON("_id" << 30), secondCmdObj["min"].Obj());
+        ASSERT_FALSE(secondCmdObj.hasField("max"));
+        scheduleNetworkResponse(secondRange, createCursorResponse(2, emptyArray));
+        finishProcessingNetworkResponse();
+    }
+
+    collectionCloner->waitForDbWorker();
+    ASSERT_TRUE(collectionCloner->isActive());
+    ASSERT_EQUALS(2U, collectionCloner->getStats().cursors);
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(
+            createFinalCursorResponse(BSON_ARRAY(BSON("_id" << 10) << BSON("_id" << 20))));
+        processNetworkResponse(createFinalCursorResponse(BSON_ARRAY(BSON("_id" << 30))));
+    }
+
+    collectionCloner->join();
+    ASSERT_EQUALS(3, collectionStats.insertCount);
+    ASSERT_TRUE(collectionStats.commitCalled);
+
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(collectionCloner->isActive());
+}
+
+TEST_F(CollectionClonerTest, CollectionClonerClonesOverSingleCursorWhenSamplingIdsFails) {
+    collectionCloner->setRangePartitioning_forTest(2, 10);
+    ASSERT_OK(collectionCloner->startup());
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createCountResponse(100));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+    collectionCloner->waitForDbWorker();
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(BSON("ok" << 0 << "errmsg"
+                                         << "Unrecognized pipeline stage name: '$sample'"
+                                         << "code"
+                                         << 16436));
+    }
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        auto noi = getNet()->getNextReadyRequest();
+        auto&& cmdObj = noi->getRequest().cmdObj;
+        ASSERT_EQUALS("find", std::string(cmdObj.firstElementFieldName()));
+        ASSERT_FALSE(cmdObj.hasField("min"));
+        ASSERT_FALSE(cmdObj.hasField("max"));
+        ASSERT_FALSE(getNet()->hasReadyRequests());
+        scheduleNetworkResponse(noi, createCursorResponse(1, BSONArray()));
+        finishProcessingNetworkResponse();
+    }
+
+    collectionCloner->waitForDbWorker();
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        processNetworkResponse(createFinalCursorResponse(BSON_ARRAY(BSON("_id" << 1))));
+    }
+
+    collectionCloner->join();
+    ASSERT_EQUALS(1, collectionStats.insertCount);
+    ASSERT_OK(getStatus());
+    ASSERT_EQUALS(1U, collectionCloner->getStats().cursors);
+}
+
 TEST_F(CollectionClonerTest, CollectionClonerTransitionsToCompleteIfShutdownBeforeStartup) {
     collectionCloner->shutdown();
     ASSERT_EQUALS(ErrorCodes::ShutdownInProgress, collectionCloner->startup());
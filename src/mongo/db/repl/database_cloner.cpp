@@ -43,6 +43,7 @@
 #include "mongo/db/server_parameters.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/old_thread_pool.h"
 #include "mongo/util/destructor_guard.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -71,6 +72,32 @@ MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListCollectionsAttempts, int, 3);
 // The number of cursors to use in the collection cloning process.
 MONGO_EXPORT_SERVER_PARAMETER(maxNumInitialSyncCollectionClonerCursors, int, 1);
 
+// The number of collections in a database that may be cloned at the same time. Also limited to one
+// less than the number of database worker threads, since each active cloner occupies one of them.
+const int kMaxInitialSyncCollectionClonerConcurrency = 16;
+server_parameter_storage_type<int, ServerParameterType::kStartupAndRuntime>::value_type
+    initialSyncCollectionClonerConcurrency(1);
+class ExportedInitialSyncCollectionClonerConcurrencyParameter
+    : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedInitialSyncCollectionClonerConcurrencyParameter()
+        : ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "initialSyncCollectionClonerConcurrency",
+              &initialSyncCollectionClonerConcurrency) {}
+
+    Status validate(const int& potentialNewValue) override {
+        if (potentialNewValue < 1 ||
+            potentialNewValue > kMaxInitialSyncCollectionClonerConcurrency) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "initialSyncCollectionClonerConcurrency must be "
+                                           "between 1 and "
+                                        << kMaxInitialSyncCollectionClonerConcurrency);
+        }
+        return Status::OK();
+    }
+} exportedInitialSyncCollectionClonerConcurrencyParameter;
+
 /**
  * Default listCollections predicate.
  */
@@ -381,20 +408,42 @@ void DatabaseCloner::_listCollectionsCallback(const StatusWith<Fetcher::QueryRes
         }
     }
 
-    // Start first collection cloner.
-    _currentCollectionClonerIter = _collectionCloners.begin();
-
-    LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
+    // Start the first batch of collection cloners.
+    _nextCollectionClonerIter = _collectionCloners.begin();
 
-    Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
+    Status startStatus = _startCollectionCloners_inlock();
     if (!startStatus.isOK()) {
-        LOG(1) << "    failed to start collection cloning on "
-               << _currentCollectionClonerIter->getSourceNamespace() << ": " << redact(startStatus);
-        _finishCallback_inlock(lk, startStatus);
-        return;
+        if (_activeCollectionCloners == 0) {
+            _finishCallback_inlock(lk, startStatus);
+            return;
+        }
+        // Let the cloners that did start run to completion before reporting the failure.
+        _collectionClonerStartStatus = startStatus;
     }
 }
 
+Status DatabaseCloner::_startCollectionCloners_inlock() {
+    const size_t concurrency = std::max<size_t>(
+        1,
+        std::min<size_t>(initialSyncCollectionClonerConcurrency.load(),
+                         _dbWorkThreadPool->getNumThreads() - 1));
+    while (_activeCollectionCloners < concurrency &&
+           _nextCollectionClonerIter != _collectionCloners.end()) {
+        auto&& collectionCloner = *_nextCollectionClonerIter++;
+
+        LOG(1) << "    cloning collection " << collectionCloner.getSourceNamespace();
+
+        Status startStatus = _startCollectionCloner(collectionCloner);
+        if (!startStatus.isOK()) {
+            LOG(1) << "    failed to start collection cloning on "
+                   << collectionCloner.getSourceNamespace() << ": " << redact(startStatus);
+            return startStatus;
+        }
+        ++_activeCollectionCloners;
+    }
+    return Status::OK();
+}
+
 void DatabaseCloner::_collectionClonerCallback(const Status& status, const NamespaceString& nss) {
     auto newStatus = status;
 
@@ -415,17 +464,19 @@ void DatabaseCloner::_collectionClonerCallback(const Status& status, const Names
     lk.unlock();
     _collectionWork(newStatus, nss);
     lk.lock();
-    _currentCollectionClonerIter++;
+    invariant(_activeCollectionCloners > 0);
+    --_activeCollectionCloners;
 
-    if (_currentCollectionClonerIter != _collectionCloners.end()) {
-        Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-        if (!startStatus.isOK()) {
-            LOG(1) << "    failed to start collection cloning on "
-                   << _currentCollectionClonerIter->getSourceNamespace() << ": "
-                   << redact(startStatus);
-            _finishCallback_inlock(lk, startStatus);
-            return;
-        }
+    if (_collectionClonerStartStatus.isOK()) {
+        _collectionClonerStartStatus = _startCollectionCloners_inlock();
+    }
+
+    if (_activeCollectionCloners > 0) {
+        return;
+    }
+
+    if (!_collectionClonerStartStatus.isOK()) {
+        _finishCallback_inlock(lk, _collectionClonerStartStatus);
         return;
     }
 
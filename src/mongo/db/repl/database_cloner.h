@@ -190,6 +190,13 @@ private:
      */
     void _collectionClonerCallback(const Status& status, const NamespaceString& nss);
 
+    /**
+     * Starts collection cloners from the list until 'initialSyncCollectionClonerConcurrency' of
+     * them are running or there are none left to start. Stops at the first cloner that fails to
+     * start and returns its status.
+     */
+    Status _startCollectionCloners_inlock();
+
     /**
      * Reports completion status.
      * Sets cloner to inactive.
@@ -233,7 +240,9 @@ private:
     std::vector<BSONObj> _collectionInfos;                               // (M)
     std::vector<NamespaceString> _collectionNamespaces;                  // (M)
     std::list<CollectionCloner> _collectionCloners;                      // (M)
-    std::list<CollectionCloner>::iterator _currentCollectionClonerIter;  // (M)
+    std::list<CollectionCloner>::iterator _nextCollectionClonerIter;     // (M)
+    size_t _activeCollectionCloners = 0;                                 // (M)
+    Status _collectionClonerStartStatus = Status::OK();                  // (M)
     std::vector<std::pair<Status, NamespaceString>> _failedNamespaces;   // (M)
     CollectionCloner::ScheduleDbWorkFn
         _scheduleDbWorkFn;  // (RT) Function for scheduling database work using the executor.
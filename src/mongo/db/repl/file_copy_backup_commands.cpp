@@ -0,0 +1,298 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/optional.hpp>
+#include <fstream>
+#include <map>
+
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/repl/repl_set_command.h"
+#include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+// The number of seconds an open backup may go without being read from before another file copy
+// initial sync may close it and open its own.
+MONGO_EXPORT_SERVER_PARAMETER(fileCopyBackupIdleTimeoutSecs, int, 600);
+
+// Keeps each 'replSetReadBackupFile' response well under the maximum BSON document size.
+const long long kMaxBackupFileChunkBytes = 8 * 1024 * 1024;
+
+// Engine metadata written by MongoDB next to the storage engine's own files. It never changes
+// once the dbpath is created, so it is copied along with the files pinned by the backup.
+const char kStorageMetadataFilename[] = "storage.bson";
+
+/**
+ * The backup opened on behalf of a file copy initial sync. The storage engine allows a single
+ * backup at a time, so there is at most one of these.
+ */
+struct OpenBackup {
+    OID backupId;
+    // Size of each file when the backup was opened. Only that much of a file belongs to the
+    // pinned checkpoint; anything appended later is not consistent with it.
+    std::map<std::string, long long> fileSizes;
+    Date_t lastActivity;
+};
+
+stdx::mutex openBackupMutex;
+boost::optional<OpenBackup> openBackup;  // (openBackupMutex)
+
+Status checkBackupId_inlock(const BSONObj& cmdObj, StringData fieldName) {
+    OID backupId;
+    auto status = bsonExtractOIDField(cmdObj, fieldName, &backupId);
+    if (!status.isOK()) {
+        return status;
+    }
+    if (!openBackup || openBackup->backupId != backupId) {
+        return {ErrorCodes::NoSuchKey,
+                str::stream() << "No backup with id " << backupId.toString() << " is open"};
+    }
+    return Status::OK();
+}
+
+/**
+ * Opens a backup pinning the latest checkpoint and returns the files to copy with their sizes.
+ *
+ * { replSetBeginFileCopyBackup: 1 }
+ */
+class CmdReplSetBeginFileCopyBackup : public ReplSetCommand {
+public:
+    CmdReplSetBeginFileCopyBackup() : ReplSetCommand("replSetBeginFileCopyBackup") {}
+
+    void help(std::stringstream& h) const override {
+        h << "Internal command used by file copy initial sync to open a backup of this node's "
+             "data files.";
+    }
+
+private:
+    bool run(OperationContext* opCtx,
+             const std::string&,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) final {
+        auto storageEngine = opCtx->getServiceContext()->getGlobalStorageEngine();
+        Lock::GlobalLock globalLock(opCtx, MODE_IS, UINT_MAX);
+
+        stdx::lock_guard<stdx::mutex> lk(openBackupMutex);
+        if (openBackup) {
+            const auto idle = Date_t::now() - openBackup->lastActivity;
+            if (idle < Seconds(fileCopyBackupIdleTimeoutSecs.load())) {
+                return appendCommandStatus(
+                    result,
+                    {ErrorCodes::IllegalOperation,
+                     str::stream() << "Backup " << openBackup->backupId.toString()
+                                   << " is already open for another initial sync"});
+            }
+            log() << "Closing backup " << openBackup->backupId << " after it went unused for "
+                  << duration_cast<Seconds>(idle);
+            storageEngine->endNonBlockingBackup(opCtx);
+            openBackup = boost::none;
+        }
+
+        // Take a checkpoint first so that the copy needs as little journal recovery as possible.
+        storageEngine->flushAllFiles(opCtx, true);
+
+        std::vector<std::string> filenames;
+        try {
+            writeConflictRetry(opCtx, "beginNonBlockingBackup", "global", [&] {
+                filenames = uassertStatusOK(storageEngine->beginNonBlockingBackup(opCtx));
+            });
+        } catch (const DBException& ex) {
+            return appendCommandStatus(result, ex.toStatus());
+        }
+
+        const boost::filesystem::path dbpath(storageGlobalParams.dbpath);
+        if (boost::filesystem::exists(dbpath / kStorageMetadataFilename)) {
+            filenames.emplace_back(kStorageMetadataFilename);
+        }
+
+        OpenBackup backup;
+        backup.backupId = OID::gen();
+        backup.lastActivity = Date_t::now();
+        BSONArrayBuilder files(result.subarrayStart("files"));
+        for (auto&& filename : filenames) {
+            boost::system::error_code ec;
+            const auto size = boost::filesystem::file_size(dbpath / filename, ec);
+            if (ec) {
+                files.doneFast();
+                storageEngine->endNonBlockingBackup(opCtx);
+                return appendCommandStatus(result,
+                                           {ErrorCodes::FileNotOpen,
+                                            str::stream() << "Unable to get the size of "
+                                                          << filename << ": " << ec.message()});
+            }
+            backup.fileSizes[filename] = static_cast<long long>(size);
+            files.append(BSON("filename" << filename << "size" << static_cast<long long>(size)));
+        }
+        files.doneFast();
+
+        result.append("backupId", backup.backupId);
+        ReplicationCoordinator::get(opCtx)->getMyLastAppliedOpTime().append(&result,
+                                                                           "lastAppliedOpTime");
+        log() << "Opened backup " << backup.backupId << " of " << backup.fileSizes.size()
+              << " files for a file copy initial sync";
+        openBackup = std::move(backup);
+        return true;
+    }
+} cmdReplSetBeginFileCopyBackup;
+
+/**
+ * Returns up to 'length' bytes of a file in the open backup, starting at 'offset'.
+ *
+ * { replSetReadBackupFile: <backupId>, filename: <string>, offset: <long>, length: <long> }
+ */
+class CmdReplSetReadBackupFile : public ReplSetCommand {
+public:
+    CmdReplSetReadBackupFile() : ReplSetCommand("replSetReadBackupFile") {}
+
+    void help(std::stringstream& h) const override {
+        h << "Internal command used by file copy initial sync to read a file of an open backup.";
+    }
+
+private:
+    bool run(OperationContext* opCtx,
+             const std::string&,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) final {
+        std::string filename;
+        auto status = bsonExtractStringField(cmdObj, "filename", &filename);
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+        long long offset;
+        status = bsonExtractIntegerField(cmdObj, "offset", &offset);
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+        long long length;
+        status = bsonExtractIntegerFieldWithDefault(
+            cmdObj, "length", kMaxBackupFileChunkBytes, &length);
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+
+        long long fileSize;
+        {
+            stdx::lock_guard<stdx::mutex> lk(openBackupMutex);
+            status = checkBackupId_inlock(cmdObj, getName());
+            if (!status.isOK()) {
+                return appendCommandStatus(result, status);
+            }
+            // Only files listed by the backup may be read, which also keeps the path inside the
+            // dbpath.
+            auto it = openBackup->fileSizes.find(filename);
+            if (it == openBackup->fileSizes.end()) {
+                return appendCommandStatus(
+                    result,
+                    {ErrorCodes::BadValue,
+                     str::stream() << filename << " is not a file of the open backup"});
+            }
+            fileSize = it->second;
+            openBackup->lastActivity = Date_t::now();
+        }
+
+        if (offset < 0 || offset > fileSize || length <= 0) {
+            return appendCommandStatus(result,
+                                       {ErrorCodes::BadValue,
+                                        str::stream() << "Invalid range of " << length
+                                                      << " bytes at offset " << offset << " of "
+                                                      << filename});
+        }
+        length = std::min({length, kMaxBackupFileChunkBytes, fileSize - offset});
+
+        std::vector<char> buffer(length);
+        const auto path = boost::filesystem::path(storageGlobalParams.dbpath) / filename;
+        std::ifstream in(path.string(), std::ios::in | std::ios::binary);
+        in.seekg(offset);
+        in.read(buffer.data(), length);
+        if (!in || in.gcount() != length) {
+            return appendCommandStatus(result,
+                                       {ErrorCodes::FileStreamFailed,
+                                        str::stream() << "Failed to read " << length
+                                                      << " bytes at offset " << offset << " of "
+                                                      << path.string()});
+        }
+
+        result.appendBinData("data", length, BinDataGeneral, buffer.data());
+        result.append("eof", offset + length >= fileSize);
+        return true;
+    }
+} cmdReplSetReadBackupFile;
+
+/**
+ * Closes the open backup, letting the storage engine release the checkpoint it pinned.
+ *
+ * { replSetEndFileCopyBackup: <backupId> }
+ */
+class CmdReplSetEndFileCopyBackup : public ReplSetCommand {
+public:
+    CmdReplSetEndFileCopyBackup() : ReplSetCommand("replSetEndFileCopyBackup") {}
+
+    void help(std::stringstream& h) const override {
+        h << "Internal command used by file copy initial sync to close an open backup.";
+    }
+
+private:
+    bool run(OperationContext* opCtx,
+             const std::string&,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) final {
+        Lock::GlobalLock globalLock(opCtx, MODE_IS, UINT_MAX);
+
+        stdx::lock_guard<stdx::mutex> lk(openBackupMutex);
+        auto status = checkBackupId_inlock(cmdObj, getName());
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+        opCtx->getServiceContext()->getGlobalStorageEngine()->endNonBlockingBackup(opCtx);
+        log() << "Closed backup " << openBackup->backupId;
+        openBackup = boost::none;
+        return true;
+    }
+} cmdReplSetEndFileCopyBackup;
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,331 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/file_copy_initial_syncer.h"
+
+#include <algorithm>
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/db/repl/oplogreader.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+// The sync source to copy the data files from. File copy initial sync is disabled when empty.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(fileCopyInitialSyncSource, std::string, "");
+
+// The number of files copied from the sync source at the same time, each over its own connection.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(fileCopyInitialSyncConnections, int, 4);
+
+// Directory in the dbpath the files are copied into before being moved into place.
+const char kStagingDirectoryName[] = "_fileCopyInitialSync";
+
+// The file whose presence tells WiredTiger, and us, that the dbpath holds data. It is moved into
+// place last so that an interrupted copy is started over on the next startup.
+const char kWiredTigerMarkerFilename[] = "WiredTiger";
+
+const long long kChunkBytes = 8 * 1024 * 1024;
+const double kSocketTimeoutSecs = 60;
+
+struct BackupFile {
+    std::string filename;
+    long long size;
+};
+
+Status connectToSyncSource(DBClientConnection* conn, const HostAndPort& source) {
+    auto status = conn->connect(source, "FileCopyInitialSync");
+    if (!status.isOK()) {
+        return status;
+    }
+    if (!replAuthenticate(conn)) {
+        return {ErrorCodes::AuthenticationFailed,
+                str::stream() << "Failed to authenticate to " << source.toString()};
+    }
+    return Status::OK();
+}
+
+StatusWith<BSONObj> runCommand(DBClientConnection* conn, const BSONObj& cmdObj) {
+    BSONObj response;
+    try {
+        conn->runCommand("admin", cmdObj, response);
+    } catch (const DBException& ex) {
+        return ex.toStatus();
+    }
+    auto status = getStatusFromCommandResult(response);
+    if (!status.isOK()) {
+        return status;
+    }
+    return response;
+}
+
+/**
+ * Copies 'file' of the open backup into the same relative path under 'destination', one chunk at
+ * a time.
+ */
+Status copyFile(DBClientConnection* conn,
+                const OID& backupId,
+                const BackupFile& file,
+                const boost::filesystem::path& destination) {
+    const auto path = destination / file.filename;
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(path.parent_path(), ec);
+    if (ec) {
+        return {ErrorCodes::FileNotOpen,
+                str::stream() << "Unable to create " << path.parent_path().string() << ": "
+                              << ec.message()};
+    }
+
+    std::ofstream out(path.string(), std::ios::out | std::ios::binary | std::ios::trunc);
+    long long offset = 0;
+    while (out && offset < file.size) {
+        auto response = runCommand(conn,
+                                   BSON("replSetReadBackupFile" << backupId << "filename"
+                                                                << file.filename
+                                                                << "offset"
+                                                                << offset
+                                                                << "length"
+                                                                << kChunkBytes));
+        if (!response.isOK()) {
+            return response.getStatus();
+        }
+        BSONElement data = response.getValue()["data"];
+        int length = 0;
+        const char* bytes = data.type() == BinData ? data.binData(length) : nullptr;
+        if (length <= 0) {
+            return {ErrorCodes::FailedToParse,
+                    str::stream() << "Missing data in the response reading " << file.filename
+                                  << " at offset " << offset};
+        }
+        out.write(bytes, length);
+        offset += length;
+    }
+    out.close();
+    if (!out) {
+        return {ErrorCodes::FileStreamFailed, str::stream() << "Failed to write " << path.string()};
+    }
+    return Status::OK();
+}
+
+/**
+ * Copies 'files' into 'destination' over 'fileCopyInitialSyncConnections' connections, largest
+ * files first so that one large file does not start last.
+ */
+Status copyFiles(const HostAndPort& source,
+                 const OID& backupId,
+                 std::vector<BackupFile> files,
+                 const boost::filesystem::path& destination) {
+    std::sort(files.begin(), files.end(), [](const BackupFile& lhs, const BackupFile& rhs) {
+        return lhs.size > rhs.size;
+    });
+
+    AtomicUInt64 nextFile;
+    stdx::mutex mutex;
+    Status firstError = Status::OK();  // (mutex)
+    auto copyNextFiles = [&] {
+        DBClientConnection conn(false, kSocketTimeoutSecs);
+        auto status = connectToSyncSource(&conn, source);
+        for (auto i = nextFile.fetchAndAdd(1); status.isOK() && i < files.size();
+             i = nextFile.fetchAndAdd(1)) {
+            LOG(1) << "Copying " << files[i].filename << " (" << files[i].size << " bytes)";
+            status = copyFile(&conn, backupId, files[i], destination);
+            if (!status.isOK()) {
+                status = {status.code(),
+                          str::stream() << "Failed to copy " << files[i].filename << ": "
+                                        << status.reason()};
+            }
+        }
+        if (!status.isOK()) {
+            // Stop the other connections from starting on more files.
+            nextFile.store(files.size());
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            if (firstError.isOK()) {
+                firstError = status;
+            }
+        }
+    };
+
+    const auto numConnections = std::min(
+        static_cast<size_t>(std::max(1, fileCopyInitialSyncConnections)), files.size());
+    std::vector<stdx::thread> threads;
+    for (size_t i = 0; i < numConnections; ++i) {
+        threads.emplace_back(copyNextFiles);
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    return firstError;
+}
+
+/**
+ * Moves every file copied into 'staging' to the same relative path under 'dbpath', leaving the
+ * WiredTiger marker file for last.
+ */
+Status moveFilesIntoPlace(const boost::filesystem::path& staging,
+                          const boost::filesystem::path& dbpath) {
+    try {
+        std::vector<boost::filesystem::path> relativePaths;
+        for (boost::filesystem::recursive_directory_iterator it(staging), end; it != end; ++it) {
+            if (boost::filesystem::is_regular_file(it->status())) {
+                const auto& path = it->path().string();
+                relativePaths.emplace_back(path.substr(staging.string().size() + 1));
+            }
+        }
+        std::stable_partition(
+            relativePaths.begin(), relativePaths.end(), [](const boost::filesystem::path& p) {
+                return p != kWiredTigerMarkerFilename;
+            });
+        for (auto&& relativePath : relativePaths) {
+            boost::filesystem::create_directories((dbpath / relativePath).parent_path());
+            boost::filesystem::rename(staging / relativePath, dbpath / relativePath);
+        }
+        boost::filesystem::remove_all(staging);
+    } catch (const boost::filesystem::filesystem_error& ex) {
+        return {ErrorCodes::FileRenameFailed, ex.what()};
+    }
+    return Status::OK();
+}
+
+}  // namespace
+
+Status copyDataFilesFromSyncSourceIfRequested() {
+    if (fileCopyInitialSyncSource.empty()) {
+        return Status::OK();
+    }
+    if (storageGlobalParams.engine != "wiredTiger") {
+        return {ErrorCodes::InvalidOptions,
+                str::stream() << "File copy initial sync requires the wiredTiger storage engine,"
+                              << " not " << storageGlobalParams.engine};
+    }
+
+    const boost::filesystem::path dbpath(storageGlobalParams.dbpath);
+    const auto staging = dbpath / kStagingDirectoryName;
+    try {
+        if (boost::filesystem::exists(staging)) {
+            log() << "Removing the files of an interrupted file copy initial sync from "
+                  << staging.string();
+            boost::filesystem::remove_all(staging);
+        }
+        if (boost::filesystem::exists(dbpath / kWiredTigerMarkerFilename)) {
+            log() << "Not copying data files from " << fileCopyInitialSyncSource << " because "
+                  << dbpath.string() << " already holds data";
+            return Status::OK();
+        }
+    } catch (const boost::filesystem::filesystem_error& ex) {
+        return {ErrorCodes::FileNotOpen, ex.what()};
+    }
+
+    auto source = HostAndPort::parse(fileCopyInitialSyncSource);
+    if (!source.isOK()) {
+        return source.getStatus();
+    }
+
+    DBClientConnection conn(false, kSocketTimeoutSecs);
+    auto status = connectToSyncSource(&conn, source.getValue());
+    if (!status.isOK()) {
+        return status;
+    }
+
+    auto beginResponse = runCommand(&conn, BSON("replSetBeginFileCopyBackup" << 1));
+    if (!beginResponse.isOK()) {
+        return beginResponse.getStatus();
+    }
+    const auto& backup = beginResponse.getValue();
+
+    OID backupId;
+    status = bsonExtractOIDField(backup, "backupId", &backupId);
+    if (!status.isOK()) {
+        return status;
+    }
+    ON_BLOCK_EXIT([&] {
+        auto endResponse = runCommand(&conn, BSON("replSetEndFileCopyBackup" << backupId));
+        if (!endResponse.isOK()) {
+            warning() << "Failed to close backup " << backupId << " on "
+                      << source.getValue().toString() << ": " << redact(endResponse.getStatus());
+        }
+    });
+
+    std::vector<BackupFile> files;
+    long long totalBytes = 0;
+    for (auto&& fileElement : backup["files"].Array()) {
+        auto fileObj = fileElement.Obj();
+        BackupFile file;
+        status = bsonExtractStringField(fileObj, "filename", &file.filename);
+        if (status.isOK()) {
+            status = bsonExtractIntegerField(fileObj, "size", &file.size);
+        }
+        if (!status.isOK()) {
+            return status;
+        }
+        totalBytes += file.size;
+        files.push_back(std::move(file));
+    }
+
+    log() << "Copying " << files.size() << " data files (" << totalBytes << " bytes) from "
+          << source.getValue().toString() << " as of its last applied optime "
+          << backup["lastAppliedOpTime"];
+
+    Timer timer;
+    status = copyFiles(source.getValue(), backupId, std::move(files), staging);
+    if (status.isOK()) {
+        status = moveFilesIntoPlace(staging, dbpath);
+    }
+    if (!status.isOK()) {
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(staging, ec);
+        return status;
+    }
+
+    log() << "Copied the data files from " << source.getValue().toString() << " in "
+          << timer.millis() << "ms";
+    return Status::OK();
+}
+
+}  // namespace repl
+}  // namespace mongo
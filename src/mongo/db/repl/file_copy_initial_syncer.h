@@ -0,0 +1,51 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+namespace mongo {
+
+class Status;
+
+namespace repl {
+
+/**
+ * Copies the data files of the sync source named by the 'fileCopyInitialSyncSource' startup
+ * parameter into an empty dbpath, through a backup the sync source opens with
+ * 'replSetBeginFileCopyBackup'. Once the storage engine starts on the copied files, the node
+ * recovers and catches up on the oplog entries written after the backup through steady state
+ * replication, like any member restarting after a clean shutdown.
+ *
+ * Does nothing if the parameter is not set or the dbpath already holds data files. Must be called
+ * before the global storage engine is initialized.
+ */
+Status copyDataFilesFromSyncSourceIfRequested();
+
+}  // namespace repl
+}  // namespace mongo
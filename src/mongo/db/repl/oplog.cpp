@@ -1075,79 +1075,150 @@ Status applyOperation_inlock(OperationContext* opCtx,
             }
         }
     } else if (*opType == 'u') {
-        opCounters->gotUpdate();
-
-        BSONObj updateCriteria = o2;
         const bool upsert = valueB || inSteadyStateReplication;
 
-        uassert(ErrorCodes::NoSuchKey,
-                str::stream() << "Failed to apply update due to missing _id: " << op.toString(),
-                updateCriteria.hasField("_id"));
-
-        UpdateRequest request(requestNss);
-
-        request.setQuery(updateCriteria);
-        request.setUpdates(o);
-        request.setUpsert(upsert);
-        UpdateLifecycleImpl updateLifecycle(requestNss);
-        request.setLifecycle(&updateLifecycle);
-
-        UpdateResult ur = update(opCtx, db, request);
-
-        if (ur.numMatched == 0 && ur.upserted.isEmpty()) {
-            if (ur.modifiers) {
-                if (updateCriteria.nFields() == 1) {
-                    // was a simple { _id : ... } update criteria
-                    string msg = str::stream() << "failed to apply update: " << redact(op);
+        // Updates which are part of a group are counted once the group commits. Their failures are
+        // expected at times, for example during initial sync, and make the group be applied again
+        // one op at a time, which reports them.
+        auto applyUpdate =
+            [&](const BSONObj& o, const BSONObj& updateCriteria, bool grouped) -> Status {
+            auto logFailure = [grouped](const string& msg) {
+                if (grouped) {
+                    LOG(1) << msg;
+                } else {
                     error() << msg;
-                    return Status(ErrorCodes::UpdateOperationFailed, msg);
                 }
-                // Need to check to see if it isn't present so we can exit early with a
-                // failure. Note that adds some overhead for this extra check in some cases,
-                // such as an updateCriteria
-                // of the form
-                //   { _id:..., { x : {$size:...} }
-                // thus this is not ideal.
-                if (collection == NULL ||
-                    (indexCatalog->haveIdIndex(opCtx) &&
-                     Helpers::findById(opCtx, collection, updateCriteria).isNull()) ||
-                    // capped collections won't have an _id index
-                    (!indexCatalog->haveIdIndex(opCtx) &&
-                     Helpers::findOne(opCtx, collection, updateCriteria, false).isNull())) {
-                    string msg = str::stream() << "couldn't find doc: " << redact(op);
-                    error() << msg;
-                    return Status(ErrorCodes::UpdateOperationFailed, msg);
+            };
+
+            uassert(ErrorCodes::NoSuchKey,
+                    str::stream() << "Failed to apply update due to missing _id: "
+                                  << op.toString(),
+                    updateCriteria.hasField("_id"));
+
+            UpdateRequest request(requestNss);
+
+            request.setQuery(updateCriteria);
+            request.setUpdates(o);
+            request.setUpsert(upsert);
+            UpdateLifecycleImpl updateLifecycle(requestNss);
+            request.setLifecycle(&updateLifecycle);
+
+            UpdateResult ur = update(opCtx, db, request);
+
+            if (ur.numMatched == 0 && ur.upserted.isEmpty()) {
+                if (ur.modifiers) {
+                    if (updateCriteria.nFields() == 1) {
+                        // was a simple { _id : ... } update criteria
+                        string msg = str::stream() << "failed to apply update: " << redact(op);
+                        logFailure(msg);
+                        return Status(ErrorCodes::UpdateOperationFailed, msg);
+                    }
+                    // Need to check to see if it isn't present so we can exit early with a
+                    // failure. Note that adds some overhead for this extra check in some cases,
+                    // such as an updateCriteria
+                    // of the form
+                    //   { _id:..., { x : {$size:...} }
+                    // thus this is not ideal.
+                    if (collection == NULL ||
+                        (indexCatalog->haveIdIndex(opCtx) &&
+                         Helpers::findById(opCtx, collection, updateCriteria).isNull()) ||
+                        // capped collections won't have an _id index
+                        (!indexCatalog->haveIdIndex(opCtx) &&
+                         Helpers::findOne(opCtx, collection, updateCriteria, false).isNull())) {
+                        string msg = str::stream() << "couldn't find doc: " << redact(op);
+                        logFailure(msg);
+                        return Status(ErrorCodes::UpdateOperationFailed, msg);
+                    }
+
+                    // Otherwise, it's present; zero objects were updated because of additional
+                    // specifiers in the query for idempotence
+                } else {
+                    // this could happen benignly on an oplog duplicate replay of an upsert
+                    // (because we are idempotent),
+                    // if an regular non-mod update fails the item is (presumably) missing.
+                    if (!upsert) {
+                        string msg = str::stream() << "update of non-mod failed: " << redact(op);
+                        logFailure(msg);
+                        return Status(ErrorCodes::UpdateOperationFailed, msg);
+                    }
                 }
+            }
+            return Status::OK();
+        };
 
-                // Otherwise, it's present; zero objects were updated because of additional
-                // specifiers in the query for idempotence
-            } else {
-                // this could happen benignly on an oplog duplicate replay of an upsert
-                // (because we are idempotent),
-                // if an regular non-mod update fails the item is (presumably) missing.
-                if (!upsert) {
-                    string msg = str::stream() << "update of non-mod failed: " << redact(op);
-                    error() << msg;
-                    return Status(ErrorCodes::UpdateOperationFailed, msg);
+        if (fieldO.type() == Array) {
+            // Batched updates, with the update criteria for each one at the same position in "o2".
+            uassert(ErrorCodes::OperationFailed,
+                    str::stream() << "Failed to apply batched update due to mismatched 'o' and "
+                                     "'o2' fields: "
+                                  << op.toString(),
+                    fieldO2.type() == Array &&
+                        fieldO.Obj().nFields() == fieldO2.Obj().nFields() &&
+                        !fieldO.Obj().isEmpty());
+            WriteUnitOfWork wuow(opCtx);
+            BSONObjIterator criteriaIt(fieldO2.Obj());
+            for (auto elem : fieldO.Obj()) {
+                Status status = applyUpdate(elem.Obj(), criteriaIt.next().Obj(), true);
+                if (!status.isOK()) {
+                    return status;
                 }
             }
-        }
-        if (incrementOpsAppliedStats) {
-            incrementOpsAppliedStats();
+            wuow.commit();
+            for (int i = 0; i < fieldO.Obj().nFields(); i++) {
+                opCounters->gotUpdate();
+                if (incrementOpsAppliedStats) {
+                    incrementOpsAppliedStats();
+                }
+            }
+        } else {
+            // Single update.
+            opCounters->gotUpdate();
+            Status status = applyUpdate(o, o2, false);
+            if (!status.isOK()) {
+                return status;
+            }
+            if (incrementOpsAppliedStats) {
+                incrementOpsAppliedStats();
+            }
         }
     } else if (*opType == 'd') {
-        opCounters->gotDelete();
+        // Deletes which are part of a group are counted once the group commits
+        auto applyDelete = [&](const BSONObj& o) {
+            uassert(ErrorCodes::NoSuchKey,
+                    str::stream() << "Failed to apply delete due to missing _id: "
+                                  << op.toString(),
+                    o.hasField("_id"));
 
-        uassert(ErrorCodes::NoSuchKey,
-                str::stream() << "Failed to apply delete due to missing _id: " << op.toString(),
-                o.hasField("_id"));
+            if (opType[1] == 0) {
+                deleteObjects(opCtx, collection, requestNss, o, /*justOne*/ valueB);
+            } else
+                verify(opType[1] == 'b');  // "db" advertisement
+        };
 
-        if (opType[1] == 0) {
-            deleteObjects(opCtx, collection, requestNss, o, /*justOne*/ valueB);
-        } else
-            verify(opType[1] == 'b');  // "db" advertisement
-        if (incrementOpsAppliedStats) {
-            incrementOpsAppliedStats();
+        if (fieldO.type() == Array) {
+            // Batched deletes.
+            uassert(ErrorCodes::OperationFailed,
+                    str::stream() << "Failed to apply delete due to empty array element: "
+                                  << op.toString(),
+                    !fieldO.Obj().isEmpty());
+            WriteUnitOfWork wuow(opCtx);
+            for (auto elem : fieldO.Obj()) {
+                applyDelete(elem.Obj());
+            }
+            wuow.commit();
+            for (int i = 0; i < fieldO.Obj().nFields(); i++) {
+                opCounters->gotDelete();
+                if (incrementOpsAppliedStats) {
+                    incrementOpsAppliedStats();
+                }
+            }
+        } else {
+            // Single delete.
+            opCounters->gotDelete();
+            applyDelete(o);
+            if (incrementOpsAppliedStats) {
+                incrementOpsAppliedStats();
+            }
         }
     } else if (*opType == 'n') {
         // no op
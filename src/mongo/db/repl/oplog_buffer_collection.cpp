@@ -39,6 +39,8 @@
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/catalog/collection_options.h"
+#include "mongo/db/concurrency/locker.h"
+#include "mongo/db/operation_context.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
@@ -55,6 +57,33 @@ const StringData kTimestampFieldName = "ts"_sd;
 const StringData kSentinelFieldName = "s"_sd;
 const StringData kIdIdxName = "_id_"_sd;
 
+/**
+ * Unless 'shouldConflict' is true, lets the storage accesses made in its scope proceed while the
+ * applier holds the parallel batch writer lock.
+ */
+class SecondaryBatchApplicationConflictBlock {
+    MONGO_DISALLOW_COPYING(SecondaryBatchApplicationConflictBlock);
+
+public:
+    SecondaryBatchApplicationConflictBlock(OperationContext* opCtx, bool shouldConflict)
+        : _locker(shouldConflict ? nullptr : opCtx->lockState()),
+          _shouldConflict(_locker && _locker->shouldConflictWithSecondaryBatchApplication()) {
+        if (_locker) {
+            _locker->setShouldConflictWithSecondaryBatchApplication(false);
+        }
+    }
+
+    ~SecondaryBatchApplicationConflictBlock() {
+        if (_locker) {
+            _locker->setShouldConflictWithSecondaryBatchApplication(_shouldConflict);
+        }
+    }
+
+private:
+    Locker* const _locker;
+    const bool _shouldConflict;
+};
+
 }  // namespace
 
 NamespaceString OplogBufferCollection::getDefaultNamespace() {
@@ -101,6 +130,8 @@ OplogBufferCollection::Options OplogBufferCollection::getOptions() const {
 }
 
 void OplogBufferCollection::startup(OperationContext* opCtx) {
+    SecondaryBatchApplicationConflictBlock conflictBlock(
+        opCtx, _options.conflictWithSecondaryBatchApplication);
     if (_options.dropCollectionAtStartup) {
         clear(opCtx);
         return;
@@ -147,6 +178,8 @@ void OplogBufferCollection::startup(OperationContext* opCtx) {
 }
 
 void OplogBufferCollection::shutdown(OperationContext* opCtx) {
+    SecondaryBatchApplicationConflictBlock conflictBlock(
+        opCtx, _options.conflictWithSecondaryBatchApplication);
     if (_options.dropCollectionAtShutdown) {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
         _dropCollection(opCtx);
@@ -171,6 +204,8 @@ void OplogBufferCollection::push(OperationContext* opCtx, const Value& value) {
 void OplogBufferCollection::pushAllNonBlocking(OperationContext* opCtx,
                                                Batch::const_iterator begin,
                                                Batch::const_iterator end) {
+    SecondaryBatchApplicationConflictBlock conflictBlock(
+        opCtx, _options.conflictWithSecondaryBatchApplication);
     if (begin == end) {
         return;
     }
@@ -221,6 +256,8 @@ std::size_t OplogBufferCollection::getCount() const {
 }
 
 void OplogBufferCollection::clear(OperationContext* opCtx) {
+    SecondaryBatchApplicationConflictBlock conflictBlock(
+        opCtx, _options.conflictWithSecondaryBatchApplication);
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     _dropCollection(opCtx);
     _createCollection(opCtx);
@@ -233,6 +270,8 @@ void OplogBufferCollection::clear(OperationContext* opCtx) {
 }
 
 bool OplogBufferCollection::tryPop(OperationContext* opCtx, Value* value) {
+    SecondaryBatchApplicationConflictBlock conflictBlock(
+        opCtx, _options.conflictWithSecondaryBatchApplication);
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     if (_count == 0) {
         return false;
@@ -250,6 +289,8 @@ bool OplogBufferCollection::waitForData(Seconds waitDuration) {
 }
 
 bool OplogBufferCollection::peek(OperationContext* opCtx, Value* value) {
+    SecondaryBatchApplicationConflictBlock conflictBlock(
+        opCtx, _options.conflictWithSecondaryBatchApplication);
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     if (_count == 0) {
         return false;
@@ -260,6 +301,8 @@ bool OplogBufferCollection::peek(OperationContext* opCtx, Value* value) {
 
 boost::optional<OplogBuffer::Value> OplogBufferCollection::lastObjectPushed(
     OperationContext* opCtx) const {
+    SecondaryBatchApplicationConflictBlock conflictBlock(
+        opCtx, _options.conflictWithSecondaryBatchApplication);
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     auto lastDocumentPushed = _lastDocumentPushed_inlock(opCtx);
     if (lastDocumentPushed) {
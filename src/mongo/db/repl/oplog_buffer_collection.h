@@ -55,6 +55,9 @@ public:
         std::size_t peekCacheSize = 0;
         bool dropCollectionAtStartup = true;
         bool dropCollectionAtShutdown = true;
+        // If false, reads and writes of the collection proceed while the applier holds the
+        // parallel batch writer lock rather than waiting for the current batch to be applied.
+        bool conflictWithSecondaryBatchApplication = true;
         Options() {}
     };
 
@@ -0,0 +1,328 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_buffer_spilling.h"
+
+#include <iterator>
+#include <numeric>
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+// The number and size of oplog entries which did not fit in memory and were spilled.
+Counter64 spilledOpsStats;
+ServerStatusMetricField<Counter64> displaySpilledOps("repl.buffer.spill.ops", &spilledOpsStats);
+Counter64 spilledBytesStats;
+ServerStatusMetricField<Counter64> displaySpilledBytes("repl.buffer.spill.bytes",
+                                                       &spilledBytesStats);
+
+std::size_t getDocumentSize(const BSONObj& o) {
+    return static_cast<std::size_t>(o.objsize());
+}
+
+}  // namespace
+
+OplogBufferSpilling::OplogBufferSpilling(std::unique_ptr<OplogBuffer> spillBuffer, Options options)
+    : _spillBuffer(std::move(spillBuffer)), _options(std::move(options)) {
+    invariant(_spillBuffer);
+    invariant(_options.maxMemorySize > 0);
+}
+
+void OplogBufferSpilling::startup(OperationContext* opCtx) {
+    _spillBuffer->startup(opCtx);
+}
+
+void OplogBufferSpilling::shutdown(OperationContext* opCtx) {
+    {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _acquireSpillBuffer_inlock(lk);
+        _memory.clear();
+        _memorySize = 0;
+        _spillBufferCount = 0;
+        _spillBufferSize = 0;
+        _spilledSize = 0;
+        _lastPushed = boost::none;
+    }
+    _cvNoLongerFull.notify_all();
+
+    ON_BLOCK_EXIT([this] { _releaseSpillBuffer(); });
+    _spillBuffer->shutdown(opCtx);
+}
+
+void OplogBufferSpilling::pushEvenIfFull(OperationContext* opCtx, const Value& value) {
+    Batch valueBatch = {value};
+    pushAllNonBlocking(opCtx, valueBatch.begin(), valueBatch.end());
+}
+
+void OplogBufferSpilling::push(OperationContext* opCtx, const Value& value) {
+    waitForSpace(opCtx, getDocumentSize(value));
+    pushEvenIfFull(opCtx, value);
+}
+
+void OplogBufferSpilling::pushAllNonBlocking(OperationContext* opCtx,
+                                             Batch::const_iterator begin,
+                                             Batch::const_iterator end) {
+    if (begin == end) {
+        return;
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _lastPushed = *std::prev(end);
+
+    auto it = begin;
+    auto pushToMemory = [&] {
+        for (; it != end && _fitsInMemory_inlock(getDocumentSize(*it)); ++it) {
+            _memory.push_back(*it);
+            _memorySize += getDocumentSize(*it);
+        }
+    };
+
+    pushToMemory();
+    if (it == end) {
+        _cvNoLongerEmpty.notify_all();
+        return;
+    }
+
+    // Wait for any reader of the spill buffer, which may have drained it in the meantime
+    _acquireSpillBuffer_inlock(lk);
+    pushToMemory();
+    if (it == end) {
+        _releaseSpillBuffer_inlock();
+        _cvNoLongerEmpty.notify_all();
+        return;
+    }
+
+    // Account for the spilled entries up front, so that readers see them while they are written
+    const auto spilledCount = std::distance(it, end);
+    const auto spilledSize =
+        std::accumulate(it, end, std::size_t(0), [](std::size_t size, const Value& value) {
+            return size + getDocumentSize(value);
+        });
+    _spillBufferCount += spilledCount;
+    _spillBufferSize += spilledSize;
+    _spilledSize += spilledSize;
+    _cvNoLongerEmpty.notify_all();
+    lk.unlock();
+
+    ON_BLOCK_EXIT([this] { _releaseSpillBuffer(); });
+    _spillBuffer->pushAllNonBlocking(opCtx, it, end);
+    spilledOpsStats.increment(spilledCount);
+    spilledBytesStats.increment(spilledSize);
+}
+
+void OplogBufferSpilling::waitForSpace(OperationContext* opCtx, std::size_t size) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _cvNoLongerFull.wait(lk, [&] { return _hasSpaceFor_inlock(size); });
+}
+
+bool OplogBufferSpilling::isEmpty() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _memory.empty() && !_spillBufferCount;
+}
+
+std::size_t OplogBufferSpilling::getMaxSize() const {
+    if (!_options.maxSpillSize) {
+        return 0;
+    }
+    return _options.maxMemorySize + _options.maxSpillSize;
+}
+
+std::size_t OplogBufferSpilling::getSize() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _memorySize + _spillBufferSize;
+}
+
+std::size_t OplogBufferSpilling::getCount() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _memory.size() + _spillBufferCount;
+}
+
+void OplogBufferSpilling::clear(OperationContext* opCtx) {
+    {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _acquireSpillBuffer_inlock(lk);
+        _memory.clear();
+        _memorySize = 0;
+        _lastPushed = boost::none;
+    }
+
+    ON_BLOCK_EXIT([this] { _releaseSpillBuffer(); });
+    _spillBuffer->clear(opCtx);
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _spillBufferCount = 0;
+        _spillBufferSize = 0;
+        _spilledSize = 0;
+    }
+    _cvNoLongerFull.notify_all();
+}
+
+bool OplogBufferSpilling::tryPop(OperationContext* opCtx, Value* value) {
+    {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _refillFromSpillBuffer(opCtx, lk);
+        if (_memory.empty()) {
+            return false;
+        }
+        *value = std::move(_memory.front());
+        _memory.pop_front();
+        _memorySize -= getDocumentSize(*value);
+    }
+    _cvNoLongerFull.notify_all();
+    return true;
+}
+
+bool OplogBufferSpilling::waitForData(Seconds waitDuration) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    return _cvNoLongerEmpty.wait_for(lk, waitDuration.toSystemDuration(), [&] {
+        return !_memory.empty() || _spillBufferCount;
+    });
+}
+
+bool OplogBufferSpilling::peek(OperationContext* opCtx, Value* value) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _refillFromSpillBuffer(opCtx, lk);
+    if (_memory.empty()) {
+        return false;
+    }
+    *value = _memory.front();
+    return true;
+}
+
+boost::optional<OplogBuffer::Value> OplogBufferSpilling::lastObjectPushed(
+    OperationContext* opCtx) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _lastPushed;
+}
+
+std::size_t OplogBufferSpilling::getMemoryCount_forTest() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _memory.size();
+}
+
+std::size_t OplogBufferSpilling::getSpilledSize_forTest() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _spilledSize;
+}
+
+bool OplogBufferSpilling::_hasSpaceFor_inlock(std::size_t size) const {
+    if (_fitsInMemory_inlock(size) || !_options.maxSpillSize) {
+        return true;
+    }
+
+    // Always accept an entry into an empty spill buffer so that entries larger than either limit
+    // can make progress.
+    return !_spilledSize || _spilledSize + size <= _options.maxSpillSize;
+}
+
+bool OplogBufferSpilling::_fitsInMemory_inlock(std::size_t size) const {
+    // Nothing may be held in memory ahead of entries which are already spilled.
+    if (_spillBufferCount) {
+        return false;
+    }
+    return _memory.empty() || _memorySize + size <= _options.maxMemorySize;
+}
+
+void OplogBufferSpilling::_acquireSpillBuffer_inlock(stdx::unique_lock<stdx::mutex>& lk) {
+    _cvSpillBufferAvailable.wait(lk, [&] { return !_spillBufferInUse; });
+    _spillBufferInUse = true;
+}
+
+void OplogBufferSpilling::_releaseSpillBuffer() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _releaseSpillBuffer_inlock();
+}
+
+void OplogBufferSpilling::_releaseSpillBuffer_inlock() {
+    invariant(_spillBufferInUse);
+    _spillBufferInUse = false;
+    _cvSpillBufferAvailable.notify_all();
+}
+
+void OplogBufferSpilling::_refillFromSpillBuffer(OperationContext* opCtx,
+                                                 stdx::unique_lock<stdx::mutex>& lk) {
+    if (!_memory.empty() || !_spillBufferCount) {
+        return;
+    }
+
+    // Wait for the spilled entries to be written, then check that no other reader moved them
+    _acquireSpillBuffer_inlock(lk);
+    if (!_memory.empty() || !_spillBufferCount) {
+        _releaseSpillBuffer_inlock();
+        return;
+    }
+    lk.unlock();
+
+    auto releaseGuard = MakeGuard([this] { _releaseSpillBuffer(); });
+
+    std::deque<Value> refilled;
+    std::size_t refilledSize = 0;
+    Value value;
+    while (refilledSize < _options.maxMemorySize / 2 && _spillBuffer->tryPop(opCtx, &value)) {
+        refilledSize += getDocumentSize(value);
+        refilled.push_back(std::move(value));
+    }
+
+    const bool drained = _spillBuffer->isEmpty();
+    if (drained) {
+        // Reclaim the space used by the entries popped from the spill buffer.
+        _spillBuffer->clear(opCtx);
+    }
+
+    // Publish the refilled entries before other threads may access the spill buffer, so that
+    // pushes which find it drained are not held in memory ahead of them.
+    lk.lock();
+    releaseGuard.Dismiss();
+    _releaseSpillBuffer_inlock();
+
+    _memorySize = refilledSize;
+    if (drained) {
+        _spillBufferCount = 0;
+        _spillBufferSize = 0;
+        _spilledSize = 0;
+        _cvNoLongerFull.notify_all();
+    } else {
+        _spillBufferCount -= refilled.size();
+        _spillBufferSize -= refilledSize;
+    }
+    _memory = std::move(refilled);
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,171 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <deque>
+#include <memory>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/repl/oplog_buffer.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Oplog buffer which holds the oldest entries in memory and spills the rest to a second, typically
+ * collection-backed, oplog buffer once the memory limit is reached. This lets the fetcher keep
+ * fetching while the applier stalls, using bounded memory and only appending to and reading
+ * sequentially from the spill buffer.
+ *
+ * Every entry in memory is older than every entry in the spill buffer: once an entry has been
+ * spilled, later entries are spilled too until the applier has drained the spill buffer, at which
+ * point it is cleared and new entries go to memory again. Entries are moved back from the spill
+ * buffer into memory in bulk whenever memory runs empty.
+ *
+ * Reads and writes of the spill buffer happen outside of the mutex which protects the in-memory
+ * state, so that the size and count accessors and in-memory pushes and pops do not wait for them.
+ * Only one thread accesses the spill buffer at a time.
+ */
+class OplogBufferSpilling final : public OplogBuffer {
+    MONGO_DISALLOW_COPYING(OplogBufferSpilling);
+
+public:
+    /**
+     * Structure used to configure an instance of OplogBufferSpilling.
+     */
+    struct Options {
+        // Maximum total size of the entries held in memory.
+        std::size_t maxMemorySize = 256 * 1024 * 1024;
+        // Maximum total size of the entries written to the spill buffer since it was last cleared.
+        // If equal to 0, the spill buffer is unbounded.
+        std::size_t maxSpillSize = std::size_t(4) * 1024 * 1024 * 1024;
+        Options() {}
+    };
+
+    explicit OplogBufferSpilling(std::unique_ptr<OplogBuffer> spillBuffer,
+                                 Options options = Options());
+
+    void startup(OperationContext* opCtx) override;
+    void shutdown(OperationContext* opCtx) override;
+    void pushEvenIfFull(OperationContext* opCtx, const Value& value) override;
+    void push(OperationContext* opCtx, const Value& value) override;
+    void pushAllNonBlocking(OperationContext* opCtx,
+                            Batch::const_iterator begin,
+                            Batch::const_iterator end) override;
+    void waitForSpace(OperationContext* opCtx, std::size_t size) override;
+    bool isEmpty() const override;
+    std::size_t getMaxSize() const override;
+    std::size_t getSize() const override;
+    std::size_t getCount() const override;
+    void clear(OperationContext* opCtx) override;
+    bool tryPop(OperationContext* opCtx, Value* value) override;
+    bool waitForData(Seconds waitDuration) override;
+    bool peek(OperationContext* opCtx, Value* value) override;
+    boost::optional<Value> lastObjectPushed(OperationContext* opCtx) const override;
+
+    // ---- Testing API ----
+    std::size_t getMemoryCount_forTest() const;
+    std::size_t getSpilledSize_forTest() const;
+
+private:
+    /**
+     * Returns true if an entry of 'size' bytes may be pushed without exceeding the configured
+     * limits.
+     */
+    bool _hasSpaceFor_inlock(std::size_t size) const;
+
+    /**
+     * Returns true if an entry of 'size' bytes would be held in memory if pushed now.
+     */
+    bool _fitsInMemory_inlock(std::size_t size) const;
+
+    /**
+     * Waits until no other thread is accessing the spill buffer, and claims it for the caller.
+     */
+    void _acquireSpillBuffer_inlock(stdx::unique_lock<stdx::mutex>& lk);
+
+    /**
+     * Lets the next thread access the spill buffer.
+     */
+    void _releaseSpillBuffer();
+    void _releaseSpillBuffer_inlock();
+
+    /**
+     * Moves entries from the spill buffer into memory until memory is half full, clearing the
+     * spill buffer once it has been drained. Does nothing unless memory is empty and entries are
+     * spilled. Releases 'lk' while reading from the spill buffer.
+     */
+    void _refillFromSpillBuffer(OperationContext* opCtx, stdx::unique_lock<stdx::mutex>& lk);
+
+    // Holds the entries which do not fit in memory. Owned by us.
+    const std::unique_ptr<OplogBuffer> _spillBuffer;
+
+    // These are the options with which the oplog buffer was configured at construction time.
+    const Options _options;
+
+    // Protects member data below.
+    mutable stdx::mutex _mutex;
+
+    // Signalled when an entry is pushed.
+    stdx::condition_variable _cvNoLongerEmpty;
+
+    // Signalled when memory or spill space is freed.
+    stdx::condition_variable _cvNoLongerFull;
+
+    // Signalled when a thread is done accessing the spill buffer.
+    stdx::condition_variable _cvSpillBufferAvailable;
+
+    // Set while a thread accesses the spill buffer without holding '_mutex'.
+    bool _spillBufferInUse = false;
+
+    // The oldest entries in the buffer, in the order in which they were pushed.
+    std::deque<Value> _memory;
+
+    // Size of the entries in '_memory'.
+    std::size_t _memorySize = 0;
+
+    // Number and size of the entries pushed to the spill buffer, including those still being
+    // written, which have not been moved back into memory yet.
+    std::size_t _spillBufferCount = 0;
+    std::size_t _spillBufferSize = 0;
+
+    // Size of the entries pushed to the spill buffer since it was last cleared. Entries popped from
+    // a collection-backed buffer keep using space until it is cleared, so these count against
+    // 'maxSpillSize' until then.
+    std::size_t _spilledSize = 0;
+
+    boost::optional<Value> _lastPushed;
+};
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,275 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_buffer_blocking_queue.h"
+#include "mongo/db/repl/oplog_buffer_spilling.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/notification.h"
+
+namespace {
+
+using namespace mongo;
+using namespace mongo::repl;
+
+const std::size_t kDocSize = 100;
+
+/**
+ * Returns an entry of exactly kDocSize bytes.
+ */
+BSONObj makeEntry(int i) {
+    BSONObj prototype = BSON("_id" << i << "x"
+                                   << "");
+    return BSON("_id" << i << "x" << std::string(kDocSize - prototype.objsize(), 'x'));
+}
+
+class OplogBufferSpillingTest : public unittest::Test {
+protected:
+    void setUp() override {
+        auto spillBuffer = stdx::make_unique<OplogBufferBlockingQueue>();
+        spill = spillBuffer.get();
+
+        OplogBufferSpilling::Options options;
+        options.maxMemorySize = 4 * kDocSize;
+        options.maxSpillSize = 8 * kDocSize;
+        buffer = stdx::make_unique<OplogBufferSpilling>(std::move(spillBuffer), options);
+        buffer->startup(nullptr);
+    }
+
+    void tearDown() override {
+        buffer->shutdown(nullptr);
+    }
+
+    void pushEntries(int first, int last) {
+        OplogBuffer::Batch batch;
+        for (int i = first; i < last; ++i) {
+            batch.push_back(makeEntry(i));
+        }
+        buffer->pushAllNonBlocking(nullptr, batch.cbegin(), batch.cend());
+    }
+
+    void popAndCheckEntries(int first, int last) {
+        for (int i = first; i < last; ++i) {
+            OplogBuffer::Value value;
+            ASSERT_TRUE(buffer->peek(nullptr, &value));
+            ASSERT_BSONOBJ_EQ(makeEntry(i), value);
+            ASSERT_TRUE(buffer->tryPop(nullptr, &value));
+            ASSERT_BSONOBJ_EQ(makeEntry(i), value);
+        }
+    }
+
+    OplogBufferBlockingQueue* spill = nullptr;
+    std::unique_ptr<OplogBufferSpilling> buffer;
+};
+
+TEST_F(OplogBufferSpillingTest, EntriesWithinMemoryLimitAreNotSpilled) {
+    pushEntries(0, 4);
+    ASSERT_EQUALS(4U, buffer->getMemoryCount_forTest());
+    ASSERT_TRUE(spill->isEmpty());
+    ASSERT_EQUALS(4U, buffer->getCount());
+    ASSERT_EQUALS(4 * kDocSize, buffer->getSize());
+    ASSERT_BSONOBJ_EQ(makeEntry(3), *buffer->lastObjectPushed(nullptr));
+
+    popAndCheckEntries(0, 4);
+    ASSERT_TRUE(buffer->isEmpty());
+}
+
+TEST_F(OplogBufferSpillingTest, EntriesBeyondMemoryLimitAreSpilledAndPoppedInOrder) {
+    pushEntries(0, 6);
+    ASSERT_EQUALS(4U, buffer->getMemoryCount_forTest());
+    ASSERT_EQUALS(2U, spill->getCount());
+    ASSERT_EQUALS(2 * kDocSize, buffer->getSpilledSize_forTest());
+    ASSERT_EQUALS(6U, buffer->getCount());
+
+    // Entries pushed while earlier entries are spilled are spilled too, even once there is room in
+    // memory, so that they are not popped ahead of the spilled ones.
+    popAndCheckEntries(0, 1);
+    pushEntries(6, 7);
+    ASSERT_EQUALS(3U, buffer->getMemoryCount_forTest());
+    ASSERT_EQUALS(3U, spill->getCount());
+
+    popAndCheckEntries(1, 7);
+    ASSERT_TRUE(buffer->isEmpty());
+    ASSERT_EQUALS(0U, buffer->getSpilledSize_forTest());
+}
+
+TEST_F(OplogBufferSpillingTest, RefillMovesSpilledEntriesIntoMemoryInBulk) {
+    pushEntries(0, 10);
+    popAndCheckEntries(0, 4);
+    ASSERT_EQUALS(0U, buffer->getMemoryCount_forTest());
+
+    // Refilling stops once memory is half full.
+    popAndCheckEntries(4, 5);
+    ASSERT_EQUALS(1U, buffer->getMemoryCount_forTest());
+    ASSERT_EQUALS(4U, spill->getCount());
+    ASSERT_EQUALS(6 * kDocSize, buffer->getSpilledSize_forTest());
+
+    // Once the spill buffer is drained it is cleared and new entries are held in memory again.
+    popAndCheckEntries(5, 9);
+    ASSERT_TRUE(spill->isEmpty());
+    ASSERT_EQUALS(0U, buffer->getSpilledSize_forTest());
+    pushEntries(10, 11);
+    ASSERT_EQUALS(2U, buffer->getMemoryCount_forTest());
+    ASSERT_TRUE(spill->isEmpty());
+    popAndCheckEntries(9, 11);
+}
+
+TEST_F(OplogBufferSpillingTest, WaitForSpaceReturnsWhileWithinSpillLimit) {
+    ASSERT_EQUALS(12 * kDocSize, buffer->getMaxSize());
+    pushEntries(0, 11);
+    buffer->waitForSpace(nullptr, kDocSize);
+    ASSERT_TRUE(buffer->waitForData(Seconds(0)));
+
+    // Entries larger than either limit are accepted into an empty buffer.
+    buffer->clear(nullptr);
+    ASSERT_TRUE(buffer->isEmpty());
+    ASSERT_FALSE(buffer->lastObjectPushed(nullptr));
+    buffer->waitForSpace(nullptr, 100 * kDocSize);
+}
+
+TEST_F(OplogBufferSpillingTest, ClearEmptiesMemoryAndSpillBuffer) {
+    pushEntries(0, 6);
+    buffer->clear(nullptr);
+    ASSERT_TRUE(buffer->isEmpty());
+    ASSERT_TRUE(spill->isEmpty());
+    ASSERT_EQUALS(0U, buffer->getSize());
+    ASSERT_EQUALS(0U, buffer->getSpilledSize_forTest());
+    ASSERT_FALSE(buffer->waitForData(Seconds(0)));
+
+    OplogBuffer::Value value;
+    ASSERT_FALSE(buffer->peek(nullptr, &value));
+    ASSERT_FALSE(buffer->tryPop(nullptr, &value));
+}
+
+TEST_F(OplogBufferSpillingTest, SpillLimitIsFiniteByDefault) {
+    ASSERT_NOT_EQUALS(0U, OplogBufferSpilling::Options().maxSpillSize);
+}
+
+/**
+ * Spill buffer whose pushes block until they are allowed to complete, to simulate slow writes.
+ */
+class PausingSpillBuffer : public OplogBuffer {
+public:
+    void startup(OperationContext* opCtx) override {
+        _queue.startup(opCtx);
+    }
+    void shutdown(OperationContext* opCtx) override {
+        _queue.shutdown(opCtx);
+    }
+    void pushEvenIfFull(OperationContext* opCtx, const Value& value) override {
+        _queue.pushEvenIfFull(opCtx, value);
+    }
+    void push(OperationContext* opCtx, const Value& value) override {
+        _queue.push(opCtx, value);
+    }
+    void pushAllNonBlocking(OperationContext* opCtx,
+                            Batch::const_iterator begin,
+                            Batch::const_iterator end) override {
+        pushStarted.set();
+        allowPush.get();
+        _queue.pushAllNonBlocking(opCtx, begin, end);
+    }
+    void waitForSpace(OperationContext* opCtx, std::size_t size) override {
+        _queue.waitForSpace(opCtx, size);
+    }
+    bool isEmpty() const override {
+        return _queue.isEmpty();
+    }
+    std::size_t getMaxSize() const override {
+        return _queue.getMaxSize();
+    }
+    std::size_t getSize() const override {
+        return _queue.getSize();
+    }
+    std::size_t getCount() const override {
+        return _queue.getCount();
+    }
+    void clear(OperationContext* opCtx) override {
+        _queue.clear(opCtx);
+    }
+    bool tryPop(OperationContext* opCtx, Value* value) override {
+        return _queue.tryPop(opCtx, value);
+    }
+    bool waitForData(Seconds waitDuration) override {
+        return _queue.waitForData(waitDuration);
+    }
+    bool peek(OperationContext* opCtx, Value* value) override {
+        return _queue.peek(opCtx, value);
+    }
+    boost::optional<Value> lastObjectPushed(OperationContext* opCtx) const override {
+        return _queue.lastObjectPushed(opCtx);
+    }
+
+    Notification<void> pushStarted;
+    Notification<void> allowPush;
+
+private:
+    OplogBufferBlockingQueue _queue;
+};
+
+TEST(OplogBufferSpillingWithSlowSpillBufferTest, AccessorsDoNotWaitForSpillBufferWrites) {
+    auto spillBuffer = stdx::make_unique<PausingSpillBuffer>();
+    auto spill = spillBuffer.get();
+
+    OplogBufferSpilling::Options options;
+    options.maxMemorySize = kDocSize;
+    OplogBufferSpilling buffer(std::move(spillBuffer), options);
+    buffer.startup(nullptr);
+
+    OplogBuffer::Batch batch = {makeEntry(0), makeEntry(1), makeEntry(2)};
+    stdx::thread pusher([&] { buffer.pushAllNonBlocking(nullptr, batch.cbegin(), batch.cend()); });
+
+    // The spilled entries are accounted for while they are being written
+    spill->pushStarted.get();
+    ASSERT_FALSE(buffer.isEmpty());
+    ASSERT_EQUALS(3U, buffer.getCount());
+    ASSERT_EQUALS(3 * kDocSize, buffer.getSize());
+    ASSERT_TRUE(buffer.waitForData(Seconds(0)));
+
+    OplogBuffer::Value value;
+    ASSERT_TRUE(buffer.tryPop(nullptr, &value));
+    ASSERT_BSONOBJ_EQ(makeEntry(0), value);
+
+    spill->allowPush.set();
+    pusher.join();
+
+    for (int i = 1; i < 3; ++i) {
+        ASSERT_TRUE(buffer.tryPop(nullptr, &value));
+        ASSERT_BSONOBJ_EQ(makeEntry(i), value);
+    }
+    ASSERT_TRUE(buffer.isEmpty());
+
+    buffer.shutdown(nullptr);
+}
+
+}  // namespace
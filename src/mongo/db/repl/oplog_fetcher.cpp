@@ -35,7 +35,9 @@
 #include "mongo/base/counter.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/query/compressed_batch.h"
 #include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/rpc/metadata/oplog_query_metadata.h"
 #include "mongo/util/assert_util.h"
@@ -52,6 +54,11 @@ MONGO_FP_DECLARE(stopReplProducer);
 
 namespace {
 
+// When enabled, getMores on the sync source's oplog ask for snappy-compressed batches, which carry
+// several times as many operations per round trip as a plain batch. Only sync sources which
+// understand the getMore 'batchCompressor' option may be used with this enabled.
+MONGO_EXPORT_SERVER_PARAMETER(oplogFetcherBatchCompression, bool, false);
+
 // The number and time spent reading batches off the network
 TimerStats getmoreReplStats;
 ServerStatusMetricField<TimerStats> displayBatchesRecieved("repl.network.getmores",
@@ -87,7 +94,15 @@ BSONObj makeGetMoreCommandObject(const NamespaceString& nss,
     BSONObjBuilder cmdBob;
     cmdBob.append("getMore", cursorId);
     cmdBob.append("collection", nss.coll());
-    cmdBob.append("batchSize", batchSize);
+    if (oplogFetcherBatchCompression.load()) {
+        // The batch size is tuned for batches bounded by the maximum reply size. A compressed
+        // batch is instead bounded by the larger amount of documents it may carry.
+        cmdBob.append("batchSize",
+                      batchSize * (CompressedBatchBuilder::kMaxRawBytes / BSONObjMaxUserSize));
+        cmdBob.append("batchCompressor", CompressedBatchBuilder::kSnappyCompressor);
+    } else {
+        cmdBob.append("batchSize", batchSize);
+    }
     cmdBob.append("maxTimeMS", durationCount<Milliseconds>(fetcherMaxTimeMS));
     if (lastCommittedWithCurrentTerm.value != OpTime::kUninitializedTerm) {
         cmdBob.append("term", lastCommittedWithCurrentTerm.value);
@@ -337,6 +337,16 @@ public:
      */
     virtual void setMyLastAppliedOpTimeForward(const OpTime& opTime) = 0;
 
+    /**
+     * Same as setMyLastAppliedOpTimeForward(), except that the new position is not reported to
+     * this node's sync source.
+     *
+     * This function is used by secondaries which report the applied OpTime of a batch together
+     * with its durable OpTime once the batch has been journaled, so that the sync source receives
+     * a single position update per batch.
+     */
+    virtual void setMyLastAppliedOpTimeForwardWithoutReporting(const OpTime& opTime) = 0;
+
     /**
      * Updates our internal tracking of the last OpTime durable to this node, but only
      * if the supplied optime is later than the current last OpTime known to the replication
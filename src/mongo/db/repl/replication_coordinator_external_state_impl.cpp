@@ -62,6 +62,7 @@
 #include "mongo/db/repl/oplog_buffer_blocking_queue.h"
 #include "mongo/db/repl/oplog_buffer_collection.h"
 #include "mongo/db/repl/oplog_buffer_proxy.h"
+#include "mongo/db/repl/oplog_buffer_spilling.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/repl/replication_process.h"
@@ -120,6 +121,9 @@ const char tsFieldName[] = "ts";
 
 const char kCollectionOplogBufferName[] = "collection";
 const char kBlockingQueueOplogBufferName[] = "inMemoryBlockingQueue";
+const char kSpillingOplogBufferName[] = "inMemorySpillingToCollection";
+
+const char kSteadyStateOplogBufferNamespace[] = "local.temp_oplog_buffer_steady_state";
 
 // Set this to true to force background creation of snapshots even if --enableMajorityReadConcern
 // isn't specified. This can be used for A-B benchmarking to find how much overhead
@@ -135,6 +139,18 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncOplogBuffer,
 // Set this to specify size of read ahead buffer in the OplogBufferCollection.
 MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncOplogBufferPeekCacheSize, int, 10000);
 
+// Set this to specify whether oplog entries which do not fit in memory during steady state
+// replication are spilled to a collection, so that the oplog fetcher keeps fetching while the
+// applier is stalled rather than letting the node fall off its sync source's oplog.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(steadyStateOplogBuffer,
+                                      std::string,
+                                      kBlockingQueueOplogBufferName);
+
+// Set these to specify the memory and spill collection limits of the spilling oplog buffer. A
+// spill limit of 0 leaves the spill collection unbounded.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(steadyStateOplogBufferMaxMemorySizeMB, int, 256);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(steadyStateOplogBufferMaxSpillSizeMB, int, 4096);
+
 // Set this to specify maximum number of times the oplog fetcher will consecutively restart the
 // oplog tailing query on non-cancellation errors.
 server_parameter_storage_type<int, ServerParameterType::kStartupAndRuntime>::value_type
@@ -171,6 +187,23 @@ MONGO_INITIALIZER(initialSyncOplogBuffer)(InitializerContext*) {
     return Status::OK();
 }
 
+MONGO_INITIALIZER(steadyStateOplogBuffer)(InitializerContext*) {
+    if ((steadyStateOplogBuffer != kBlockingQueueOplogBufferName) &&
+        (steadyStateOplogBuffer != kSpillingOplogBufferName)) {
+        return Status(ErrorCodes::BadValue,
+                      "unsupported steady state oplog buffer option: " + steadyStateOplogBuffer);
+    }
+    if (steadyStateOplogBufferMaxMemorySizeMB <= 0) {
+        return Status(ErrorCodes::BadValue,
+                      "steadyStateOplogBufferMaxMemorySizeMB must be greater than 0");
+    }
+    if (steadyStateOplogBufferMaxSpillSizeMB < 0) {
+        return Status(ErrorCodes::BadValue,
+                      "steadyStateOplogBufferMaxSpillSizeMB must be greater than or equal to 0");
+    }
+    return Status::OK();
+}
+
 /**
  * Returns new thread pool for thread pool task executor.
  */
@@ -871,6 +904,19 @@ std::unique_ptr<OplogBuffer> ReplicationCoordinatorExternalStateImpl::makeInitia
 
 std::unique_ptr<OplogBuffer> ReplicationCoordinatorExternalStateImpl::makeSteadyStateOplogBuffer(
     OperationContext* opCtx) const {
+    if (steadyStateOplogBuffer == kSpillingOplogBufferName) {
+        OplogBufferCollection::Options collectionOptions;
+        collectionOptions.peekCacheSize = std::size_t(initialSyncOplogBufferPeekCacheSize);
+        collectionOptions.conflictWithSecondaryBatchApplication = false;
+        OplogBufferSpilling::Options options;
+        options.maxMemorySize = std::size_t(steadyStateOplogBufferMaxMemorySizeMB) * 1024 * 1024;
+        options.maxSpillSize = std::size_t(steadyStateOplogBufferMaxSpillSizeMB) * 1024 * 1024;
+        auto spillBuffer = stdx::make_unique<OplogBufferCollection>(
+            StorageInterface::get(opCtx),
+            NamespaceString(kSteadyStateOplogBufferNamespace),
+            collectionOptions);
+        return stdx::make_unique<OplogBufferSpilling>(std::move(spillBuffer), options);
+    }
     return stdx::make_unique<OplogBufferBlockingQueue>();
 }
 
@@ -172,6 +172,7 @@ void ReplicationCoordinatorImpl::CallbackWaiter::notify_inlock() {
 }
 
 
+template <typename WaiterListType>
 class ReplicationCoordinatorImpl::WaiterGuard {
 public:
     /**
@@ -185,7 +186,7 @@ public:
      * _list is guarded by ReplicationCoordinatorImpl::_mutex, thus it is illegal to construct one
      * of these without holding _mutex
      */
-    WaiterGuard(WaiterList* list, Waiter* waiter) : _list(list), _waiter(waiter) {
+    WaiterGuard(WaiterListType* list, Waiter* waiter) : _list(list), _waiter(waiter) {
         list->add_inlock(_waiter);
     }
 
@@ -194,7 +195,7 @@ public:
     }
 
 private:
-    WaiterList* _list;
+    WaiterListType* _list;
     Waiter* _waiter;
 };
 
@@ -246,6 +247,46 @@ bool ReplicationCoordinatorImpl::WaiterList::remove_inlock(WaiterType waiter) {
     return true;
 }
 
+void ReplicationCoordinatorImpl::OrderedWaiterList::add_inlock(WaiterType waiter) {
+    _waiters.emplace(waiter->opTime, waiter);
+}
+
+void ReplicationCoordinatorImpl::OrderedWaiterList::signalAndRemoveWhile_inlock(
+    stdx::function<bool(WaiterType)> func) {
+    while (!_waiters.empty()) {
+        auto it = _waiters.begin();
+        WaiterType waiter = it->second;
+        if (!func(waiter)) {
+            return;
+        }
+        _waiters.erase(it);
+
+        // It's important to call notify() after the waiter has been removed from the list
+        // since notify() might remove the waiter itself.
+        waiter->notify_inlock();
+    }
+}
+
+void ReplicationCoordinatorImpl::OrderedWaiterList::signalAndRemoveAll_inlock() {
+    std::multimap<OpTime, WaiterType> waiters = std::move(_waiters);
+    _waiters.clear();
+    // Call notify() after removing the waiters from the list.
+    for (auto& entry : waiters) {
+        entry.second->notify_inlock();
+    }
+}
+
+bool ReplicationCoordinatorImpl::OrderedWaiterList::remove_inlock(WaiterType waiter) {
+    auto range = _waiters.equal_range(waiter->opTime);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == waiter) {
+            _waiters.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
 namespace {
 ReplicationCoordinator::Mode getReplicationModeFromSettings(const ReplSettings& settings) {
     if (settings.usingReplSets()) {
@@ -737,6 +778,8 @@ void ReplicationCoordinatorImpl::shutdown(OperationContext* opCtx) {
             fassert(18823, _rsConfigState != kConfigStartingUp);
         }
         _replicationWaiterList.signalAndRemoveAll_inlock();
+        _majorityAppliedWaiterList.signalAndRemoveAll_inlock();
+        _majorityDurableWaiterList.signalAndRemoveAll_inlock();
         _opTimeWaiterList.signalAndRemoveAll_inlock();
         _currentCommittedSnapshotCond.notify_all();
         _initialSyncer.swap(initialSyncerCopy);
@@ -979,6 +1022,15 @@ void ReplicationCoordinatorImpl::setMyLastAppliedOpTimeForward(const OpTime& opT
     }
 }
 
+void ReplicationCoordinatorImpl::setMyLastAppliedOpTimeForwardWithoutReporting(
+    const OpTime& opTime) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    if (opTime > _getMyLastAppliedOpTime_inlock()) {
+        const bool allowRollback = false;
+        _setMyLastAppliedOpTime_inlock(opTime, allowRollback);
+    }
+}
+
 void ReplicationCoordinatorImpl::setMyLastDurableOpTimeForward(const OpTime& opTime) {
     stdx::unique_lock<stdx::mutex> lock(_mutex);
     if (opTime > _getMyLastDurableOpTime_inlock()) {
@@ -1169,7 +1221,7 @@ Status ReplicationCoordinatorImpl::_waitUntilOpTime(OperationContext* opCtx,
         // We just need to wait for the opTime to catch up to what we need (not majority RC).
         stdx::condition_variable condVar;
         ThreadWaiter waiter(targetOpTime, nullptr, &condVar);
-        WaiterGuard guard(&_opTimeWaiterList, &waiter);
+        WaiterGuard<WaiterList> guard(&_opTimeWaiterList, &waiter);
 
         LOG(3) << "waitUntilOpTime: OpID " << opCtx->getOpID() << " is waiting for OpTime "
                << waiter << " until " << opCtx->getDeadline();
@@ -1533,10 +1585,17 @@ Status ReplicationCoordinatorImpl::_awaitReplication_inlock(
             Milliseconds{writeConcern.wTimeout};
     }();
 
-    // Must hold _mutex before constructing waitInfo as it will modify _replicationWaiterList
+    // Must hold _mutex before constructing waitInfo as it will modify _replicationWaiterList or
+    // one of the majority waiter lists.
     stdx::condition_variable condVar;
     ThreadWaiter waiter(opTime, &writeConcern, &condVar);
-    WaiterGuard guard(&_replicationWaiterList, &waiter);
+    boost::optional<WaiterGuard<WaiterList>> guard;
+    boost::optional<WaiterGuard<OrderedWaiterList>> majorityGuard;
+    if (writeConcern.wMode == WriteConcernOptions::kMajority) {
+        majorityGuard.emplace(_getMajorityWaiterList_inlock(writeConcern), &waiter);
+    } else {
+        guard.emplace(&_replicationWaiterList, &waiter);
+    }
     while (!_doneWaitingForReplication_inlock(opTime, minSnapshot, writeConcern)) {
 
         if (_inShutdown) {
@@ -2377,6 +2436,8 @@ ReplicationCoordinatorImpl::_updateMemberStateFromTopologyCoordinator_inlock() {
     if (_memberState.primary() || newState.removed() || newState.rollback()) {
         // Wake up any threads blocked in awaitReplication, close connections, etc.
         _replicationWaiterList.signalAndRemoveAll_inlock();
+        _majorityAppliedWaiterList.signalAndRemoveAll_inlock();
+        _majorityDurableWaiterList.signalAndRemoveAll_inlock();
         // Wake up the optime waiter that is waiting for primary catch-up to finish.
         _opTimeWaiterList.signalAndRemoveAll_inlock();
         _canAcceptNonLocalWrites = false;
@@ -2715,10 +2776,24 @@ ReplicationCoordinatorImpl::_setCurrentRSConfig_inlock(const ReplSetConfig& newC
 }
 
 void ReplicationCoordinatorImpl::_wakeReadyWaiters_inlock() {
-    _replicationWaiterList.signalAndRemoveIf_inlock([this](Waiter* waiter) {
+    const auto isDone = [this](Waiter* waiter) {
         return _doneWaitingForReplication_inlock(
             waiter->opTime, SnapshotName::min(), *waiter->writeConcern);
-    });
+    };
+    _replicationWaiterList.signalAndRemoveIf_inlock(isDone);
+    // Whether a "majority" waiter is done only depends on how far the commit point and the
+    // majority of voters have advanced, so all waiters up to the first one which is not done can
+    // be released in a single pass over the front of each list.
+    _majorityAppliedWaiterList.signalAndRemoveWhile_inlock(isDone);
+    _majorityDurableWaiterList.signalAndRemoveWhile_inlock(isDone);
+}
+
+ReplicationCoordinatorImpl::OrderedWaiterList*
+ReplicationCoordinatorImpl::_getMajorityWaiterList_inlock(const WriteConcernOptions& writeConcern) {
+    invariant(writeConcern.wMode == WriteConcernOptions::kMajority);
+    return writeConcern.syncMode == WriteConcernOptions::SyncMode::JOURNAL
+        ? &_majorityDurableWaiterList
+        : &_majorityAppliedWaiterList;
 }
 
 Status ReplicationCoordinatorImpl::processReplSetUpdatePosition(
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -157,6 +158,7 @@ public:
     virtual void setMyLastDurableOpTime(const OpTime& opTime);
 
     virtual void setMyLastAppliedOpTimeForward(const OpTime& opTime);
+    virtual void setMyLastAppliedOpTimeForwardWithoutReporting(const OpTime& opTime);
     virtual void setMyLastDurableOpTimeForward(const OpTime& opTime);
 
     virtual void resetMyLastOpTimes();
@@ -531,6 +533,7 @@ private:
         FinishFunc finishCallback = nullptr;
     };
 
+    template <typename WaiterListType>
     class WaiterGuard;
 
     class WaiterList {
@@ -550,6 +553,28 @@ private:
         std::vector<WaiterType> _list;
     };
 
+    // A list of waiters kept in OpTime order, for conditions which, once satisfied for an OpTime,
+    // are also satisfied for every earlier OpTime. This holds for "majority" write concern waiters
+    // that share a sync mode, so releasing the waiters up to a new commit point stops at the first
+    // waiter which is not done yet instead of evaluating every waiter on each progress update.
+    class OrderedWaiterList {
+    public:
+        using WaiterType = Waiter*;
+
+        // Adds waiter into the list.
+        void add_inlock(WaiterType waiter);
+        // Returns whether waiter is found and removed.
+        bool remove_inlock(WaiterType waiter);
+        // Signals and removes waiters in OpTime order, stopping at the first waiter that does not
+        // satisfy the condition.
+        void signalAndRemoveWhile_inlock(stdx::function<bool(WaiterType)> func);
+        // Signals and removes all waiters from the list.
+        void signalAndRemoveAll_inlock();
+
+    private:
+        std::multimap<OpTime, WaiterType> _waiters;
+    };
+
     typedef std::vector<executor::TaskExecutor::CallbackHandle> HeartbeatHandles;
 
     // The state and logic of primary catchup.
@@ -623,10 +648,17 @@ private:
                                                            int myIndex);
 
     /**
-     * Helper to wake waiters in _replicationWaiterList that are doneWaitingForReplication.
+     * Helper to wake waiters in _replicationWaiterList and the majority waiter lists that are
+     * doneWaitingForReplication.
      */
     void _wakeReadyWaiters_inlock();
 
+    /**
+     * Returns the ordered list that waiters for "majority" write concern with the sync mode of
+     * "writeConcern" are queued on.
+     */
+    OrderedWaiterList* _getMajorityWaiterList_inlock(const WriteConcernOptions& writeConcern);
+
     /**
      * Scheduled to cause the ReplicationCoordinator to reconsider any state that might
      * need to change as a result of time passing - for instance becoming PRIMARY when a single
@@ -1212,6 +1244,11 @@ private:
     // list of information about clients waiting on replication.  Does *not* own the WaiterInfos.
     WaiterList _replicationWaiterList;  // (M)
 
+    // Clients waiting for "majority" write concern, waiting on the applied and the durable OpTimes
+    // of the majority respectively. Do *not* own the waiters.
+    OrderedWaiterList _majorityAppliedWaiterList;  // (M)
+    OrderedWaiterList _majorityDurableWaiterList;  // (M)
+
     // list of information about clients waiting for a particular opTime.
     // Does *not* own the WaiterInfos.
     WaiterList _opTimeWaiterList;  // (M)
@@ -1187,6 +1187,81 @@ TEST_F(ReplCoordTest, NodeReturnsOkWhenAWriteConcernWithNoTimeoutHasBeenSatisfie
     awaiter.reset();
 }
 
+TEST_F(ReplCoordTest, NodeReleasesMajorityWaitersUpToTheOpTimeReachedByAMajority) {
+    assertStartSuccess(BSON("_id"
+                            << "mySet"
+                            << "version"
+                            << 2
+                            << "members"
+                            << BSON_ARRAY(BSON("host"
+                                               << "node1:12345"
+                                               << "_id"
+                                               << 0)
+                                          << BSON("host"
+                                                  << "node2:12345"
+                                                  << "_id"
+                                                  << 1)
+                                          << BSON("host"
+                                                  << "node3:12345"
+                                                  << "_id"
+                                                  << 2))),
+                       HostAndPort("node1", 12345));
+
+    // Turn off readconcern majority support, and snapshots.
+    disableReadConcernMajoritySupport();
+    disableSnapshots();
+
+    ASSERT_OK(getReplCoord()->setFollowerMode(MemberState::RS_SECONDARY));
+    getReplCoord()->setMyLastAppliedOpTime(OpTimeWithTermOne(100, 0));
+    getReplCoord()->setMyLastDurableOpTime(OpTimeWithTermOne(100, 0));
+    simulateSuccessfulV1Election();
+
+    OpTimeWithTermOne time1(100, 1);
+    OpTimeWithTermOne time2(100, 2);
+    OpTimeWithTermOne time3(100, 3);
+    getReplCoord()->setMyLastAppliedOpTime(time3);
+    getReplCoord()->setMyLastDurableOpTime(time3);
+
+    WriteConcernOptions writeConcern;
+    writeConcern.wTimeout = WriteConcernOptions::kNoTimeout;
+    writeConcern.wMode = WriteConcernOptions::kMajority;
+    writeConcern.syncMode = WriteConcernOptions::SyncMode::NONE;
+
+    // Waiters are queued out of OpTime order.
+    ReplicationAwaiter awaiter3(getReplCoord(), getServiceContext());
+    awaiter3.setOpTime(time3);
+    awaiter3.setWriteConcern(writeConcern);
+    awaiter3.start();
+
+    ReplicationAwaiter awaiter1(getReplCoord(), getServiceContext());
+    awaiter1.setOpTime(time1);
+    awaiter1.setWriteConcern(writeConcern);
+    awaiter1.start();
+
+    ReplicationAwaiter awaiter2(getReplCoord(), getServiceContext());
+    awaiter2.setOpTime(time2);
+    awaiter2.setWriteConcern(writeConcern);
+    awaiter2.start();
+
+    WriteConcernOptions journaledWriteConcern = writeConcern;
+    journaledWriteConcern.syncMode = WriteConcernOptions::SyncMode::JOURNAL;
+    ReplicationAwaiter awaiterJournaled(getReplCoord(), getServiceContext());
+    awaiterJournaled.setOpTime(time1);
+    awaiterJournaled.setWriteConcern(journaledWriteConcern);
+    awaiterJournaled.start();
+
+    // A single update releases both waiters at or before the new majority OpTime.
+    ASSERT_OK(getReplCoord()->setLastAppliedOptime_forTest(2, 1, time2));
+    ASSERT_OK(awaiter1.getResult().status);
+    ASSERT_OK(awaiter2.getResult().status);
+
+    ASSERT_OK(getReplCoord()->setLastDurableOptime_forTest(2, 1, time1));
+    ASSERT_OK(awaiterJournaled.getResult().status);
+
+    ASSERT_OK(getReplCoord()->setLastAppliedOptime_forTest(2, 2, time3));
+    ASSERT_OK(awaiter3.getResult().status);
+}
+
 TEST_F(ReplCoordTest, NodeReturnsWriteConcernFailedWhenAWriteConcernTimesOutBeforeBeingSatisified) {
     assertStartSuccess(BSON("_id"
                             << "mySet"
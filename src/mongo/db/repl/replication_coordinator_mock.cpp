@@ -206,6 +206,11 @@ void ReplicationCoordinatorMock::setMyLastAppliedOpTimeForward(const OpTime& opT
     }
 }
 
+void ReplicationCoordinatorMock::setMyLastAppliedOpTimeForwardWithoutReporting(
+    const OpTime& opTime) {
+    setMyLastAppliedOpTimeForward(opTime);
+}
+
 void ReplicationCoordinatorMock::setMyLastDurableOpTimeForward(const OpTime& opTime) {
     if (opTime > _myLastDurableOpTime) {
         _myLastDurableOpTime = opTime;
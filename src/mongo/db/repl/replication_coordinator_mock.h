@@ -120,6 +120,7 @@ public:
     virtual void setMyLastDurableOpTime(const OpTime& opTime);
 
     virtual void setMyLastAppliedOpTimeForward(const OpTime& opTime);
+    virtual void setMyLastAppliedOpTimeForwardWithoutReporting(const OpTime& opTime);
     virtual void setMyLastDurableOpTimeForward(const OpTime& opTime);
 
     virtual void resetMyLastOpTimes();
@@ -28,9 +28,12 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/uuid.h"
 
@@ -87,6 +90,27 @@ public:
                                   UUID uuid,
                                   const BSONObj& filter) const = 0;
 
+    /**
+     * Fetches the documents with the given _id values from the sync source using the UUID, in no
+     * particular order. Documents which no longer exist on the sync source are left out. Unlike the
+     * other functions, this one may be called concurrently.
+     *
+     * The default implementation fetches the documents one at a time through findOneByUUID().
+     */
+    virtual std::vector<BSONObj> findByIdsByUUID(const std::string& db,
+                                                 UUID uuid,
+                                                 const std::vector<BSONElement>& ids) const {
+        stdx::lock_guard<stdx::mutex> lk(_findByIdsMutex);
+        std::vector<BSONObj> docs;
+        for (const auto& id : ids) {
+            BSONObj doc = findOneByUUID(db, uuid, id.wrap());
+            if (!doc.isEmpty()) {
+                docs.push_back(doc.getOwned());
+            }
+        }
+        return docs;
+    }
+
     /**
      * Clones a single collection from the sync source.
      */
@@ -105,6 +129,10 @@ public:
      * necessary for rollback with no uuid oplogs. See SERVER-29766.
      */
     virtual StatusWith<BSONObj> getCollectionInfo(const NamespaceString& nss) const = 0;
+
+private:
+    // Serializes the calls to findOneByUUID() made by the default findByIdsByUUID().
+    mutable stdx::mutex _findByIdsMutex;
 };
 
 }  // namespace repl
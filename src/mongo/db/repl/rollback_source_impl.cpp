@@ -79,6 +79,62 @@ BSONObj RollbackSourceImpl::findOneByUUID(const std::string& db,
     return _getConnection()->findOneByUUID(db, uuid, filter);
 }
 
+std::vector<BSONObj> RollbackSourceImpl::findByIdsByUUID(
+    const std::string& db, UUID uuid, const std::vector<BSONElement>& ids) const {
+    // Each call uses its own connection so that documents can be refetched from several
+    // collections at once.
+    std::string errmsg;
+    DBClientConnection conn;
+    uassert(40733,
+            str::stream() << "unable to connect to " << _source << " to refetch documents: "
+                          << errmsg,
+            conn.connect(_source, StringData(), errmsg) && replAuthenticate(&conn));
+
+    BSONObjBuilder cmdBuilder;
+    uuid.appendToBuilder(&cmdBuilder, "find");
+    {
+        BSONObjBuilder filterBuilder(cmdBuilder.subobjStart("filter"));
+        BSONObjBuilder idBuilder(filterBuilder.subobjStart("_id"));
+        BSONArrayBuilder inBuilder(idBuilder.subarrayStart("$in"));
+        for (const auto& id : ids) {
+            inBuilder.append(id);
+        }
+    }
+    // Rollback identifies documents by their exact _id values, regardless of the collation of the
+    // collection.
+    cmdBuilder.append("collation",
+                      BSON("locale"
+                           << "simple"));
+    BSONObj cmd = cmdBuilder.obj();
+
+    std::vector<BSONObj> docs;
+    BSONObj res;
+    uassert(40734,
+            str::stream() << "find command using UUID failed. Command: " << cmd << " Result: "
+                          << res,
+            conn.runCommand(db, cmd, res, QueryOption_SlaveOk));
+    BSONObj cursorObj = res.getObjectField("cursor");
+    for (const auto& doc : cursorObj.getObjectField("firstBatch")) {
+        docs.push_back(doc.Obj().getOwned());
+    }
+
+    long long cursorId = cursorObj["id"].numberLong();
+    const NamespaceString nss(cursorObj["ns"].valueStringData());
+    while (cursorId != 0) {
+        BSONObj getMoreCmd = BSON("getMore" << cursorId << "collection" << nss.coll());
+        uassert(40735,
+                str::stream() << "getMore command failed. Command: " << getMoreCmd << " Result: "
+                              << res,
+                conn.runCommand(db, getMoreCmd, res, QueryOption_SlaveOk));
+        cursorObj = res.getObjectField("cursor");
+        for (const auto& doc : cursorObj.getObjectField("nextBatch")) {
+            docs.push_back(doc.Obj().getOwned());
+        }
+        cursorId = cursorObj["id"].numberLong();
+    }
+    return docs;
+}
+
 void RollbackSourceImpl::copyCollectionFromRemote(OperationContext* opCtx,
                                                   const NamespaceString& nss) const {
     std::string errmsg;
@@ -68,6 +68,10 @@ public:
 
     BSONObj findOneByUUID(const std::string& db, UUID uuid, const BSONObj& filter) const override;
 
+    std::vector<BSONObj> findByIdsByUUID(const std::string& db,
+                                         UUID uuid,
+                                         const std::vector<BSONElement>& ids) const override;
+
     void copyCollectionFromRemote(OperationContext* opCtx,
                                   const NamespaceString& nss) const override;
 
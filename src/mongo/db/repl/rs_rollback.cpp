@@ -70,7 +70,10 @@
 #include "mongo/db/repl/rollback_source.h"
 #include "mongo/db/repl/rslog.h"
 #include "mongo/db/s/shard_identity_rollback_notifier.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/session_catalog.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -576,6 +579,183 @@ Status rollback_internal::updateFixUpInfoFromLocalOplogEntry(FixUpInfo& fixUpInf
 
 namespace {
 
+// The maximum number of documents refetched from the sync source with a single query.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(rollbackRefetchBatchSize, int, 1000);
+
+// The number of threads refetching documents from the sync source and restoring them. The documents
+// of different collections are refetched and restored concurrently.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(rollbackWriterThreadCount, int, 16);
+
+MONGO_INITIALIZER(rollbackWriterParameters)(InitializerContext*) {
+    if (rollbackRefetchBatchSize < 1 || rollbackRefetchBatchSize > 100 * 1000) {
+        return Status(ErrorCodes::BadValue,
+                      "rollbackRefetchBatchSize must be between 1 and 100000, inclusive");
+    }
+    if (rollbackWriterThreadCount < 1 || rollbackWriterThreadCount > 256) {
+        return Status(ErrorCodes::BadValue,
+                      "rollbackWriterThreadCount must be between 1 and 256, inclusive");
+    }
+    return Status::OK();
+}
+
+// The maximum total size of the _id values refetched with a single query, which keeps the query
+// well below the maximum command size.
+const int kMaxRefetchBatchIdBytes = 8 * 1024 * 1024;
+
+// We do not roll back more than 300 MB of documents in order to prevent out of memory errors from
+// too much data being stored. See SERVER-23392.
+const unsigned long long kMaxRefetchTotalBytes = 300 * 1024 * 1024;
+
+// UUID -> doc id -> doc
+using GoodVersions = stdx::unordered_map<UUID, std::map<DocID, BSONObj>, UUID::Hash>;
+
+/**
+ * Runs each of "tasks" with an OperationContext, on a pool of up to rollbackWriterThreadCount
+ * threads, and waits for all of them to finish. A single task is run on the calling thread with
+ * "opCtx". Once a task throws, the tasks which have not started yet are skipped, and the exception
+ * is rethrown after the others have finished.
+ */
+void runConcurrently(OperationContext* opCtx,
+                     const std::string& poolName,
+                     const std::vector<stdx::function<void(OperationContext*)>>& tasks) {
+    if (tasks.size() <= 1) {
+        for (const auto& task : tasks) {
+            task(opCtx);
+        }
+        return;
+    }
+
+    ThreadPool::Options options;
+    options.poolName = poolName;
+    options.maxThreads = std::min(static_cast<size_t>(rollbackWriterThreadCount), tasks.size());
+    options.onCreateThread = [](const std::string& threadName) { Client::initThread(threadName); };
+    ThreadPool pool(options);
+    pool.startup();
+
+    stdx::mutex mutex;
+    std::exception_ptr firstException;
+    for (const auto& task : tasks) {
+        fassertStatusOK(40736, pool.schedule([&mutex, &firstException, &task] {
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                if (firstException) {
+                    return;
+                }
+            }
+            try {
+                auto taskOpCtx = cc().makeOperationContext();
+                DisableDocumentValidation validationDisabler(taskOpCtx.get());
+                UnreplicatedWritesBlock replicationDisabler(taskOpCtx.get());
+                task(taskOpCtx.get());
+            } catch (...) {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                if (!firstException) {
+                    firstException = std::current_exception();
+                }
+            }
+        }));
+    }
+    pool.shutdown();
+    pool.join();
+
+    if (firstException) {
+        std::rethrow_exception(firstException);
+    }
+}
+
+/**
+ * Fetches the current version of each document in "docsToRefetch" from the sync source into
+ * "goodVersions", where an empty document means that it no longer exists there. The documents of a
+ * collection are fetched with one query per rollbackRefetchBatchSize documents, and the queries for
+ * different collections run concurrently.
+ */
+void refetchDocuments(OperationContext* opCtx,
+                      const std::set<DocID>& docsToRefetch,
+                      const RollbackSource& rollbackSource,
+                      GoodVersions* goodVersions) {
+    auto& catalog = UUIDCatalog::get(opCtx);
+
+    stdx::mutex mutex;
+    unsigned long long totalSize = 0;
+    unsigned long long numFetched = 0;
+
+    // Fetches one batch of documents, all of which belong to the same collection.
+    auto fetchBatch = [&](const std::vector<const DocID*>& batch) {
+        const UUID uuid = batch.front()->uuid;
+        const NamespaceString nss = catalog.lookupNSSByUUID(uuid);
+
+        std::vector<BSONElement> ids;
+        for (const auto doc : batch) {
+            invariant(!doc->_id.eoo());  // This is checked when we insert to the set.
+            ids.push_back(doc->_id);
+        }
+
+        LOG(2) << "Refetching " << ids.size() << " documents, namespace: " << nss.toString()
+               << ", first _id: " << redact(ids.front());
+
+        std::vector<BSONObj> docs;
+        try {
+            docs = rollbackSource.findByIdsByUUID(nss.db().toString(), uuid, ids);
+        } catch (const DBException& ex) {
+            // If the collection turned into a view, we might get an error trying to
+            // refetch documents, but these errors should be ignored, as we'll be creating
+            // the view during oplog replay.
+            if (ex.code() == ErrorCodes::CommandNotSupportedOnView)
+                return;
+
+            log() << "Rollback couldn't re-fetch " << ids.size() << " documents from uuid: " << uuid
+                  << " starting at _id: " << redact(ids.front()) << ": " << redact(ex);
+            throw;
+        }
+
+        // Note a good version might stay empty, indicating we should delete the document.
+        std::map<DocID, BSONObj> versions;
+        for (const auto doc : batch) {
+            versions.emplace(*doc, BSONObj());
+        }
+        unsigned long long batchSize = 0;
+        for (const auto& good : docs) {
+            auto it = versions.find(DocID(good, good["_id"], uuid));
+            if (it == versions.end()) {
+                continue;
+            }
+            it->second = good;
+            batchSize += good.objsize();
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        totalSize += batchSize;
+        numFetched += batch.size();
+        if (totalSize >= kMaxRefetchTotalBytes) {
+            throw RSFatalException("replSet too much data to roll back.");
+        }
+        (*goodVersions)[uuid].insert(versions.begin(), versions.end());
+    };
+
+    // Splits the documents into batches. Since the documents are ordered by collection first, the
+    // documents of each collection are contiguous.
+    std::vector<std::vector<const DocID*>> batches;
+    int batchIdBytes = 0;
+    for (const auto& doc : docsToRefetch) {
+        if (batches.empty() || batches.back().front()->uuid != doc.uuid ||
+            batches.back().size() >= static_cast<size_t>(rollbackRefetchBatchSize) ||
+            batchIdBytes + doc._id.size() > kMaxRefetchBatchIdBytes) {
+            batches.emplace_back();
+            batchIdBytes = 0;
+        }
+        batches.back().push_back(&doc);
+        batchIdBytes += doc._id.size();
+    }
+
+    std::vector<stdx::function<void(OperationContext*)>> tasks;
+    for (const auto& batch : batches) {
+        tasks.push_back([&fetchBatch, &batch](OperationContext*) { fetchBatch(batch); });
+    }
+    runConcurrently(opCtx, "rollback refetcher", tasks);
+
+    log() << "Refetched " << numFetched << " documents in " << batches.size() << " batches";
+}
+
 /**
  * This must be called before making any changes to our local data and after fetching any
  * information from the upstream node. If any information is fetched from the upstream node after we
@@ -874,54 +1054,13 @@ void syncFixUp(OperationContext* opCtx,
                const RollbackSource& rollbackSource,
                ReplicationCoordinator* replCoord,
                ReplicationProcess* replicationProcess) {
-    unsigned long long totalSize = 0;
-
-    // UUID -> doc id -> doc
-    stdx::unordered_map<UUID, std::map<DocID, BSONObj>, UUID::Hash> goodVersions;
+    GoodVersions goodVersions;
     auto& catalog = UUIDCatalog::get(opCtx);
 
     // Fetches all the goodVersions of each document from the current sync source.
-    unsigned long long numFetched = 0;
-
     log() << "Starting refetching documents";
 
-    for (auto&& doc : fixUpInfo.docsToRefetch) {
-        invariant(!doc._id.eoo());  // This is checked when we insert to the set.
-
-        UUID uuid = doc.uuid;
-        NamespaceString nss = catalog.lookupNSSByUUID(uuid);
-
-        try {
-            LOG(2) << "Refetching document, namespace: " << nss.toString()
-                   << ", _id: " << redact(doc._id);
-            // TODO : Slow. Lots of round trips.
-            numFetched++;
-            BSONObj good = rollbackSource.findOneByUUID(nss.db().toString(), uuid, doc._id.wrap());
-            totalSize += good.objsize();
-
-            // Checks that the total amount of data that needs to be refetched is at most
-            // 300 MB. We do not roll back more than 300 MB of documents in order to
-            // prevent out of memory errors from too much data being stored. See SERVER-23392.
-            if (totalSize >= 300 * 1024 * 1024) {
-                throw RSFatalException("replSet too much data to roll back.");
-            }
-
-            // Note good might be empty, indicating we should delete it.
-            goodVersions[uuid].insert(std::pair<DocID, BSONObj>(doc, good));
-
-        } catch (const DBException& ex) {
-            // If the collection turned into a view, we might get an error trying to
-            // refetch documents, but these errors should be ignored, as we'll be creating
-            // the view during oplog replay.
-            if (ex.code() == ErrorCodes::CommandNotSupportedOnView)
-                continue;
-
-            log() << "Rollback couldn't re-fetch from uuid: " << uuid << " _id: " << redact(doc._id)
-                  << ' ' << numFetched << '/' << fixUpInfo.docsToRefetch.size() << ": "
-                  << redact(ex);
-            throw;
-        }
-    }
+    refetchDocuments(opCtx, fixUpInfo.docsToRefetch, rollbackSource, &goodVersions);
 
     log() << "Finished refetching documents. Total size of documents refetched: "
           << goodVersions.size();
@@ -1115,16 +1254,17 @@ void syncFixUp(OperationContext* opCtx,
 
     log() << "Deleting and updating documents to roll back insert, update and remove "
              "operations";
-    unsigned deletes = 0, updates = 0;
-    time_t lastProgressUpdate = time(0);
-    time_t progressUpdateGap = 10;
+    AtomicUInt32 deletes, updates;
+    const time_t progressUpdateGap = 10;
 
-    for (const auto& nsAndGoodVersionsByDocID : goodVersions) {
+    // Restores the documents of one collection. The collections are restored concurrently.
+    auto rollBackDocuments = [&](OperationContext* opCtx,
+                                 const UUID& uuid,
+                                 const std::map<DocID, BSONObj>& goodVersionsByDocID) {
+        time_t lastProgressUpdate = time(0);
 
         // Keeps an archive of items rolled back if the collection has not been dropped
         // while rolling back createCollection operations.
-
-        const auto& uuid = nsAndGoodVersionsByDocID.first;
         unique_ptr<Helpers::RemoveSaver> removeSaver;
         invariant(!fixUpInfo.collectionsToDrop.count(uuid));
 
@@ -1132,23 +1272,30 @@ void syncFixUp(OperationContext* opCtx,
 
         removeSaver.reset(new Helpers::RemoveSaver("rollback", "", nss.ns()));
 
-        const auto& goodVersionsByDocID = nsAndGoodVersionsByDocID.second;
+        // The documents of a collection which exists are restored under an exclusive lock on just
+        // that collection, so that other collections of its database can be restored meanwhile.
+        // Otherwise an upsert may need to create the collection, which takes an exclusive database
+        // lock.
+        const bool collectionExists = catalog.lookupCollectionByUUID(uuid);
+
         for (const auto& idAndDoc : goodVersionsByDocID) {
             time_t now = time(0);
             if (now - lastProgressUpdate > progressUpdateGap) {
-                log() << deletes << " delete and " << updates
-                      << " update operations processed out of " << goodVersions.size()
+                log() << deletes.load() << " delete and " << updates.load()
+                      << " update operations processed out of " << fixUpInfo.docsToRefetch.size()
                       << " total operations.";
                 lastProgressUpdate = now;
             }
             const DocID& doc = idAndDoc.first;
             BSONObj pattern = doc._id.wrap();  // { _id : ... }
             try {
-
-                // TODO: Lots of overhead in context. This can be faster.
-                const NamespaceString docNss(doc.ns);
-                Lock::DBLock docDbLock(opCtx, docNss.db(), MODE_X);
-                OldClientContext ctx(opCtx, doc.ns.toString());
+                const NamespaceString docNss = collectionExists ? nss : NamespaceString(doc.ns);
+                Lock::DBLock docDbLock(opCtx, docNss.db(), collectionExists ? MODE_IX : MODE_X);
+                boost::optional<Lock::CollectionLock> docCollLock;
+                if (collectionExists) {
+                    docCollLock.emplace(opCtx->lockState(), docNss.ns(), MODE_X);
+                }
+                OldClientContext ctx(opCtx, docNss.ns());
                 Collection* collection = catalog.lookupCollectionByUUID(uuid);
 
                 // Adds the doc to our rollback file if the collection was not dropped while
@@ -1180,7 +1327,7 @@ void syncFixUp(OperationContext* opCtx,
                     // If the document could not be found on the primary, deletes the document.
                     // TODO 1.6 : can't delete from a capped collection. Need to handle that
                     // here.
-                    deletes++;
+                    deletes.fetchAndAdd(1);
 
                     if (collection) {
                         if (collection->isCapped()) {
@@ -1239,7 +1386,7 @@ void syncFixUp(OperationContext* opCtx,
                     }
                 } else {
                     // TODO faster...
-                    updates++;
+                    updates.fetchAndAdd(1);
 
                     UpdateRequest request(nss);
 
@@ -1254,13 +1401,23 @@ void syncFixUp(OperationContext* opCtx,
                 }
             } catch (const DBException& e) {
                 log() << "Exception in rollback ns:" << nss.ns() << ' ' << pattern.toString() << ' '
-                      << redact(e) << " ndeletes:" << deletes;
+                      << redact(e) << " ndeletes:" << deletes.load();
                 throw;
             }
         }
+    };
+
+    std::vector<stdx::function<void(OperationContext*)>> rollBackTasks;
+    for (const auto& nsAndGoodVersionsByDocID : goodVersions) {
+        rollBackTasks.push_back(
+            [&rollBackDocuments, &nsAndGoodVersionsByDocID](OperationContext* opCtx) {
+                rollBackDocuments(
+                    opCtx, nsAndGoodVersionsByDocID.first, nsAndGoodVersionsByDocID.second);
+            });
     }
+    runConcurrently(opCtx, "rollback writer", rollBackTasks);
 
-    log() << "Rollback deleted " << deletes << " documents and updated " << updates
+    log() << "Rollback deleted " << deletes.load() << " documents and updated " << updates.load()
           << " documents.";
 
     log() << "Truncating the oplog at " << fixUpInfo.commonPoint.toString();
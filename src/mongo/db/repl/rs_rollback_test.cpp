@@ -1695,6 +1695,98 @@ TEST_F(RSRollbackTest, RollbackApplyOpsCommand) {
         << result;
 }
 
+TEST_F(RSRollbackTest, RollbackRefetchesDocumentsOfEachCollectionInOneBatch) {
+    createOplog(_opCtx.get());
+    CollectionOptions options1;
+    options1.uuid = UUID::gen();
+    auto coll1 = _createCollection(_opCtx.get(), "test.t1", options1);
+    CollectionOptions options2;
+    options2.uuid = UUID::gen();
+    auto coll2 = _createCollection(_opCtx.get(), "test.t2", options2);
+    {
+        AutoGetOrCreateDb autoDb(_opCtx.get(), "test", MODE_X);
+        mongo::WriteUnitOfWork wuow(_opCtx.get());
+        OpDebug* const nullOpDebug = nullptr;
+        ASSERT_OK(coll1->insertDocument(
+            _opCtx.get(), InsertStatement(BSON("_id" << 1)), nullOpDebug, false));
+        ASSERT_OK(coll2->insertDocument(
+            _opCtx.get(), InsertStatement(BSON("_id" << 1 << "v" << 1)), nullOpDebug, false));
+        ASSERT_OK(coll2->insertDocument(
+            _opCtx.get(), InsertStatement(BSON("_id" << 2 << "v" << 2)), nullOpDebug, false));
+        wuow.commit();
+    }
+
+    const auto makeOperation = [](
+        int seconds, const char* opType, UUID uuid, const char* ns, int id) {
+        return std::make_pair(BSON("ts" << Timestamp(Seconds(seconds), 0) << "h" << 1LL << "op"
+                                        << opType
+                                        << "ui"
+                                        << uuid
+                                        << "ns"
+                                        << ns
+                                        << "o"
+                                        << BSON("_id" << id)
+                                        << "o2"
+                                        << BSON("_id" << id)),
+                              RecordId(seconds));
+    };
+    const auto commonOperation =
+        std::make_pair(BSON("ts" << Timestamp(Seconds(1), 0) << "h" << 1LL), RecordId(1));
+    const auto insertOperation = makeOperation(2, "i", *options1.uuid, "test.t1", 1);
+    const auto updateOperation1 = makeOperation(3, "u", *options2.uuid, "test.t2", 1);
+    const auto updateOperation2 = makeOperation(4, "u", *options2.uuid, "test.t2", 2);
+
+    class RollbackSourceLocal : public RollbackSourceMock {
+    public:
+        RollbackSourceLocal(std::unique_ptr<OplogInterface> oplog)
+            : RollbackSourceMock(std::move(oplog)) {}
+
+        std::vector<BSONObj> findByIdsByUUID(const std::string& db,
+                                             UUID uuid,
+                                             const std::vector<BSONElement>& ids) const override {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            batchSizes.push_back(ids.size());
+            std::vector<BSONObj> docs;
+            for (const auto& id : ids) {
+                // Only the documents of test.t2 still exist at the sync source.
+                if (uuid == uuid2) {
+                    docs.push_back(BSON("_id" << id.numberInt() << "v" << 10 * id.numberInt()));
+                }
+            }
+            return docs;
+        }
+
+        UUID uuid2 = UUID::gen();
+        mutable stdx::mutex mutex;
+        mutable std::vector<size_t> batchSizes;
+    } rollbackSource(std::unique_ptr<OplogInterface>(new OplogInterfaceMock({commonOperation})));
+    rollbackSource.uuid2 = *options2.uuid;
+
+    ASSERT_OK(syncRollback(
+        _opCtx.get(),
+        OplogInterfaceMock({updateOperation2, updateOperation1, insertOperation, commonOperation}),
+        rollbackSource,
+        {},
+        _coordinator,
+        _replicationProcess.get()));
+    std::sort(rollbackSource.batchSizes.begin(), rollbackSource.batchSizes.end());
+    ASSERT_EQUALS(2U, rollbackSource.batchSizes.size());
+    ASSERT_EQUALS(1U, rollbackSource.batchSizes[0]);
+    ASSERT_EQUALS(2U, rollbackSource.batchSizes[1]);
+
+    BSONObj result;
+    {
+        AutoGetCollectionForReadCommand acr(_opCtx.get(), NamespaceString("test.t1"));
+        ASSERT_FALSE(Helpers::findOne(_opCtx.get(), acr.getCollection(), BSON("_id" << 1), result))
+            << result;
+    }
+    AutoGetCollectionForReadCommand acr(_opCtx.get(), NamespaceString("test.t2"));
+    ASSERT(Helpers::findOne(_opCtx.get(), acr.getCollection(), BSON("_id" << 1), result));
+    ASSERT_EQUALS(10, result["v"].numberInt()) << result;
+    ASSERT(Helpers::findOne(_opCtx.get(), acr.getCollection(), BSON("_id" << 2), result));
+    ASSERT_EQUALS(20, result["v"].numberInt()) << result;
+}
+
 TEST_F(RSRollbackTest, RollbackCreateCollectionCommand) {
     createOplog(_opCtx.get());
     CollectionOptions options;
@@ -247,12 +247,14 @@ StorageInterfaceImpl::createCollectionForBulkLoading(
         return status;
     }
 
-    // Move locks into loader, so it now controls their lifetime.
+    // The loader takes the collection lock for each of its operations, rather than holding it for
+    // its lifetime, so that creating another collection in this database does not wait for it.
     auto loader =
         stdx::make_unique<CollectionBulkLoaderImpl>(Client::releaseCurrent(),
                                                     std::move(opCtx),
-                                                    std::move(autoColl),
+                                                    autoColl->getCollection(),
                                                     options.capped ? BSONObj() : idIndexSpec);
+    autoColl.reset();
 
     status = loader->init(options.capped ? std::vector<BSONObj>() : secondaryIndexSpecs);
     if (!status.isOK()) {
@@ -482,6 +482,34 @@ TEST_F(StorageInterfaceImplTest, CreateCollectionWithIDIndexCommits) {
     ASSERT_EQ(count, 2LL);
 }
 
+TEST_F(StorageInterfaceImplTest, CollectionBulkLoaderFailsAfterCollectionIsDropped) {
+    auto opCtx = getOperationContext();
+    StorageInterfaceImpl storage;
+    auto nss = makeNamespace(_agent);
+
+    // A capped collection has no unfinished indexes which would prevent dropping it while loading
+    CollectionOptions opts;
+    opts.capped = true;
+    opts.cappedSize = 1024 * 1024;
+    opts.uuid = UUID::gen();
+    std::vector<BSONObj> indexes;
+    auto loader = unittest::assertGet(
+        storage.createCollectionForBulkLoading(nss, opts, makeIdIndexSpec(nss), indexes));
+    std::vector<BSONObj> docs = {BSON("_id" << 1)};
+    ASSERT_OK(loader->insertDocuments(docs.begin(), docs.end()));
+
+    ASSERT_OK(storage.dropCollection(opCtx, nss));
+    ASSERT_OK(storage.createCollection(opCtx, nss, CollectionOptions()));
+
+    docs = {BSON("_id" << 2)};
+    ASSERT_EQUALS(ErrorCodes::NamespaceNotFound,
+                  loader->insertDocuments(docs.begin(), docs.end()));
+
+    AutoGetCollectionForReadCommand autoColl(opCtx, nss);
+    ASSERT_TRUE(autoColl.getCollection());
+    ASSERT_EQUALS(0LL, autoColl.getCollection()->getRecordStore()->numRecords(opCtx));
+}
+
 void _testDestroyUncommitedCollectionBulkLoader(
     OperationContext* opCtx,
     const NamespaceString& nss,
@@ -36,6 +36,7 @@
 #include "third_party/murmurhash3/MurmurHash3.h"
 #include <boost/functional/hash.hpp>
 #include <memory>
+#include <queue>
 
 #include "mongo/base/counter.h"
 #include "mongo/bson/bsonelement_comparator.h"
@@ -44,6 +45,7 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/document_validation.h"
+#include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog/uuid_catalog.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/fsync.h"
@@ -72,6 +74,7 @@
 #include "mongo/db/session_txn_record.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -93,6 +96,8 @@ AtomicInt32 SyncTail::replBatchLimitOperations{50 * 1000};
  * "replWriterThreadCount" server parameter.
  */
 namespace {
+const int kMaxReplWriterThreadCount = 256;
+
 #if defined(MONGO_PLATFORM_64)
 int replWriterThreadCount = 16;
 #elif defined(MONGO_PLATFORM_32)
@@ -109,7 +114,7 @@ public:
               ServerParameterSet::getGlobal(), "replWriterThreadCount", &replWriterThreadCount) {}
 
     virtual Status validate(const int& potentialNewValue) {
-        if (potentialNewValue < 1 || potentialNewValue > 256) {
+        if (potentialNewValue < 1 || potentialNewValue > kMaxReplWriterThreadCount) {
             return Status(ErrorCodes::BadValue, "replWriterThreadCount must be between 1 and 256");
         }
 
@@ -137,6 +142,49 @@ public:
     }
 } exportedBatchLimitOperationsParam;
 
+// The maximum number of consecutive batches that steady state replication applies under a single
+// acquisition of the ParallelBatchWriterMode lock. Within such a run, writing a batch to the oplog
+// and partitioning it among the writers overlaps with applying the batches before it. The default
+// of 1 applies each batch on its own.
+AtomicInt32 replBatchPipelineDepth{1};
+
+class ExportedBatchPipelineDepthParameter
+    : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedBatchPipelineDepthParameter()
+        : ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(), "replBatchPipelineDepth", &replBatchPipelineDepth) {}
+
+    virtual Status validate(const int& potentialNewValue) {
+        if (potentialNewValue < 1 || potentialNewValue > 64) {
+            return Status(ErrorCodes::BadValue,
+                          "replBatchPipelineDepth must be between 1 and 64, inclusive");
+        }
+
+        return Status::OK();
+    }
+} exportedBatchPipelineDepthParam;
+
+// Set this to have the documents and index entries that each batch will touch read into the
+// storage engine's cache while the batch before it is being applied. Under MMAPv1, each batch is
+// instead prefetched just before it is applied, regardless of this setting.
+MONGO_EXPORT_SERVER_PARAMETER(replPrefetchNextBatch, bool, false);
+
+// The maximum number of threads prefetching for the next batch.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(replPrefetcherThreadCount, int, 16);
+
+// Set this to have a node with a durable storage engine report the progress of each batch to its
+// sync source once, after the batch has been journaled, with both its applied and durable OpTimes.
+// Otherwise the applied OpTime is reported as soon as the batch is applied and the durable OpTime
+// is only sent after the sync source has responded to that report, which delays acknowledging
+// journaled "majority" writes by a round trip.
+MONGO_EXPORT_SERVER_PARAMETER(replReportProgressAfterJournal, bool, false);
+
+// The oplog entries whose prefetch was abandoned because their batch was no longer the next one
+Counter64 prefetchAbandonedOpsStats;
+ServerStatusMetricField<Counter64> displayPrefetchAbandonedOps("repl.preload.abandonedOps",
+                                                               &prefetchAbandonedOpsStats);
+
 // The oplog entries applied
 Counter64 opsAppliedStats;
 ServerStatusMetricField<Counter64> displayOpsApplied("repl.apply.ops", &opsAppliedStats);
@@ -149,6 +197,35 @@ ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
 // Number and time of each ApplyOps worker pool round
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
+
+// Time spent applying ops and number of ops applied by each writer, indexed by writer vector.
+struct WriterActivity {
+    AtomicInt64 busyMicros;
+    AtomicInt64 ops;
+};
+WriterActivity writerActivity[kMaxReplWriterThreadCount];
+
+class WriterActivityMetric : public ServerStatusMetric {
+public:
+    WriterActivityMetric() : ServerStatusMetric("repl.apply.writers") {}
+
+    void appendAtLeaf(BSONObjBuilder& b) const override {
+        BSONArrayBuilder writers(b.subarrayStart(_leafName));
+        for (int i = 0; i < replWriterThreadCount; i++) {
+            writers.append(BSON("busyMicros" << writerActivity[i].busyMicros.load() << "ops"
+                                             << writerActivity[i].ops.load()));
+        }
+    }
+} writerActivityMetric;
+
+void recordWriterActivity(size_t writerId, size_t numOps, const Timer& timer) {
+    if (writerId >= size_t(kMaxReplWriterThreadCount)) {
+        return;
+    }
+    writerActivity[writerId].busyMicros.addAndFetch(timer.micros());
+    writerActivity[writerId].ops.addAndFetch(numOps);
+}
+
 void initializePrefetchThread() {
     if (!Client::getCurrent()) {
         Client::initThreadIfNotAlready();
@@ -182,6 +259,11 @@ protected:
         _replCoord->setMyLastAppliedOpTimeForward(newOpTime);
     }
 
+    void _recordAppliedWithoutReporting(const OpTime& newOpTime) {
+        // Reporting is left to the subsequent call to _recordDurable().
+        _replCoord->setMyLastAppliedOpTimeForwardWithoutReporting(newOpTime);
+    }
+
     void _recordDurable(const OpTime& newOpTime) {
         // We have to use setMyLastDurableOpTimeForward since this thread races with
         // ReplicationExternalStateImpl::onTransitionToPrimary.
@@ -232,7 +314,11 @@ ApplyBatchFinalizerForJournal::~ApplyBatchFinalizerForJournal() {
 }
 
 void ApplyBatchFinalizerForJournal::record(const OpTime& newOpTime) {
-    _recordApplied(newOpTime);
+    if (replReportProgressAfterJournal.load()) {
+        _recordAppliedWithoutReporting(newOpTime);
+    } else {
+        _recordApplied(newOpTime);
+    }
 
     stdx::unique_lock<stdx::mutex> lock(_mutex);
     _latestOpTime = newOpTime;
@@ -430,6 +516,83 @@ void prefetchOps(const MultiApplier::Operations& ops, OldThreadPool* prefetcherP
     prefetcherPool->join();
 }
 
+/**
+ * Reads the documents and index entries that a batch will touch into the storage engine's cache on
+ * a pool of threads, so that the next batch is prefetched while the current one is being applied.
+ * Prefetching a batch abandons whatever is left of the previous prefetch, since that batch has
+ * been handed to the applier by then.
+ */
+class BatchPrefetcher {
+    MONGO_DISALLOW_COPYING(BatchPrefetcher);
+
+public:
+    BatchPrefetcher() : _pool(_makeThreadPoolOptions()) {
+        _pool.startup();
+    }
+
+    ~BatchPrefetcher() {
+        _generation.addAndFetch(1);
+        _pool.shutdown();
+        _pool.join();
+    }
+
+    void prefetch(const std::vector<OplogEntry>& ops) {
+        const auto generation = _generation.addAndFetch(1);
+        for (size_t begin = 0; begin < ops.size(); begin += kOpsPerTask) {
+            const auto end = std::min(ops.size(), begin + kOpsPerTask);
+            std::vector<BSONObj> task;
+            for (auto i = begin; i < end; ++i) {
+                if (ops[i].isCrudOpType()) {
+                    task.push_back(ops[i].raw);
+                }
+            }
+            if (task.empty()) {
+                continue;
+            }
+
+            auto status = _pool.schedule(
+                [ this, generation, task = std::move(task) ] { _prefetchOps(generation, task); });
+            if (!status.isOK()) {
+                return;  // Shutting down.
+            }
+        }
+    }
+
+private:
+    static const size_t kOpsPerTask = 16;
+
+    static ThreadPool::Options _makeThreadPoolOptions() {
+        ThreadPool::Options options;
+        options.poolName = "ReplPrefetcher";
+        options.minThreads = 0;
+        options.maxThreads = size_t(std::max(1, replPrefetcherThreadCount));
+        options.onCreateThread = [](const std::string& threadName) {
+            Client::initThread(threadName.c_str());
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+        };
+        return options;
+    }
+
+    void _prefetchOps(unsigned long long generation, const std::vector<BSONObj>& ops) {
+        const auto opCtx = cc().makeOperationContext();
+        // Only the storage engine's cache is of interest here, so there is no need to wait for the
+        // batch being applied to finish.
+        opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(false);
+        opCtx->lockState()->setShouldAcquireTicket(false);
+
+        for (size_t i = 0; i < ops.size(); ++i) {
+            if (_generation.load() != generation) {
+                prefetchAbandonedOpsStats.increment(ops.size() - i);
+                return;
+            }
+            prefetchForReplicatedOp(opCtx.get(), ops[i]);
+        }
+    }
+
+    AtomicUInt64 _generation;
+    ThreadPool _pool;
+};
+
 // Doles out all the work to the writer pool threads.
 // Does not modify writerVectors, but passes non-const pointers to inner vectors into func.
 void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
@@ -441,7 +604,10 @@ void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
     for (size_t i = 0; i < writerVectors.size(); i++) {
         if (!writerVectors[i].empty()) {
             writerPool->schedule([&func, &writerVectors, statusVector, i] {
+                const size_t numOps = writerVectors[i].size();
+                Timer timer;
                 (*statusVector)[i] = func(&writerVectors[i]);
+                recordWriterActivity(i, numOps, timer);
             });
         }
     }
@@ -470,6 +636,7 @@ void scheduleWritesToOplog(OperationContext* opCtx,
             const auto opCtxHolder = cc().makeOperationContext();
             const auto opCtx = opCtxHolder.get();
             opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(false);
+            opCtx->lockState()->setShouldAcquireTicket(false);
             UnreplicatedWritesBlock uwb(opCtx);
 
             std::vector<InsertStatement> docs;
@@ -558,6 +725,7 @@ void scheduleTxnTableUpdates(OperationContext* opCtx,
             const auto opCtxHolder = cc().makeOperationContext();
             const auto opCtx = opCtxHolder.get();
             opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(false);
+            opCtx->lockState()->setShouldAcquireTicket(false);
 
             Session::updateSessionRecord(
                 opCtx, record.getSessionId(), record.getTxnNum(), record.getLastWriteOpTimeTs());
@@ -574,6 +742,7 @@ public:
     struct CollectionProperties {
         bool isCapped = false;
         const CollatorInterface* collator = nullptr;
+        int numIndexes = 0;
     };
 
     CollectionProperties getCollectionProperties(OperationContext* opCtx,
@@ -605,26 +774,64 @@ private:
 
         collProperties.isCapped = collection->isCapped();
         collProperties.collator = collection->getDefaultCollator();
+        collProperties.numIndexes = collection->getIndexCatalog()->numIndexesTotal(opCtx);
         return collProperties;
     }
 
     StringMap<CollectionProperties> _cache;
 };
 
+// Maps the dependency key of an op to the writer it has been assigned to. Ops with the same key
+// must be applied by the same writer, in oplog order.
+using WriterAssignments = stdx::unordered_map<uint32_t, uint32_t>;
+
+// Returns a rough estimate of the work needed to apply 'op', in arbitrary units. It is only used to
+// balance the writers against one another.
+uint64_t estimateApplyCost(const OplogEntry& op,
+                           const CachedCollectionProperties::CollectionProperties& collProperties) {
+    // Every op pays for its document and for maintaining each index of the collection. Updates and
+    // deletes also have to find the document first.
+    const uint64_t documentCost = 1 + collProperties.numIndexes + op.raw.objsize() / 1024;
+    switch (op.getOpType()) {
+        case OpTypeEnum::kInsert:
+            return documentCost;
+        case OpTypeEnum::kUpdate:
+        case OpTypeEnum::kDelete:
+            return 1 + documentCost;
+        default:
+            return 1;
+    }
+}
+
+// Distributes the ops among the writers. Ops which depend on each other are given to the same
+// writer in oplog order: ops on the same document, on the same capped collection, or on the same
+// collection for engines without document locking. Otherwise ops are spread so that each writer
+// gets roughly the same amount of work, as estimated by estimateApplyCost().
+//
+// If 'assignments' is provided, dependency keys which it already contains keep their writer and the
+// writers chosen for new keys are added to it, which keeps dependent ops in successive batches on
+// the same writer.
+//
 // This only modifies the isForCappedCollection field on each op. It does not alter the ops vector
 // in any other way.
 void fillWriterVectors(OperationContext* opCtx,
                        MultiApplier::Operations* ops,
-                       std::vector<MultiApplier::OperationPtrs>* writerVectors) {
+                       std::vector<MultiApplier::OperationPtrs>* writerVectors,
+                       WriterAssignments* assignments = nullptr) {
     const bool supportsDocLocking =
         getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking();
     const uint32_t numWriters = writerVectors->size();
 
     CachedCollectionProperties collPropertiesCache;
 
+    // Compute the dependency key of each op and the total cost of the ops sharing each key.
+    std::vector<uint32_t> opKeys;
+    opKeys.reserve(ops->size());
+    stdx::unordered_map<uint32_t, uint64_t> costPerKey;
     for (auto&& op : *ops) {
         StringMapTraits::HashedKey hashedNs(op.getNamespace().ns());
         uint32_t hash = hashedNs.hash();
+        uint64_t cost = 1;
 
         if (op.isCrudOpType()) {
             auto collProperties = collPropertiesCache.getCollectionProperties(opCtx, hashedNs);
@@ -647,15 +854,265 @@ void fillWriterVectors(OperationContext* opCtx,
                 // bulk insert them.
                 op.isForCappedCollection = true;
             }
+
+            cost = estimateApplyCost(op, collProperties);
         }
 
-        auto& writer = (*writerVectors)[hash % numWriters];
+        opKeys.push_back(hash);
+        costPerKey[hash] += cost;
+    }
+
+    WriterAssignments batchAssignments;
+    if (!assignments) {
+        assignments = &batchAssignments;
+    }
+
+    // Keys which are already assigned count towards the load of their writer. The remaining keys
+    // go to the least loaded writer, heaviest first.
+    std::vector<uint64_t> writerLoads(numWriters, 0);
+    std::vector<std::pair<uint64_t, uint32_t>> unassignedKeys;
+    for (auto&& keyAndCost : costPerKey) {
+        auto it = assignments->find(keyAndCost.first);
+        if (it != assignments->end()) {
+            writerLoads[it->second] += keyAndCost.second;
+        } else {
+            unassignedKeys.emplace_back(keyAndCost.second, keyAndCost.first);
+        }
+    }
+    std::sort(unassignedKeys.begin(), unassignedKeys.end(), std::greater<>());
+
+    using LoadAndWriter = std::pair<uint64_t, uint32_t>;
+    std::priority_queue<LoadAndWriter, std::vector<LoadAndWriter>, std::greater<LoadAndWriter>>
+        leastLoaded;
+    for (uint32_t writer = 0; writer < numWriters; writer++) {
+        leastLoaded.emplace(writerLoads[writer], writer);
+    }
+    for (auto&& costAndKey : unassignedKeys) {
+        auto loadAndWriter = leastLoaded.top();
+        leastLoaded.pop();
+        assignments->emplace(costAndKey.second, loadAndWriter.second);
+        leastLoaded.emplace(loadAndWriter.first + costAndKey.first, loadAndWriter.second);
+    }
+
+    for (size_t i = 0; i < ops->size(); i++) {
+        auto& writer = (*writerVectors)[assignments->find(opKeys[i])->second];
         if (writer.empty())
             writer.reserve(8);  // skip a few growth rounds.
-        writer.push_back(&op);
+        writer.push_back(&(*ops)[i]);
+    }
+}
+
+// Writes 'ops' to the oplog on the calling thread, using the caller's operation context.
+void writeToOplog(OperationContext* opCtx, const MultiApplier::Operations& ops) {
+    UnreplicatedWritesBlock uwb(opCtx);
+
+    std::vector<InsertStatement> docs;
+    docs.reserve(ops.size());
+    for (auto&& op : ops) {
+        docs.emplace_back(BSONObj(op.raw.objdata()));
     }
+
+    fassertStatusOK(40729,
+                    StorageInterface::get(opCtx)->insertDocuments(
+                        opCtx, NamespaceString::kRsOplogNamespace, docs));
 }
 
+// Updates the transaction table on the calling thread, using the caller's operation context.
+void updateTxnTable(OperationContext* opCtx, const SessionRecordMap& latestRecords) {
+    for (const auto& it : latestRecords) {
+        auto& record = it.second;
+        Session::updateSessionRecord(
+            opCtx, record.getSessionId(), record.getTxnNum(), record.getLastWriteOpTimeTs());
+    }
+}
+
+// Returns true if 'ops' consists of a single op which must not be applied concurrently with any
+// other op. See SyncTail::tryPopAndWaitForMore().
+bool mustBeAppliedAlone(const SyncTail::OpQueue& ops) {
+    if (ops.getCount() != 1) {
+        return false;
+    }
+    const auto& entry = ops.front();
+    return entry.isCommand() ||
+        (!entry.getNamespace().isEmpty() && entry.getNamespace().coll() == "system.indexes");
+}
+
+/**
+ * Applies consecutive batches on the writer pool without waiting for all writers at each batch
+ * boundary. Every writer has its own queue of batches which it works through in order, so a writer
+ * which finishes its share of one batch moves straight on to its share of the next one while the
+ * slower writers catch up. Ops which depend on each other stay with the writer they were first
+ * assigned to for the lifetime of this object, so they are still applied in oplog order.
+ *
+ * A batch has been applied once every writer has finished its share of it. Batches are popped in
+ * the order in which they were pushed, which makes the last op of the most recently popped batch a
+ * low watermark below which every op has been applied.
+ *
+ * The caller must hold the ParallelBatchWriterMode lock for the lifetime of this object, and must
+ * not push a batch which has to be applied alone behind other batches.
+ */
+class PipelinedBatchApplier {
+    MONGO_DISALLOW_COPYING(PipelinedBatchApplier);
+
+public:
+    PipelinedBatchApplier(OldThreadPool* writerPool, MultiApplier::ApplyOperationFn applyOperation)
+        : _writerPool(writerPool),
+          _applyOperation(std::move(applyOperation)),
+          _writers(writerPool->getNumThreads()) {}
+
+    ~PipelinedBatchApplier() {
+        // The writers refer to batches owned by this object.
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [&] { return _activeWriters == 0; });
+    }
+
+    /**
+     * Returns the number of batches which have been pushed but not yet popped.
+     */
+    size_t size() const {
+        return _batches.size();
+    }
+
+    /**
+     * Writes 'ops' to the oplog and hands them to the writers. Returns without waiting for the ops
+     * to be applied.
+     */
+    void push(OperationContext* opCtx, MultiApplier::Operations ops) {
+        invariant(!ops.empty());
+        auto batch = stdx::make_unique<Batch>();
+        batch->ops = std::move(ops);
+        batch->latestTxnRecords = computeLatestTransactionTableRecords(batch->ops);
+        batch->writerVectors.resize(_writers.size());
+
+        auto consistencyMarkers = ReplicationProcess::get(opCtx)->getConsistencyMarkers();
+        consistencyMarkers->setOplogTruncateAfterPoint(opCtx, batch->ops.front().getTimestamp());
+        if (_batches.empty()) {
+            // The writers are idle, so use them to write the oplog in parallel.
+            ON_BLOCK_EXIT([&] { _writerPool->join(); });
+            scheduleWritesToOplog(opCtx, _writerPool, batch->ops);
+            fillWriterVectors(opCtx, &batch->ops, &batch->writerVectors, &_assignments);
+        } else {
+            // The writers are busy applying earlier batches, which is what this overlaps with.
+            fillWriterVectors(opCtx, &batch->ops, &batch->writerVectors, &_assignments);
+            writeToOplog(opCtx, batch->ops);
+        }
+
+        // From here on a node which fails replays this batch from the applied through point, which
+        // only moves past it once the batch has been popped.
+        consistencyMarkers->setOplogTruncateAfterPoint(opCtx, Timestamp());
+        consistencyMarkers->setMinValidToAtLeast(opCtx, batch->ops.back().getOpTime());
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (size_t i = 0; i < _writers.size(); i++) {
+            if (batch->writerVectors[i].empty()) {
+                continue;
+            }
+            batch->pendingWriters++;
+            _writers[i].queue.push_back(batch.get());
+            _scheduleWriter_inlock(i);
+        }
+        _batches.push_back(std::move(batch));
+    }
+
+    /**
+     * Waits for the oldest batch to be applied, updates the transaction table for it and removes
+     * it. Returns the OpTime of its last op, or the first error returned by a writer.
+     */
+    StatusWith<OpTime> pop(OperationContext* opCtx) {
+        invariant(!_batches.empty());
+        const auto batch = std::move(_batches.front());
+        _batches.pop_front();
+        {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            _cv.wait(lk, [&] { return batch->pendingWriters == 0; });
+        }
+        applyBatchStats.recordMillis(batch->timer.millis());
+
+        if (!batch->status.isOK()) {
+            return batch->status;
+        }
+
+        updateTxnTable(opCtx, batch->latestTxnRecords);
+        return batch->ops.back().getOpTime();
+    }
+
+private:
+    struct Batch {
+        MultiApplier::Operations ops;
+        std::vector<MultiApplier::OperationPtrs> writerVectors;
+        SessionRecordMap latestTxnRecords;
+        Timer timer;
+
+        // Guarded by _mutex.
+        size_t pendingWriters = 0;
+        Status status = Status::OK();
+    };
+
+    struct Writer {
+        std::deque<Batch*> queue;
+        bool running = false;
+    };
+
+    void _scheduleWriter_inlock(size_t writerId) {
+        auto& writer = _writers[writerId];
+        if (writer.running) {
+            return;
+        }
+        writer.running = true;
+        _activeWriters++;
+        _writerPool->schedule([this, writerId] { _runWriter(writerId); });
+    }
+
+    void _runWriter(size_t writerId) {
+        auto& writer = _writers[writerId];
+        while (true) {
+            Batch* batch;
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                if (writer.queue.empty()) {
+                    writer.running = false;
+                    if (--_activeWriters == 0) {
+                        _cv.notify_all();
+                    }
+                    return;
+                }
+                batch = writer.queue.front();
+                writer.queue.pop_front();
+            }
+
+            const size_t numOps = batch->writerVectors[writerId].size();
+            Timer timer;
+            Status status = Status::OK();
+            try {
+                status = _applyOperation(&batch->writerVectors[writerId]);
+            } catch (...) {
+                status = exceptionToStatus();
+            }
+            recordWriterActivity(writerId, numOps, timer);
+
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (!status.isOK() && batch->status.isOK()) {
+                batch->status = status;
+            }
+            if (--batch->pendingWriters == 0) {
+                _cv.notify_all();
+            }
+        }
+    }
+
+    OldThreadPool* const _writerPool;
+    const MultiApplier::ApplyOperationFn _applyOperation;
+
+    // Only accessed by the thread which owns this object.
+    std::deque<std::unique_ptr<Batch>> _batches;
+    WriterAssignments _assignments;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    std::vector<Writer> _writers;  // Queues guarded by _mutex.
+    size_t _activeWriters = 0;     // Guarded by _mutex.
+};
+
 }  // namespace
 
 // Applies a batch of oplog entries, by writing the oplog entries to the local oplog
@@ -739,6 +1196,7 @@ private:
         Client::initThread("ReplBatcher");
         const ServiceContext::UniqueOperationContext opCtxPtr = cc().makeOperationContext();
         OperationContext& opCtx = *opCtxPtr;
+        opCtx.lockState()->setShouldAcquireTicket(false);
         const auto replCoord = ReplicationCoordinator::get(&opCtx);
         const auto fastClockSource = opCtx.getServiceContext()->getFastClockSource();
         const auto oplogMaxSize = fassertStatusOK(40301,
@@ -749,6 +1207,12 @@ private:
         BatchLimits batchLimits;
         batchLimits.bytes = std::min(oplogMaxSize / 10, size_t(replBatchLimitBytes));
 
+        // MMAPv1 prefetches each batch in multiApply() instead.
+        boost::optional<BatchPrefetcher> prefetcher;
+        if (!opCtx.getServiceContext()->getGlobalStorageEngine()->isMmapV1()) {
+            prefetcher.emplace();
+        }
+
         while (true) {
             const auto slaveDelay = replCoord->getSlaveDelaySecs();
             batchLimits.slaveDelayLatestTimestamp = (slaveDelay > Seconds(0))
@@ -767,6 +1231,11 @@ private:
                 continue;  // Don't emit empty batches.
             }
 
+            // Start warming the cache for this batch while the previous one is still applying.
+            if (prefetcher && replPrefetchNextBatch.load()) {
+                prefetcher->prefetch(ops.getBatch());
+            }
+
             stdx::unique_lock<stdx::mutex> lk(_mutex);
             // Block until the previous batch has been taken.
             _cv.wait(lk, [&] { return _ops.empty(); });
@@ -800,11 +1269,32 @@ void SyncTail::oplogApplication(ReplicationCoordinator* replCoord) {
             ? new ApplyBatchFinalizerForJournal(replCoord)
             : new ApplyBatchFinalizer(replCoord)};
 
+    auto applyOperation = [this](MultiApplier::OperationPtrs* ops) -> Status {
+        _applyFunc(ops, this);
+        // _applyFunc() will throw or abort on error, so we return OK here.
+        return Status::OK();
+    };
+
+    // Update various things that care about our last applied optime. Tests rely on 2 happening
+    // before 3 even though it isn't strictly necessary. The order of 1 doesn't matter.
+    auto finishBatch = [&](OperationContext* opCtx, const OpTime& lastOpTimeInBatch) {
+        setNewTimestamp(opCtx->getServiceContext(), lastOpTimeInBatch.getTimestamp());  // 1
+        ReplicationProcess::get(opCtx)->getConsistencyMarkers()->setAppliedThrough(
+            opCtx,
+            lastOpTimeInBatch);                // 2
+        finalizer->record(lastOpTimeInBatch);  // 3
+    };
+
+    // A batch taken from the batcher while pipelining which could not join the pipeline. It is
+    // applied on the next iteration instead of fetching a new batch.
+    boost::optional<OpQueue> deferredBatch;
+
     while (true) {  // Exits on message from OpQueueBatcher.
         // Use a new operation context each iteration, as otherwise we may appear to use a single
         // collection name to refer to collections with different UUIDs.
         const ServiceContext::UniqueOperationContext opCtxPtr = cc().makeOperationContext();
         OperationContext& opCtx = *opCtxPtr;
+        opCtx.lockState()->setShouldAcquireTicket(false);
 
         // For pausing replication in tests.
         if (MONGO_FAIL_POINT(rsSyncApplyStop)) {
@@ -826,7 +1316,8 @@ void SyncTail::oplogApplication(ReplicationCoordinator* replCoord) {
         long long termWhenBufferIsEmpty = replCoord->getTerm();
         // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't become
         // ready in time, we'll loop again so we can do the above checks periodically.
-        OpQueue ops = batcher.getNextBatch(Seconds(1));
+        OpQueue ops = deferredBatch ? std::move(*deferredBatch) : batcher.getNextBatch(Seconds(1));
+        deferredBatch = boost::none;
         if (ops.empty()) {
             if (ops.mustShutdown()) {
                 return;
@@ -859,16 +1350,65 @@ void SyncTail::oplogApplication(ReplicationCoordinator* replCoord) {
         // Don't allow the fsync+lock thread to see intermediate states of batch application.
         stdx::lock_guard<SimpleMutex> fsynclk(filesLockedFsync);
 
-        // Do the work.
-        multiApply(&opCtx, ops.releaseBatch());
+        const auto pipelineDepth = replBatchPipelineDepth.load();
+        if (pipelineDepth == 1 || mustBeAppliedAlone(ops) ||
+            !opCtx.getServiceContext()->getGlobalStorageEngine()->supportsDocLocking()) {
+            // Do the work.
+            multiApply(&opCtx, ops.releaseBatch());
+            finishBatch(&opCtx, lastOpTimeInBatch);
+            continue;
+        }
+
+        // Apply up to 'pipelineDepth' batches under a single PBWM acquisition for as long as the
+        // next batch is ready, writing each batch to the oplog while the previous ones are being
+        // applied.
+        Lock::ParallelBatchWriterMode pbwm(opCtx.lockState());
+        if (replCoord->getApplierState() == ReplicationCoordinator::ApplierState::Stopped) {
+            severe() << "attempting to replicate ops while primary";
+            fassertFailedNoTrace(40737);
+        }
 
-        // Update various things that care about our last applied optime. Tests rely on 2 happening
-        // before 3 even though it isn't strictly necessary. The order of 1 doesn't matter.
-        setNewTimestamp(opCtx.getServiceContext(), lastOpTimeInBatch.getTimestamp());  // 1
-        ReplicationProcess::get(&opCtx)->getConsistencyMarkers()->setAppliedThrough(
-            &opCtx,
-            lastOpTimeInBatch);                // 2
-        finalizer->record(lastOpTimeInBatch);  // 3
+        PipelinedBatchApplier pipeline(_writerPool.get(), applyOperation);
+        LOG(2) << "replication batch size is " << ops.getCount();
+        pipeline.push(&opCtx, ops.releaseBatch());
+
+        auto lastOpTimeInPipeline = lastOpTimeInBatch;
+        int batchesPushed = 1;
+        while (pipeline.size()) {
+            if (batchesPushed < pipelineDepth && !deferredBatch) {
+                OpQueue next = batcher.getNextBatch(Seconds(0));
+                if (!next.empty() && !mustBeAppliedAlone(next)) {
+                    const auto firstOpTimeInNext =
+                        fassertStatusOK(40730, OpTime::parseFromOplogEntry(next.front().raw));
+                    if (firstOpTimeInNext <= lastOpTimeInPipeline) {
+                        fassert(40731,
+                                Status(ErrorCodes::OplogOutOfOrder,
+                                       str::stream() << "Attempted to apply an oplog entry ("
+                                                     << firstOpTimeInNext.toString()
+                                                     << ") which is not greater than the last "
+                                                        "OpTime in the previous batch ("
+                                                     << lastOpTimeInPipeline.toString()
+                                                     << ")."));
+                    }
+                    lastOpTimeInPipeline =
+                        fassertStatusOK(40732, OpTime::parseFromOplogEntry(next.back().raw));
+
+                    LOG(2) << "replication batch size is " << next.getCount();
+                    pipeline.push(&opCtx, next.releaseBatch());
+                    batchesPushed++;
+                    continue;
+                }
+
+                // Batches which must be applied alone wait for the pipeline to drain, as does
+                // shutting down. If no batch is ready yet, look again once the oldest batch has
+                // been applied.
+                if (!next.empty() || next.mustShutdown()) {
+                    deferredBatch = std::move(next);
+                }
+            }
+
+            finishBatch(&opCtx, fassertStatusOK(40738, pipeline.pop(&opCtx)));
+        }
     }
 }
 
@@ -1084,10 +1624,74 @@ bool SyncTail::fetchAndInsertMissingDocument(OperationContext* opCtx, const BSON
     });
 }
 
+namespace {
+
+// Returns true if 'entry' is an update or delete which can be applied as part of a group.
+bool isGroupableUpdateOrDelete(const OplogEntry* entry) {
+    return entry->getOpType() == OpTypeEnum::kDelete ||
+        (entry->getOpType() == OpTypeEnum::kUpdate && entry->getObject2());
+}
+
+// Returns true if ordering ops by the _id element 'id' with a plain BSON comparison cannot reorder
+// two ops on the same document, whatever the collation of the collection.
+bool canOrderById(const BSONElement& id) {
+    switch (id.type()) {
+        case EOO:
+        case String:
+        case Symbol:
+        case Object:
+        case Array:
+            return false;
+        default:
+            return true;
+    }
+}
+
+// Builds a single op which applies all the updates or all the deletes in 'group' in one storage
+// transaction. Every field other than "o" and "o2" is copied from the first op, and "o" and "o2"
+// become arrays holding that field of each op. When it cannot change the order of ops on the same
+// document, the ops are sorted by _id so that their lookups walk the _id index in order.
+BSONObj makeGroupedUpdateOrDelete(std::vector<const OplogEntry*> group) {
+    if (std::all_of(group.begin(), group.end(), [](const OplogEntry* entry) {
+            return canOrderById(entry->getIdElement());
+        })) {
+        std::stable_sort(group.begin(), group.end(), [](const OplogEntry* l, const OplogEntry* r) {
+            return l->getIdElement().woCompare(r->getIdElement(), false) < 0;
+        });
+    }
+
+    BSONObjBuilder groupedOpBuilder;
+    for (auto elem : group.front()->raw) {
+        const auto fieldName = elem.fieldNameStringData();
+        if (fieldName != "o" && fieldName != "o2") {
+            groupedOpBuilder.append(elem);
+        }
+    }
+
+    BSONArrayBuilder objectBuilder(groupedOpBuilder.subarrayStart("o"));
+    for (auto&& entry : group) {
+        objectBuilder.append(entry->getObject());
+    }
+    objectBuilder.done();
+
+    if (group.front()->getOpType() == OpTypeEnum::kUpdate) {
+        BSONArrayBuilder object2Builder(groupedOpBuilder.subarrayStart("o2"));
+        for (auto&& entry : group) {
+            object2Builder.append(*entry->getObject2());
+        }
+        object2Builder.done();
+    }
+
+    return groupedOpBuilder.obj();
+}
+
+}  // namespace
+
 // This free function is used by the writer threads to apply each op
 void multiSyncApply(MultiApplier::OperationPtrs* ops, SyncTail*) {
     initializeWriterThread();
     auto opCtx = cc().makeOperationContext();
+    opCtx->lockState()->setShouldAcquireTicket(false);
     auto syncApply = [](OperationContext* opCtx, const BSONObj& op, bool inSteadyStateReplication) {
         return SyncTail::syncApply(opCtx, op, inSteadyStateReplication);
     };
@@ -1214,6 +1818,50 @@ Status multiSyncApply_noAbort(OperationContext* opCtx,
             }
         }
 
+        // Attempt to group consecutive updates, or consecutive deletes, on the same namespace.
+        if (isGroupableUpdateOrDelete(entry) && oplogEntriesIterator > doNotGroupBeforePoint) {
+            const auto maxBatchSize = insertVectorMaxBytes;
+            const auto maxBatchCount = 64;
+
+            int batchSize = entry->raw.objsize();
+            int batchCount = 1;
+            const bool valueB = entry->raw["b"].booleanSafe();
+
+            // As for inserts, endOfGroupableOpsIterator points to the first op which can't be
+            // added to the group. All ops in a group must agree on the upsert/justOne flag.
+            auto endOfGroupableOpsIterator = std::find_if(
+                oplogEntriesIterator + 1,
+                oplogEntryPointers->end(),
+                [&](const OplogEntry* nextEntry) -> bool {
+                    batchSize += nextEntry->raw.objsize();
+                    batchCount += 1;
+
+                    return nextEntry->getOpType() != entry->getOpType() ||
+                        !isGroupableUpdateOrDelete(nextEntry) ||
+                        nextEntry->getNamespace() != entry->getNamespace() ||
+                        nextEntry->raw["b"].booleanSafe() != valueB ||
+                        batchSize > maxBatchSize || batchCount > maxBatchCount;
+                });
+
+            if (endOfGroupableOpsIterator > oplogEntriesIterator + 1) {
+                auto groupedOp = makeGroupedUpdateOrDelete(
+                    {oplogEntriesIterator, endOfGroupableOpsIterator});
+                try {
+                    uassertStatusOK(syncApply(opCtx, groupedOp, inSteadyStateReplication));
+                    oplogEntriesIterator = endOfGroupableOpsIterator - 1;
+                    continue;
+                } catch (const DBException& e) {
+                    // The group was rolled back as a whole, so apply its ops one at a time. Any
+                    // error which persists is reported when its op is applied on its own.
+                    LOG(1) << "Error applying "
+                           << (entry->getOpType() == OpTypeEnum::kUpdate ? "updates" : "deletes")
+                           << " in bulk " << causedBy(redact(e))
+                           << " trying first one as a lone operation";
+                    doNotGroupBeforePoint = endOfGroupableOpsIterator - 1;
+                }
+            }
+        }
+
         // If we didn't create a group, try to apply the op individually.
         try {
             const Status status = syncApply(opCtx, entry->raw, inSteadyStateReplication);
@@ -1237,6 +1885,7 @@ Status multiSyncApply_noAbort(OperationContext* opCtx,
 void multiInitialSyncApply_abortOnFailure(MultiApplier::OperationPtrs* ops, SyncTail* st) {
     initializeWriterThread();
     auto opCtx = cc().makeOperationContext();
+    opCtx->lockState()->setShouldAcquireTicket(false);
     AtomicUInt32 fetchCount(0);
     fassertNoTrace(15915, multiInitialSyncApply_noAbort(opCtx.get(), ops, st, &fetchCount));
 }
@@ -1246,6 +1895,7 @@ Status multiInitialSyncApply(MultiApplier::OperationPtrs* ops,
                              AtomicUInt32* fetchCount) {
     initializeWriterThread();
     auto opCtx = cc().makeOperationContext();
+    opCtx->lockState()->setShouldAcquireTicket(false);
     return multiInitialSyncApply_noAbort(opCtx.get(), ops, st, fetchCount);
 }
 
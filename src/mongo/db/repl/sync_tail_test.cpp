@@ -45,6 +45,7 @@
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/dbhelpers.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/bgsync.h"
@@ -495,6 +496,60 @@ TEST_F(SyncTailTest, MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceH
     ASSERT_BSONOBJ_EQ(op2.raw, operationsWrittenToOplog[1].doc);
 }
 
+TEST_F(SyncTailTest, MultiApplyBalancesWritersWhileKeepingDependentOperationsTogether) {
+    // The test storage engine does not support document locking, so all ops on a collection depend
+    // on each other. The three ops on 'nss1' must go to one writer in oplog order, which leaves the
+    // other writer with the remaining three ops.
+    NamespaceString nss1("test.t0");
+    NamespaceString nss2("test.t1");
+    NamespaceString nss3("test.t2");
+    NamespaceString nss4("test.t3");
+    OldThreadPool writerPool(2);
+
+    stdx::mutex mutex;
+    std::vector<MultiApplier::Operations> operationsApplied;
+    auto applyOperationFn = [&mutex, &operationsApplied](
+        MultiApplier::OperationPtrs* operationsForWriterThreadToApply) -> Status {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        operationsApplied.emplace_back();
+        for (auto&& opPtr : *operationsForWriterThreadToApply) {
+            operationsApplied.back().push_back(*opPtr);
+        }
+        return Status::OK();
+    };
+
+    MultiApplier::Operations ops = {
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss1, BSON("x" << 1)),
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(2), 0), 1LL}, nss2, BSON("x" << 2)),
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(3), 0), 1LL}, nss1, BSON("x" << 3)),
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(4), 0), 1LL}, nss3, BSON("x" << 4)),
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(5), 0), 1LL}, nss1, BSON("x" << 5)),
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(6), 0), 1LL}, nss4, BSON("x" << 6))};
+    _storageInterface->insertDocumentsFn =
+        [](OperationContext*, const NamespaceString&, const std::vector<InsertStatement>&) {
+            return Status::OK();
+        };
+
+    auto lastOpTime =
+        unittest::assertGet(multiApply(_opCtx.get(), &writerPool, ops, applyOperationFn));
+    ASSERT_EQUALS(ops.back().getOpTime(), lastOpTime);
+
+    stdx::lock_guard<stdx::mutex> lock(mutex);
+    ASSERT_EQUALS(2U, operationsApplied.size());
+    for (auto&& operationsAppliedByThread : operationsApplied) {
+        ASSERT_EQUALS(3U, operationsAppliedByThread.size());
+        if (operationsAppliedByThread.front().getNamespace() == nss1) {
+            ASSERT_EQUALS(ops[0], operationsAppliedByThread[0]);
+            ASSERT_EQUALS(ops[2], operationsAppliedByThread[1]);
+            ASSERT_EQUALS(ops[4], operationsAppliedByThread[2]);
+        } else {
+            ASSERT_EQUALS(ops[1], operationsAppliedByThread[0]);
+            ASSERT_EQUALS(ops[3], operationsAppliedByThread[1]);
+            ASSERT_EQUALS(ops[5], operationsAppliedByThread[2]);
+        }
+    }
+}
+
 TEST_F(SyncTailTest, MultiApplyUpdatesTheTransactionTable) {
     // Set up the transactions collection, which can only be done by the primary.
     ASSERT_OK(ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_PRIMARY));
@@ -939,6 +994,132 @@ TEST_F(SyncTailTest, MultiSyncApplyFallsBackOnApplyingInsertsIndividuallyWhenGro
     ASSERT_EQUALS(1U, numFailedGroupedInserts);
 }
 
+TEST_F(SyncTailTest, MultiSyncApplyGroupsUpdateOperationsByNamespaceAndSortsThemById) {
+    int seconds = 0;
+    auto makeOp = [&seconds](const NamespaceString& nss, int id) {
+        return makeUpdateDocumentOplogEntry({Timestamp(Seconds(seconds), 0), 1LL},
+                                            nss,
+                                            BSON("_id" << id),
+                                            BSON("$set" << BSON("x" << seconds++)));
+    };
+    NamespaceString nss1("test." + _agent.getSuiteName() + "_" + _agent.getTestName() + "_1");
+    NamespaceString nss2("test." + _agent.getSuiteName() + "_" + _agent.getTestName() + "_2");
+    auto createOp = makeCreateCollectionOplogEntry({Timestamp(Seconds(seconds++), 0), 1LL}, nss1);
+    auto updateOp1a = makeOp(nss1, 2);
+    auto updateOp1b = makeOp(nss1, 1);
+    auto updateOp1c = makeOp(nss1, 2);
+    auto updateOp2 = makeOp(nss2, 1);
+    std::vector<BSONObj> operationsApplied;
+    auto syncApply = [&operationsApplied](OperationContext*, const BSONObj& op, bool) {
+        operationsApplied.push_back(op.copy());
+        return Status::OK();
+    };
+
+    MultiApplier::OperationPtrs ops = {
+        &createOp, &updateOp1a, &updateOp1b, &updateOp1c, &updateOp2};
+    ASSERT_OK(multiSyncApply_noAbort(_opCtx.get(), &ops, syncApply));
+
+    ASSERT_EQUALS(3U, operationsApplied.size());
+    ASSERT_BSONOBJ_EQ(createOp.raw, operationsApplied[0]);
+    ASSERT_BSONOBJ_EQ(updateOp2.raw, operationsApplied[2]);
+
+    // The grouped updates are ordered by _id, and the updates to the same document keep their
+    // relative order.
+    const auto& groupedOp = operationsApplied[1];
+    ASSERT_EQUALS(updateOp1a.getOpTime(), OpTime::parseFromOplogEntry(groupedOp));
+    ASSERT_EQUALS("u", groupedOp["op"].str());
+    auto objects = groupedOp["o"].Array();
+    auto objects2 = groupedOp["o2"].Array();
+    ASSERT_EQUALS(3U, objects.size());
+    ASSERT_EQUALS(3U, objects2.size());
+    ASSERT_BSONOBJ_EQ(updateOp1b.getObject(), objects[0].Obj());
+    ASSERT_BSONOBJ_EQ(*updateOp1b.getObject2(), objects2[0].Obj());
+    ASSERT_BSONOBJ_EQ(updateOp1a.getObject(), objects[1].Obj());
+    ASSERT_BSONOBJ_EQ(*updateOp1a.getObject2(), objects2[1].Obj());
+    ASSERT_BSONOBJ_EQ(updateOp1c.getObject(), objects[2].Obj());
+    ASSERT_BSONOBJ_EQ(*updateOp1c.getObject2(), objects2[2].Obj());
+}
+
+TEST_F(SyncTailTest, MultiSyncApplyFallsBackOnApplyingUpdatesIndividuallyWhenGroupedUpdateFails) {
+    int seconds = 0;
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    auto createOp = makeCreateCollectionOplogEntry({Timestamp(Seconds(seconds++), 0), 1LL}, nss);
+    MultiApplier::Operations operationsToApply = {createOp};
+    for (int i = 0; i < 3; i++) {
+        operationsToApply.push_back(
+            makeUpdateDocumentOplogEntry({Timestamp(Seconds(seconds++), 0), 1LL},
+                                         nss,
+                                         BSON("_id" << i),
+                                         BSON("$set" << BSON("x" << i))));
+    }
+
+    std::size_t numFailedGroupedUpdates = 0;
+    MultiApplier::Operations operationsApplied;
+    auto syncApply = [&numFailedGroupedUpdates,
+                      &operationsApplied](OperationContext*, const BSONObj& op, bool) -> Status {
+        if (op["o"].type() == BSONType::Array) {
+            numFailedGroupedUpdates++;
+            return {ErrorCodes::OperationFailed, "grouped updates not supported"};
+        }
+        operationsApplied.push_back(OplogEntry(op));
+        return Status::OK();
+    };
+
+    MultiApplier::OperationPtrs ops;
+    for (auto&& op : operationsToApply) {
+        ops.push_back(&op);
+    }
+    ASSERT_OK(multiSyncApply_noAbort(_opCtx.get(), &ops, syncApply));
+
+    ASSERT_EQUALS(1U, numFailedGroupedUpdates);
+    ASSERT_EQUALS(operationsToApply.size(), operationsApplied.size());
+    for (std::size_t i = 0; i < operationsToApply.size(); i++) {
+        ASSERT_EQUALS(operationsToApply[i], operationsApplied[i]);
+    }
+}
+
+TEST_F(SyncTailTest, MultiSyncApplyAppliesGroupedUpdatesAndDeletes) {
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    createCollection(_opCtx.get(), nss, {});
+
+    int seconds = 0;
+    auto nextOpTime = [&seconds]() -> OpTime { return {Timestamp(Seconds(++seconds), 0), 1LL}; };
+    auto noopOp = OplogEntry(nextOpTime(), 1LL, OpTypeEnum::kNoop, nss, BSON("msg" << "noop"));
+    auto insertOp1 = makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 1));
+    auto insertOp2 = makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 2));
+    auto insertOp3 = makeInsertDocumentOplogEntry(nextOpTime(), nss, BSON("_id" << 3));
+    auto updateOp1 = makeUpdateDocumentOplogEntry(
+        nextOpTime(), nss, BSON("_id" << 2), BSON("$set" << BSON("x" << 1)));
+    auto updateOp2 = makeUpdateDocumentOplogEntry(
+        nextOpTime(), nss, BSON("_id" << 1), BSON("$set" << BSON("x" << 2)));
+    auto updateOp3 = makeUpdateDocumentOplogEntry(
+        nextOpTime(), nss, BSON("_id" << 2), BSON("$inc" << BSON("x" << 10)));
+    auto deleteOp1 = OplogEntry(nextOpTime(), 1LL, OpTypeEnum::kDelete, nss, BSON("_id" << 3));
+    auto deleteOp2 = OplogEntry(nextOpTime(), 1LL, OpTypeEnum::kDelete, nss, BSON("_id" << 1));
+    _opCtx.reset();
+
+    MultiApplier::OperationPtrs ops = {&noopOp,
+                                       &insertOp1,
+                                       &insertOp2,
+                                       &insertOp3,
+                                       &updateOp1,
+                                       &updateOp2,
+                                       &updateOp3,
+                                       &deleteOp1,
+                                       &deleteOp2};
+    multiSyncApply(&ops, nullptr);
+
+    _opCtx = cc().makeOperationContext();
+    AutoGetCollectionForReadCommand autoColl(_opCtx.get(), nss);
+    auto collection = autoColl.getCollection();
+    ASSERT_TRUE(collection);
+    ASSERT_EQUALS(1LL, collection->numRecords(_opCtx.get()));
+    auto recordId = Helpers::findById(_opCtx.get(), collection, BSON("_id" << 2));
+    ASSERT_FALSE(recordId.isNull());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2 << "x" << 11),
+                      collection->docFor(_opCtx.get(), recordId).value());
+}
+
 TEST_F(SyncTailTest, MultiInitialSyncApplyDisablesDocumentValidationWhileApplyingOperations) {
     SyncTailWithOperationContextChecker syncTail;
     NamespaceString nss("test.t");
@@ -30,19 +30,30 @@
 
 #include "mongo/db/s/active_migrations_registry.h"
 
+#include <algorithm>
+
 #include "mongo/base/status_with.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/migration_session_id.h"
 #include "mongo/db/s/migration_source_manager.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/assert_util.h"
 
 namespace mongo {
+namespace {
+
+// The number of chunks of distinct collections, which this shard may donate at the same time.
+// Incoming migrations are always serialized, because a shard has a single migration destination
+// manager, and a shard never donates and receives chunks at the same time.
+MONGO_EXPORT_SERVER_PARAMETER(maxConcurrentOutgoingMigrations, int, 1);
+
+}  // namespace
 
 ActiveMigrationsRegistry::ActiveMigrationsRegistry() = default;
 
 ActiveMigrationsRegistry::~ActiveMigrationsRegistry() {
-    invariant(!_activeMoveChunkState);
+    invariant(_activeMoveChunkStates.empty());
 }
 
 StatusWith<ScopedRegisterDonateChunk> ActiveMigrationsRegistry::registerDonateChunk(
@@ -52,17 +63,27 @@ StatusWith<ScopedRegisterDonateChunk> ActiveMigrationsRegistry::registerDonateCh
         return _activeReceiveChunkState->constructErrorStatus();
     }
 
-    if (_activeMoveChunkState) {
-        if (_activeMoveChunkState->args == args) {
-            return {ScopedRegisterDonateChunk(nullptr, false, _activeMoveChunkState->notification)};
+    for (const auto& activeMoveChunkState : _activeMoveChunkStates) {
+        if (activeMoveChunkState.args == args) {
+            return {ScopedRegisterDonateChunk(nullptr, false, activeMoveChunkState.notification)};
+        }
+
+        // Each collection has a single migration source manager, so at most one chunk of any given
+        // collection can be donated at a time
+        if (activeMoveChunkState.args.getNss() == args.getNss()) {
+            return activeMoveChunkState.constructErrorStatus();
         }
+    }
 
-        return _activeMoveChunkState->constructErrorStatus();
+    const size_t maxOutgoingMigrations =
+        static_cast<size_t>(std::max(1, maxConcurrentOutgoingMigrations.load()));
+    if (_activeMoveChunkStates.size() >= maxOutgoingMigrations) {
+        return _activeMoveChunkStates.front().constructErrorStatus();
     }
 
-    _activeMoveChunkState.emplace(args);
+    _activeMoveChunkStates.emplace_back(args);
 
-    return {ScopedRegisterDonateChunk(this, true, _activeMoveChunkState->notification)};
+    return {ScopedRegisterDonateChunk(this, true, _activeMoveChunkStates.back().notification)};
 }
 
 StatusWith<ScopedRegisterReceiveChunk> ActiveMigrationsRegistry::registerReceiveChunk(
@@ -72,8 +93,8 @@ StatusWith<ScopedRegisterReceiveChunk> ActiveMigrationsRegistry::registerReceive
         return _activeReceiveChunkState->constructErrorStatus();
     }
 
-    if (_activeMoveChunkState) {
-        return _activeMoveChunkState->constructErrorStatus();
+    if (!_activeMoveChunkStates.empty()) {
+        return _activeMoveChunkStates.front().constructErrorStatus();
     }
 
     _activeReceiveChunkState.emplace(nss, chunkRange, fromShardId);
@@ -81,13 +102,15 @@ StatusWith<ScopedRegisterReceiveChunk> ActiveMigrationsRegistry::registerReceive
     return {ScopedRegisterReceiveChunk(this)};
 }
 
-boost::optional<NamespaceString> ActiveMigrationsRegistry::getActiveDonateChunkNss() {
+std::vector<NamespaceString> ActiveMigrationsRegistry::getActiveDonateChunkNamespaces() {
+    std::vector<NamespaceString> namespaces;
+
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    if (_activeMoveChunkState) {
-        return _activeMoveChunkState->args.getNss();
+    for (const auto& activeMoveChunkState : _activeMoveChunkStates) {
+        namespaces.push_back(activeMoveChunkState.args.getNss());
     }
 
-    return boost::none;
+    return namespaces;
 }
 
 BSONObj ActiveMigrationsRegistry::getActiveMigrationStatusReport(OperationContext* opCtx) {
@@ -95,8 +118,8 @@ BSONObj ActiveMigrationsRegistry::getActiveMigrationStatusReport(OperationContex
     {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
 
-        if (_activeMoveChunkState) {
-            nss = _activeMoveChunkState->args.getNss();
+        if (!_activeMoveChunkStates.empty()) {
+            nss = _activeMoveChunkStates.front().args.getNss();
         }
     }
 
@@ -117,10 +140,17 @@ BSONObj ActiveMigrationsRegistry::getActiveMigrationStatusReport(OperationContex
     return BSONObj();
 }
 
-void ActiveMigrationsRegistry::_clearDonateChunk() {
+void ActiveMigrationsRegistry::_clearDonateChunk(
+    const std::shared_ptr<Notification<Status>>& completionNotification) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    invariant(_activeMoveChunkState);
-    _activeMoveChunkState.reset();
+
+    auto it = std::find_if(_activeMoveChunkStates.begin(),
+                           _activeMoveChunkStates.end(),
+                           [&](const ActiveMoveChunkState& activeMoveChunkState) {
+                               return activeMoveChunkState.notification == completionNotification;
+                           });
+    invariant(it != _activeMoveChunkStates.end());
+    _activeMoveChunkStates.erase(it);
 }
 
 void ActiveMigrationsRegistry::_clearReceiveChunk() {
@@ -163,7 +193,7 @@ ScopedRegisterDonateChunk::~ScopedRegisterDonateChunk() {
     if (_registry && _forUnregister) {
         // If this is a newly started migration the caller must always signal on completion
         invariant(*_completionNotification);
-        _registry->_clearDonateChunk();
+        _registry->_clearDonateChunk(_completionNotification);
     }
 }
 
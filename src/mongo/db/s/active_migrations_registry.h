@@ -29,6 +29,8 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <list>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/s/migration_session_id.h"
@@ -47,7 +49,9 @@ class StatusWith;
 
 /**
  * Thread-safe object, which keeps track of the active migrations running on a node and limits them
- * to only one per-shard. There is only one instance of this object per shard.
+ * to either a single incoming migration or up to maxConcurrentOutgoingMigrations outgoing
+ * migrations of distinct collections per-shard. There is only one instance of this object per
+ * shard.
  */
 class ActiveMigrationsRegistry {
     MONGO_DISALLOW_COPYING(ActiveMigrationsRegistry);
@@ -57,9 +61,10 @@ public:
     ~ActiveMigrationsRegistry();
 
     /**
-     * If there are no migrations running on this shard, registers an active migration with the
-     * specified arguments and returns a ScopedRegisterDonateChunk, which must be signaled by the
-     * caller before it goes out of scope.
+     * If this shard is not receiving a chunk, is not already donating a chunk of the same
+     * collection and is donating fewer than maxConcurrentOutgoingMigrations chunks, registers an
+     * active migration with the specified arguments and returns a ScopedRegisterDonateChunk, which
+     * must be signaled by the caller before it goes out of scope.
      *
      * If there is an active migration already running on this shard and it has the exact same
      * arguments, returns a ScopedRegisterDonateChunk, which can be used to join the already running
@@ -81,14 +86,15 @@ public:
                                                                 const ShardId& fromShardId);
 
     /**
-     * If a migration has been previously registered through a call to registerDonateChunk returns
-     * that namespace. Otherwise returns boost::none.
+     * Returns the namespaces of all migrations, which have been previously registered through a
+     * call to registerDonateChunk, in the order in which they were registered. Returns an empty
+     * vector if this shard is not donating any chunks.
      */
-    boost::optional<NamespaceString> getActiveDonateChunkNss();
+    std::vector<NamespaceString> getActiveDonateChunkNamespaces();
 
     /**
-     * Returns a report on the active migration if there currently is one. Otherwise, returns an
-     * empty BSONObj.
+     * Returns a report on the oldest active migration if there currently is one. Otherwise, returns
+     * an empty BSONObj.
      *
      * Takes an IS lock on the namespace of the active migration, if one is active.
      */
@@ -136,10 +142,10 @@ private:
     };
 
     /**
-     * Unregisters a previously registered namespace with ongoing migration. Must only be called if
-     * a previous call to registerDonateChunk has succeeded.
+     * Unregisters the previously registered migration, which signals the specified completion
+     * notification. Must only be called if a previous call to registerDonateChunk has succeeded.
      */
-    void _clearDonateChunk();
+    void _clearDonateChunk(const std::shared_ptr<Notification<Status>>& completionNotification);
 
     /**
      * Unregisters a previously registered incoming migration. Must only be called if a previous
@@ -150,9 +156,9 @@ private:
     // Protects the state below
     stdx::mutex _mutex;
 
-    // If there is an active moveChunk operation going on, this field contains the request, which
-    // initiated it
-    boost::optional<ActiveMoveChunkState> _activeMoveChunkState;
+    // Contains the requests, which initiated the active moveChunk operations, in the order in which
+    // they were registered
+    std::list<ActiveMoveChunkState> _activeMoveChunkStates;
 
     // If there is an active receive of a chunk going on, this field contains the session id, which
     // initiated it
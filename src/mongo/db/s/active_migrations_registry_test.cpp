@@ -32,9 +32,11 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/client.h"
 #include "mongo/db/s/active_migrations_registry.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/s/move_chunk_request.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -98,15 +100,22 @@ TEST_F(MoveChunkRegistration, ScopedRegisterDonateChunkMoveConstructorAndAssignm
     originalScopedRegisterDonateChunk.complete(Status::OK());
 }
 
+void setMaxConcurrentOutgoingMigrations(StringData value) {
+    auto param = ServerParameterSet::getGlobal()->getMap().find("maxConcurrentOutgoingMigrations");
+    ASSERT_OK(param->second->setFromString(value.toString()));
+}
+
 TEST_F(MoveChunkRegistration, GetActiveMigrationNamespace) {
-    ASSERT(!_registry.getActiveDonateChunkNss());
+    ASSERT(_registry.getActiveDonateChunkNamespaces().empty());
 
     const NamespaceString nss("TestDB", "TestColl");
 
     auto originalScopedRegisterDonateChunk =
         assertGet(_registry.registerDonateChunk(createMoveChunkRequest(nss)));
 
-    ASSERT_EQ(nss.ns(), _registry.getActiveDonateChunkNss()->ns());
+    const auto namespaces = _registry.getActiveDonateChunkNamespaces();
+    ASSERT_EQ(1U, namespaces.size());
+    ASSERT_EQ(nss.ns(), namespaces[0].ns());
 
     // Need to signal the registered migration so the destructor doesn't invariant
     originalScopedRegisterDonateChunk.complete(Status::OK());
@@ -138,5 +147,84 @@ TEST_F(MoveChunkRegistration, SecondMigrationWithSameArgumentsJoinsFirst) {
               secondScopedRegisterDonateChunk.waitForCompletion(getTxn()));
 }
 
+TEST_F(MoveChunkRegistration, ConcurrentMigrationsOfDistinctCollectionsUpToTheLimit) {
+    setMaxConcurrentOutgoingMigrations("2");
+    ON_BLOCK_EXIT([] { setMaxConcurrentOutgoingMigrations("1"); });
+
+    auto firstScopedRegisterDonateChunk = assertGet(_registry.registerDonateChunk(
+        createMoveChunkRequest(NamespaceString("TestDB", "TestColl1"))));
+    ASSERT(firstScopedRegisterDonateChunk.mustExecute());
+
+    {
+        auto secondScopedRegisterDonateChunk = assertGet(_registry.registerDonateChunk(
+            createMoveChunkRequest(NamespaceString("TestDB", "TestColl2"))));
+        ASSERT(secondScopedRegisterDonateChunk.mustExecute());
+
+        const auto namespaces = _registry.getActiveDonateChunkNamespaces();
+        ASSERT_EQ(2U, namespaces.size());
+        ASSERT_EQ("TestDB.TestColl1", namespaces[0].ns());
+        ASSERT_EQ("TestDB.TestColl2", namespaces[1].ns());
+
+        ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+                  _registry
+                      .registerDonateChunk(
+                          createMoveChunkRequest(NamespaceString("TestDB", "TestColl3")))
+                      .getStatus());
+
+        ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+                  _registry
+                      .registerReceiveChunk(NamespaceString("TestDB", "TestColl3"),
+                                            ChunkRange(BSON("Key" << -100), BSON("Key" << 100)),
+                                            ShardId("shard0003"))
+                      .getStatus());
+
+        secondScopedRegisterDonateChunk.complete(Status::OK());
+    }
+
+    // Completing a migration makes room for another one
+    auto thirdScopedRegisterDonateChunk = assertGet(_registry.registerDonateChunk(
+        createMoveChunkRequest(NamespaceString("TestDB", "TestColl3"))));
+    ASSERT(thirdScopedRegisterDonateChunk.mustExecute());
+
+    const auto namespaces = _registry.getActiveDonateChunkNamespaces();
+    ASSERT_EQ(2U, namespaces.size());
+    ASSERT_EQ("TestDB.TestColl1", namespaces[0].ns());
+    ASSERT_EQ("TestDB.TestColl3", namespaces[1].ns());
+
+    firstScopedRegisterDonateChunk.complete(Status::OK());
+    thirdScopedRegisterDonateChunk.complete(Status::OK());
+}
+
+TEST_F(MoveChunkRegistration, ConcurrentMigrationsOfSameCollectionReturnConflictingOperation) {
+    setMaxConcurrentOutgoingMigrations("2");
+    ON_BLOCK_EXIT([] { setMaxConcurrentOutgoingMigrations("1"); });
+
+    const NamespaceString nss("TestDB", "TestColl");
+
+    auto originalScopedRegisterDonateChunk =
+        assertGet(_registry.registerDonateChunk(createMoveChunkRequest(nss)));
+
+    BSONObjBuilder builder;
+    MoveChunkRequest::appendAsCommand(
+        &builder,
+        nss,
+        ChunkVersion(1, 3, OID::gen()),
+        assertGet(ConnectionString::parse("TestConfigRS/CS1:12345,CS2:12345,CS3:12345")),
+        ShardId("shard0001"),
+        ShardId("shard0003"),
+        ChunkRange(BSON("Key" << 100), BSON("Key" << 200)),
+        1024,
+        MigrationSecondaryThrottleOptions::create(MigrationSecondaryThrottleOptions::kOff),
+        true);
+
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress,
+              _registry
+                  .registerDonateChunk(
+                      assertGet(MoveChunkRequest::createFromCommand(nss, builder.obj())))
+                  .getStatus());
+
+    originalScopedRegisterDonateChunk.complete(Status::OK());
+}
+
 }  // namespace
 }  // namespace mongo
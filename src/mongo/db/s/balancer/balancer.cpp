@@ -302,6 +302,7 @@ void Balancer::report(OperationContext* opCtx, BSONObjBuilder* builder) {
 void Balancer::_mainThread() {
     Client::initThread("Balancer");
     auto opCtx = cc().makeOperationContext();
+    opCtx->lockState()->setShouldAcquireTicket(false);
     auto shardingContext = Grid::get(opCtx.get());
 
     log() << "CSRS balancer is starting";
@@ -376,12 +377,22 @@ void Balancer::_mainThread() {
                     LOG(1) << "Done enforcing tag range boundaries.";
                 }
 
-                const auto candidateChunks = uassertStatusOK(
-                    _chunkSelectionPolicy->selectChunksToMove(opCtx.get(), _balancedLastTime));
+                const auto shardStats = uassertStatusOK(_clusterStats->getStats(opCtx.get()));
+
+                const auto candidateChunks =
+                    uassertStatusOK(_chunkSelectionPolicy->selectChunksToMove(
+                        opCtx.get(), shardStats, _balancedLastTime));
 
                 if (candidateChunks.empty()) {
                     LOG(1) << "no need to move any chunk";
                     _balancedLastTime = false;
+
+                    // Only merge chunks once the cluster is balanced, so that merging does not
+                    // take away the chunks the balancer would otherwise have moved
+                    status = _mergeChunks(opCtx.get(), shardStats);
+                    if (!status.isOK()) {
+                        warning() << "Failed to merge chunks" << causedBy(status);
+                    }
                 } else {
                     _balancedLastTime = _moveChunks(opCtx.get(), candidateChunks);
 
@@ -563,6 +574,64 @@ Status Balancer::_enforceTagRanges(OperationContext* opCtx) {
     return Status::OK();
 }
 
+Status Balancer::_mergeChunks(OperationContext* opCtx, const ShardStatisticsVector& shardStats) {
+    auto chunksToMergeStatus = _chunkSelectionPolicy->selectChunksToMerge(opCtx, shardStats);
+    if (!chunksToMergeStatus.isOK()) {
+        return chunksToMergeStatus.getStatus();
+    }
+
+    // Leave room for the merged chunk to grow before it needs to be split again
+    const long long maxMergedSizeBytes =
+        Grid::get(opCtx)->getBalancerConfiguration()->getMaxChunkSizeBytes() / 2;
+
+    for (const auto& mergeInfo : chunksToMergeStatus.getValue()) {
+        if (_stopRequested()) {
+            break;
+        }
+
+        const NamespaceString nss(mergeInfo.ns);
+        const ChunkRange range(mergeInfo.minKey, mergeInfo.maxKey);
+
+        auto routingInfoStatus =
+            Grid::get(opCtx)->catalogCache()->getShardedCollectionRoutingInfoWithRefresh(opCtx,
+                                                                                         nss);
+        if (!routingInfoStatus.isOK()) {
+            return routingInfoStatus.getStatus();
+        }
+
+        auto cm = routingInfoStatus.getValue().cm();
+
+        auto dataSizeStatus = shardutil::retrieveChunkDataSize(opCtx,
+                                                               mergeInfo.shardId,
+                                                               nss,
+                                                               cm->getShardKeyPattern(),
+                                                               range,
+                                                               maxMergedSizeBytes);
+        if (!dataSizeStatus.isOK()) {
+            warning() << "Failed to determine the size of chunks " << redact(mergeInfo.toString())
+                      << causedBy(redact(dataSizeStatus.getStatus()));
+            continue;
+        }
+
+        if (dataSizeStatus.getValue() > maxMergedSizeBytes) {
+            LOG(1) << "Not merging chunks " << redact(mergeInfo.toString()) << " because they hold "
+                   << dataSizeStatus.getValue() << " bytes";
+            continue;
+        }
+
+        auto mergeStatus =
+            shardutil::mergeChunks(opCtx, mergeInfo.shardId, nss, cm->getVersion(), range);
+        if (!mergeStatus.isOK()) {
+            warning() << "Failed to merge chunks " << redact(mergeInfo.toString())
+                      << causedBy(redact(mergeStatus));
+        } else {
+            LOG(1) << "Merged chunks " << redact(mergeInfo.toString());
+        }
+    }
+
+    return Status::OK();
+}
+
 int Balancer::_moveChunks(OperationContext* opCtx,
                           const BalancerChunkSelectionPolicy::MigrateInfoVector& candidateChunks) {
     auto balancerConfig = Grid::get(opCtx)->getBalancerConfiguration();
@@ -184,6 +184,13 @@ private:
      */
     Status _enforceTagRanges(OperationContext* opCtx);
 
+    /**
+     * Merges runs of adjacent chunks, which reside on the same shard, as selected by the chunk
+     * selection policy based on the specified shard statistics. Runs which hold too much data to
+     * stay below the maximum chunk size after the merge are skipped.
+     */
+    Status _mergeChunks(OperationContext* opCtx, const ShardStatisticsVector& shardStats);
+
     /**
      * Schedules migrations for the specified set of chunks and returns how many chunks were
      * successfully processed.
@@ -80,6 +80,8 @@ public:
 
     typedef std::vector<MigrateInfo> MigrateInfoVector;
 
+    typedef std::vector<MergeInfo> MergeInfoVector;
+
     virtual ~BalancerChunkSelectionPolicy();
 
     /**
@@ -90,12 +92,24 @@ public:
     virtual StatusWith<SplitInfoVector> selectChunksToSplit(OperationContext* opCtx) = 0;
 
     /**
-     * Potentially blocking method, which gives out a set of chunks to be moved. The
-     * aggressiveBalanceHint indicates to the balancing logic that it should lower the threshold for
-     * difference in number of chunks across shards and thus potentially cause more chunks to move.
+     * Potentially blocking method, which gives out a set of chunks to be moved, based on the
+     * specified shard statistics. The aggressiveBalanceHint indicates to the balancing logic that
+     * it should lower the threshold for difference in number of chunks across shards and thus
+     * potentially cause more chunks to move.
+     */
+    virtual StatusWith<MigrateInfoVector> selectChunksToMove(
+        OperationContext* opCtx,
+        const ShardStatisticsVector& shardStats,
+        bool aggressiveBalanceHint) = 0;
+
+    /**
+     * Potentially blocking method, which gives out a set of runs of adjacent chunks, which reside
+     * on the same shard and can be merged in order to reduce the number of chunks in the cluster.
+     * Expects the same shard statistics, based on which no chunks were selected to be moved.
+     * Returns an empty set if chunk merging is disabled.
      */
-    virtual StatusWith<MigrateInfoVector> selectChunksToMove(OperationContext* opCtx,
-                                                             bool aggressiveBalanceHint) = 0;
+    virtual StatusWith<MergeInfoVector> selectChunksToMerge(
+        OperationContext* opCtx, const ShardStatisticsVector& shardStats) = 0;
 
     /**
      * Requests a single chunk to be relocated to a different shard, if possible. If some error
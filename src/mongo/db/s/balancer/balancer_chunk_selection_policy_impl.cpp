@@ -37,6 +37,7 @@
 
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj_comparator_interface.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/sharding_catalog_client.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/catalog/type_collection.h"
@@ -49,6 +50,7 @@
 
 namespace mongo {
 
+using MergeInfoVector = BalancerChunkSelectionPolicy::MergeInfoVector;
 using MigrateInfoVector = BalancerChunkSelectionPolicy::MigrateInfoVector;
 using SplitInfoVector = BalancerChunkSelectionPolicy::SplitInfoVector;
 using std::shared_ptr;
@@ -57,6 +59,23 @@ using std::vector;
 
 namespace {
 
+// When positive, the migrations selected for a balancer round are limited across all collections so
+// that each shard donates chunks of at most this many collections and receives at most one chunk.
+// Shards are only able to donate chunks of several collections at the same time if their
+// maxConcurrentOutgoingMigrations parameter allows it. When zero, migrations are only limited
+// within each collection.
+MONGO_EXPORT_SERVER_PARAMETER(balancerMaxConcurrentMigrationsPerShard, int, 0);
+
+// When positive, balancer rounds which have no chunks to move merge at most this many runs of
+// adjacent chunks, which are owned by the same shard, in order to keep the number of chunks (and
+// with it the size of the routing tables) down. When zero, chunks are never merged. Chunks with
+// recent write load are only left unmerged if balancerBalanceByOpLoad is enabled, since otherwise
+// the balancer has no write load information.
+MONGO_EXPORT_SERVER_PARAMETER(balancerMaxChunkMergesPerRound, int, 0);
+
+// Upper bound on the number of chunks, which are merged into one in a single step
+const size_t kMaxChunksPerMerge = 16;
+
 /**
  * Does a linear pass over the information cached in the specified chunk manager and extracts chunk
  * distrubution and chunk placement information which is needed by the balancer policy.
@@ -96,6 +115,18 @@ StatusWith<DistributionStatus> createCollectionDistributionStatus(
     DistributionStatus distribution(NamespaceString(chunkMgr->getns()),
                                     std::move(shardToChunksMap));
 
+    // Attach the write load, which the shards reported for the collection's chunks
+    for (const auto& stat : allShards) {
+        const auto it = stat.chunkOpStats.find(chunkMgr->getns());
+        if (it == stat.chunkOpStats.end()) {
+            continue;
+        }
+
+        for (const auto& chunkOpStats : it->second) {
+            distribution.addChunkOpStatistics(stat.shardId, chunkOpStats);
+        }
+    }
+
     // Cache the collection tags
     const auto& keyPattern = chunkMgr->getShardKeyPattern().getKeyPattern();
 
@@ -153,6 +184,13 @@ public:
         }
     }
 
+    /**
+     * Returns whether any split points have been added.
+     */
+    bool empty() const {
+        return _chunkSplitPoints.empty();
+    }
+
     /**
      * May be called only once for the lifetime of the buffer. Moves the contents of the buffer into
      * a vector of split infos to be passed to the split call.
@@ -231,14 +269,7 @@ StatusWith<SplitInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToSpli
 }
 
 StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMove(
-    OperationContext* opCtx, bool aggressiveBalanceHint) {
-    auto shardStatsStatus = _clusterStats->getStats(opCtx);
-    if (!shardStatsStatus.isOK()) {
-        return shardStatsStatus.getStatus();
-    }
-
-    const auto shardStats = std::move(shardStatsStatus.getValue());
-
+    OperationContext* opCtx, const ShardStatisticsVector& shardStats, bool aggressiveBalanceHint) {
     if (shardStats.size() < 2) {
         return MigrateInfoVector{};
     }
@@ -257,6 +288,9 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
 
     MigrateInfoVector candidateChunks;
 
+    const int maxConcurrentMigrationsPerShard = balancerMaxConcurrentMigrationsPerShard.load();
+    MigrationRoundLimits roundLimits(std::max(1, maxConcurrentMigrationsPerShard));
+
     for (const auto& coll : collections) {
         if (coll.getDropped()) {
             continue;
@@ -269,8 +303,8 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
             continue;
         }
 
-        auto candidatesStatus =
-            _getMigrateCandidatesForCollection(opCtx, nss, shardStats, aggressiveBalanceHint);
+        auto candidatesStatus = _getMigrateCandidatesForCollection(
+            opCtx, nss, shardStats, aggressiveBalanceHint, roundLimits.getBusyShards());
         if (candidatesStatus == ErrorCodes::NamespaceNotFound) {
             // Namespace got dropped before we managed to get to it, so just skip it
             continue;
@@ -280,14 +314,74 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
             continue;
         }
 
-        candidateChunks.insert(candidateChunks.end(),
-                               std::make_move_iterator(candidatesStatus.getValue().begin()),
-                               std::make_move_iterator(candidatesStatus.getValue().end()));
+        for (auto& candidate : candidatesStatus.getValue()) {
+            // The policy may still pick a donor of another collection as the recipient
+            if (maxConcurrentMigrationsPerShard > 0 && !roundLimits.tryAdd(candidate)) {
+                continue;
+            }
+
+            candidateChunks.push_back(std::move(candidate));
+        }
     }
 
     return candidateChunks;
 }
 
+StatusWith<MergeInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMerge(
+    OperationContext* opCtx, const ShardStatisticsVector& shardStats) {
+    const int maxChunkMergesPerRound = balancerMaxChunkMergesPerRound.load();
+    if (maxChunkMergesPerRound <= 0) {
+        return MergeInfoVector{};
+    }
+
+    vector<CollectionType> collections;
+
+    Status collsStatus =
+        Grid::get(opCtx)->catalogClient()->getCollections(opCtx, nullptr, &collections, nullptr);
+    if (!collsStatus.isOK()) {
+        return collsStatus;
+    }
+
+    MergeInfoVector candidateMerges;
+
+    for (const auto& coll : collections) {
+        if (candidateMerges.size() >= static_cast<size_t>(maxChunkMergesPerRound)) {
+            break;
+        }
+
+        if (coll.getDropped()) {
+            continue;
+        }
+
+        const NamespaceString nss(coll.getNs());
+
+        if (!coll.getAllowBalance()) {
+            LOG(1) << "Not merging chunks of collection " << nss << "; balancing is disabled.";
+            continue;
+        }
+
+        auto candidatesStatus = _getMergeCandidatesForCollection(opCtx, nss, shardStats);
+        if (candidatesStatus == ErrorCodes::NamespaceNotFound) {
+            // Namespace got dropped before we managed to get to it, so just skip it
+            continue;
+        } else if (!candidatesStatus.isOK()) {
+            warning() << "Unable to merge chunks of collection " << nss.ns()
+                      << causedBy(candidatesStatus.getStatus());
+            continue;
+        }
+
+        for (auto& candidate : candidatesStatus.getValue()) {
+            if (candidateMerges.size() >= static_cast<size_t>(maxChunkMergesPerRound)) {
+                break;
+            }
+
+            candidateMerges.push_back(std::move(candidate));
+        }
+    }
+
+    return candidateMerges;
+}
+
 StatusWith<boost::optional<MigrateInfo>>
 BalancerChunkSelectionPolicyImpl::selectSpecificChunkToMove(OperationContext* opCtx,
                                                             const ChunkType& chunk) {
@@ -407,14 +501,50 @@ StatusWith<SplitInfoVector> BalancerChunkSelectionPolicyImpl::_getSplitCandidate
         }
     }
 
+    // Zone boundaries are enforced first. A chunk which is too hot to be moved as a whole is split
+    // at the median of its recently written keys in a later round, once they are all in place.
+    if (splitCandidates.empty()) {
+        const auto hotChunk = BalancerPolicy::selectHotChunkToSplit(shardStats, distribution);
+        if (hotChunk) {
+            shared_ptr<Chunk> chunk = cm->findIntersectingChunkWithSimpleCollation(hotChunk->min);
+            if (!chunk->getMin().woCompare(hotChunk->min) &&
+                !chunk->getMax().woCompare(hotChunk->max)) {
+                log() << "Splitting chunk " << redact(chunk->toString()) << " with write load "
+                      << hotChunk->numOps << " at " << redact(hotChunk->medianKey)
+                      << " to even out the write load";
+                splitCandidates.addSplitPoint(chunk, hotChunk->medianKey);
+            }
+        }
+    }
+
     return splitCandidates.done();
 }
 
+StatusWith<MergeInfoVector> BalancerChunkSelectionPolicyImpl::_getMergeCandidatesForCollection(
+    OperationContext* opCtx, const NamespaceString& nss, const ShardStatisticsVector& shardStats) {
+    auto routingInfoStatus =
+        Grid::get(opCtx)->catalogCache()->getShardedCollectionRoutingInfoWithRefresh(opCtx, nss);
+    if (!routingInfoStatus.isOK()) {
+        return routingInfoStatus.getStatus();
+    }
+
+    const auto cm = routingInfoStatus.getValue().cm().get();
+
+    const auto collInfoStatus = createCollectionDistributionStatus(opCtx, shardStats, cm);
+    if (!collInfoStatus.isOK()) {
+        return collInfoStatus.getStatus();
+    }
+
+    return BalancerPolicy::selectChunksToMerge(
+        shardStats, collInfoStatus.getValue(), kMaxChunksPerMerge);
+}
+
 StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandidatesForCollection(
     OperationContext* opCtx,
     const NamespaceString& nss,
     const ShardStatisticsVector& shardStats,
-    bool aggressiveBalanceHint) {
+    bool aggressiveBalanceHint,
+    const std::set<ShardId>& busyShards) {
     auto routingInfoStatus =
         Grid::get(opCtx)->catalogCache()->getShardedCollectionRoutingInfoWithRefresh(opCtx, nss);
     if (!routingInfoStatus.isOK()) {
@@ -473,7 +603,7 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
         }
     }
 
-    return BalancerPolicy::balance(shardStats, distribution, aggressiveBalanceHint);
+    return BalancerPolicy::balance(shardStats, distribution, aggressiveBalanceHint, busyShards);
 }
 
 }  // namespace mongo
@@ -42,8 +42,12 @@ public:
     StatusWith<SplitInfoVector> selectChunksToSplit(OperationContext* opCtx) override;
 
     StatusWith<MigrateInfoVector> selectChunksToMove(OperationContext* opCtx,
+                                                     const ShardStatisticsVector& shardStats,
                                                      bool aggressiveBalanceHint) override;
 
+    StatusWith<MergeInfoVector> selectChunksToMerge(
+        OperationContext* opCtx, const ShardStatisticsVector& shardStats) override;
+
     StatusWith<boost::optional<MigrateInfo>> selectSpecificChunkToMove(
         OperationContext* opCtx, const ChunkType& chunk) override;
 
@@ -63,13 +67,24 @@ private:
 
     /**
      * Synchronous method, which iterates the collection's chunks and uses the cluster statistics to
-     * figure out where to place them.
+     * figure out where to place them. None of the chunks is moved off of or onto any of the shards
+     * in 'busyShards'.
      */
     StatusWith<MigrateInfoVector> _getMigrateCandidatesForCollection(
         OperationContext* opCtx,
         const NamespaceString& nss,
         const ShardStatisticsVector& shardStats,
-        bool aggressiveBalanceHint);
+        bool aggressiveBalanceHint,
+        const std::set<ShardId>& busyShards);
+
+    /**
+     * Synchronous method, which iterates the collection's chunks and returns the runs of adjacent
+     * chunks of the same shard, which can be merged.
+     */
+    StatusWith<MergeInfoVector> _getMergeCandidatesForCollection(
+        OperationContext* opCtx,
+        const NamespaceString& nss,
+        const ShardStatisticsVector& shardStats);
 
     // Source for obtaining cluster statistics. Not owned and must not be destroyed before the
     // policy object is destroyed.
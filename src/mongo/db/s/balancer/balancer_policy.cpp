@@ -53,12 +53,121 @@ namespace {
 const size_t kDefaultImbalanceThreshold = 2;
 const size_t kAggressiveImbalanceThreshold = 1;
 
+// The write load, which the hottest shard of a collection must have for load balancing to kick in,
+// so that an otherwise idle collection does not have its chunks shuffled around by a few writes.
+const uint64_t kMinOpLoadToBalance = 1000;
+
+// How much, in percent, the write load of the hottest shard of a collection must exceed the
+// average across all shards for a load balancing migration or split to be initiated.
+const uint64_t kOpLoadImbalancePercent = 25;
+
+/**
+ * A chunk on the shard with the highest write load of a collection. If it is movable, moving it
+ * to the shard with the lowest write load evens out the load. Otherwise it is the donor's hottest
+ * chunk, which is too hot to be moved as a whole.
+ */
+struct HotChunkCandidate {
+    ShardId to;
+    const ChunkType* chunk;
+    bool movable;
+};
+
+boost::optional<HotChunkCandidate> findHotChunk(const ShardStatisticsVector& shardStats,
+                                                const DistributionStatus& distribution,
+                                                const set<ShardId>& excludedShards) {
+    if (!distribution.hasOpLoad()) {
+        return boost::none;
+    }
+
+    uint64_t totalLoad = 0;
+    uint64_t numShards = 0;
+
+    const ClusterStatistics::ShardStatistics* from = nullptr;
+    uint64_t fromLoad = 0;
+    const ClusterStatistics::ShardStatistics* to = nullptr;
+    uint64_t toLoad = 0;
+
+    for (const auto& stat : shardStats) {
+        // Draining shards are being emptied anyways
+        if (stat.isDraining)
+            continue;
+
+        const uint64_t load = distribution.opLoadOfShard(stat.shardId);
+        totalLoad += load;
+        numShards++;
+
+        if (excludedShards.count(stat.shardId))
+            continue;
+
+        if (!from || load > fromLoad) {
+            from = &stat;
+            fromLoad = load;
+        }
+
+        if (!stat.isSizeMaxed() && (!to || load < toLoad)) {
+            to = &stat;
+            toLoad = load;
+        }
+    }
+
+    if (!from || !to || from == to || fromLoad < kMinOpLoadToBalance)
+        return boost::none;
+
+    if (fromLoad * 100 <= totalLoad / numShards * (100 + kOpLoadImbalancePercent))
+        return boost::none;
+
+    // Moving more than half of the difference would only make the receiver the new hottest shard
+    const uint64_t maxLoadToMove = (fromLoad - toLoad) / 2;
+
+    const ChunkType* hottest = nullptr;
+    uint64_t hottestLoad = 0;
+    const ChunkType* best = nullptr;
+    uint64_t bestLoad = 0;
+
+    for (const auto& chunk : distribution.getChunks(from->shardId)) {
+        const uint64_t load = distribution.opLoadOfChunk(chunk);
+        if (!load || chunk.getJumbo())
+            continue;
+
+        if (!BalancerPolicy::isShardSuitableReceiver(*to, distribution.getTagForChunk(chunk))
+                 .isOK())
+            continue;
+
+        if (load > hottestLoad) {
+            hottest = &chunk;
+            hottestLoad = load;
+        }
+
+        if (load <= maxLoadToMove && load > bestLoad) {
+            best = &chunk;
+            bestLoad = load;
+        }
+    }
+
+    LOG(1) << "collection : " << distribution.nss().ns();
+    LOG(1) << "hottest    : " << from->shardId << " write load " << fromLoad;
+    LOG(1) << "coldest    : " << to->shardId << " write load " << toLoad;
+    LOG(1) << "average    : " << totalLoad / numShards;
+
+    if (best) {
+        return HotChunkCandidate{to->shardId, best, true};
+    }
+
+    if (hottest) {
+        return HotChunkCandidate{to->shardId, hottest, false};
+    }
+
+    return boost::none;
+}
+
 }  // namespace
 
 DistributionStatus::DistributionStatus(NamespaceString nss, ShardToChunksMap shardToChunksMap)
     : _nss(std::move(nss)),
       _shardChunks(std::move(shardToChunksMap)),
-      _zoneRanges(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ZoneRange>()) {}
+      _zoneRanges(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ZoneRange>()),
+      _chunkOpStats(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<
+                    std::pair<ShardId, ClusterStatistics::ChunkOpStatistics>>()) {}
 
 size_t DistributionStatus::totalChunks() const {
     size_t total = 0;
@@ -174,6 +283,43 @@ string DistributionStatus::getTagForChunk(const ChunkType& chunk) const {
     return "";
 }
 
+void DistributionStatus::addChunkOpStatistics(const ShardId& shardId,
+                                              const ClusterStatistics::ChunkOpStatistics& stats) {
+    _chunkOpStats.emplace(stats.min, std::make_pair(shardId, stats));
+}
+
+const ClusterStatistics::ChunkOpStatistics* DistributionStatus::getChunkOpStatistics(
+    const ChunkType& chunk) const {
+    const auto it = _chunkOpStats.find(chunk.getMin());
+    if (it == _chunkOpStats.end()) {
+        return nullptr;
+    }
+
+    const auto& reportingShard = it->second.first;
+    const auto& stats = it->second.second;
+    if (reportingShard != chunk.getShard() ||
+        SimpleBSONObjComparator::kInstance.evaluate(stats.max != chunk.getMax())) {
+        return nullptr;
+    }
+
+    return &stats;
+}
+
+uint64_t DistributionStatus::opLoadOfChunk(const ChunkType& chunk) const {
+    const auto stats = getChunkOpStatistics(chunk);
+    return stats ? stats->numOps : 0;
+}
+
+uint64_t DistributionStatus::opLoadOfShard(const ShardId& shardId) const {
+    uint64_t total = 0;
+
+    for (const auto& chunk : getChunks(shardId)) {
+        total += opLoadOfChunk(chunk);
+    }
+
+    return total;
+}
+
 void DistributionStatus::report(BSONObjBuilder* builder) const {
     builder->append("ns", _nss.ns());
 
@@ -291,12 +437,13 @@ ShardId BalancerPolicy::_getMostOverloadedShard(const ShardStatisticsVector& sha
 
 vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardStats,
                                             const DistributionStatus& distribution,
-                                            bool shouldAggressivelyBalance) {
+                                            bool shouldAggressivelyBalance,
+                                            const set<ShardId>& busyShards) {
     vector<MigrateInfo> migrations;
 
     // Set of shards, which have already been used for migrations. Used so we don't return multiple
     // migrations for the same shard.
-    set<ShardId> usedShards;
+    set<ShardId> usedShards(busyShards);
 
     // 1) Check for shards, which are in draining mode
     {
@@ -438,6 +585,9 @@ vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardSt
             ;
     }
 
+    // 4) Even out the write load across the shards, which are not used by any migration yet
+    _singleLoadBalance(shardStats, distribution, &migrations, &usedShards);
+
     return migrations;
 }
 
@@ -456,6 +606,152 @@ boost::optional<MigrateInfo> BalancerPolicy::balanceSingleChunk(
     return MigrateInfo(newShardId, chunk);
 }
 
+boost::optional<ClusterStatistics::ChunkOpStatistics> BalancerPolicy::selectHotChunkToSplit(
+    const ShardStatisticsVector& shardStats, const DistributionStatus& distribution) {
+    const auto candidate = findHotChunk(shardStats, distribution, set<ShardId>());
+    if (!candidate || candidate->movable) {
+        return boost::none;
+    }
+
+    const auto stats = distribution.getChunkOpStatistics(*candidate->chunk);
+    invariant(stats);
+
+    // If most writes go to the chunk's min key, the median falls on the chunk boundary and the
+    // chunk cannot be split any further by load
+    if (stats->medianKey.isEmpty() ||
+        SimpleBSONObjComparator::kInstance.evaluate(stats->medianKey <= stats->min) ||
+        SimpleBSONObjComparator::kInstance.evaluate(stats->medianKey >= stats->max)) {
+        return boost::none;
+    }
+
+    return *stats;
+}
+
+vector<MergeInfo> BalancerPolicy::selectChunksToMerge(const ShardStatisticsVector& shardStats,
+                                                      const DistributionStatus& distribution,
+                                                      size_t maxChunksPerMerge) {
+    vector<MergeInfo> merges;
+
+    const auto isMergeable = [&distribution](const ChunkType& chunk) {
+        return !chunk.getJumbo() && distribution.opLoadOfChunk(chunk) == 0;
+    };
+
+    // Number of chunks of each shard in each zone, as compared by the balancer, less the chunks
+    // merged away by the merges selected so far. Filled in lazily, one zone at a time.
+    map<string, map<ShardId, size_t>> zoneChunkCounts;
+    size_t totalChunks = distribution.totalChunks();
+
+    const auto getZoneChunkCounts = [&](const string& tag) -> map<ShardId, size_t>& {
+        auto it = zoneChunkCounts.find(tag);
+        if (it == zoneChunkCounts.end()) {
+            it = zoneChunkCounts.emplace(tag, map<ShardId, size_t>()).first;
+            for (const auto& stat : shardStats) {
+                it->second[stat.shardId] =
+                    distribution.numberOfChunksInShardWithTag(stat.shardId, tag);
+            }
+        }
+        return it->second;
+    };
+
+    // Mirrors the checks, which a non-aggressive balance() makes for a zone, so that merging does
+    // not make the balancer move chunks back onto the shard in a later round
+    const auto wouldMigrate = [&](const string& tag) {
+        const auto& counts = getZoneChunkCounts(tag);
+        const size_t imbalanceThreshold =
+            totalChunks < 20 ? kAggressiveImbalanceThreshold : kDefaultImbalanceThreshold;
+
+        size_t totalNumberOfChunksWithTag = tag.empty() ? totalChunks : 0;
+        size_t totalNumberOfShardsWithTag = 0;
+        size_t maxChunks = 0;
+        size_t minChunks = numeric_limits<size_t>::max();
+
+        for (const auto& stat : shardStats) {
+            const size_t numChunks = counts.at(stat.shardId);
+
+            if (!tag.empty()) {
+                totalNumberOfChunksWithTag += numChunks;
+            }
+            if (tag.empty() || stat.shardTags.count(tag)) {
+                totalNumberOfShardsWithTag++;
+            }
+
+            maxChunks = std::max(maxChunks, numChunks);
+            if (isShardSuitableReceiver(stat, tag).isOK()) {
+                minChunks = std::min(minChunks, numChunks);
+            }
+        }
+
+        if (totalNumberOfShardsWithTag == 0) {
+            return false;
+        }
+
+        const size_t idealNumberOfChunksPerShardForTag =
+            (totalNumberOfChunksWithTag / totalNumberOfShardsWithTag) +
+            (totalNumberOfChunksWithTag % totalNumberOfShardsWithTag ? 1 : 0);
+
+        return maxChunks > idealNumberOfChunksPerShardForTag &&
+            maxChunks - idealNumberOfChunksPerShardForTag >= imbalanceThreshold &&
+            minChunks < idealNumberOfChunksPerShardForTag;
+    };
+
+    // Takes the specified number of chunks away from the shard's count for the zone, unless that
+    // would make the zone, or the chunks outside of any zone, need balancing
+    const auto tryMergeAway = [&](const ShardId& shardId, const string& tag, size_t numChunks) {
+        auto& shardChunkCount = getZoneChunkCounts(tag)[shardId];
+        shardChunkCount -= numChunks;
+        totalChunks -= numChunks;
+
+        if (wouldMigrate(tag) || (!tag.empty() && wouldMigrate(""))) {
+            shardChunkCount += numChunks;
+            totalChunks += numChunks;
+            return false;
+        }
+
+        return true;
+    };
+
+    for (const auto& stat : shardStats) {
+        if (stat.isDraining)
+            continue;
+
+        // The chunks of a shard are in shard key order, so a run can only be extended by the next
+        // chunk of the same shard, and only if no other shard owns anything in between
+        const auto& chunks = distribution.getChunks(stat.shardId);
+
+        size_t runStart = 0;
+        while (runStart < chunks.size()) {
+            size_t runEnd = runStart + 1;
+
+            if (isMergeable(chunks[runStart])) {
+                const string tag = distribution.getTagForChunk(chunks[runStart]);
+
+                while (runEnd < chunks.size() && runEnd - runStart < maxChunksPerMerge &&
+                       SimpleBSONObjComparator::kInstance.evaluate(chunks[runEnd - 1].getMax() ==
+                                                                   chunks[runEnd].getMin()) &&
+                       isMergeable(chunks[runEnd]) &&
+                       distribution.getTagForChunk(chunks[runEnd]) == tag) {
+                    runEnd++;
+                }
+
+                // Shorten the run until the shard is left with enough chunks to stay balanced
+                size_t numChunks = runEnd - runStart;
+                while (numChunks > 1 && !tryMergeAway(stat.shardId, tag, numChunks - 1)) {
+                    numChunks--;
+                }
+
+                if (numChunks > 1) {
+                    merges.emplace_back(
+                        chunks[runStart], chunks[runStart + numChunks - 1], numChunks);
+                }
+            }
+
+            runStart = runEnd;
+        }
+    }
+
+    return merges;
+}
+
 bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
                                         const DistributionStatus& distribution,
                                         const string& tag,
@@ -504,6 +800,10 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
 
     unsigned numJumboChunks = 0;
 
+    // Without write load information any chunk will do. Otherwise prefer the coldest one, so that
+    // evening out the number of chunks does not undo the load balancing migrations.
+    const ChunkType* chunkToMove = nullptr;
+
     for (const auto& chunk : chunks) {
         if (distribution.getTagForChunk(chunk) != tag)
             continue;
@@ -513,8 +813,18 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
             continue;
         }
 
-        migrations->emplace_back(to, chunk);
-        invariant(usedShards->insert(chunk.getShard()).second);
+        const uint64_t load = distribution.opLoadOfChunk(chunk);
+        if (!chunkToMove || load < distribution.opLoadOfChunk(*chunkToMove)) {
+            chunkToMove = &chunk;
+        }
+
+        if (!load)
+            break;
+    }
+
+    if (chunkToMove) {
+        migrations->emplace_back(to, *chunkToMove);
+        invariant(usedShards->insert(chunkToMove->getShard()).second);
         invariant(usedShards->insert(to).second);
         return true;
     }
@@ -528,6 +838,26 @@ bool BalancerPolicy::_singleZoneBalance(const ShardStatisticsVector& shardStats,
     return false;
 }
 
+bool BalancerPolicy::_singleLoadBalance(const ShardStatisticsVector& shardStats,
+                                        const DistributionStatus& distribution,
+                                        vector<MigrateInfo>* migrations,
+                                        set<ShardId>* usedShards) {
+    const auto candidate = findHotChunk(shardStats, distribution, *usedShards);
+    if (!candidate || !candidate->movable)
+        return false;
+
+    const ChunkType& chunk = *candidate->chunk;
+
+    LOG(1) << "Moving chunk " << redact(chunk.toString()) << " with write load "
+           << distribution.opLoadOfChunk(chunk) << " to " << candidate->to
+           << " to even out the write load";
+
+    migrations->emplace_back(candidate->to, chunk);
+    invariant(usedShards->insert(chunk.getShard()).second);
+    invariant(usedShards->insert(candidate->to).second);
+    return true;
+}
+
 ZoneRange::ZoneRange(const BSONObj& a_min, const BSONObj& a_max, const std::string& _zone)
     : min(a_min.getOwned()), max(a_max.getOwned()), zone(_zone) {}
 
@@ -557,4 +887,40 @@ string MigrateInfo::toString() const {
                          << to;
 }
 
+MergeInfo::MergeInfo(const ChunkType& firstChunk, const ChunkType& lastChunk, size_t a_numChunks)
+    : ns(firstChunk.getNS()),
+      shardId(firstChunk.getShard()),
+      minKey(firstChunk.getMin()),
+      maxKey(lastChunk.getMax()),
+      numChunks(a_numChunks) {
+    invariant(firstChunk.getShard() == lastChunk.getShard());
+}
+
+string MergeInfo::toString() const {
+    return str::stream() << ns << ": [" << minKey << ", " << maxKey << "), " << numChunks
+                         << " chunks on " << shardId;
+}
+
+MigrationRoundLimits::MigrationRoundLimits(size_t maxMigrationsPerDonor)
+    : _maxMigrationsPerDonor(maxMigrationsPerDonor) {
+    invariant(_maxMigrationsPerDonor > 0);
+}
+
+bool MigrationRoundLimits::tryAdd(const MigrateInfo& migration) {
+    // Recipients are always busy, so this also rules out donating from a recipient, and a donor
+    // which has not reached its limit yet still cannot receive
+    if (_busyShards.count(migration.from) || _busyShards.count(migration.to) ||
+        _numMigrationsPerDonor.count(migration.to)) {
+        return false;
+    }
+
+    if (++_numMigrationsPerDonor[migration.from] == _maxMigrationsPerDonor) {
+        _busyShards.insert(migration.from);
+    }
+
+    _busyShards.insert(migration.to);
+
+    return true;
+}
+
 }  // namespace mongo
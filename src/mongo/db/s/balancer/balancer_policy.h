@@ -62,9 +62,61 @@ struct MigrateInfo {
     ChunkVersion version;
 };
 
+/**
+ * Describes a run of adjacent chunks, which are all owned by the same shard and can be merged into
+ * a single chunk.
+ */
+struct MergeInfo {
+    MergeInfo(const ChunkType& firstChunk, const ChunkType& lastChunk, size_t a_numChunks);
+
+    std::string toString() const;
+
+    std::string ns;
+    ShardId shardId;
+    BSONObj minKey;
+    BSONObj maxKey;
+    size_t numChunks;
+};
+
 typedef std::vector<ClusterStatistics::ShardStatistics> ShardStatisticsVector;
 typedef std::map<ShardId, std::vector<ChunkType>> ShardToChunksMap;
 
+/**
+ * Keeps track of the shards, which take part in the migrations selected for a balancer round across
+ * all collections, so that the round can run several migrations off the same donor at the same
+ * time. A shard may donate chunks of up to 'maxMigrationsPerDonor' collections, but it may receive
+ * only one chunk and may not donate and receive chunks at the same time, which mirrors what the
+ * shards themselves allow.
+ */
+class MigrationRoundLimits {
+public:
+    explicit MigrationRoundLimits(size_t maxMigrationsPerDonor);
+
+    /**
+     * Returns the shards, which cannot take part in any further migrations in this round, neither
+     * as donors nor as recipients.
+     */
+    const std::set<ShardId>& getBusyShards() const {
+        return _busyShards;
+    }
+
+    /**
+     * If the specified migration fits within the limits given the migrations which have already
+     * been added, accounts for it and returns true. Otherwise returns false.
+     */
+    bool tryAdd(const MigrateInfo& migration);
+
+private:
+    // Maximum number of chunks, which a single shard may donate in the round
+    const size_t _maxMigrationsPerDonor;
+
+    // Number of chunks, which each shard donates in the round
+    std::map<ShardId, size_t> _numMigrationsPerDonor;
+
+    // Recipients and donors, which have reached '_maxMigrationsPerDonor'
+    std::set<ShardId> _busyShards;
+};
+
 /**
  * This class constitutes a cache of the chunk distribution across the entire cluster along with the
  * zone boundaries imposed on it. This information is stored in format, which makes it efficient to
@@ -136,6 +188,33 @@ public:
      */
     std::string getTagForChunk(const ChunkType& chunk) const;
 
+    /**
+     * Records the recent write load which the specified shard reported for one of its chunks.
+     * Reports for chunks which the shard no longer owns, or which have since been split or merged,
+     * are ignored.
+     */
+    void addChunkOpStatistics(const ShardId& shardId,
+                              const ClusterStatistics::ChunkOpStatistics& stats);
+
+    /**
+     * Returns whether the write load of any chunk is known.
+     */
+    bool hasOpLoad() const {
+        return !_chunkOpStats.empty();
+    }
+
+    /**
+     * Returns the write load statistics of the specified chunk or nullptr if none were reported.
+     */
+    const ClusterStatistics::ChunkOpStatistics* getChunkOpStatistics(const ChunkType& chunk) const;
+
+    /**
+     * Returns the recent write load on the specified chunk, or on all the chunks of the specified
+     * shard. Chunks without reported statistics count as having no load.
+     */
+    uint64_t opLoadOfChunk(const ChunkType& chunk) const;
+    uint64_t opLoadOfShard(const ShardId& shardId) const;
+
     /**
      * Returns a BSON/string representation of this distribution status.
      */
@@ -154,6 +233,9 @@ private:
 
     // Set of all zones defined for this collection
     std::set<std::string> _allTags;
+
+    // Map of chunk min key to the shard, which reported the chunk's write load, and the load
+    BSONObjIndexedMap<std::pair<ShardId, ClusterStatistics::ChunkOpStatistics>> _chunkOpStats;
 };
 
 class BalancerPolicy {
@@ -182,7 +264,19 @@ public:
      */
     static std::vector<MigrateInfo> balance(const ShardStatisticsVector& shardStats,
                                             const DistributionStatus& distribution,
-                                            bool shouldAggressivelyBalance);
+                                            bool shouldAggressivelyBalance) {
+        return balance(shardStats, distribution, shouldAggressivelyBalance, std::set<ShardId>());
+    }
+
+    /**
+     * Same as above, except that none of the shards in 'busyShards' is used as either the source
+     * or the destination of a migration, because they are already busy with the migrations of
+     * other collections.
+     */
+    static std::vector<MigrateInfo> balance(const ShardStatisticsVector& shardStats,
+                                            const DistributionStatus& distribution,
+                                            bool shouldAggressivelyBalance,
+                                            const std::set<ShardId>& busyShards);
 
     /**
      * Using the specified distribution information, returns a suggested better location for the
@@ -192,6 +286,26 @@ public:
                                                            const ShardStatisticsVector& shardStats,
                                                            const DistributionStatus& distribution);
 
+    /**
+     * If the write load of the collection is unevenly spread across the shards, but the hottest
+     * shard's chunks are all too hot to be moved without just moving the hot spot, returns the
+     * hottest of them so that it can be split at its median key. Returns boost::none otherwise.
+     */
+    static boost::optional<ClusterStatistics::ChunkOpStatistics> selectHotChunkToSplit(
+        const ShardStatisticsVector& shardStats, const DistributionStatus& distribution);
+
+    /**
+     * Returns the runs of adjacent chunks of the same shard and zone, which can be merged in order
+     * to reduce the number of chunks of the collection without moving any data. Each run consists
+     * of at most 'maxChunksPerMerge' chunks. Runs are shortened or skipped so that no shard ends up
+     * with so few chunks that balance() would move chunks back to it. Jumbo chunks are left alone,
+     * and so are chunks with recent write load, as reported in 'distribution', since they would
+     * only be split again. Draining shards are skipped.
+     */
+    static std::vector<MergeInfo> selectChunksToMerge(const ShardStatisticsVector& shardStats,
+                                                      const DistributionStatus& distribution,
+                                                      size_t maxChunksPerMerge);
+
 private:
     /**
      * Return the shard with the specified tag, which has the least number of chunks. If the tag is
@@ -230,6 +344,19 @@ private:
                                    size_t imbalanceThreshold,
                                    std::vector<MigrateInfo>* migrations,
                                    std::set<ShardId>* usedShards);
+
+    /**
+     * Selects one chunk to be moved from the shard with the highest write load to the shard with
+     * the lowest, if the load is sufficiently uneven and moving the chunk brings the two closer
+     * together. Takes into account and updates the shards, which have already been used for
+     * migrations.
+     *
+     * Returns true if a migration was suggested, false otherwise.
+     */
+    static bool _singleLoadBalance(const ShardStatisticsVector& shardStats,
+                                   const DistributionStatus& distribution,
+                                   std::vector<MigrateInfo>* migrations,
+                                   std::set<ShardId>* usedShards);
 };
 
 }  // namespace mongo
@@ -30,6 +30,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/s/balancer/balancer_policy.h"
 #include "mongo/platform/random.h"
@@ -553,6 +554,275 @@ TEST(BalancerPolicy, BalancerHandlesNoShardsWithTag) {
     ASSERT(BalancerPolicy::balance(cluster.first, distribution, false).empty());
 }
 
+/**
+ * Records the specified write load for a chunk, as if the shard owning it had reported it.
+ */
+void addOpLoad(DistributionStatus* distribution,
+               const ChunkType& chunk,
+               uint64_t numOps,
+               BSONObj medianKey = BSONObj()) {
+    ClusterStatistics::ChunkOpStatistics stats;
+    stats.min = chunk.getMin();
+    stats.max = chunk.getMax();
+    stats.numOps = numOps;
+    stats.medianKey = medianKey;
+    distribution->addChunkOpStatistics(chunk.getShard(), stats);
+}
+
+TEST(BalancerPolicy, BalancerMovesColdestChunkToEvenOutChunkCounts) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId2, kNoMaxSize, 3, false, emptyTagSet, emptyShardVersion), 3}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addOpLoad(&distribution, cluster.second[kShardId0][0], 100);
+    addOpLoad(&distribution, cluster.second[kShardId0][1], 50);
+    addOpLoad(&distribution, cluster.second[kShardId0][3], 100);
+
+    const auto migrations(BalancerPolicy::balance(cluster.first, distribution, false));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId1, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][2].getMin(), migrations[0].minKey);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][2].getMax(), migrations[0].maxKey);
+}
+
+TEST(BalancerPolicy, BalancerMovesHotChunkToColdestShardWhenChunkCountsAreEven) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 3, false, emptyTagSet, emptyShardVersion), 3},
+         {ShardStatistics(kShardId1, kNoMaxSize, 3, false, emptyTagSet, emptyShardVersion), 3},
+         {ShardStatistics(kShardId2, kNoMaxSize, 3, false, emptyTagSet, emptyShardVersion), 3}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addOpLoad(&distribution, cluster.second[kShardId0][0], 1000);
+    addOpLoad(&distribution, cluster.second[kShardId0][1], 2000);
+    addOpLoad(&distribution, cluster.second[kShardId0][2], 2000);
+    addOpLoad(&distribution, cluster.second[kShardId1][0], 1000);
+
+    const auto migrations(BalancerPolicy::balance(cluster.first, distribution, false));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId2, migrations[0].to);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), migrations[0].minKey);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMax(), migrations[0].maxKey);
+
+    ASSERT(!BalancerPolicy::selectHotChunkToSplit(cluster.first, distribution));
+}
+
+TEST(BalancerPolicy, BalancerSplitsChunkTooHotToBeMoved) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 3, false, emptyTagSet, emptyShardVersion), 3},
+         {ShardStatistics(kShardId1, kNoMaxSize, 3, false, emptyTagSet, emptyShardVersion), 3}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    addOpLoad(&distribution, cluster.second[kShardId0][1], 6000, BSON("x" << 1.5));
+    addOpLoad(&distribution, cluster.second[kShardId1][0], 1000);
+
+    const auto migrations(BalancerPolicy::balance(cluster.first, distribution, false));
+    ASSERT(migrations.empty());
+
+    const auto hotChunk = BalancerPolicy::selectHotChunkToSplit(cluster.first, distribution);
+    ASSERT(hotChunk);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMin(), hotChunk->min);
+    ASSERT_BSONOBJ_EQ(BSON("x" << 1.5), hotChunk->medianKey);
+}
+
+TEST(BalancerPolicy, BalancerIgnoresLoadOfChunksWhichHaveMoved) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 2, false, emptyTagSet, emptyShardVersion), 2},
+         {ShardStatistics(kShardId1, kNoMaxSize, 2, false, emptyTagSet, emptyShardVersion), 2}});
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+
+    // Reported by a shard, which no longer owns the chunk
+    ClusterStatistics::ChunkOpStatistics stats;
+    stats.min = cluster.second[kShardId0][0].getMin();
+    stats.max = cluster.second[kShardId0][0].getMax();
+    stats.numOps = 5000;
+    distribution.addChunkOpStatistics(kShardId1, stats);
+
+    ASSERT_EQ(0U, distribution.opLoadOfShard(kShardId0));
+    ASSERT_EQ(0U, distribution.opLoadOfShard(kShardId1));
+    ASSERT(BalancerPolicy::balance(cluster.first, distribution, false).empty());
+}
+
+TEST(BalancerPolicy, DrainingSkipsShardsBusyWithOtherCollections) {
+    // shard1 would be the preferred recipient, but it is already receiving a chunk of another
+    // collection
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 2, true, emptyTagSet, emptyShardVersion), 2},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId2, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 5}});
+
+    const auto migrations(BalancerPolicy::balance(cluster.first,
+                                                  DistributionStatus(kNamespace, cluster.second),
+                                                  false,
+                                                  std::set<ShardId>{kShardId1}));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId2, migrations[0].to);
+
+    // The draining shard is busy, so only the rest of the cluster is balanced
+    const auto otherMigrations(
+        BalancerPolicy::balance(cluster.first,
+                                DistributionStatus(kNamespace, cluster.second),
+                                false,
+                                std::set<ShardId>{kShardId0}));
+    ASSERT_EQ(1U, otherMigrations.size());
+    ASSERT_EQ(kShardId2, otherMigrations[0].from);
+    ASSERT_EQ(kShardId1, otherMigrations[0].to);
+}
+
+TEST(MigrationRoundLimits, DonorMayDonateUpToTheLimitToDistinctRecipients) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 4, true, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 1, false, emptyTagSet, emptyShardVersion), 1},
+         {ShardStatistics(kShardId2, kNoMaxSize, 1, false, emptyTagSet, emptyShardVersion), 1},
+         {ShardStatistics(kShardId3, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId4, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    const auto& donorChunks = cluster.second[kShardId0];
+
+    MigrationRoundLimits roundLimits(2);
+    ASSERT(roundLimits.tryAdd(MigrateInfo(kShardId2, donorChunks[0])));
+
+    // A recipient may not receive a second chunk
+    ASSERT(!roundLimits.tryAdd(MigrateInfo(kShardId2, donorChunks[1])));
+
+    // A donor, which has not reached the limit, may not receive
+    ASSERT(!roundLimits.tryAdd(MigrateInfo(kShardId0, cluster.second[kShardId1][0])));
+
+    // A recipient may not donate
+    ASSERT(!roundLimits.tryAdd(MigrateInfo(kShardId4, cluster.second[kShardId2][0])));
+
+    ASSERT(roundLimits.tryAdd(MigrateInfo(kShardId3, donorChunks[1])));
+
+    // The donor has reached the limit
+    ASSERT(!roundLimits.tryAdd(MigrateInfo(kShardId4, donorChunks[2])));
+
+    ASSERT_EQ(3U, roundLimits.getBusyShards().size());
+    ASSERT_EQ(1U, roundLimits.getBusyShards().count(kShardId0));
+    ASSERT_EQ(1U, roundLimits.getBusyShards().count(kShardId2));
+    ASSERT_EQ(1U, roundLimits.getBusyShards().count(kShardId3));
+}
+
+/**
+ * Replaces the chunks of each of the specified runs with a single chunk, as merging them would.
+ */
+void applyMerges(ShardToChunksMap* chunkMap, const vector<MergeInfo>& merges) {
+    for (const auto& merge : merges) {
+        auto& chunks = (*chunkMap)[merge.shardId];
+        auto first = std::find_if(chunks.begin(), chunks.end(), [&merge](const ChunkType& chunk) {
+            return SimpleBSONObjComparator::kInstance.evaluate(chunk.getMin() == merge.minKey);
+        });
+        ASSERT(first != chunks.end());
+
+        first->setMax(merge.maxKey);
+        chunks.erase(first + 1, first + merge.numChunks);
+    }
+}
+
+TEST(BalancerPolicy, MergeAdjacentChunksOfEachShard) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 10, false, emptyTagSet, emptyShardVersion), 10},
+         {ShardStatistics(kShardId1, kNoMaxSize, 10, false, emptyTagSet, emptyShardVersion), 10}});
+
+    const auto merges(BalancerPolicy::selectChunksToMerge(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), 16));
+    ASSERT_EQ(2U, merges.size());
+
+    // Each run is shortened, so that the shards stay within the imbalance threshold
+    ASSERT_EQ(kShardId0, merges[0].shardId);
+    ASSERT_EQ(2U, merges[0].numChunks);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMin(), merges[0].minKey);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][1].getMax(), merges[0].maxKey);
+
+    ASSERT_EQ(kShardId1, merges[1].shardId);
+    ASSERT_EQ(3U, merges[1].numChunks);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId1][0].getMin(), merges[1].minKey);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId1][2].getMax(), merges[1].maxKey);
+
+    applyMerges(&cluster.second, merges);
+    ASSERT(BalancerPolicy::balance(
+               cluster.first, DistributionStatus(kNamespace, cluster.second), false)
+               .empty());
+}
+
+TEST(BalancerPolicy, MergeRespectsTheMaxChunksPerMerge) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8},
+         {ShardStatistics(kShardId1, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8},
+         {ShardStatistics(kShardId2, kNoMaxSize, 8, false, emptyTagSet, emptyShardVersion), 8}});
+
+    const auto merges(BalancerPolicy::selectChunksToMerge(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), 4));
+    ASSERT_EQ(2U, merges.size());
+
+    ASSERT_EQ(kShardId0, merges[0].shardId);
+    ASSERT_EQ(4U, merges[0].numChunks);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][0].getMin(), merges[0].minKey);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][3].getMax(), merges[0].maxKey);
+
+    ASSERT_EQ(kShardId0, merges[1].shardId);
+    ASSERT_EQ(2U, merges[1].numChunks);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][4].getMin(), merges[1].minKey);
+    ASSERT_BSONOBJ_EQ(cluster.second[kShardId0][5].getMax(), merges[1].maxKey);
+
+    applyMerges(&cluster.second, merges);
+    ASSERT(BalancerPolicy::balance(
+               cluster.first, DistributionStatus(kNamespace, cluster.second), false)
+               .empty());
+}
+
+TEST(BalancerPolicy, MergeStopsAtHotJumboZonedAndNonAdjacentChunks) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 9, false, emptyTagSet, emptyShardVersion), 9},
+         {ShardStatistics(kShardId1, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4}});
+
+    auto& shard0Chunks = cluster.second[kShardId0];
+    shard0Chunks[2].setJumbo(true);
+
+    // Chunk [6, 7) is owned by shard1, so [5, 6) and [7, 8) are not adjacent
+    ChunkType movedChunk = shard0Chunks[6];
+    movedChunk.setShard(kShardId1);
+    cluster.second[kShardId1].insert(cluster.second[kShardId1].begin(), movedChunk);
+    shard0Chunks.erase(shard0Chunks.begin() + 6);
+
+    DistributionStatus distribution(kNamespace, cluster.second);
+    ASSERT_OK(distribution.addRangeToZone(ZoneRange(BSON("x" << 3), BSON("x" << 5), "a")));
+    addOpLoad(&distribution, shard0Chunks[1], 100);
+
+    const auto merges(BalancerPolicy::selectChunksToMerge(cluster.first, distribution, 16));
+    ASSERT_EQ(3U, merges.size());
+
+    ASSERT_EQ(kShardId0, merges[0].shardId);
+    ASSERT_EQ(2U, merges[0].numChunks);
+    ASSERT_BSONOBJ_EQ(BSON("x" << 3), merges[0].minKey);
+    ASSERT_BSONOBJ_EQ(BSON("x" << 5), merges[0].maxKey);
+
+    ASSERT_EQ(kShardId0, merges[1].shardId);
+    ASSERT_EQ(2U, merges[1].numChunks);
+    ASSERT_BSONOBJ_EQ(BSON("x" << 7), merges[1].minKey);
+    ASSERT_BSONOBJ_EQ(BSON("x" << 9), merges[1].maxKey);
+
+    // The run of shard1 is shortened, so that it keeps as many chunks as shard0
+    ASSERT_EQ(kShardId1, merges[2].shardId);
+    ASSERT_EQ(3U, merges[2].numChunks);
+    ASSERT_BSONOBJ_EQ(BSON("x" << 9), merges[2].minKey);
+    ASSERT_BSONOBJ_EQ(BSON("x" << 12), merges[2].maxKey);
+}
+
+TEST(BalancerPolicy, MergeSkipsDrainingShards) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 3, true, emptyTagSet, emptyShardVersion), 3},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    const auto merges(BalancerPolicy::selectChunksToMerge(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), 16));
+    ASSERT(merges.empty());
+}
+
 TEST(DistributionStatus, AddTagRangeOverlap) {
     DistributionStatus d(kNamespace, ShardToChunksMap{});
 
@@ -28,17 +28,18 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
 #include "mongo/s/client/shard.h"
 
 namespace mongo {
 
-class BSONObj;
 class OperationContext;
 template <typename T>
 class StatusWith;
@@ -52,6 +53,22 @@ class ClusterStatistics {
     MONGO_DISALLOW_COPYING(ClusterStatistics);
 
 public:
+    /**
+     * Structure, which describes the recent write load on a single chunk, as recorded by the shard
+     * which owns it.
+     */
+    struct ChunkOpStatistics {
+        BSONObj min;
+        BSONObj max;
+
+        // Number of write operations and bytes written, decayed over time by the shard
+        uint64_t numOps{0};
+        uint64_t numBytes{0};
+
+        // Median of the shard keys recently written to or empty if unknown
+        BSONObj medianKey;
+    };
+
     /**
      * Structure, which describes the statistics of a single shard host.
      */
@@ -92,6 +109,10 @@ public:
 
         // Version of mongod, which runs on this shard's primary
         std::string mongoVersion;
+
+        // The chunks of each collection with the highest write load on this shard. Only collected
+        // if load-based balancing is enabled.
+        std::map<std::string, std::vector<ChunkOpStatistics>> chunkOpStats;
     };
 
     virtual ~ClusterStatistics();
@@ -35,6 +35,7 @@
 #include "mongo/base/status_with.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/client/read_preference.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/sharding_catalog_client.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/client/shard_registry.h"
@@ -48,10 +49,17 @@ namespace mongo {
 using std::string;
 using std::vector;
 
+using ChunkOpStatistics = ClusterStatistics::ChunkOpStatistics;
+
 namespace {
 
 const char kVersionField[] = "version";
 
+// When enabled, the balancer collects the recent write load on the chunks of every shard and, in
+// addition to evening out the number of chunks, moves and splits hot chunks so that the load is
+// spread evenly too. Requires trackChunkOpLoad to be enabled on the shards.
+MONGO_EXPORT_SERVER_PARAMETER(balancerBalanceByOpLoad, bool, false);
+
 /**
  * Executes the serverStatus command against the specified shard and obtains the version of the
  * running MongoD service.
@@ -92,6 +100,118 @@ StatusWith<string> retrieveShardMongoDVersion(OperationContext* opCtx, ShardId s
     return version;
 }
 
+/**
+ * Parses a single chunk entry of the _getChunkOpLoad response.
+ */
+StatusWith<ChunkOpStatistics> parseChunkOpStatistics(const BSONObj& obj) {
+    ChunkOpStatistics stats;
+
+    BSONElement elem;
+    Status status = bsonExtractTypedField(obj, "min", Object, &elem);
+    if (!status.isOK()) {
+        return status;
+    }
+    stats.min = elem.Obj().getOwned();
+
+    status = bsonExtractTypedField(obj, "max", Object, &elem);
+    if (!status.isOK()) {
+        return status;
+    }
+    stats.max = elem.Obj().getOwned();
+
+    long long numOps;
+    status = bsonExtractIntegerField(obj, "ops", &numOps);
+    if (!status.isOK()) {
+        return status;
+    }
+    stats.numOps = numOps;
+
+    long long numBytes;
+    status = bsonExtractIntegerField(obj, "bytes", &numBytes);
+    if (!status.isOK()) {
+        return status;
+    }
+    stats.numBytes = numBytes;
+
+    if (obj.hasField("medianKey")) {
+        status = bsonExtractTypedField(obj, "medianKey", Object, &elem);
+        if (!status.isOK()) {
+            return status;
+        }
+        stats.medianKey = elem.Obj().getOwned();
+    }
+
+    return stats;
+}
+
+/**
+ * Executes the _getChunkOpLoad command against the specified shard and obtains the chunks of each
+ * collection with the highest recent write load, keyed by namespace.
+ */
+StatusWith<std::map<string, vector<ChunkOpStatistics>>> retrieveShardChunkOpLoad(
+    OperationContext* opCtx, ShardId shardId) {
+    auto shardStatus = Grid::get(opCtx)->shardRegistry()->getShard(opCtx, shardId);
+    if (!shardStatus.isOK()) {
+        return shardStatus.getStatus();
+    }
+
+    auto commandResponse = shardStatus.getValue()->runCommandWithFixedRetryAttempts(
+        opCtx,
+        ReadPreferenceSetting{ReadPreference::PrimaryOnly},
+        "admin",
+        BSON("_getChunkOpLoad" << 1),
+        Shard::RetryPolicy::kIdempotent);
+    if (!commandResponse.isOK()) {
+        return commandResponse.getStatus();
+    }
+    if (!commandResponse.getValue().commandStatus.isOK()) {
+        return commandResponse.getValue().commandStatus;
+    }
+
+    const BSONObj& response = commandResponse.getValue().response;
+
+    BSONElement collectionsElem;
+    Status status = bsonExtractTypedField(response, "collections", Array, &collectionsElem);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    std::map<string, vector<ChunkOpStatistics>> chunkOpStats;
+    for (const auto& collectionElem : collectionsElem.Obj()) {
+        if (collectionElem.type() != Object) {
+            return {ErrorCodes::TypeMismatch, "Expected an object for each collection entry"};
+        }
+        const BSONObj collection = collectionElem.Obj();
+
+        string ns;
+        status = bsonExtractStringField(collection, "ns", &ns);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        BSONElement chunksElem;
+        status = bsonExtractTypedField(collection, "chunks", Array, &chunksElem);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        auto& nsChunkOpStats = chunkOpStats[ns];
+        for (const auto& chunkElem : chunksElem.Obj()) {
+            if (chunkElem.type() != Object) {
+                return {ErrorCodes::TypeMismatch, "Expected an object for each chunk entry"};
+            }
+
+            auto chunkStatsStatus = parseChunkOpStatistics(chunkElem.Obj());
+            if (!chunkStatsStatus.isOK()) {
+                return chunkStatsStatus.getStatus();
+            }
+            nsChunkOpStats.push_back(std::move(chunkStatsStatus.getValue()));
+        }
+    }
+
+    return chunkOpStats;
+}
+
 }  // namespace
 
 using ShardStatistics = ClusterStatistics::ShardStatistics;
@@ -159,6 +279,18 @@ StatusWith<vector<ShardStatistics>> ClusterStatisticsImpl::getStats(OperationCon
                            shard.getDraining(),
                            std::move(shardTags),
                            std::move(mongoDVersion));
+
+        if (balancerBalanceByOpLoad.load()) {
+            auto chunkOpLoadStatus = retrieveShardChunkOpLoad(opCtx, shard.getName());
+            if (chunkOpLoadStatus.isOK()) {
+                stats.back().chunkOpStats = std::move(chunkOpLoadStatus.getValue());
+            } else {
+                // Without the load of a shard, its collections are balanced by chunk count only,
+                // so there is no need to fail the entire round
+                log() << "Unable to obtain chunk write load for " << shard.getName()
+                      << causedBy(chunkOpLoadStatus.getStatus());
+            }
+        }
     }
 
     return stats;
@@ -34,6 +34,7 @@
 
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_catalog.h"
@@ -53,12 +54,15 @@
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/metadata_manager.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -72,6 +76,58 @@ namespace {
 const WriteConcernOptions kMajorityWriteConcern(WriteConcernOptions::kMajority,
                                                 WriteConcernOptions::SyncMode::UNSET,
                                                 Seconds(60));
+
+// When positive, the number of documents deleted per batch is adjusted after each batch so that
+// batches take about this long, starting from the batch size requested by the caller. When zero,
+// every batch deletes up to the requested number of documents.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchTargetMillis, int, 0);
+
+// Upper bound on the number of documents per batch when batches are sized adaptively.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxBatchSize, int, 10000);
+
+// When positive, range deletion pauses while the majority commit point trails this node's last
+// applied optime by more than this many seconds, so that orphan cleanup does not add to the lag of
+// secondaries which are already behind.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxMajorityLagSecs, int, 0);
+
+// When true, range deletion pauses while the storage engine reports that its cache is under
+// eviction pressure.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterThrottleOnCachePressure, bool, false);
+
+// How long a paused range deletion waits before checking again whether it may proceed.
+const Milliseconds kThrottleRetryInterval(500);
+
+// Documents of a batch are deleted in write units of work of at most this many documents.
+const size_t kMaxDeletesPerWriteUnit = 64;
+
+/**
+ * Returns why the next batch of range deletion should be postponed, or boost::none if it may
+ * proceed now.
+ */
+boost::optional<std::string> checkThrottle(OperationContext* opCtx) {
+    const int maxLagSecs = rangeDeleterMaxMajorityLagSecs.load();
+    auto replCoord = repl::ReplicationCoordinator::get(opCtx);
+    if (maxLagSecs > 0 &&
+        replCoord->getReplicationMode() == repl::ReplicationCoordinator::modeReplSet) {
+        const long long lastAppliedSecs =
+            replCoord->getMyLastAppliedOpTime().getTimestamp().getSecs();
+        const long long lastCommittedSecs =
+            replCoord->getLastCommittedOpTime().getTimestamp().getSecs();
+        if (lastAppliedSecs - lastCommittedSecs > maxLagSecs) {
+            return std::string(str::stream() << "majority commit point is "
+                                             << (lastAppliedSecs - lastCommittedSecs)
+                                             << " seconds behind");
+        }
+    }
+
+    if (rangeDeleterThrottleOnCachePressure.load() &&
+        opCtx->getServiceContext()->getGlobalStorageEngine()->isCacheUnderPressure()) {
+        return std::string("storage engine cache is under pressure");
+    }
+
+    return boost::none;
+}
+
 }  // unnamed namespace
 
 CollectionRangeDeleter::~CollectionRangeDeleter() {
@@ -168,10 +224,21 @@ auto CollectionRangeDeleter::cleanUpNextRange(OperationContext* opCtx,
                 // clang-format on
             }
 
+            if (auto reason = checkThrottle(opCtx)) {
+                LOG(1) << "Postponing deletion of " << nss.ns() << " range "
+                       << redact(range->toString()) << " because the " << *reason;
+                return Date_t::now() + kThrottleRetryInterval;
+            }
+
             try {
                 auto keyPattern = scopedCollectionMetadata->getKeyPattern();
 
-                wrote = self->_doDeletion(opCtx, collection, keyPattern, *range, maxToDelete);
+                const int batchSize = self->_nextBatchSize(maxToDelete);
+                Timer batchTimer;
+                wrote = self->_doDeletion(opCtx, collection, keyPattern, *range, batchSize);
+                if (wrote.isOK()) {
+                    self->_adjustBatchSize(batchSize, wrote.getValue(), batchTimer.millis());
+                }
             } catch (const DBException& e) {
                 wrote = e.toStatus();
                 warning() << e.what();
@@ -278,42 +345,93 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
         saver.emplace("moveChunk", nss.ns(), "cleaning");
     }
 
-    int numDeleted = 0;
-    do {
+    // Collect the whole batch with a single index scan, which does not need to fetch the documents.
+    std::vector<RecordId> recordIds;
+    {
         auto halfOpen = BoundInclusion::kIncludeStartKeyOnly;
         auto manual = PlanExecutor::YIELD_MANUAL;
         auto forward = InternalPlanner::FORWARD;
-        auto fetch = InternalPlanner::IXSCAN_FETCH;
 
         auto exec = InternalPlanner::indexScan(
-            opCtx, collection, descriptor, min, max, halfOpen, manual, forward, fetch);
+            opCtx, collection, descriptor, min, max, halfOpen, manual, forward);
 
         RecordId rloc;
         BSONObj obj;
-        PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
-        if (state == PlanExecutor::IS_EOF) {
-            break;
-        }
-        if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
-            warning(LogComponent::kSharding)
-                << PlanExecutor::statestr(state) << " - cursor error while trying to delete " << min
-                << " to " << max << " in " << nss << ": " << WorkingSetCommon::toStatusString(obj)
-                << ", stats: " << Explain::getWinningPlanStats(exec.get());
-            break;
+        while (recordIds.size() < static_cast<size_t>(maxToDelete)) {
+            PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
+            if (state == PlanExecutor::IS_EOF) {
+                break;
+            }
+            if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
+                warning(LogComponent::kSharding)
+                    << PlanExecutor::statestr(state) << " - cursor error while trying to delete "
+                    << min << " to " << max << " in " << nss << ": "
+                    << WorkingSetCommon::toStatusString(obj)
+                    << ", stats: " << Explain::getWinningPlanStats(exec.get());
+                break;
+            }
+            invariant(PlanExecutor::ADVANCED == state);
+            recordIds.push_back(rloc);
         }
-        invariant(PlanExecutor::ADVANCED == state);
+    }
 
+    // Shard key order is usually unrelated to the order of the records in the record store, so
+    // deleting in RecordId order instead touches each page of the collection far fewer times.
+    std::sort(recordIds.begin(), recordIds.end());
+
+    for (size_t start = 0; start < recordIds.size(); start += kMaxDeletesPerWriteUnit) {
+        const size_t end = std::min(recordIds.size(), start + kMaxDeletesPerWriteUnit);
         writeConflictRetry(opCtx, "delete range", nss.ns(), [&] {
             WriteUnitOfWork wuow(opCtx);
-            if (saver) {
-                saver->goingToDelete(obj).transitional_ignore();
+            for (size_t i = start; i < end; ++i) {
+                Snapshotted<BSONObj> doc;
+                if (!collection->findDoc(opCtx, recordIds[i], &doc)) {
+                    continue;
+                }
+                if (saver) {
+                    saver->goingToDelete(doc.value()).transitional_ignore();
+                }
+                collection->deleteDocument(
+                    opCtx, kUninitializedStmtId, recordIds[i], nullptr, true);
             }
-            collection->deleteDocument(opCtx, kUninitializedStmtId, rloc, nullptr, true);
             wuow.commit();
         });
-    } while (++numDeleted < maxToDelete);
+    }
+
+    // Documents which disappeared after the index scan still count, so that a batch which found
+    // any documents is never mistaken for the end of the range.
+    return static_cast<int>(recordIds.size());
+}
+
+int CollectionRangeDeleter::_nextBatchSize(int maxToDelete) const {
+    if (rangeDeleterBatchTargetMillis.load() <= 0 || _batchSize == 0) {
+        return maxToDelete;
+    }
+    return _batchSize;
+}
+
+void CollectionRangeDeleter::_adjustBatchSize(int batchSize, int numDeleted, int elapsedMillis) {
+    const int targetMillis = rangeDeleterBatchTargetMillis.load();
+    if (targetMillis <= 0) {
+        _batchSize = 0;
+        return;
+    }
+
+    // A batch which reached the end of the range says little about how long a full one would take.
+    if (numDeleted < batchSize) {
+        return;
+    }
+
+    // Grow slowly, but shrink straight to the size which would have met the target.
+    long long next = batchSize;
+    if (elapsedMillis * 2 < targetMillis) {
+        next = 2LL * batchSize;
+    } else if (elapsedMillis > targetMillis) {
+        next = static_cast<long long>(batchSize) * targetMillis / elapsedMillis;
+    }
 
-    return numDeleted;
+    const long long maxBatchSize = std::max(1, rangeDeleterMaxBatchSize.load());
+    _batchSize = static_cast<int>(std::max(1LL, std::min(next, maxBatchSize)));
 }
 
 namespace {
@@ -153,6 +153,11 @@ public:
      * watchers of ranges as they are done being deleted. It performs its own collection locking, so
      * it must be called without locks.
      *
+     * If rangeDeleterBatchTargetMillis is set, maxToDelete is only the size of the first batch and
+     * later batches are sized by how long earlier ones took. A batch may also be postponed, while
+     * replication to a majority lags or the storage engine cache is under pressure, as configured
+     * by rangeDeleterMaxMajorityLagSecs and rangeDeleterThrottleOnCachePressure.
+     *
      * If it should be scheduled to run again because there might be more documents to delete,
      * returns the time to begin, or boost::none otherwise.
      *
@@ -168,8 +173,8 @@ public:
 
 private:
     /**
-     * Performs the deletion of up to maxToDelete entries within the range in progress. Must be
-     * called under the collection lock.
+     * Performs the deletion of up to maxToDelete entries within the range in progress, in RecordId
+     * order. Must be called under the collection lock.
      *
      * Returns the number of documents deleted, 0 if done with the range, or bad status if deleting
      * the range failed.
@@ -180,6 +185,18 @@ private:
                                 ChunkRange const& range,
                                 int maxToDelete);
 
+    /**
+     * Returns the number of documents to delete in the next batch, which is maxToDelete unless
+     * batches are being sized adaptively.
+     */
+    int _nextBatchSize(int maxToDelete) const;
+
+    /**
+     * Updates the adaptive batch size from a batch of batchSize documents which deleted numDeleted
+     * of them in elapsedMillis.
+     */
+    void _adjustBatchSize(int batchSize, int numDeleted, int elapsedMillis);
+
     /**
      * Removes the latest-scheduled range from the ranges to be cleaned up, and notifies any
      * interested callers of this->overlaps(range) with specified status.
@@ -192,6 +209,10 @@ private:
      */
     std::list<Deletion> _orphans;
     std::list<Deletion> _delayedOrphans;
+
+    // Number of documents to delete in the next batch when batches are sized adaptively, or 0 if
+    // not yet known. Only used by cleanUpNextRange, so it is not protected by the manager lock.
+    int _batchSize{0};
 };
 
 }  // namespace mongo
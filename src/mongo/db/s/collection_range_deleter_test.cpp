@@ -43,12 +43,14 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context_d_test_fixture.h"
 #include "mongo/s/balancer_configuration.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/sharding_mongod_test_fixture.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -403,5 +405,55 @@ TEST_F(CollectionRangeDeleterTest, MultipleDocumentsInMultipleRangesToClean) {
     ASSERT_FALSE(next(rangeDeleter, 1));
 }
 
+// Tests that a batch deletes the lowest shard keys in the range even though it deletes them in
+// RecordId order, which here is the reverse of shard key order.
+TEST_F(CollectionRangeDeleterTest, BatchDeletesLowestKeysOfRangeInRecordIdOrder) {
+    CollectionRangeDeleter rangeDeleter;
+    DBDirectClient dbclient(operationContext());
+    for (int i = 6; i >= 1; --i) {
+        dbclient.insert(kNss.toString(), BSON(kPattern << i));
+    }
+
+    std::list<Deletion> ranges;
+    ranges.emplace_back(Deletion{ChunkRange{BSON(kPattern << 0), BSON(kPattern << 10)}, Date_t{}});
+    rangeDeleter.add(std::move(ranges));
+
+    ASSERT_TRUE(next(rangeDeleter, 4));
+    ASSERT_EQUALS(2ULL, dbclient.count(kNss.toString(), BSON(kPattern << GT << 4)));
+    ASSERT_EQUALS(0ULL, dbclient.count(kNss.toString(), BSON(kPattern << LTE << 4)));
+
+    ASSERT_TRUE(next(rangeDeleter, 4));
+    ASSERT_TRUE(next(rangeDeleter, 4));
+    ASSERT_EQUALS(0ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 10)));
+    ASSERT_FALSE(next(rangeDeleter, 4));
+}
+
+// Tests that batches grow while they finish well within rangeDeleterBatchTargetMillis.
+TEST_F(CollectionRangeDeleterTest, AdaptiveBatchesGrowWhileUnderTarget) {
+    auto targetParam =
+        ServerParameterSet::getGlobal()->getMap().find("rangeDeleterBatchTargetMillis")->second;
+    ASSERT_OK(targetParam->setFromString("1000000"));
+    ON_BLOCK_EXIT([&] { targetParam->setFromString("0").transitional_ignore(); });
+
+    CollectionRangeDeleter rangeDeleter;
+    DBDirectClient dbclient(operationContext());
+    for (int i = 0; i < 10; ++i) {
+        dbclient.insert(kNss.toString(), BSON(kPattern << i));
+    }
+
+    std::list<Deletion> ranges;
+    ranges.emplace_back(Deletion{ChunkRange{BSON(kPattern << 0), BSON(kPattern << 10)}, Date_t{}});
+    rangeDeleter.add(std::move(ranges));
+
+    ASSERT_TRUE(next(rangeDeleter, 1));
+    ASSERT_EQUALS(9ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 10)));
+    ASSERT_TRUE(next(rangeDeleter, 1));
+    ASSERT_EQUALS(7ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 10)));
+    ASSERT_TRUE(next(rangeDeleter, 1));
+    ASSERT_EQUALS(3ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 10)));
+    ASSERT_TRUE(next(rangeDeleter, 1));
+    ASSERT_EQUALS(0ULL, dbclient.count(kNss.toString(), BSON(kPattern << LT << 10)));
+}
+
 }  // unnamed namespace
 }  // namespace mongo
@@ -32,6 +32,9 @@
 
 #include "mongo/db/s/collection_sharding_state.h"
 
+#include <algorithm>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/client.h"
 #include "mongo/db/concurrency/lock_state.h"
@@ -66,10 +69,20 @@ namespace mongo {
 
 MONGO_EXPORT_SERVER_PARAMETER(orphanCleanupDelaySecs, int, 900);  // 900s = 15m
 
+// Whether writes to sharded collections are counted against the chunks they land in, so that the
+// balancer can even out the write load across shards. See _getChunkOpLoad.
+MONGO_EXPORT_SERVER_PARAMETER(trackChunkOpLoad, bool, false);
+
 namespace {
 
 using std::string;
 
+// Every this many recorded writes to a chunk, the shard key of the write is sampled
+const uint64_t kOpKeySampleInterval = 16;
+
+// Number of most recently sampled keys kept per chunk
+const size_t kMaxSampledKeys = 16;
+
 /**
  * Used to perform shard identity initialization once it is certain that the document is committed.
  */
@@ -115,7 +128,9 @@ private:
 CollectionShardingState::CollectionShardingState(ServiceContext* sc, NamespaceString nss)
     : _nss(std::move(nss)),
       _metadataManager(std::make_shared<MetadataManager>(
-          sc, _nss, ShardingState::get(sc)->getRangeDeleterTaskExecutor())) {}
+          sc, _nss, ShardingState::get(sc)->getRangeDeleterTaskExecutor())),
+      _chunkOpLoads(SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ChunkOpLoadEntry>()) {
+}
 
 CollectionShardingState::~CollectionShardingState() {
     invariant(!_sourceMgr);
@@ -139,6 +154,59 @@ ScopedCollectionMetadata CollectionShardingState::getMetadata() {
     return _metadataManager->getActiveMetadata(_metadataManager);
 }
 
+std::vector<CollectionShardingState::ChunkOpLoad> CollectionShardingState::getChunkOpLoads(
+    bool decay) {
+    ScopedCollectionMetadata metadata = getMetadata();
+
+    stdx::lock_guard<stdx::mutex> lk(_chunkOpLoadMutex);
+    if (!metadata) {
+        _chunkOpLoads.clear();
+        return {};
+    }
+
+    std::shared_ptr<ChunkManager> cm = metadata->getChunkManager();
+
+    std::vector<ChunkOpLoad> loads;
+    for (auto it = _chunkOpLoads.begin(); it != _chunkOpLoads.end();) {
+        auto& entry = it->second;
+
+        // Drop the load of chunks which are no longer owned by this shard in the same shape
+        auto chunk = cm->findIntersectingChunkWithSimpleCollation(it->first);
+        if (!metadata->keyBelongsToMe(it->first) ||
+            SimpleBSONObjComparator::kInstance.evaluate(chunk->getMin() != it->first) ||
+            SimpleBSONObjComparator::kInstance.evaluate(chunk->getMax() != entry.max)) {
+            it = _chunkOpLoads.erase(it);
+            continue;
+        }
+
+        if (entry.numOps) {
+            ChunkOpLoad load;
+            load.min = it->first;
+            load.max = entry.max;
+            load.numOps = entry.numOps;
+            load.numBytes = entry.numBytes;
+
+            if (!entry.sampledKeys.empty()) {
+                std::vector<BSONObj> keys(entry.sampledKeys);
+                std::sort(
+                    keys.begin(), keys.end(), SimpleBSONObjComparator::kInstance.makeLessThan());
+                load.medianKey = keys[keys.size() / 2];
+            }
+
+            loads.push_back(std::move(load));
+        }
+
+        if (decay) {
+            entry.numOps -= entry.numOps / 2;
+            entry.numBytes -= entry.numBytes / 2;
+        }
+
+        ++it;
+    }
+
+    return loads;
+}
+
 void CollectionShardingState::refreshMetadata(OperationContext* opCtx,
                                               std::unique_ptr<CollectionMetadata> newMetadata) {
     invariant(opCtx->lockState()->isCollectionLockedForMode(_nss.ns(), MODE_X));
@@ -350,6 +418,10 @@ void CollectionShardingState::onDeleteOp(OperationContext* opCtx,
                 }
             }
         }
+
+        if (ShardingState::get(opCtx)->enabled() && trackChunkOpLoad.load()) {
+            _recordChunkOpOnDelete(deleteState.documentKey);
+        }
     }
 
     if (serverGlobalParams.clusterRole == ClusterRole::ConfigServer) {
@@ -562,6 +634,12 @@ uint64_t CollectionShardingState::_incrementChunkOnInsertOrUpdate(OperationConte
     invariant(chunk);
     chunk->addBytesWritten(dataWritten);
 
+    // Documents cloned by an incoming migration land in chunks which this shard does not own yet
+    // and must not make the chunk look hot once it does.
+    if (trackChunkOpLoad.load() && metadata->keyBelongsToMe(shardKey)) {
+        _recordChunkOp(*chunk, shardKey, dataWritten);
+    }
+
     // If the chunk becomes too large, then we call the ChunkSplitter to schedule a split. Then, we
     // reset the tracking for that chunk to 0.
     if (_shouldSplitChunk(opCtx, shardKeyPattern, *chunk)) {
@@ -571,6 +649,61 @@ uint64_t CollectionShardingState::_incrementChunkOnInsertOrUpdate(OperationConte
     return chunk->getBytesWritten();
 }
 
+void CollectionShardingState::_recordChunkOpOnDelete(const BSONObj& documentKey) {
+    ScopedCollectionMetadata metadata = getMetadata();
+    if (!metadata) {
+        return;
+    }
+
+    std::shared_ptr<ChunkManager> cm = metadata->getChunkManager();
+
+    // The document key of a delete contains the shard key fields, unless the document was
+    // inserted directly on the shard without one.
+    BSONObj shardKey = cm->getShardKeyPattern().extractShardKeyFromDoc(documentKey);
+    if (shardKey.isEmpty()) {
+        return;
+    }
+
+    // Deletions of orphaned documents are not part of the load on this shard
+    if (!metadata->keyBelongsToMe(shardKey)) {
+        return;
+    }
+
+    std::shared_ptr<Chunk> chunk = cm->findIntersectingChunkWithSimpleCollation(shardKey);
+    invariant(chunk);
+    _recordChunkOp(*chunk, shardKey, 0);
+}
+
+void CollectionShardingState::_recordChunkOp(const Chunk& chunk,
+                                             const BSONObj& shardKey,
+                                             uint64_t bytes) {
+    stdx::lock_guard<stdx::mutex> lk(_chunkOpLoadMutex);
+
+    auto it = _chunkOpLoads.find(chunk.getMin());
+    if (it == _chunkOpLoads.end()) {
+        it = _chunkOpLoads.emplace(chunk.getMin().getOwned(), ChunkOpLoadEntry()).first;
+        it->second.max = chunk.getMax().getOwned();
+    } else if (SimpleBSONObjComparator::kInstance.evaluate(it->second.max != chunk.getMax())) {
+        // The chunk has been split or merged since the load was recorded, so start over
+        it->second = ChunkOpLoadEntry();
+        it->second.max = chunk.getMax().getOwned();
+    }
+
+    auto& entry = it->second;
+    entry.numBytes += bytes;
+    if (++entry.numOps % kOpKeySampleInterval) {
+        return;
+    }
+
+    BSONObj ownedKey = shardKey.getOwned();
+    if (entry.sampledKeys.size() < kMaxSampledKeys) {
+        entry.sampledKeys.push_back(std::move(ownedKey));
+    } else {
+        entry.sampledKeys[entry.nextSampledKey] = std::move(ownedKey);
+    }
+    entry.nextSampledKey = (entry.nextSampledKey + 1) % kMaxSampledKeys;
+}
+
 bool CollectionShardingState::_shouldSplitChunk(OperationContext* opCtx,
                                                 const ShardKeyPattern& shardKeyPattern,
                                                 const Chunk& chunk) {
@@ -30,12 +30,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/string_data.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/s/collection_range_deleter.h"
 #include "mongo/db/s/metadata_manager.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/notification.h"
 
 namespace mongo {
@@ -45,6 +47,7 @@ extern AtomicInt32 orphanCleanupDelaySecs;
 
 class BalancerConfiguration;
 class BSONObj;
+class Chunk;
 struct ChunkVersion;
 class CollectionMetadata;
 class MigrationSourceManager;
@@ -85,6 +88,22 @@ public:
 
     DeleteState makeDeleteState(BSONObj const& doc);
 
+    /**
+     * The write load which this shard has recently observed on one of the chunks it owns.
+     */
+    struct ChunkOpLoad {
+        BSONObj min;
+        BSONObj max;
+
+        // Number of write operations and bytes written, both decayed over time
+        uint64_t numOps{0};
+        uint64_t numBytes{0};
+
+        // Median of the shard keys most recently sampled from the writes, or empty if there are
+        // none. Used as the split point when the chunk is too hot to be moved as a whole.
+        BSONObj medianKey;
+    };
+
     /**
      * Obtains the sharding state for the specified collection. If it does not exist, it will be
      * created and will remain active until the collection is dropped or unsharded.
@@ -102,6 +121,16 @@ public:
      */
     ScopedCollectionMetadata getMetadata();
 
+    /**
+     * Returns the write load recorded against each chunk this shard currently owns, skipping the
+     * chunks without any recorded writes. If 'decay' is true, the recorded load is halved after
+     * being read, so that it reflects recent rather than total activity. Load recorded against
+     * chunks which have since been split, merged or migrated away is discarded.
+     *
+     * Must be called with some lock held on the collection.
+     */
+    std::vector<ChunkOpLoad> getChunkOpLoads(bool decay);
+
     /**
      * BSON output of the pending metadata into a BSONArray
      */
@@ -297,6 +326,19 @@ private:
                                              const BSONObj& document,
                                              long dataWritten);
 
+    /**
+     * If the collection is sharded, records a write operation against the chunk that contains the
+     * deleted document with the specified document key.
+     */
+    void _recordChunkOpOnDelete(const BSONObj& documentKey);
+
+    /**
+     * Records a write of the specified number of bytes to the document with the given shard key,
+     * which falls in 'chunk', for load-based balancing. Only every few writes is the key itself
+     * sampled.
+     */
+    void _recordChunkOp(const Chunk& chunk, const BSONObj& shardKey, uint64_t bytes);
+
     /**
      * Returns true if the total number of bytes on the specified chunk nears the max size of
      * a shard.
@@ -318,6 +360,23 @@ private:
     // NOTE: The value is not owned by this class.
     MigrationSourceManager* _sourceMgr{nullptr};
 
+    // Write load recorded against a single chunk owned by this shard
+    struct ChunkOpLoadEntry {
+        BSONObj max;
+        uint64_t numOps{0};
+        uint64_t numBytes{0};
+
+        // Ring of the most recently sampled shard keys and the position of the next one to replace
+        std::vector<BSONObj> sampledKeys;
+        size_t nextSampledKey{0};
+    };
+
+    // Protects _chunkOpLoads, which is updated by writers holding only an intent lock
+    stdx::mutex _chunkOpLoadMutex;
+
+    // Write load of the chunks owned by this shard, keyed by the chunk's min key
+    BSONObjIndexedMap<ChunkOpLoadEntry> _chunkOpLoads;
+
     // for access to _metadataManager
     friend auto CollectionRangeDeleter::cleanUpNextRange(OperationContext*,
                                                          NamespaceString const&,
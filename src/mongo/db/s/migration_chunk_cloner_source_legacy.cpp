@@ -38,7 +38,6 @@
 #include "mongo/db/concurrency/locker.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
-#include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/query/internal_plans.h"
@@ -85,45 +84,6 @@ BSONObj createRequestWithSessionId(StringData commandName,
 
 }  // namespace
 
-/**
- * Used to receive invalidation notifications from operations, which delete documents.
- */
-class DeleteNotificationStage final : public PlanStage {
-public:
-    DeleteNotificationStage(MigrationChunkClonerSourceLegacy* cloner, OperationContext* opCtx)
-        : PlanStage("SHARDING_NOTIFY_DELETE", opCtx), _cloner(cloner) {}
-
-    void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) override {
-        if (type == INVALIDATION_DELETION) {
-            stdx::lock_guard<stdx::mutex> sl(_cloner->_mutex);
-            _cloner->_cloneLocs.erase(dl);
-        }
-    }
-
-    StageState doWork(WorkingSetID* out) override {
-        MONGO_UNREACHABLE;
-    }
-
-    bool isEOF() override {
-        MONGO_UNREACHABLE;
-    }
-
-    std::unique_ptr<PlanStageStats> getStats() override {
-        MONGO_UNREACHABLE;
-    }
-
-    SpecificStats* getSpecificStats() const override {
-        MONGO_UNREACHABLE;
-    }
-
-    StageType stageType() const override {
-        return STAGE_NOTIFY_DELETE;
-    }
-
-private:
-    MigrationChunkClonerSourceLegacy* const _cloner;
-};
-
 /**
  * Used to commit work for LogOpForSharding. Used to keep track of changes in documents that are
  * part of a chunk being migrated.
@@ -179,17 +139,17 @@ MigrationChunkClonerSourceLegacy::MigrationChunkClonerSourceLegacy(MoveChunkRequ
 
 MigrationChunkClonerSourceLegacy::~MigrationChunkClonerSourceLegacy() {
     invariant(_state == kDone);
-    invariant(!_deleteNotifyExec);
+    invariant(!_cloneExec);
 }
 
 Status MigrationChunkClonerSourceLegacy::startClone(OperationContext* opCtx) {
     invariant(_state == kNew);
     invariant(!opCtx->lockState()->isLocked());
 
-    // Load the ids of the currently available documents
-    auto storeCurrentLocsStatus = _storeCurrentLocs(opCtx);
-    if (!storeCurrentLocsStatus.isOK()) {
-        return storeCurrentLocsStatus;
+    // Count the currently available documents and prepare to stream them
+    auto prepareCloneScanStatus = _prepareCloneScan(opCtx);
+    if (!prepareCloneScanStatus.isOK()) {
+        return prepareCloneScanStatus;
     }
 
     // Tell the recipient shard to start cloning
@@ -249,17 +209,17 @@ Status MigrationChunkClonerSourceLegacy::awaitUntilCriticalSectionIsAppropriate(
 
         stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-        const std::size_t cloneLocsRemaining = _cloneLocs.size();
+        const uint64_t cloneRecordsRemaining = _getCloneRecordsRemaining_inlock();
 
         log() << "moveChunk data transfer progress: " << redact(res) << " mem used: " << _memoryUsed
-              << " documents remaining to clone: " << cloneLocsRemaining;
+              << " documents remaining to clone: " << cloneRecordsRemaining;
 
         if (res["state"].String() == "steady") {
-            if (cloneLocsRemaining != 0) {
+            if (!_cloneExhausted) {
                 return {ErrorCodes::OperationIncomplete,
                         str::stream() << "Unable to enter critical section because the recipient "
                                          "shard thinks all data is cloned while there are still "
-                                      << cloneLocsRemaining
+                                      << cloneRecordsRemaining
                                       << " documents remaining"};
             }
 
@@ -397,7 +357,7 @@ uint64_t MigrationChunkClonerSourceLegacy::getCloneBatchBufferAllocationSize() {
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
     return std::min(static_cast<uint64_t>(BSONObjMaxUserSize),
-                    _averageObjectSizeForCloneLocs * _cloneLocs.size());
+                    _averageObjectSizeForClone * _getCloneRecordsRemaining_inlock());
 }
 
 Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* opCtx,
@@ -411,39 +371,69 @@ Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* opCtx,
 
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-    std::set<RecordId>::iterator it;
+    if (!_cloneExec) {
+        return Status::OK();
+    }
+
+    _cloneExec->reattachToOperationContext(opCtx);
 
-    for (it = _cloneLocs.begin(); it != _cloneLocs.end(); ++it) {
+    // The executor could have been killed, for example by the collection being dropped, while it
+    // was saved in between the calls
+    if (!_cloneExec->restoreState()) {
+        _cloneExec->dispose(opCtx, collection->getCursorManager());
+        _cloneExec.reset();
+        return {ErrorCodes::QueryPlanKilled,
+                str::stream() << "Scan of the documents of chunk " << _args.getMinKey() << " -> "
+                              << _args.getMaxKey()
+                              << " was killed while cloning"};
+    }
+
+    BSONObj obj;
+    PlanExecutor::ExecState state;
+
+    while (true) {
         // We must always make progress in this method by at least one document because empty return
         // indicates there is no more initial clone data.
         if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
             break;
         }
 
-        Snapshotted<BSONObj> doc;
-        if (collection->findDoc(opCtx, *it, &doc)) {
-            // Use the builder size instead of accumulating the document sizes directly so that we
-            // take into consideration the overhead of BSONArray indices.
-            if (arrBuilder->arrSize() &&
-                (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
-                break;
-            }
+        state = _cloneExec->getNext(&obj, nullptr);
+        if (state != PlanExecutor::ADVANCED) {
+            break;
+        }
 
-            arrBuilder->append(doc.value());
+        // Use the builder size instead of accumulating the document sizes directly so that we
+        // take into consideration the overhead of BSONArray indices.
+        if (arrBuilder->arrSize() &&
+            (arrBuilder->len() + obj.objsize() + 1024) > BSONObjMaxUserSize) {
+            // Keep the document for the next batch
+            _cloneExec->enqueue(obj.getOwned());
+            break;
         }
+
+        arrBuilder->append(obj);
+        _numRecordsCloned++;
+    }
+
+    if (state == PlanExecutor::ADVANCED) {
+        _cloneExec->saveState();
+        _cloneExec->detachFromOperationContext();
+        return Status::OK();
     }
 
-    _cloneLocs.erase(_cloneLocs.begin(), it);
+    // We have a different OperationContext than when we created the PlanExecutor, so need to
+    // manually destroy it ourselves.
+    _cloneExec->dispose(opCtx, collection->getCursorManager());
+    _cloneExec.reset();
 
-    // If we have drained all the cloned data, there is no need to keep the delete notify executor
-    // around
-    if (_cloneLocs.empty() && _deleteNotifyExec) {
-        // We have a different OperationContext than when we created the PlanExecutor, so need to
-        // manually destroy it ourselves.
-        _deleteNotifyExec->dispose(opCtx, collection->getCursorManager());
-        _deleteNotifyExec.reset();
+    if (state != PlanExecutor::IS_EOF) {
+        return {ErrorCodes::InternalError,
+                str::stream() << "Executor error while cloning documents belonging to chunk: "
+                              << WorkingSetCommon::toStatusString(obj)};
     }
 
+    _cloneExhausted = true;
     return Status::OK();
 }
 
@@ -455,7 +445,7 @@ Status MigrationChunkClonerSourceLegacy::nextModsBatch(OperationContext* opCtx,
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
     // All clone data must have been drained before starting to fetch the incremental changes
-    invariant(_cloneLocs.empty());
+    invariant(_cloneExhausted);
 
     long long docSizeAccumulator = 0;
 
@@ -475,13 +465,21 @@ void MigrationChunkClonerSourceLegacy::_cleanup(OperationContext* opCtx) {
         _deleted.clear();
     }
 
-    if (_deleteNotifyExec) {
+    if (_cloneExec) {
         AutoGetCollection autoColl(opCtx, _args.getNss(), MODE_IS);
         const auto cursorManager =
             autoColl.getCollection() ? autoColl.getCollection()->getCursorManager() : nullptr;
-        _deleteNotifyExec->dispose(opCtx, cursorManager);
-        _deleteNotifyExec.reset();
+        _cloneExec->dispose(opCtx, cursorManager);
+        _cloneExec.reset();
+    }
+}
+
+uint64_t MigrationChunkClonerSourceLegacy::_getCloneRecordsRemaining_inlock() const {
+    if (_cloneExhausted || _numRecordsCloned > _numRecordsToClone) {
+        return 0;
     }
+
+    return _numRecordsToClone - _numRecordsCloned;
 }
 
 StatusWith<BSONObj> MigrationChunkClonerSourceLegacy::_callRecipient(const BSONObj& cmdObj) {
@@ -514,7 +512,7 @@ StatusWith<BSONObj> MigrationChunkClonerSourceLegacy::_callRecipient(const BSONO
     return responseStatus.data.getOwned();
 }
 
-Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* opCtx) {
+Status MigrationChunkClonerSourceLegacy::_prepareCloneScan(OperationContext* opCtx) {
     AutoGetCollection autoColl(opCtx, _args.getNss(), MODE_IS);
 
     Collection* const collection = autoColl.getCollection();
@@ -532,23 +530,10 @@ Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* opC
     if (!idx) {
         return {ErrorCodes::IndexNotFound,
                 str::stream() << "can't find index with prefix " << _shardKeyPattern.toBSON()
-                              << " in storeCurrentLocs for "
+                              << " in prepareCloneScan for "
                               << _args.getNss().ns()};
     }
 
-    // Install the stage, which will listen for notifications on the collection
-    auto statusWithDeleteNotificationPlanExecutor =
-        PlanExecutor::make(opCtx,
-                           stdx::make_unique<WorkingSet>(),
-                           stdx::make_unique<DeleteNotificationStage>(this, opCtx),
-                           collection,
-                           PlanExecutor::YIELD_MANUAL);
-    if (!statusWithDeleteNotificationPlanExecutor.isOK()) {
-        return statusWithDeleteNotificationPlanExecutor.getStatus();
-    }
-
-    _deleteNotifyExec = std::move(statusWithDeleteNotificationPlanExecutor.getValue());
-
     // Assume both min and max non-empty, append MinKey's to make them fit chosen index
     const KeyPattern kp(idx->keyPattern());
 
@@ -587,18 +572,19 @@ Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* opC
     bool isLargeChunk = false;
     unsigned long long recCount = 0;
 
+    // The index key of the last document in the chunk, at which the clone scan stops
+    BSONObj lastKey;
+
     BSONObj obj;
-    RecordId recordId;
     PlanExecutor::ExecState state;
-    while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, &recordId))) {
+    while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, nullptr))) {
         Status interruptStatus = opCtx->checkForInterruptNoAssert();
         if (!interruptStatus.isOK()) {
             return interruptStatus;
         }
 
         if (!isLargeChunk) {
-            stdx::lock_guard<stdx::mutex> lk(_mutex);
-            _cloneLocs.insert(recordId);
+            lastKey = obj.getOwned();
         }
 
         if (++recCount > maxRecsWhenFull) {
@@ -636,8 +622,29 @@ Status MigrationChunkClonerSourceLegacy::_storeCurrentLocs(OperationContext* opC
                           << _args.getMaxKey()};
     }
 
+    // Any document which was inserted in the chunk after the scan above started, or which was
+    // changed while it ran, is transferred as a mod, so the clone can stop at the last key the
+    // scan saw. This keeps the clone from chasing inserts at the end of the chunk.
+    std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> cloneExec;
+    if (recCount > 0) {
+        cloneExec = InternalPlanner::indexScan(opCtx,
+                                               collection,
+                                               idx,
+                                               min,
+                                               lastKey,
+                                               BoundInclusion::kIncludeBothStartAndEndKeys,
+                                               PlanExecutor::YIELD_MANUAL,
+                                               InternalPlanner::FORWARD,
+                                               InternalPlanner::IXSCAN_FETCH);
+        cloneExec->saveState();
+        cloneExec->detachFromOperationContext();
+    }
+
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    _averageObjectSizeForCloneLocs = collectionAverageObjectSize + 12;
+    _cloneExec = std::move(cloneExec);
+    _cloneExhausted = !_cloneExec;
+    _numRecordsToClone = recCount;
+    _averageObjectSizeForClone = collectionAverageObjectSize + 12;
 
     return Status::OK();
 }
@@ -29,7 +29,6 @@
 #pragma once
 
 #include <list>
-#include <set>
 
 #include "mongo/bson/bsonobj.h"
 #include "mongo/client/connection_string.h"
@@ -49,7 +48,6 @@ class BSONArrayBuilder;
 class BSONObjBuilder;
 class Collection;
 class Database;
-class RecordId;
 
 class MigrationChunkClonerSourceLegacy final : public MigrationChunkClonerSource {
     MONGO_DISALLOW_COPYING(MigrationChunkClonerSourceLegacy);
@@ -96,7 +94,9 @@ public:
 
     /**
      * Called by the recipient shard. Populates the passed BSONArrayBuilder with a set of documents,
-     * which are part of the initial clone sequence.
+     * which are part of the initial clone sequence. The documents are streamed in the order of the
+     * shard key index, continuing where the previous call left off, so the recipient may have
+     * several calls outstanding at once.
      *
      * Returns OK status on success. If there were documents returned in the result argument, this
      * method should be called more times until the result is empty. If it returns failure, it is
@@ -122,7 +122,6 @@ public:
     Status nextModsBatch(OperationContext* opCtx, Database* db, BSONObjBuilder* builder);
 
 private:
-    friend class DeleteNotificationStage;
     friend class LogOpForShardingHandler;
 
     // Represents the states in which the cloner can be
@@ -134,6 +133,12 @@ private:
      */
     void _cleanup(OperationContext* opCtx);
 
+    /**
+     * Returns an estimate of the number of documents which remain to be returned by nextCloneBatch.
+     * Documents inserted or deleted since the clone started make it inexact.
+     */
+    uint64_t _getCloneRecordsRemaining_inlock() const;
+
     /**
      * Synchronously invokes the recipient shard with the specified command and either returns the
      * command response (if succeeded) or the status, if the command failed.
@@ -141,12 +146,12 @@ private:
     StatusWith<BSONObj> _callRecipient(const BSONObj& cmdObj);
 
     /**
-     * Get the disklocs that belong to the chunk migrated and sort them in _cloneLocs (to avoid
-     * seeking disk later).
+     * Counts the documents that belong to the chunk migrated, to reject chunks which are too large
+     * to move, and sets up _cloneExec to stream them for the initial clone.
      *
      * Returns OK or any error status otherwise.
      */
-    Status _storeCurrentLocs(OperationContext* opCtx);
+    Status _prepareCloneScan(OperationContext* opCtx);
 
     /**
      * Insert items from docIdList to a new array with the given fieldName in the given builder. If
@@ -179,22 +184,30 @@ private:
     // The resolved primary of the recipient shard
     const HostAndPort _recipientHost;
 
-    // Registered deletion notifications plan executor, which will listen for document deletions
-    // during the cloning stage
-    std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> _deleteNotifyExec;
-
     // Protects the entries below
     stdx::mutex _mutex;
 
     // The current state of the cloner
     State _state{kNew};
 
-    // List of record ids that needs to be transferred (initial clone)
-    std::set<RecordId> _cloneLocs;
+    // Registered plan executor, which scans the shard key index over the chunk range and fetches
+    // the documents to transfer (initial clone). It is saved and detached from its operation
+    // context between calls to nextCloneBatch and is reset once it is exhausted. Documents which
+    // are inserted or changed after the scan started are transferred as mods, so the scan stops at
+    // the largest key which the chunk contained when the clone started.
+    std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> _cloneExec;
+
+    // Whether all the documents of the initial clone have been returned by nextCloneBatch
+    bool _cloneExhausted{false};
+
+    // The number of documents the chunk contained when the clone started and how many of them have
+    // been transferred so far (initial clone)
+    uint64_t _numRecordsToClone{0};
+    uint64_t _numRecordsCloned{0};
 
     // The estimated average object size during the clone phase. Used for buffer size
     // pre-allocation (initial clone).
-    uint64_t _averageObjectSizeForCloneLocs{0};
+    uint64_t _averageObjectSizeForClone{0};
 
     // List of _id of documents that were modified that must be re-cloned (xfer mods)
     std::list<BSONObj> _reload;
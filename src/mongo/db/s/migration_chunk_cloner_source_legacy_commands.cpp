@@ -50,8 +50,8 @@ namespace {
 
 /**
  * Shortcut class to perform the appropriate checks and acquire the cloner associated with the
- * currently active migration. Uses the currently registered migration for this shard and ensures
- * the session ids match.
+ * currently active migration. Uses the migrations currently registered for this shard and picks
+ * the one whose session id matches.
  */
 class AutoGetActiveCloner {
     MONGO_DISALLOW_COPYING(AutoGetActiveCloner);
@@ -60,32 +60,17 @@ public:
     AutoGetActiveCloner(OperationContext* opCtx, const MigrationSessionId& migrationSessionId) {
         ShardingState* const gss = ShardingState::get(opCtx);
 
-        const auto nss = gss->getActiveDonateChunkNss();
-        uassert(ErrorCodes::NotYetInitialized, "No active migrations were found", nss);
-
-        // Once the collection is locked, the migration status cannot change
-        _autoColl.emplace(opCtx, *nss, MODE_IS);
-
-        uassert(ErrorCodes::NamespaceNotFound,
-                str::stream() << "Collection " << nss->ns() << " does not exist",
-                _autoColl->getCollection());
-
-        auto css = CollectionShardingState::get(opCtx, *nss);
-        uassert(ErrorCodes::IllegalOperation,
-                str::stream() << "No active migrations were found for collection " << nss->ns(),
-                css && css->getMigrationSourceManager());
-
-        // It is now safe to access the cloner
-        _chunkCloner = dynamic_cast<MigrationChunkClonerSourceLegacy*>(
-            css->getMigrationSourceManager()->getCloner());
-        invariant(_chunkCloner);
+        // A shard may be donating chunks of several collections at the same time, so report the
+        // error for the last of them if none has a matching session
+        Status status(ErrorCodes::NotYetInitialized, "No active migrations were found");
+        for (const auto& nss : gss->getActiveDonateChunkNamespaces()) {
+            status = _acquire(opCtx, nss, migrationSessionId);
+            if (status.isOK()) {
+                return;
+            }
+        }
 
-        // Ensure the session ids are correct
-        uassert(ErrorCodes::IllegalOperation,
-                str::stream() << "Requested migration session id " << migrationSessionId.toString()
-                              << " does not match active session id "
-                              << _chunkCloner->getSessionId().toString(),
-                migrationSessionId.matches(_chunkCloner->getSessionId()));
+        uassertStatusOK(status);
     }
 
     Database* getDb() const {
@@ -104,11 +89,59 @@ public:
     }
 
 private:
+    /**
+     * Locks the specified collection and acquires its cloner if the session id of the migration
+     * active on it matches. Leaves the collection unlocked if an error is returned.
+     */
+    Status _acquire(OperationContext* opCtx,
+                    const NamespaceString& nss,
+                    const MigrationSessionId& migrationSessionId) {
+        // Once the collection is locked, the migration status cannot change
+        _autoColl.emplace(opCtx, nss, MODE_IS);
+
+        Status status = [&]() -> Status {
+            if (!_autoColl->getCollection()) {
+                return {ErrorCodes::NamespaceNotFound,
+                        str::stream() << "Collection " << nss.ns() << " does not exist"};
+            }
+
+            auto css = CollectionShardingState::get(opCtx, nss);
+            if (!css || !css->getMigrationSourceManager()) {
+                return {ErrorCodes::IllegalOperation,
+                        str::stream() << "No active migrations were found for collection "
+                                      << nss.ns()};
+            }
+
+            // It is now safe to access the cloner
+            _chunkCloner = dynamic_cast<MigrationChunkClonerSourceLegacy*>(
+                css->getMigrationSourceManager()->getCloner());
+            invariant(_chunkCloner);
+
+            // Ensure the session ids are correct
+            if (!migrationSessionId.matches(_chunkCloner->getSessionId())) {
+                return {ErrorCodes::IllegalOperation,
+                        str::stream() << "Requested migration session id "
+                                      << migrationSessionId.toString()
+                                      << " does not match active session id "
+                                      << _chunkCloner->getSessionId().toString()};
+            }
+
+            return Status::OK();
+        }();
+
+        if (!status.isOK()) {
+            _chunkCloner = nullptr;
+            _autoColl.reset();
+        }
+
+        return status;
+    }
+
     // Scoped database + collection lock
     boost::optional<AutoGetCollection> _autoColl;
 
     // Contains the active cloner for the namespace
-    MigrationChunkClonerSourceLegacy* _chunkCloner;
+    MigrationChunkClonerSourceLegacy* _chunkCloner{nullptr};
 };
 
 class InitialCloneCommand : public BasicCommand {
@@ -294,6 +294,93 @@ TEST_F(MigrationChunkClonerSourceLegacyTest, CorrectDocumentsFetched) {
     futureCommit.timed_get(kFutureTimeout);
 }
 
+TEST_F(MigrationChunkClonerSourceLegacyTest, CloneStreamsOnlyDocumentsPresentWhenItStarted) {
+    const std::vector<BSONObj> contents = {createCollectionDocument(100),
+                                           createCollectionDocument(120),
+                                           createCollectionDocument(140),
+                                           createCollectionDocument(160)};
+
+    createShardedCollection(contents);
+
+    MigrationChunkClonerSourceLegacy cloner(
+        createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200))),
+        kShardKeyPattern,
+        kDonorConnStr,
+        kRecipientConnStr.getServers()[0]);
+
+    {
+        auto futureStartClone = launchAsync([&]() {
+            onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+        });
+
+        ASSERT_OK(cloner.startClone(operationContext()));
+        futureStartClone.timed_get(kFutureTimeout);
+    }
+
+    // Delete a document which has not been cloned yet and insert documents both before and after
+    // the last document of the chunk. Only the documents present when the clone started and not
+    // deleted since are cloned, the inserted ones are transferred as mods.
+    client()->remove(kNss.ns(), BSON("_id" << 120));
+    client()->insert(kNss.ns(), createCollectionDocument(130));
+    client()->insert(kNss.ns(), createCollectionDocument(180));
+
+    {
+        AutoGetCollection autoColl(operationContext(), kNss, MODE_IX);
+
+        WriteUnitOfWork wuow(operationContext());
+
+        cloner.onDeleteOp(operationContext(), createCollectionDocument(120));
+        cloner.onInsertOp(operationContext(), createCollectionDocument(130));
+        cloner.onInsertOp(operationContext(), createCollectionDocument(180));
+
+        wuow.commit();
+    }
+
+    {
+        AutoGetCollection autoColl(operationContext(), kNss, MODE_IS);
+
+        std::vector<BSONObj> cloned;
+        while (true) {
+            BSONArrayBuilder arrBuilder;
+            ASSERT_OK(
+                cloner.nextCloneBatch(operationContext(), autoColl.getCollection(), &arrBuilder));
+            if (arrBuilder.arrSize() == 0) {
+                break;
+            }
+
+            for (const auto& elem : arrBuilder.arr()) {
+                cloned.push_back(elem.Obj().getOwned());
+            }
+        }
+
+        // The document inserted before the last key of the chunk may be cloned, since the scan
+        // had not passed it yet, but the one inserted after it must not be
+        ASSERT_GTE(cloned.size(), 3U);
+        ASSERT_BSONOBJ_EQ(contents[0], cloned.front());
+        ASSERT_BSONOBJ_EQ(contents[3], cloned.back());
+        for (const auto& doc : cloned) {
+            ASSERT_NE(120, doc["_id"].numberInt());
+            ASSERT_NE(180, doc["_id"].numberInt());
+        }
+
+        BSONObjBuilder modsBuilder;
+        ASSERT_OK(cloner.nextModsBatch(operationContext(), autoColl.getDb(), &modsBuilder));
+
+        const auto modsObj = modsBuilder.obj();
+        ASSERT_EQ(2U, modsObj["reload"].Array().size());
+        ASSERT_BSONOBJ_EQ(createCollectionDocument(130), modsObj["reload"].Array()[0].Obj());
+        ASSERT_BSONOBJ_EQ(createCollectionDocument(180), modsObj["reload"].Array()[1].Obj());
+        ASSERT_EQ(1U, modsObj["deleted"].Array().size());
+    }
+
+    auto futureCommit = launchAsync([&]() {
+        onCommand([&](const RemoteCommandRequest& request) { return BSON("ok" << true); });
+    });
+
+    ASSERT_OK(cloner.commitClone(operationContext()));
+    futureCommit.timed_get(kFutureTimeout);
+}
+
 TEST_F(MigrationChunkClonerSourceLegacyTest, CollectionNotFound) {
     MigrationChunkClonerSourceLegacy cloner(
         createMoveChunkRequest(ChunkRange(BSON("X" << 100), BSON("X" << 200))),
@@ -32,9 +32,11 @@
 
 #include "mongo/db/s/migration_destination_manager.h"
 
+#include <deque>
 #include <list>
 #include <vector>
 
+#include "mongo/bson/simple_bsonelement_comparator.h"
 #include "mongo/client/connpool.h"
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/auth/authorization_session.h"
@@ -42,6 +44,8 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/namespace_string.h"
@@ -55,14 +59,19 @@
 #include "mongo/db/s/migration_util.h"
 #include "mongo/db/s/move_timing_helper.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/stdx/chrono.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/concurrency/notification.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -137,6 +146,239 @@ bool willOverrideLocalId(OperationContext* opCtx,
     return false;
 }
 
+/**
+ * Inserts a batch of documents of the initial clone. The documents which do not exist locally yet,
+ * which is the common case, are inserted together in one write unit of work, so that the index
+ * keys of the whole batch are maintained at once. The documents which do exist locally, because
+ * they were already cloned, are upserted one by one.
+ *
+ * The donor scans a shard key prefixed index, which may be multikey over its other fields, so the
+ * same document can appear more than once in a batch. Only its last copy, which is the most recent
+ * one, is inserted.
+ */
+void cloneDocuments(OperationContext* opCtx,
+                    const NamespaceString& nss,
+                    const BSONObj& min,
+                    const BSONObj& max,
+                    const BSONObj& shardKeyPattern,
+                    const std::vector<BSONObj>& docs) {
+    OldClientWriteContext cx(opCtx, nss.ns());
+
+    std::vector<InsertStatement> inserts;
+    inserts.reserve(docs.size());
+
+    // Position in 'inserts' of each _id already queued for insertion
+    auto insertIndexes =
+        SimpleBSONElementComparator::kInstance.makeBSONEltIndexedUnorderedMap<size_t>();
+
+    for (const auto& docToClone : docs) {
+        BSONObj localDoc;
+        if (willOverrideLocalId(
+                opCtx, nss, min, max, shardKeyPattern, cx.db(), docToClone, &localDoc)) {
+            string errMsg = str::stream() << "cannot migrate chunk, local document "
+                                          << redact(localDoc) << " has same _id as cloned "
+                                          << "remote document " << redact(docToClone);
+
+            warning() << errMsg;
+
+            // Exception will abort migration cleanly
+            uasserted(16976, errMsg);
+        }
+
+        if (!localDoc.isEmpty()) {
+            Helpers::upsert(opCtx, nss.ns(), docToClone, true);
+            continue;
+        }
+
+        const auto insertIt = insertIndexes.find(docToClone["_id"]);
+        if (insertIt != insertIndexes.end()) {
+            inserts[insertIt->second] = InsertStatement(docToClone);
+            continue;
+        }
+
+        insertIndexes.emplace(docToClone["_id"], inserts.size());
+        inserts.emplace_back(docToClone);
+    }
+
+    if (inserts.empty()) {
+        return;
+    }
+
+    Collection* const collection = cx.getCollection();
+    uassert(ErrorCodes::NamespaceNotFound,
+            str::stream() << "Collection " << nss.ns() << " was dropped while cloning",
+            collection);
+
+    writeConflictRetry(opCtx, "cloneDocuments", nss.ns(), [&] {
+        WriteUnitOfWork wuow(opCtx);
+        uassertStatusOK(collection->insertDocuments(
+            opCtx, inserts.begin(), inserts.end(), nullptr, true, true /* fromMigrate */));
+        wuow.commit();
+    });
+}
+
+// The number of _migrateClone requests which the recipient keeps outstanding at the same time
+// during the initial clone, each on its own connection to the donor shard.
+AtomicInt32 migrateCloneConcurrency(1);
+
+const int kMaxMigrateCloneConcurrency = 16;
+
+class ExportedMigrateCloneConcurrencyParameter
+    : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedMigrateCloneConcurrencyParameter()
+        : ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "migrateCloneConcurrency",
+              &migrateCloneConcurrency) {}
+
+    Status validate(const int& potentialNewValue) override {
+        if (potentialNewValue < 1 || potentialNewValue > kMaxMigrateCloneConcurrency) {
+            return {ErrorCodes::BadValue, "migrateCloneConcurrency must be between 1 and 16"};
+        }
+
+        return Status::OK();
+    }
+
+} exportedMigrateCloneConcurrencyParameter;
+
+/**
+ * Fetches the batches of the initial clone from the donor shard on background threads, so that the
+ * next batches are already in flight while the migration thread inserts the current one. Each
+ * thread issues _migrateClone requests on its own connection until the donor returns an empty
+ * batch, and at most one fetched batch per thread is kept waiting to be inserted.
+ */
+class CloneBatchFetcher {
+    MONGO_DISALLOW_COPYING(CloneBatchFetcher);
+
+public:
+    CloneBatchFetcher(ConnectionString donorConnStr, BSONObj migrateCloneRequest, int numThreads)
+        : _donorConnStr(std::move(donorConnStr)),
+          _migrateCloneRequest(std::move(migrateCloneRequest)),
+          _numThreads(numThreads) {}
+
+    ~CloneBatchFetcher() {
+        shutdown();
+    }
+
+    void startup() {
+        for (size_t i = 0; i < _numThreads; i++) {
+            _threads.emplace_back([this] { _fetchBatches(); });
+        }
+    }
+
+    /**
+     * Stops fetching and waits for the threads to finish their outstanding requests.
+     */
+    void shutdown() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _inShutdown = true;
+        }
+        _condVar.notify_all();
+
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+        _threads.clear();
+    }
+
+    /**
+     * Waits for the next fetched batch and returns the _migrateClone response which contains it.
+     * Returns an empty object once all the batches have been returned, or the error with which a
+     * request failed.
+     */
+    StatusWith<BSONObj> next(OperationContext* opCtx) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        opCtx->waitForConditionOrInterrupt(_condVar, lk, [&] {
+            return !_batches.empty() || !_status.isOK() || _numThreadsDone == _numThreads;
+        });
+
+        if (!_status.isOK()) {
+            return _status;
+        }
+
+        if (_batches.empty()) {
+            return BSONObj();
+        }
+
+        BSONObj batch = std::move(_batches.front());
+        _batches.pop_front();
+        _condVar.notify_all();
+
+        return batch;
+    }
+
+private:
+    void _fetchBatches() {
+        Client::initThread("migrateCloneFetcher");
+
+        Status status = Status::OK();
+
+        try {
+            ScopedDbConnection conn(_donorConnStr);
+
+            while (true) {
+                {
+                    stdx::unique_lock<stdx::mutex> lk(_mutex);
+                    _condVar.wait(lk, [&] {
+                        return _inShutdown || !_status.isOK() || _batches.size() < _numThreads;
+                    });
+                    if (_inShutdown || !_status.isOK()) {
+                        break;
+                    }
+                }
+
+                BSONObj res;
+                if (!conn->runCommand("admin", _migrateCloneRequest, res)) {
+                    status = {ErrorCodes::OperationFailed,
+                              str::stream() << "_migrateClone failed: " << redact(res.toString())};
+                    break;
+                }
+
+                if (res["objects"].Obj().isEmpty()) {
+                    break;
+                }
+
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                _batches.push_back(res.getOwned());
+                _condVar.notify_all();
+            }
+
+            conn.done();
+        } catch (const DBException& ex) {
+            status = ex.toStatus();
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (!status.isOK() && _status.isOK()) {
+            _status = std::move(status);
+        }
+        _numThreadsDone++;
+        _condVar.notify_all();
+    }
+
+    const ConnectionString _donorConnStr;
+    const BSONObj _migrateCloneRequest;
+    const size_t _numThreads;
+
+    std::vector<stdx::thread> _threads;
+
+    // Protects the state below
+    stdx::mutex _mutex;
+    stdx::condition_variable _condVar;
+
+    bool _inShutdown{false};
+
+    // Fetched batches, which wait to be inserted
+    std::deque<BSONObj> _batches;
+
+    // The first error any of the threads encountered
+    Status _status{Status::OK()};
+
+    size_t _numThreadsDone{0};
+};
+
 /**
  * Returns true if the majority of the nodes and the nodes corresponding to the given writeConcern
  * (if not empty) have applied till the specified lastOp.
@@ -676,79 +918,69 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
 
         _chunkMarkedPending = true;  // no lock needed, only the migrate thread looks.
 
+        CloneBatchFetcher fetcher(
+            fromShardConnString, migrateCloneRequest, migrateCloneConcurrency.load());
+        fetcher.startup();
+        ON_BLOCK_EXIT([&fetcher] { fetcher.shutdown(); });
+
+        Timer cloneTimer;
+
         while (true) {
-            BSONObj res;
-            if (!conn->runCommand("admin",
-                                  migrateCloneRequest,
-                                  res)) {  // gets array of objects to copy, in disk order
-                setStateFail(str::stream() << "_migrateClone failed: " << redact(res.toString()));
-                conn.done();
+            auto swRes = fetcher.next(opCtx);
+            if (!swRes.isOK()) {
+                setStateFail(swRes.getStatus().reason());
                 return;
             }
 
-            BSONObj arr = res["objects"].Obj();
-            int thisTime = 0;
+            const BSONObj& res = swRes.getValue();
+            if (res.isEmpty()) {
+                break;
+            }
 
-            BSONObjIterator i(arr);
-            while (i.more()) {
-                opCtx->checkForInterrupt();
+            opCtx->checkForInterrupt();
 
-                if (getState() == ABORT) {
-                    log() << "Migration aborted while copying documents";
-                    return;
-                }
+            if (getState() == ABORT) {
+                log() << "Migration aborted while copying documents";
+                return;
+            }
 
-                BSONObj docToClone = i.next().Obj();
-                {
-                    OldClientWriteContext cx(opCtx, _nss.ns());
-
-                    BSONObj localDoc;
-                    if (willOverrideLocalId(opCtx,
-                                            _nss,
-                                            min,
-                                            max,
-                                            shardKeyPattern,
-                                            cx.db(),
-                                            docToClone,
-                                            &localDoc)) {
-                        string errMsg = str::stream() << "cannot migrate chunk, local document "
-                                                      << redact(localDoc)
-                                                      << " has same _id as cloned "
-                                                      << "remote document " << redact(docToClone);
-
-                        warning() << errMsg;
-
-                        // Exception will abort migration cleanly
-                        uasserted(16976, errMsg);
-                    }
+            std::vector<BSONObj> docs;
+            long long batchBytes = 0;
+            for (const auto& elem : res["objects"].Obj()) {
+                docs.push_back(elem.Obj());
+                batchBytes += docs.back().objsize();
+            }
 
-                    Helpers::upsert(opCtx, _nss.ns(), docToClone, true);
-                }
-                thisTime++;
+            cloneDocuments(opCtx, _nss, min, max, shardKeyPattern, docs);
 
-                {
-                    stdx::lock_guard<stdx::mutex> statsLock(_mutex);
-                    _numCloned++;
-                    _clonedBytes += docToClone.objsize();
-                }
+            {
+                stdx::lock_guard<stdx::mutex> statsLock(_mutex);
+                _numCloned += docs.size();
+                _clonedBytes += batchBytes;
+            }
 
-                if (writeConcern.shouldWaitForOtherNodes()) {
-                    repl::ReplicationCoordinator::StatusAndDuration replStatus =
-                        repl::getGlobalReplicationCoordinator()->awaitReplication(
-                            opCtx,
-                            repl::ReplClientInfo::forClient(opCtx->getClient()).getLastOp(),
-                            writeConcern);
-                    if (replStatus.status.code() == ErrorCodes::WriteConcernFailed) {
-                        warning() << "secondaryThrottle on, but doc insert timed out; "
-                                     "continuing";
-                    } else {
-                        massertStatusOK(replStatus.status);
-                    }
+            if (writeConcern.shouldWaitForOtherNodes()) {
+                repl::ReplicationCoordinator::StatusAndDuration replStatus =
+                    repl::getGlobalReplicationCoordinator()->awaitReplication(
+                        opCtx,
+                        repl::ReplClientInfo::forClient(opCtx->getClient()).getLastOp(),
+                        writeConcern);
+                if (replStatus.status.code() == ErrorCodes::WriteConcernFailed) {
+                    warning() << "secondaryThrottle on, but doc insert timed out; "
+                                 "continuing";
+                } else {
+                    massertStatusOK(replStatus.status);
                 }
             }
+        }
 
-            if (thisTime == 0)
-                break;
+        {
+            stdx::lock_guard<stdx::mutex> statsLock(_mutex);
+            const long long cloneMillis = cloneTimer.millis();
+            timing.appendNumber("clonedDocs", _numCloned);
+            timing.appendNumber("clonedBytes", _clonedBytes);
+            timing.appendNumber("clonedBytesPerSecond",
+                                cloneMillis ? _clonedBytes * 1000 / cloneMillis : _clonedBytes);
         }
 
         timing.done(3);
@@ -113,4 +113,8 @@ void MoveTimingHelper::done(int step) {
     _t.reset();
 }
 
+void MoveTimingHelper::appendNumber(StringData fieldName, long long value) {
+    _b.appendNumber(fieldName, value);
+}
+
 }  // namespace mongo
@@ -54,6 +54,12 @@ public:
 
     void done(int step);
 
+    /**
+     * Adds a field with a statistic of the migration, such as its throughput, to the changelog
+     * entry written when the migration finishes.
+     */
+    void appendNumber(StringData fieldName, long long value);
+
 private:
     // Measures how long the receiving of a chunk takes
     Timer _t;
@@ -67,6 +67,7 @@
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
@@ -84,6 +85,12 @@ namespace {
 
 const auto getShardingState = ServiceContext::declareDecoration<ShardingState>();
 
+// How often the recorded chunk write load is halved
+const Seconds kChunkOpLoadDecayInterval(60);
+
+// The most chunks per collection reported by appendChunkOpLoad
+const size_t kMaxReportedChunkOpLoads = 32;
+
 /**
  * Updates the config server field of the shardIdentity document with the given connection string
  * if setName is equal to the config server replica set name.
@@ -533,8 +540,8 @@ StatusWith<ScopedRegisterReceiveChunk> ShardingState::registerReceiveChunk(
     return _activeMigrationsRegistry.registerReceiveChunk(nss, chunkRange, fromShardId);
 }
 
-boost::optional<NamespaceString> ShardingState::getActiveDonateChunkNss() {
-    return _activeMigrationsRegistry.getActiveDonateChunkNss();
+std::vector<NamespaceString> ShardingState::getActiveDonateChunkNamespaces() {
+    return _activeMigrationsRegistry.getActiveDonateChunkNamespaces();
 }
 
 BSONObj ShardingState::getActiveMigrationStatusReport(OperationContext* opCtx) {
@@ -569,6 +576,66 @@ void ShardingState::appendInfo(OperationContext* opCtx, BSONObjBuilder& builder)
     versionB.done();
 }
 
+void ShardingState::appendChunkOpLoad(OperationContext* opCtx, BSONObjBuilder* builder) {
+    bool decay;
+    std::vector<std::string> namespaces;
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        const Date_t now = Date_t::now();
+        decay = now - _lastChunkOpLoadDecay >= kChunkOpLoadDecayInterval;
+        if (decay) {
+            _lastChunkOpLoadDecay = now;
+        }
+
+        for (const auto& coll : _collections) {
+            namespaces.push_back(coll.first);
+        }
+    }
+
+    BSONArrayBuilder collectionsArr(builder->subarrayStart("collections"));
+    for (const auto& ns : namespaces) {
+        const NamespaceString nss(ns);
+
+        std::vector<CollectionShardingState::ChunkOpLoad> loads;
+        {
+            AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+            loads = CollectionShardingState::get(opCtx, nss)->getChunkOpLoads(decay);
+        }
+
+        if (loads.empty()) {
+            continue;
+        }
+
+        const auto numReported = std::min(loads.size(), kMaxReportedChunkOpLoads);
+        std::partial_sort(loads.begin(),
+                          loads.begin() + numReported,
+                          loads.end(),
+                          [](const auto& a, const auto& b) { return a.numOps > b.numOps; });
+
+        BSONObjBuilder collectionEntry(collectionsArr.subobjStart());
+        collectionEntry.append("ns", ns);
+        BSONArrayBuilder chunksArr(collectionEntry.subarrayStart("chunks"));
+        for (size_t i = 0; i < numReported; i++) {
+            const auto& load = loads[i];
+
+            BSONObjBuilder chunkEntry(chunksArr.subobjStart());
+            chunkEntry.append("min", load.min);
+            chunkEntry.append("max", load.max);
+            chunkEntry.append("ops", static_cast<long long>(load.numOps));
+            chunkEntry.append("bytes", static_cast<long long>(load.numBytes));
+            if (!load.medianKey.isEmpty()) {
+                chunkEntry.append("medianKey", load.medianKey);
+            }
+            chunkEntry.doneFast();
+        }
+        chunksArr.doneFast();
+        collectionEntry.doneFast();
+    }
+    collectionsArr.doneFast();
+}
+
 bool ShardingState::needCollectionMetadata(OperationContext* opCtx, const string& ns) {
     if (!enabled())
         return false;
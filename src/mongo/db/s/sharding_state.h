@@ -197,6 +197,14 @@ public:
 
     void appendInfo(OperationContext* opCtx, BSONObjBuilder& b);
 
+    /**
+     * Appends, for every sharded collection, the chunks owned by this shard with the highest
+     * recorded write load, hottest first. The recorded load is halved at most once per decay
+     * interval, so that it tracks recent activity. Takes each collection's lock in turn, so must not
+     * be called with the sharding state mutex held.
+     */
+    void appendChunkOpLoad(OperationContext* opCtx, BSONObjBuilder* builder);
+
     bool needCollectionMetadata(OperationContext* opCtx, const std::string& ns);
 
     /**
@@ -232,17 +240,17 @@ public:
                                                                 const ShardId& fromShardId);
 
     /**
-     * If a migration has been previously registered through a call to registerDonateChunk returns
-     * that namespace. Otherwise returns boost::none.
+     * Returns the namespaces of all migrations, which have been previously registered through a
+     * call to registerDonateChunk and have not completed yet.
      *
-     * This method can be called without any locks, but once the namespace is fetched it needs to be
+     * This method can be called without any locks, but once a namespace is fetched it needs to be
      * re-checked after acquiring some intent lock on that namespace.
      */
-    boost::optional<NamespaceString> getActiveDonateChunkNss();
+    std::vector<NamespaceString> getActiveDonateChunkNamespaces();
 
     /**
-     * Get a migration status report from the migration registry. If no migration is active, this
-     * returns an empty BSONObj.
+     * Get a status report on the oldest active migration from the migration registry. If no
+     * migration is active, this returns an empty BSONObj.
      *
      * Takes an IS lock on the namespace of the active migration, if one is active.
      */
@@ -350,6 +358,9 @@ private:
     // The id for the cluster this shard belongs to.
     OID _clusterId;
 
+    // When the recorded chunk write load was last decayed
+    Date_t _lastChunkOpLoadDecay;
+
     // Function for initializing the external sharding state components not owned here.
     GlobalInitFunc _globalInit;
 
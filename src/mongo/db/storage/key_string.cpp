@@ -101,6 +101,19 @@ const uint8_t kNumericPositive8ByteInt = kNumeric + 20;
 const uint8_t kNumericPositiveLargeMagnitude = kNumeric + 21;  // >= 2**63 including +Inf
 MONGO_STATIC_ASSERT(kNumericPositiveLargeMagnitude < kStringLike);
 
+// KeyString V2 encodes the positive integers 1 through kV2NumTinyInts as the type byte alone. Each
+// of them is followed by a second type byte for the non-integers with that integer part, which
+// keeps the numeric order: 1 < 1.5 < 2. Those non-integers are otherwise encoded exactly as with
+// kNumericPositive1ByteInt. The type bytes of the tiny integers take the place of
+// kNumericPositive1ByteInt onwards, and all of the larger positive ctypes are shifted up to make
+// room for them.
+const uint8_t kV2NumTinyInts = 4;
+const uint8_t kV2NumTinyIntCTypes = 2 * kV2NumTinyInts;
+const uint8_t kV2NumericPositiveTinyInt1 = kNumericPositive1ByteInt;
+const uint8_t kV2NumericPositiveLargeMagnitude =
+    kNumericPositiveLargeMagnitude + kV2NumTinyIntCTypes;
+MONGO_STATIC_ASSERT(kV2NumericPositiveLargeMagnitude < kStringLike);
+
 const uint8_t kBoolFalse = kBool + 0;
 const uint8_t kBoolTrue = kBool + 1;
 MONGO_STATIC_ASSERT(kBoolTrue < kDate);
@@ -115,6 +128,26 @@ size_t numBytesForInt(uint8_t ctype) {
     dassert(ctype >= kNumericNegative8ByteInt);
     return kNumericNegative1ByteInt - ctype + 1;
 }
+
+/**
+ * Maps a V1 ctype to the ctype encoding the same thing in 'version'.
+ */
+uint8_t toVersionedNumericCType(KeyString::Version version, uint8_t ctype) {
+    if (version >= KeyString::Version::V2 && ctype >= kNumericPositive1ByteInt &&
+        ctype <= kNumericPositiveLargeMagnitude) {
+        return ctype + kV2NumTinyIntCTypes;
+    }
+    return ctype;
+}
+
+/**
+ * Returns the V2 ctype of a positive number with integer part 'integerPart', which must be at most
+ * kV2NumTinyInts.
+ */
+uint8_t v2TinyIntCType(uint64_t integerPart, bool hasFraction) {
+    dassert(integerPart >= 1 && integerPart <= kV2NumTinyInts);
+    return kV2NumericPositiveTinyInt1 + 2 * (integerPart - 1) + (hasFraction ? 1 : 0);
+}
 }  // namespace CType
 
 uint8_t bsonTypeToGenericKeyStringType(BSONType type) {
@@ -587,7 +620,13 @@ void KeyString::_appendDoubleWithoutTypeBits(const double num,
             const size_t fractionalBytes = countLeadingZeros64(integerPart << 1) / 8;
             const auto ctype = isNegative ? CType::kNumericNegative8ByteInt + fractionalBytes
                                           : CType::kNumericPositive8ByteInt - fractionalBytes;
-            _append(static_cast<uint8_t>(ctype), invert);
+            if (version >= Version::V2 && !isNegative && integerPart <= CType::kV2NumTinyInts) {
+                dassert(ctype == CType::kNumericPositive1ByteInt);
+                _append(CType::v2TinyIntCType(integerPart, true), invert);
+            } else {
+                _append(CType::toVersionedNumericCType(version, static_cast<uint8_t>(ctype)),
+                        invert);
+            }
 
             // Multiplying the double by 256 to the power X is logically equivalent to shifting the
             // fraction left by X bytes.
@@ -638,8 +677,10 @@ void KeyString::_appendNumberDecimal(const Decimal128 dec, bool invert) {
     }
 
     if (dec.isInfinite()) {
-        _append(isNegative ? CType::kNumericNegativeLargeMagnitude
-                           : CType::kNumericPositiveLargeMagnitude,
+        _append(CType::toVersionedNumericCType(version,
+                                               isNegative
+                                                   ? CType::kNumericNegativeLargeMagnitude
+                                                   : CType::kNumericPositiveLargeMagnitude),
                 invert);
         const uint64_t infinity = ~0ULL;
         _append(infinity, isNegative ? !invert : invert);
@@ -925,8 +966,9 @@ void KeyString::_appendLargeDouble(double value, DecimalContinuationMarker dcm,
     dassert(value != 0.0);
     invariant(dcm != kDCMEqualToDoubleRoundedUpTo15Digits);  // only single DCM bit here
 
-    _append(value > 0 ? CType::kNumericPositiveLargeMagnitude
-                      : CType::kNumericNegativeLargeMagnitude,
+    _append(CType::toVersionedNumericCType(version,
+                                           value > 0 ? CType::kNumericPositiveLargeMagnitude
+                                                     : CType::kNumericNegativeLargeMagnitude),
             invert);
 
     uint64_t encoded;
@@ -1013,8 +1055,9 @@ void KeyString::_appendHugeDecimalWithoutTypeBits(const Decimal128 dec, bool inv
     uint64_t lo = normalizedMagnitude.getValue().low64;
     dassert(hi < (1ULL << 63));
     hi |= (1ULL << 63);
-    _append(isNegative ? CType::kNumericNegativeLargeMagnitude
-                       : CType::kNumericPositiveLargeMagnitude,
+    _append(CType::toVersionedNumericCType(version,
+                                           isNegative ? CType::kNumericNegativeLargeMagnitude
+                                                      : CType::kNumericPositiveLargeMagnitude),
             invert);
     _append(endian::nativeToBig(hi), isNegative ? !invert : invert);
     _append(endian::nativeToBig(lo), isNegative ? !invert : invert);
@@ -1044,6 +1087,13 @@ void KeyString::_appendPreshiftedIntegerPortion(uint64_t value, bool isNegative,
     dassert(value != 0ULL);
     dassert(value != 1ULL);
 
+    if (version >= Version::V2 && !isNegative && !(value & 1) &&
+        (value >> 1) <= CType::kV2NumTinyInts) {
+        // A whole number small enough to be encoded in the type byte.
+        _append(CType::v2TinyIntCType(value >> 1, false), invert);
+        return;
+    }
+
     const size_t bytesNeeded = (64 - countLeadingZeros64(value) + 7) / 8;
 
     // Append the low bytes of value in big endian order.
@@ -1054,7 +1104,9 @@ void KeyString::_appendPreshiftedIntegerPortion(uint64_t value, bool isNegative,
         _append(uint8_t(CType::kNumericNegative1ByteInt - (bytesNeeded - 1)), invert);
         _appendBytes(firstUsedByte, bytesNeeded, !invert);
     } else {
-        _append(uint8_t(CType::kNumericPositive1ByteInt + (bytesNeeded - 1)), invert);
+        _append(CType::toVersionedNumericCType(
+                    version, uint8_t(CType::kNumericPositive1ByteInt + (bytesNeeded - 1))),
+                invert);
         _appendBytes(firstUsedByte, bytesNeeded, invert);
     }
 }
@@ -1136,6 +1188,38 @@ void toBsonValue(uint8_t ctype,
     // since it is used across a fallthrough.
     bool isNegative = false;
 
+    if (version >= KeyString::Version::V2 && ctype >= CType::kV2NumericPositiveTinyInt1 &&
+        ctype <= CType::kV2NumericPositiveLargeMagnitude) {
+        const uint8_t tinyIntOffset = ctype - CType::kV2NumericPositiveTinyInt1;
+        if (tinyIntOffset >= CType::kV2NumTinyIntCTypes) {
+            // Every other positive numeric ctype is shifted up to make room for the tiny integers.
+            ctype -= CType::kV2NumTinyIntCTypes;
+        } else if (tinyIntOffset % 2) {
+            // A non-integer with a tiny integer part, which is followed by the same bytes as with
+            // kNumericPositive1ByteInt.
+            ctype = CType::kNumericPositive1ByteInt;
+        } else {
+            const int value = tinyIntOffset / 2 + 1;
+            switch (typeBits->readNumeric()) {
+                case TypeBits::kDouble:
+                    *stream << double(value);
+                    break;
+                case TypeBits::kInt:
+                    *stream << value;
+                    break;
+                case TypeBits::kLong:
+                    *stream << static_cast<long long>(value);
+                    break;
+                case TypeBits::kDecimal:
+                    *stream << adjustDecimalExponent(typeBits, Decimal128(value));
+                    break;
+                default:
+                    MONGO_UNREACHABLE;
+            }
+            return;
+        }
+    }
+
     switch (ctype) {
         case CType::kMinKey:
             *stream << MINKEY;
@@ -1302,7 +1386,7 @@ void toBsonValue(uint8_t ctype,
             if (type == TypeBits::kDouble) {
                 *stream << std::numeric_limits<double>::quiet_NaN();
             } else {
-                invariant(type == TypeBits::kDecimal && version == KeyString::Version::V1);
+                invariant(type == TypeBits::kDecimal && version != KeyString::Version::V0);
                 *stream << Decimal128::kPositiveNaN;
             }
             break;
@@ -40,6 +40,7 @@
 #include "mongo/bson/timestamp.h"
 #include "mongo/db/record_id.h"
 #include "mongo/platform/decimal128.h"
+#include "mongo/util/assert_util.h"
 
 namespace mongo {
 
@@ -47,16 +48,26 @@ class KeyString {
 public:
     /**
      * Selects version of KeyString to use. V0 and V1 differ in their encoding of numeric values.
+     * V2 is V1 with the positive integers 1 through 4 encoded in the type byte alone, which saves
+     * a byte for the small values common in compound index keys.
      */
-    enum class Version : uint8_t { V0 = 0, V1 = 1 };
+    enum class Version : uint8_t { V0 = 0, V1 = 1, V2 = 2 };
     static StringData versionToString(Version version) {
-        return version == Version::V0 ? "V0" : "V1";
+        switch (version) {
+            case Version::V0:
+                return "V0";
+            case Version::V1:
+                return "V1";
+            case Version::V2:
+                return "V2";
+        }
+        MONGO_UNREACHABLE;
     }
 
     /**
      * Provides the latest version of KeyString available.
      */
-    static const Version kLatestVersion = Version::V1;
+    static const Version kLatestVersion = Version::V2;
 
     /**
      * Encodes info needed to restore the original BSONTypes from a KeyString. They cannot be
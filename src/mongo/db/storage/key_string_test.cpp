@@ -75,6 +75,8 @@ public:
             base->run();
             version = KeyString::Version::V1;
             base->run();
+            version = KeyString::Version::V2;
+            base->run();
         } catch (...) {
             log() << "exception while testing KeyString version "
                   << mongo::KeyString::versionToString(version);
@@ -149,10 +151,14 @@ TEST_F(KeyStringTest, ActualBytesDouble) {
                                                      "0B"              // (5 << 1) | 1
                                                      "02000000000000"  // fractional bytes of double
                                                      "04"              // kEnd
-                                                   : "2B"              // kNumericPositive1ByteInt
-                                                     "0B"              // (5 << 1) | 1
-                                                     "80000000000000"  // fractional bytes
-                                                     "04";             // kEnd
+        : version == KeyString::Version::V1 ? "2B"              // kNumericPositive1ByteInt
+                                              "0B"              // (5 << 1) | 1
+                                              "80000000000000"  // fractional bytes
+                                              "04"              // kEnd
+                                            : "33"              // V2 kNumericPositive1ByteInt
+                                              "0B"              // (5 << 1) | 1
+                                              "80000000000000"  // fractional bytes
+                                              "04";             // kEnd
 
     ASSERT_EQUALS(hex, toHex(ks.getBuffer(), ks.getSize()));
 
@@ -173,6 +179,51 @@ TEST_F(KeyStringTest, ActualBytesDouble) {
     ASSERT_EQUALS(hexFlipped, toHex(ks.getBuffer(), ks.getSize()));
 }
 
+TEST_F(KeyStringTest, ActualBytesTinyInts) {
+    const bool tiny = version >= KeyString::Version::V2;
+    ASSERT_EQUALS(tiny ? "2B04" : "2B0204",
+                  KeyString(version, BSON("" << 1), ALL_ASCENDING).toString());
+    ASSERT_EQUALS(tiny ? "3104" : "2B0804",
+                  KeyString(version, BSON("" << 4), ALL_ASCENDING).toString());
+    ASSERT_EQUALS(tiny ? "330A04" : "2B0A04",
+                  KeyString(version, BSON("" << 5), ALL_ASCENDING).toString());
+
+    // Non-integers with a tiny integer part get the type byte following that of the integer.
+    ASSERT_EQUALS(tiny ? "2C" : "2B",
+                  KeyString(version, BSON("" << 1.5), ALL_ASCENDING).toString().substr(0, 2));
+
+    // Negative numbers and fractions never use the single byte encoding.
+    ASSERT_EQUALS(3U, KeyString(version, BSON("" << -1), ALL_ASCENDING).getSize());
+    ASSERT_EQUALS(KeyString(version, BSON("" << 1.5), ALL_ASCENDING).getSize(),
+                  KeyString(version, BSON("" << 9.5), ALL_ASCENDING).getSize());
+}
+
+TEST_F(KeyStringTest, TinyIntsRoundtripAndOrder) {
+    std::vector<BSONObj> numbers;
+    for (int i = -10; i <= 10; i++) {
+        numbers.push_back(BSON("" << i));
+        numbers.push_back(BSON("" << static_cast<long long>(i)));
+        numbers.push_back(BSON("" << static_cast<double>(i)));
+        numbers.push_back(BSON("" << i + 0.5));
+        numbers.push_back(BSON("" << i + 0.999));
+        if (version != KeyString::Version::V0) {
+            numbers.push_back(BSON("" << Decimal128(i)));
+            numbers.push_back(BSON("" << Decimal128(i).add(Decimal128("0.00"))));
+        }
+    }
+    numbers.push_back(BSON("" << 0.25));
+    numbers.push_back(BSON("" << std::numeric_limits<double>::infinity()));
+    numbers.push_back(BSON("" << std::numeric_limits<long long>::max()));
+
+    for (auto&& x : numbers) {
+        ROUNDTRIP(version, x);
+        for (auto&& y : numbers) {
+            COMPARES_SAME(version, x, y);
+        }
+        ROUNDTRIP(version, BSON("" << BSON("a" << x.firstElement())));
+    }
+}
+
 TEST_F(KeyStringTest, AllTypesSimple) {
     ROUNDTRIP(version, BSON("" << 5.5));
     ROUNDTRIP(version,
@@ -35,6 +35,7 @@
 #include <vector>
 
 #include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
 #include "mongo/base/string_data.h"
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/storage/kv/kv_prefix.h"
@@ -183,6 +184,21 @@ public:
         MONGO_UNREACHABLE;
     }
 
+    /**
+     * See StorageEngine::beginNonBlockingBackup for details
+     */
+    virtual StatusWith<std::vector<std::string>> beginNonBlockingBackup(OperationContext* opCtx) {
+        return Status(ErrorCodes::CommandNotSupported,
+                      "The current storage engine doesn't support a non-blocking backup");
+    }
+
+    /**
+     * See StorageEngine::endNonBlockingBackup for details
+     */
+    virtual void endNonBlockingBackup(OperationContext* opCtx) {
+        MONGO_UNREACHABLE;
+    }
+
     virtual bool isDurable() const = 0;
 
     /**
@@ -263,6 +279,13 @@ public:
         return false;
     }
 
+    /**
+     * See `StorageEngine::isCacheUnderPressure`
+     */
+    virtual bool isCacheUnderPressure() const {
+        return false;
+    }
+
     /**
      * The destructor will never be called from mongod, but may be called from tests.
      * Engines may assume that this will only be called in the case of clean shutdown, even if
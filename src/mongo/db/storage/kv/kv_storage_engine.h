@@ -104,6 +104,10 @@ public:
 
     virtual void endBackup(OperationContext* opCtx);
 
+    virtual StatusWith<std::vector<std::string>> beginNonBlockingBackup(OperationContext* opCtx);
+
+    virtual void endNonBlockingBackup(OperationContext* opCtx);
+
     virtual bool isDurable() const;
 
     virtual bool isEphemeral() const;
@@ -118,6 +122,8 @@ public:
 
     virtual bool supportsRecoverToStableTimestamp() const override;
 
+    virtual bool isCacheUnderPressure() const override;
+
     SnapshotManager* getSnapshotManager() const final;
 
     void setJournalListener(JournalListener* jl) final;
@@ -252,6 +252,26 @@ public:
         return;
     }
 
+    /**
+     * Pins the storage engine's latest checkpoint so that its files can be copied while writes
+     * continue, and returns the names of those files relative to the dbpath. Copying each file up
+     * to its size at the time of this call yields a consistent copy of the data.
+     *
+     * Storage engines that implement this must also implement endNonBlockingBackup(). Only one
+     * backup, blocking or not, may be open at a time.
+     */
+    virtual StatusWith<std::vector<std::string>> beginNonBlockingBackup(OperationContext* opCtx) {
+        return Status(ErrorCodes::CommandNotSupported,
+                      "The current storage engine doesn't support a non-blocking backup");
+    }
+
+    /**
+     * Releases the checkpoint pinned by beginNonBlockingBackup().
+     */
+    virtual void endNonBlockingBackup(OperationContext* opCtx) {
+        return;
+    }
+
     /**
      * Recover as much data as possible from a potentially corrupt RecordStore.
      * This only recovers the record data, not indexes or anything else.
@@ -328,6 +348,16 @@ public:
      */
     virtual void setInitialDataTimestamp(SnapshotName snapshotName) {}
 
+    /**
+     * Returns whether the storage engine's cache is currently under eviction pressure, for
+     * example because dirty data is accumulating faster than it can be written out. Background
+     * tasks which generate a lot of writes, such as orphan range deletion, may use this to back
+     * off. Engines which do not track this always return false.
+     */
+    virtual bool isCacheUnderPressure() const {
+        return false;
+    }
+
     // (CollectionName, IndexName)
     typedef std::pair<std::string, std::string> CollectionIndexNamePair;
 
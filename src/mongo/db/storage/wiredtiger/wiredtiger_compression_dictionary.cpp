@@ -0,0 +1,700 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_compression_dictionary.h"
+
+#include <algorithm>
+#include <boost/filesystem/operations.hpp>
+#include <zlib.h>
+
+#include "mongo/base/data_view.h"
+#include "mongo/base/parse_number.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/platform/compiler.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/file.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+const char WiredTigerCompressionDictionaries::kCompressorNamePrefix[] = "mongodb_dictionary_";
+const char WiredTigerCompressionDictionaries::kDirectoryName[] = "compressionDictionaries";
+const char WiredTigerCompressionDictionaries::kExtensionConfig[] =
+    "local={entry=mongo_compression_dictionary_extension}";
+
+namespace {
+
+const size_t kBlockHeaderSize = sizeof(uint32_t);
+const char kDictionaryFileSuffix[] = ".dict";
+
+// Candidate strings longer than this are unlikely to repeat and only crowd out field names.
+const int kMaxTrainedStringSize = 64;
+
+// WiredTiger's default leaf page size, used to evaluate a dictionary against realistic blocks.
+const size_t kEvaluationBlockSize = 32 * 1024;
+
+std::string dictionaryFileName(uint64_t id, uint32_t version) {
+    return str::stream() << id << "." << version << kDictionaryFileSuffix;
+}
+
+/**
+ * Parses "<id>.<version>.dict". Returns false for anything else, including leftover temporary
+ * files from an interrupted write.
+ */
+bool parseDictionaryFileName(StringData fileName, uint64_t* id, uint32_t* version) {
+    if (!fileName.endsWith(kDictionaryFileSuffix)) {
+        return false;
+    }
+    fileName = fileName.substr(0, fileName.size() - strlen(kDictionaryFileSuffix));
+    size_t dot = fileName.find('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    long long parsedId;
+    int parsedVersion;
+    if (!parseNumberFromStringWithBase(fileName.substr(0, dot), 10, &parsedId).isOK() ||
+        !parseNumberFromStringWithBase(fileName.substr(dot + 1), 10, &parsedVersion).isOK() ||
+        parsedId <= 0 || parsedVersion < 0) {
+        return false;
+    }
+    *id = static_cast<uint64_t>(parsedId);
+    *version = static_cast<uint32_t>(parsedVersion);
+    return true;
+}
+
+void countCandidates(const BSONObj& obj, std::map<std::string, size_t>* counts) {
+    for (auto&& elem : obj) {
+        // The type byte and the field name, including its terminating NUL.
+        (*counts)[std::string(elem.rawdata(), 1 + elem.fieldNameSize())]++;
+
+        switch (elem.type()) {
+            case String:
+                if (elem.valuestrsize() <= kMaxTrainedStringSize) {
+                    (*counts)[std::string(elem.rawdata(), elem.size())]++;
+                }
+                break;
+            case Object:
+            case Array:
+                countCandidates(elem.embeddedObject(), counts);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * The zlib streams of a thread. Initializing a stream allocates and sets up several hundred KB of
+ * state, which would cost more than compressing a block, so each thread initializes its streams
+ * once and resets them before each block.
+ */
+class ThreadStreams {
+    MONGO_DISALLOW_COPYING(ThreadStreams);
+
+public:
+    ThreadStreams() {
+        memset(&_deflateStream, 0, sizeof(_deflateStream));
+        memset(&_inflateStream, 0, sizeof(_inflateStream));
+    }
+
+    ~ThreadStreams() {
+        if (_deflateInitialized) {
+            deflateEnd(&_deflateStream);
+        }
+        if (_inflateInitialized) {
+            inflateEnd(&_inflateStream);
+        }
+    }
+
+    /**
+     * Returns a deflate stream ready for a new block, or nullptr if zlib fails.
+     */
+    z_stream* getDeflateStream() {
+        if (!_deflateInitialized) {
+            if (deflateInit(&_deflateStream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+                return nullptr;
+            }
+            _deflateInitialized = true;
+        } else if (deflateReset(&_deflateStream) != Z_OK) {
+            return nullptr;
+        }
+        return &_deflateStream;
+    }
+
+    /**
+     * Returns an inflate stream ready for a new block, or nullptr if zlib fails.
+     */
+    z_stream* getInflateStream() {
+        if (!_inflateInitialized) {
+            if (inflateInit(&_inflateStream) != Z_OK) {
+                return nullptr;
+            }
+            _inflateInitialized = true;
+        } else if (inflateReset(&_inflateStream) != Z_OK) {
+            return nullptr;
+        }
+        return &_inflateStream;
+    }
+
+private:
+    z_stream _deflateStream;
+    bool _deflateInitialized = false;
+    z_stream _inflateStream;
+    bool _inflateInitialized = false;
+};
+
+thread_local ThreadStreams threadStreams;
+
+int compressWithDictionary(const std::string& dictionary,
+                           const uint8_t* src,
+                           size_t srcLen,
+                           uint8_t* dst,
+                           size_t dstLen,
+                           size_t* resultLen,
+                           int* compressionFailed) {
+    z_stream* const zs = threadStreams.getDeflateStream();
+    if (!zs) {
+        return WT_ERROR;
+    }
+
+    if (!dictionary.empty() &&
+        deflateSetDictionary(
+            zs, reinterpret_cast<const Bytef*>(dictionary.data()), dictionary.size()) != Z_OK) {
+        return WT_ERROR;
+    }
+
+    zs->next_in = const_cast<Bytef*>(src);
+    zs->avail_in = srcLen;
+    zs->next_out = dst;
+    zs->avail_out = dstLen;
+
+    int ret = deflate(zs, Z_FINISH);
+    if (ret == Z_STREAM_END) {
+        *compressionFailed = 0;
+        *resultLen = zs->total_out;
+        return 0;
+    }
+    if (ret == Z_OK || ret == Z_BUF_ERROR) {
+        *compressionFailed = 1;
+        return 0;
+    }
+    return WT_ERROR;
+}
+
+/**
+ * Returns the total compressed size of 'samples' packed into page-sized blocks.
+ */
+size_t evaluateDictionary(const std::string& dictionary, const std::vector<BSONObj>& samples) {
+    std::vector<uint8_t> out(2 * kEvaluationBlockSize + 1024);
+    size_t total = 0;
+    std::string block;
+
+    auto flush = [&] {
+        size_t resultLen = block.size();
+        int failed = 0;
+        if (!block.empty() &&
+            compressWithDictionary(dictionary,
+                                   reinterpret_cast<const uint8_t*>(block.data()),
+                                   block.size(),
+                                   out.data(),
+                                   out.size(),
+                                   &resultLen,
+                                   &failed) == 0 &&
+            !failed) {
+            total += resultLen;
+        } else {
+            total += block.size();
+        }
+        block.clear();
+    };
+
+    for (auto&& sample : samples) {
+        if (block.size() + sample.objsize() > kEvaluationBlockSize) {
+            flush();
+        }
+        block.append(sample.objdata(), std::min<size_t>(sample.objsize(), kEvaluationBlockSize));
+    }
+    flush();
+    return total;
+}
+
+}  // namespace
+
+WiredTigerCompressionDictionaries* WiredTigerCompressionDictionaries::get() {
+    static WiredTigerCompressionDictionaries instance;
+    return &instance;
+}
+
+Status WiredTigerCompressionDictionaries::open(const std::string& dbpath, bool readOnly) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _directory = (boost::filesystem::path(dbpath) / kDirectoryName).string();
+    _readOnly = readOnly;
+    _conn = nullptr;
+    _nextId = 1;
+    _sets.clear();
+    _droppedCompressors.clear();
+    _droppedFiles.clear();
+    _nextDropMarker = 0;
+
+    try {
+        if (!boost::filesystem::exists(_directory)) {
+            return Status::OK();
+        }
+
+        for (boost::filesystem::directory_iterator it(_directory), end; it != end; ++it) {
+            uint64_t id;
+            uint32_t version;
+            if (!parseDictionaryFileName(it->path().filename().string(), &id, &version)) {
+                continue;
+            }
+
+            File file;
+            file.open(it->path().string().c_str(), true /* readOnly */);
+            std::string dictionary(file.bad() ? 0 : file.len(), '\0');
+            if (!dictionary.empty()) {
+                file.read(0, &dictionary[0], dictionary.size());
+            }
+            if (file.bad()) {
+                return Status(ErrorCodes::FileStreamFailed,
+                              str::stream() << "Failed to read compression dictionary "
+                                            << it->path().string());
+            }
+
+            DictionarySet* set = _getOrCreateSet_inlock(id);
+            if (set->versions.size() <= version) {
+                set->versions.resize(version + 1);
+            }
+            set->versions[version] = std::make_shared<const std::string>(std::move(dictionary));
+            _nextId = std::max(_nextId, id + 1);
+        }
+    } catch (const boost::filesystem::filesystem_error& ex) {
+        return Status(ErrorCodes::FileStreamFailed,
+                      str::stream() << "Failed to load compression dictionaries from "
+                                    << _directory
+                                    << ": "
+                                    << ex.what());
+    }
+
+    LOG(1) << "Loaded " << _sets.size() << " compression dictionary sets from " << _directory;
+    return Status::OK();
+}
+
+bool WiredTigerCompressionDictionaries::isInUse() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return !_sets.empty();
+}
+
+Status WiredTigerCompressionDictionaries::registerCompressors(WT_CONNECTION* conn) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _conn = conn;
+    for (auto&& entry : _sets) {
+        Status status = _register(conn, &entry.second);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    return Status::OK();
+}
+
+StatusWith<std::string> WiredTigerCompressionDictionaries::createCompressor() {
+    stdx::lock_guard<stdx::mutex> persistLk(_persistMutex);
+
+    uint64_t id;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_readOnly || _directory.empty()) {
+            return Status(ErrorCodes::IllegalOperation,
+                          "Dictionary compression is not available on this storage engine");
+        }
+        id = _nextId++;
+    }
+
+    Status status = _persist(id, 0, std::string());
+    if (!status.isOK()) {
+        return status;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    DictionarySet* set = _getOrCreateSet_inlock(id);
+    set->versions.push_back(std::make_shared<const std::string>());
+    if (_conn) {
+        status = _register(_conn, set);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    return std::string(str::stream() << kCompressorNamePrefix << id);
+}
+
+void WiredTigerCompressionDictionaries::dropCompressor(uint64_t id) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _sets.find(id);
+    if (it == _sets.end()) {
+        return;
+    }
+
+    if (!_readOnly) {
+        _droppedFiles.push_back({_nextDropMarker++, id, uint32_t(it->second.versions.size())});
+    }
+    _droppedCompressors.push_back(std::move(it->second.compressor));
+    _sets.erase(it);
+}
+
+uint64_t WiredTigerCompressionDictionaries::getDropMarker() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _nextDropMarker;
+}
+
+Status WiredTigerCompressionDictionaries::removeDroppedFiles(uint64_t dropMarker) {
+    stdx::lock_guard<stdx::mutex> persistLk(_persistMutex);
+
+    boost::filesystem::path directory(_directory);
+    while (true) {
+        DroppedFiles dropped;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (_droppedFiles.empty() || _droppedFiles.front().dropMarker >= dropMarker) {
+                return Status::OK();
+            }
+            dropped = _droppedFiles.front();
+        }
+
+        try {
+            for (uint32_t version = 0; version < dropped.numVersions; ++version) {
+                boost::filesystem::remove(directory / dictionaryFileName(dropped.id, version));
+            }
+        } catch (const boost::filesystem::filesystem_error& ex) {
+            return Status(ErrorCodes::FileStreamFailed,
+                          str::stream() << "Failed to remove compression dictionaries of set "
+                                        << dropped.id
+                                        << ": "
+                                        << ex.what());
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _droppedFiles.pop_front();
+    }
+}
+
+bool WiredTigerCompressionDictionaries::parseCompressorName(StringData compressorName,
+                                                            uint64_t* id) {
+    if (!compressorName.startsWith(kCompressorNamePrefix)) {
+        return false;
+    }
+    long long parsedId;
+    if (!parseNumberFromStringWithBase(
+             compressorName.substr(strlen(kCompressorNamePrefix)), 10, &parsedId)
+             .isOK() ||
+        parsedId <= 0) {
+        return false;
+    }
+    *id = static_cast<uint64_t>(parsedId);
+    return true;
+}
+
+Status WiredTigerCompressionDictionaries::train(uint64_t id, const std::vector<BSONObj>& samples) {
+    stdx::lock_guard<stdx::mutex> persistLk(_persistMutex);
+
+    uint32_t current;
+    auto currentDictionary = _getCurrentDictionary(id, &current);
+    if (!currentDictionary) {
+        return Status(ErrorCodes::NoSuchKey,
+                      str::stream() << "Unknown compression dictionary set " << id);
+    }
+
+    std::string dictionary = trainDictionary(samples, kMaxDictionarySize);
+    if (dictionary.empty()) {
+        return Status::OK();
+    }
+
+    // Keep the current dictionary unless the new one actually does better on the same data.
+    const size_t currentSize = evaluateDictionary(*currentDictionary, samples);
+    const size_t trainedSize = evaluateDictionary(dictionary, samples);
+    LOG(1) << "Trained a " << dictionary.size() << " byte compression dictionary for set " << id
+           << " from " << samples.size() << " samples: " << currentSize << " -> " << trainedSize
+           << " bytes";
+    if (trainedSize >= currentSize) {
+        return Status::OK();
+    }
+
+    const uint32_t version = current + 1;
+    Status status = _persist(id, version, dictionary);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    DictionarySet* set = _getOrCreateSet_inlock(id);
+    set->versions.resize(version + 1);
+    set->versions[version] = std::make_shared<const std::string>(std::move(dictionary));
+    return Status::OK();
+}
+
+std::string WiredTigerCompressionDictionaries::trainDictionary(const std::vector<BSONObj>& samples,
+                                                               size_t maxSize) {
+    std::map<std::string, size_t> counts;
+    for (auto&& sample : samples) {
+        countCandidates(sample, &counts);
+    }
+
+    // Score each string by the number of bytes it would save across the samples. Strings seen
+    // only once cannot benefit from a shared dictionary.
+    std::vector<std::pair<size_t, const std::string*>> scored;
+    for (auto&& entry : counts) {
+        if (entry.second > 1) {
+            scored.emplace_back(entry.second * entry.first.size(), &entry.first);
+        }
+    }
+    std::sort(scored.begin(), scored.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    std::vector<const std::string*> chosen;
+    size_t size = 0;
+    for (auto&& candidate : scored) {
+        if (size + candidate.second->size() > maxSize) {
+            continue;
+        }
+        chosen.push_back(candidate.second);
+        size += candidate.second->size();
+    }
+
+    // zlib encodes nearer matches more cheaply, so the best strings go last.
+    std::string dictionary;
+    dictionary.reserve(size);
+    for (auto it = chosen.rbegin(); it != chosen.rend(); ++it) {
+        dictionary.append(**it);
+    }
+    return dictionary;
+}
+
+uint32_t WiredTigerCompressionDictionaries::currentVersion(uint64_t id) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _sets.find(id);
+    if (it == _sets.end() || it->second.versions.empty()) {
+        return 0;
+    }
+    return it->second.versions.size() - 1;
+}
+
+int WiredTigerCompressionDictionaries::compress(uint64_t id,
+                                                const uint8_t* src,
+                                                size_t srcLen,
+                                                uint8_t* dst,
+                                                size_t dstLen,
+                                                size_t* resultLen,
+                                                int* compressionFailed) const {
+    if (dstLen <= kBlockHeaderSize) {
+        *compressionFailed = 1;
+        return 0;
+    }
+
+    uint32_t version;
+    auto dictionary = _getCurrentDictionary(id, &version);
+    if (!dictionary) {
+        error() << "Missing compression dictionaries for set " << id;
+        return WT_ERROR;
+    }
+
+    DataView(reinterpret_cast<char*>(dst)).write<LittleEndian<uint32_t>>(version);
+    int ret = compressWithDictionary(*dictionary,
+                                     src,
+                                     srcLen,
+                                     dst + kBlockHeaderSize,
+                                     dstLen - kBlockHeaderSize,
+                                     resultLen,
+                                     compressionFailed);
+    if (ret == 0 && !*compressionFailed) {
+        *resultLen += kBlockHeaderSize;
+    }
+    return ret;
+}
+
+int WiredTigerCompressionDictionaries::decompress(uint64_t id,
+                                                  const uint8_t* src,
+                                                  size_t srcLen,
+                                                  uint8_t* dst,
+                                                  size_t dstLen,
+                                                  size_t* resultLen) const {
+    if (srcLen < kBlockHeaderSize) {
+        return WT_ERROR;
+    }
+
+    const uint32_t version =
+        ConstDataView(reinterpret_cast<const char*>(src)).read<LittleEndian<uint32_t>>();
+    auto dictionary = _getDictionary(id, version);
+    if (!dictionary) {
+        error() << "Missing compression dictionary " << version << " for set " << id;
+        return WT_ERROR;
+    }
+
+    z_stream* const zs = threadStreams.getInflateStream();
+    if (!zs) {
+        return WT_ERROR;
+    }
+
+    zs->next_in = const_cast<Bytef*>(src + kBlockHeaderSize);
+    zs->avail_in = srcLen - kBlockHeaderSize;
+    zs->next_out = dst;
+    zs->avail_out = dstLen;
+
+    int ret = inflate(zs, Z_FINISH);
+    if (ret == Z_NEED_DICT) {
+        if (inflateSetDictionary(zs,
+                                 reinterpret_cast<const Bytef*>(dictionary->data()),
+                                 dictionary->size()) != Z_OK) {
+            return WT_ERROR;
+        }
+        ret = inflate(zs, Z_FINISH);
+    }
+    if (ret != Z_STREAM_END) {
+        return WT_ERROR;
+    }
+    *resultLen = zs->total_out;
+    return 0;
+}
+
+std::shared_ptr<const std::string> WiredTigerCompressionDictionaries::_getDictionary(
+    uint64_t id, uint32_t version) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _sets.find(id);
+    if (it == _sets.end() || it->second.versions.size() <= version) {
+        return nullptr;
+    }
+    return it->second.versions[version];
+}
+
+std::shared_ptr<const std::string> WiredTigerCompressionDictionaries::_getCurrentDictionary(
+    uint64_t id, uint32_t* version) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _sets.find(id);
+    if (it == _sets.end() || it->second.versions.empty()) {
+        return nullptr;
+    }
+    *version = it->second.versions.size() - 1;
+    return it->second.versions.back();
+}
+
+Status WiredTigerCompressionDictionaries::_persist(uint64_t id,
+                                                   uint32_t version,
+                                                   const std::string& dictionary) {
+    boost::filesystem::path directory(_directory);
+    boost::filesystem::path path = directory / dictionaryFileName(id, version);
+    boost::filesystem::path tempPath = directory / (dictionaryFileName(id, version) + ".tmp");
+    try {
+        boost::filesystem::create_directories(directory);
+
+        {
+            File file;
+            file.open(tempPath.string().c_str());
+            if (!file.bad()) {
+                file.truncate(0);
+            }
+            if (!file.bad() && !dictionary.empty()) {
+                file.write(0, dictionary.data(), dictionary.size());
+            }
+            if (file.bad()) {
+                return Status(ErrorCodes::FileStreamFailed,
+                              str::stream() << "Failed to write compression dictionary "
+                                            << tempPath.string());
+            }
+            // The dictionary must be durable before any block compressed with it can be.
+            file.fsync();
+        }
+
+        boost::filesystem::rename(tempPath, path);
+    } catch (const boost::filesystem::filesystem_error& ex) {
+        return Status(ErrorCodes::FileStreamFailed,
+                      str::stream() << "Failed to persist compression dictionary " << path.string()
+                                    << ": "
+                                    << ex.what());
+    }
+    return Status::OK();
+}
+
+Status WiredTigerCompressionDictionaries::_register(WT_CONNECTION* conn, DictionarySet* set) {
+    invariant(set->compressor);
+    const std::string name = str::stream() << kCompressorNamePrefix << set->compressor->id;
+    return wtRCToStatus(
+        conn->add_compressor(conn, name.c_str(), &set->compressor->wtCompressor, nullptr));
+}
+
+WiredTigerCompressionDictionaries::DictionarySet*
+WiredTigerCompressionDictionaries::_getOrCreateSet_inlock(uint64_t id) {
+    DictionarySet& set = _sets[id];
+    if (!set.compressor) {
+        set.compressor = stdx::make_unique<Compressor>();
+        memset(&set.compressor->wtCompressor, 0, sizeof(WT_COMPRESSOR));
+        set.compressor->wtCompressor.compress = _wtCompress;
+        set.compressor->wtCompressor.decompress = _wtDecompress;
+        set.compressor->owner = this;
+        set.compressor->id = id;
+    }
+    return &set;
+}
+
+int WiredTigerCompressionDictionaries::_wtCompress(WT_COMPRESSOR* compressor,
+                                                   WT_SESSION* session,
+                                                   uint8_t* src,
+                                                   size_t srcLen,
+                                                   uint8_t* dst,
+                                                   size_t dstLen,
+                                                   size_t* resultLen,
+                                                   int* compressionFailed) {
+    auto self = reinterpret_cast<Compressor*>(compressor);
+    return self->owner->compress(self->id, src, srcLen, dst, dstLen, resultLen, compressionFailed);
+}
+
+int WiredTigerCompressionDictionaries::_wtDecompress(WT_COMPRESSOR* compressor,
+                                                     WT_SESSION* session,
+                                                     uint8_t* src,
+                                                     size_t srcLen,
+                                                     uint8_t* dst,
+                                                     size_t dstLen,
+                                                     size_t* resultLen) {
+    auto self = reinterpret_cast<Compressor*>(compressor);
+    return self->owner->decompress(self->id, src, srcLen, dst, dstLen, resultLen);
+}
+
+extern "C" MONGO_COMPILER_API_EXPORT int mongo_compression_dictionary_extension(
+    WT_CONNECTION* conn, WT_CONFIG_ARG* cfg) {
+    Status status = WiredTigerCompressionDictionaries::get()->registerCompressors(conn);
+    if (!status.isOK()) {
+        error() << "Failed to register compression dictionaries: " << status;
+        return WT_ERROR;
+    }
+    return 0;
+}
+
+}  // namespace mongo
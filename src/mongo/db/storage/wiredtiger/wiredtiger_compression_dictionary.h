@@ -0,0 +1,248 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <wiredtiger.h>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+/**
+ * Manages the per-collection compression dictionaries used by the "dictionary" collection
+ * block compressor.
+ *
+ * Every collection created with dictionary compression gets its own WiredTiger compressor, named
+ * with 'kCompressorNamePrefix' followed by a numeric id. A compressor owns a list of dictionary
+ * versions. Version 0 is always the empty dictionary, so a freshly created collection behaves like
+ * a plain zlib collection until a dictionary has been trained from its documents. Each compressed
+ * block starts with the version of the dictionary used to produce it, which allows retraining
+ * (on 'compact') without rewriting the blocks compressed with an older dictionary.
+ *
+ * Dictionaries are persisted as files in the 'compressionDictionaries' directory under the dbpath.
+ * Because WiredTiger may need to decompress blocks during recovery, all persisted compressors are
+ * registered from a WiredTiger extension ('kExtensionConfig') which runs inside wiredtiger_open.
+ */
+class WiredTigerCompressionDictionaries {
+    MONGO_DISALLOW_COPYING(WiredTigerCompressionDictionaries);
+
+public:
+    static const char kCompressorNamePrefix[];
+    static const char kDirectoryName[];
+
+    /**
+     * The `wiredtiger_open` extension which registers the compressors of the global instance.
+     */
+    static const char kExtensionConfig[];
+
+    /**
+     * zlib only looks back 32KB, so any larger dictionary would be wasted.
+     */
+    static const size_t kMaxDictionarySize = 32 * 1024;
+
+    /**
+     * Number of documents sampled from a collection to train a new dictionary.
+     */
+    static const size_t kTrainingSampleSize = 1000;
+
+    /**
+     * Returns the process-wide instance used by WiredTiger. The WiredTiger compressor callbacks do
+     * not carry any context beyond the compressor itself, so there is no ServiceContext to hang
+     * this off.
+     */
+    static WiredTigerCompressionDictionaries* get();
+
+    WiredTigerCompressionDictionaries() = default;
+
+    /**
+     * Sets the directory where dictionaries are persisted, and loads any previously persisted
+     * dictionaries from it. Must be called before the connection is opened.
+     */
+    Status open(const std::string& dbpath, bool readOnly);
+
+    /**
+     * Returns true if any dictionary sets were loaded by 'open' or created since.
+     */
+    bool isInUse() const;
+
+    /**
+     * Registers one compressor per known dictionary set with 'conn'. Compressors created after
+     * this call are registered with 'conn' as they are created.
+     */
+    Status registerCompressors(WT_CONNECTION* conn);
+
+    /**
+     * Allocates and persists a new, untrained dictionary set and returns the name of the
+     * WiredTiger compressor to be used in a table's 'block_compressor' setting.
+     */
+    StatusWith<std::string> createCompressor();
+
+    /**
+     * Forgets the dictionaries of compressor 'id'. Must only be called once the table using the
+     * compressor has been dropped. WiredTiger cannot unregister a compressor, so the compressor
+     * itself stays registered with the connection, but without any dictionaries.
+     *
+     * Recovery may still need the dictionaries until the drop of the table is part of a checkpoint,
+     * so their files are only removed by a later call to removeDroppedFiles().
+     */
+    void dropCompressor(uint64_t id);
+
+    /**
+     * Returns a marker for the compressors dropped so far, to be passed to removeDroppedFiles()
+     * once a checkpoint which started after this call has completed.
+     */
+    uint64_t getDropMarker() const;
+
+    /**
+     * Removes the dictionary files of the compressors which were dropped before 'dropMarker' was
+     * returned by getDropMarker().
+     */
+    Status removeDroppedFiles(uint64_t dropMarker);
+
+    /**
+     * Returns true and sets 'id' if 'compressorName' names a dictionary compressor.
+     */
+    static bool parseCompressorName(StringData compressorName, uint64_t* id);
+
+    /**
+     * Trains a dictionary from 'samples' and, if it improves compression of the samples, persists
+     * it as the newest version for compressor 'id'. Blocks written from then on use it.
+     */
+    Status train(uint64_t id, const std::vector<BSONObj>& samples);
+
+    /**
+     * Builds a zlib preset dictionary of at most 'maxSize' bytes out of the byte strings that
+     * repeat most often across 'samples': BSON field headers (type byte and field name) and short
+     * string values. The most valuable strings are placed at the end, closest to the data.
+     */
+    static std::string trainDictionary(const std::vector<BSONObj>& samples, size_t maxSize);
+
+    /**
+     * Returns the newest dictionary version for compressor 'id', or 0 if it is unknown or has not
+     * been trained.
+     */
+    uint32_t currentVersion(uint64_t id) const;
+
+    /**
+     * Block codecs with the WT_COMPRESSOR calling conventions: a return value of 0 means success,
+     * and '*compressionFailed' is set if the output would not fit into 'dst'.
+     */
+    int compress(uint64_t id,
+                 const uint8_t* src,
+                 size_t srcLen,
+                 uint8_t* dst,
+                 size_t dstLen,
+                 size_t* resultLen,
+                 int* compressionFailed) const;
+    int decompress(uint64_t id,
+                   const uint8_t* src,
+                   size_t srcLen,
+                   uint8_t* dst,
+                   size_t dstLen,
+                   size_t* resultLen) const;
+
+private:
+    struct Compressor {
+        WT_COMPRESSOR wtCompressor;  // Must be first: WiredTiger hands back a pointer to it.
+        WiredTigerCompressionDictionaries* owner;
+        uint64_t id;
+    };
+
+    struct DictionarySet {
+        std::unique_ptr<Compressor> compressor;
+        // Indexed by version. Version 0 is the empty dictionary.
+        std::vector<std::shared_ptr<const std::string>> versions;
+    };
+
+    static int _wtCompress(WT_COMPRESSOR* compressor,
+                           WT_SESSION* session,
+                           uint8_t* src,
+                           size_t srcLen,
+                           uint8_t* dst,
+                           size_t dstLen,
+                           size_t* resultLen,
+                           int* compressionFailed);
+    static int _wtDecompress(WT_COMPRESSOR* compressor,
+                             WT_SESSION* session,
+                             uint8_t* src,
+                             size_t srcLen,
+                             uint8_t* dst,
+                             size_t dstLen,
+                             size_t* resultLen);
+
+    std::shared_ptr<const std::string> _getDictionary(uint64_t id, uint32_t version) const;
+
+    /**
+     * Returns the newest dictionary of compressor 'id' and sets 'version' to its version, or
+     * returns nullptr if the compressor is unknown.
+     */
+    std::shared_ptr<const std::string> _getCurrentDictionary(uint64_t id,
+                                                             uint32_t* version) const;
+    Status _persist(uint64_t id, uint32_t version, const std::string& dictionary);
+    Status _register(WT_CONNECTION* conn, DictionarySet* set);
+    DictionarySet* _getOrCreateSet_inlock(uint64_t id);
+
+    // Serializes writers of dictionary files. Acquire *before* _mutex, which the block codecs take
+    // and which must therefore never be held across I/O.
+    stdx::mutex _persistMutex;
+
+    mutable stdx::mutex _mutex;
+    std::string _directory;
+    bool _readOnly = false;
+    WT_CONNECTION* _conn = nullptr;
+    uint64_t _nextId = 1;
+    std::map<uint64_t, DictionarySet> _sets;
+
+    // Compressors of dropped tables. WiredTiger keeps pointing at them until the connection is
+    // closed, so they cannot be freed.
+    std::vector<std::unique_ptr<Compressor>> _droppedCompressors;
+
+    // Dropped compressors whose dictionary files have not been removed yet, in the order in which
+    // they were dropped.
+    struct DroppedFiles {
+        uint64_t dropMarker;
+        uint64_t id;
+        uint32_t numVersions;
+    };
+    std::deque<DroppedFiles> _droppedFiles;
+    uint64_t _nextDropMarker = 0;
+};
+
+}  // namespace mongo
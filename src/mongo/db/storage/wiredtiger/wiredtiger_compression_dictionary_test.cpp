@@ -0,0 +1,274 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_compression_dictionary.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::vector<BSONObj> makeEvents(int count) {
+    std::vector<BSONObj> events;
+    for (int i = 0; i < count; ++i) {
+        events.push_back(BSON("_id" << i << "eventType" << (i % 2 ? "pageView" : "click")
+                                    << "sessionIdentifier"
+                                    << i * 7919
+                                    << "note"
+                                    << ("n" + std::to_string(i * 7919))
+                                    << "context"
+                                    << BSON("userAgentFamily"
+                                            << "Firefox"
+                                            << "screenResolution"
+                                            << "1920x1080")));
+    }
+    return events;
+}
+
+std::string concatenate(const std::vector<BSONObj>& objs) {
+    std::string data;
+    for (auto&& obj : objs) {
+        data.append(obj.objdata(), obj.objsize());
+    }
+    return data;
+}
+
+std::string compressBlock(const WiredTigerCompressionDictionaries& dictionaries,
+                          uint64_t id,
+                          const std::string& data) {
+    std::string block(data.size() + 1024, '\0');
+    size_t resultLen = 0;
+    int failed = 0;
+    ASSERT_EQUALS(0,
+                  dictionaries.compress(id,
+                                        reinterpret_cast<const uint8_t*>(data.data()),
+                                        data.size(),
+                                        reinterpret_cast<uint8_t*>(&block[0]),
+                                        block.size(),
+                                        &resultLen,
+                                        &failed));
+    ASSERT_EQUALS(0, failed);
+    block.resize(resultLen);
+    return block;
+}
+
+std::string decompressBlock(const WiredTigerCompressionDictionaries& dictionaries,
+                            uint64_t id,
+                            const std::string& block,
+                            size_t originalSize) {
+    std::string data(originalSize, '\0');
+    size_t resultLen = 0;
+    ASSERT_EQUALS(0,
+                  dictionaries.decompress(id,
+                                          reinterpret_cast<const uint8_t*>(block.data()),
+                                          block.size(),
+                                          reinterpret_cast<uint8_t*>(&data[0]),
+                                          data.size(),
+                                          &resultLen));
+    ASSERT_EQUALS(originalSize, resultLen);
+    return data;
+}
+
+uint64_t createCompressor(WiredTigerCompressionDictionaries* dictionaries) {
+    StatusWith<std::string> name = dictionaries->createCompressor();
+    ASSERT_OK(name.getStatus());
+    uint64_t id;
+    ASSERT_TRUE(WiredTigerCompressionDictionaries::parseCompressorName(name.getValue(), &id));
+    return id;
+}
+
+TEST(WiredTigerCompressionDictionaryTest, ParseCompressorName) {
+    uint64_t id = 0;
+    ASSERT_TRUE(
+        WiredTigerCompressionDictionaries::parseCompressorName("mongodb_dictionary_12", &id));
+    ASSERT_EQUALS(12U, id);
+    ASSERT_FALSE(WiredTigerCompressionDictionaries::parseCompressorName("snappy", &id));
+    ASSERT_FALSE(
+        WiredTigerCompressionDictionaries::parseCompressorName("mongodb_dictionary_", &id));
+    ASSERT_FALSE(
+        WiredTigerCompressionDictionaries::parseCompressorName("mongodb_dictionary_0", &id));
+}
+
+TEST(WiredTigerCompressionDictionaryTest, TrainedDictionaryHoldsRepeatedFieldNames) {
+    std::string dictionary =
+        WiredTigerCompressionDictionaries::trainDictionary(makeEvents(100), 32 * 1024);
+    ASSERT_NOT_EQUALS(std::string::npos, dictionary.find("sessionIdentifier"));
+    ASSERT_NOT_EQUALS(std::string::npos, dictionary.find("userAgentFamily"));
+    ASSERT_NOT_EQUALS(std::string::npos, dictionary.find("pageView"));
+
+    // Values which never repeat are not worth a place in the dictionary.
+    ASSERT_EQUALS(std::string::npos, dictionary.find("n7919"));
+}
+
+TEST(WiredTigerCompressionDictionaryTest, TrainedDictionaryRespectsMaxSize) {
+    ASSERT_LESS_THAN_OR_EQUALS(
+        WiredTigerCompressionDictionaries::trainDictionary(makeEvents(100), 20).size(), 20U);
+    ASSERT_TRUE(WiredTigerCompressionDictionaries::trainDictionary({}, 1024).empty());
+}
+
+TEST(WiredTigerCompressionDictionaryTest, CreateRequiresOpen) {
+    WiredTigerCompressionDictionaries dictionaries;
+    ASSERT_EQUALS(ErrorCodes::IllegalOperation, dictionaries.createCompressor().getStatus());
+}
+
+TEST(WiredTigerCompressionDictionaryTest, RoundTripAcrossRetraining) {
+    unittest::TempDir dbpath("wt_compression_dictionary_test");
+    WiredTigerCompressionDictionaries dictionaries;
+    ASSERT_OK(dictionaries.open(dbpath.path(), false));
+    ASSERT_FALSE(dictionaries.isInUse());
+
+    const uint64_t id = createCompressor(&dictionaries);
+    ASSERT_TRUE(dictionaries.isInUse());
+    ASSERT_EQUALS(0U, dictionaries.currentVersion(id));
+
+    // A small block, where the lack of a shared dictionary hurts the most.
+    const std::string data = concatenate(makeEvents(2));
+    const std::string untrainedBlock = compressBlock(dictionaries, id, data);
+    ASSERT_EQUALS(data, decompressBlock(dictionaries, id, untrainedBlock, data.size()));
+
+    ASSERT_OK(dictionaries.train(id, makeEvents(200)));
+    ASSERT_EQUALS(1U, dictionaries.currentVersion(id));
+
+    const std::string trainedBlock = compressBlock(dictionaries, id, data);
+    ASSERT_LESS_THAN(trainedBlock.size(), untrainedBlock.size());
+    ASSERT_EQUALS(data, decompressBlock(dictionaries, id, trainedBlock, data.size()));
+
+    // Blocks written before retraining remain readable.
+    ASSERT_EQUALS(data, decompressBlock(dictionaries, id, untrainedBlock, data.size()));
+
+    // Dictionaries survive a restart.
+    WiredTigerCompressionDictionaries reopened;
+    ASSERT_OK(reopened.open(dbpath.path(), false));
+    ASSERT_EQUALS(1U, reopened.currentVersion(id));
+    ASSERT_EQUALS(data, decompressBlock(reopened, id, trainedBlock, data.size()));
+    ASSERT_EQUALS(data, decompressBlock(reopened, id, untrainedBlock, data.size()));
+    ASSERT_NOT_EQUALS(id, createCompressor(&reopened));
+}
+
+TEST(WiredTigerCompressionDictionaryTest, DropRemovesDictionaries) {
+    unittest::TempDir dbpath("wt_compression_dictionary_test");
+    WiredTigerCompressionDictionaries dictionaries;
+    ASSERT_OK(dictionaries.open(dbpath.path(), false));
+
+    const uint64_t dropped = createCompressor(&dictionaries);
+    const uint64_t kept = createCompressor(&dictionaries);
+    ASSERT_OK(dictionaries.train(dropped, makeEvents(200)));
+    ASSERT_EQUALS(1U, dictionaries.currentVersion(dropped));
+
+    const uint64_t markerBeforeDrop = dictionaries.getDropMarker();
+    dictionaries.dropCompressor(dropped);
+    ASSERT_EQUALS(0U, dictionaries.currentVersion(dropped));
+    ASSERT_EQUALS(ErrorCodes::NoSuchKey, dictionaries.train(dropped, makeEvents(200)));
+
+    // Dropping is idempotent. The files of the dropped set are kept for recovery until a checkpoint
+    // which started after the drop has completed.
+    dictionaries.dropCompressor(dropped);
+    ASSERT_OK(dictionaries.removeDroppedFiles(markerBeforeDrop));
+    {
+        WiredTigerCompressionDictionaries beforeCheckpoint;
+        ASSERT_OK(beforeCheckpoint.open(dbpath.path(), false));
+        ASSERT_EQUALS(1U, beforeCheckpoint.currentVersion(dropped));
+    }
+
+    // Once they are removed, the dropped set is gone after a restart.
+    ASSERT_OK(dictionaries.removeDroppedFiles(dictionaries.getDropMarker()));
+    WiredTigerCompressionDictionaries reopened;
+    ASSERT_OK(reopened.open(dbpath.path(), false));
+    ASSERT_EQUALS(ErrorCodes::NoSuchKey, reopened.train(dropped, makeEvents(200)));
+    ASSERT_OK(reopened.train(kept, makeEvents(200)));
+    ASSERT_EQUALS(1U, reopened.currentVersion(kept));
+}
+
+TEST(WiredTigerCompressionDictionaryTest, TrainingUnknownSetFails) {
+    unittest::TempDir dbpath("wt_compression_dictionary_test");
+    WiredTigerCompressionDictionaries dictionaries;
+    ASSERT_OK(dictionaries.open(dbpath.path(), false));
+    ASSERT_EQUALS(ErrorCodes::NoSuchKey, dictionaries.train(42, makeEvents(10)));
+}
+
+TEST(WiredTigerCompressionDictionaryTest, UsableAsWiredTigerBlockCompressor) {
+    unittest::TempDir dbpath("wt_compression_dictionary_test");
+    WiredTigerCompressionDictionaries dictionaries;
+    ASSERT_OK(dictionaries.open(dbpath.path(), false));
+    StatusWith<std::string> name = dictionaries.createCompressor();
+    ASSERT_OK(name.getStatus());
+    uint64_t id;
+    ASSERT_TRUE(WiredTigerCompressionDictionaries::parseCompressorName(name.getValue(), &id));
+    ASSERT_OK(dictionaries.train(id, makeEvents(200)));
+
+    WT_CONNECTION* conn;
+    ASSERT_OK(wtRCToStatus(wiredtiger_open(dbpath.path().c_str(), NULL, "create", &conn)));
+    ASSERT_OK(dictionaries.registerCompressors(conn));
+
+    WT_SESSION* session;
+    ASSERT_OK(wtRCToStatus(conn->open_session(conn, NULL, NULL, &session)));
+    const std::string config = "key_format=q,value_format=u,block_compressor=" + name.getValue();
+    ASSERT_OK(wtRCToStatus(session->create(session, "table:events", config.c_str())));
+
+    std::vector<BSONObj> events = makeEvents(1000);
+    WT_CURSOR* cursor;
+    ASSERT_OK(wtRCToStatus(session->open_cursor(session, "table:events", NULL, NULL, &cursor)));
+    for (size_t i = 0; i < events.size(); ++i) {
+        WiredTigerItem value(events[i].objdata(), events[i].objsize());
+        cursor->set_key(cursor, static_cast<int64_t>(i));
+        cursor->set_value(cursor, value.Get());
+        ASSERT_OK(wtRCToStatus(cursor->insert(cursor)));
+    }
+    ASSERT_OK(wtRCToStatus(cursor->close(cursor)));
+
+    // Checkpointing writes the pages through the compressor; closing discards the cache so the
+    // verification below has to read them back through the compressor.
+    ASSERT_OK(wtRCToStatus(session->checkpoint(session, NULL)));
+    ASSERT_OK(wtRCToStatus(conn->close(conn, NULL)));
+    ASSERT_OK(wtRCToStatus(wiredtiger_open(dbpath.path().c_str(), NULL, "", &conn)));
+    ASSERT_OK(dictionaries.registerCompressors(conn));
+    ASSERT_OK(wtRCToStatus(conn->open_session(conn, NULL, NULL, &session)));
+
+    ASSERT_OK(wtRCToStatus(session->open_cursor(session, "table:events", NULL, NULL, &cursor)));
+    size_t found = 0;
+    while (cursor->next(cursor) == 0) {
+        WT_ITEM value;
+        ASSERT_OK(wtRCToStatus(cursor->get_value(cursor, &value)));
+        ASSERT_BSONOBJ_EQ(events[found], BSONObj(static_cast<const char*>(value.data)));
+        ++found;
+    }
+    ASSERT_EQUALS(events.size(), found);
+    ASSERT_OK(wtRCToStatus(cursor->close(cursor)));
+    ASSERT_OK(wtRCToStatus(conn->close(conn, NULL)));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -40,6 +40,8 @@ namespace mongo {
 
 WiredTigerGlobalOptions wiredTigerGlobalOptions;
 
+const char WiredTigerGlobalOptions::kDictionaryBlockCompressor[] = "dictionary";
+
 Status WiredTigerGlobalOptions::add(moe::OptionSection* options) {
     moe::OptionSection wiredTigerOptions("WiredTiger options");
 
@@ -84,8 +86,9 @@ Status WiredTigerGlobalOptions::add(moe::OptionSection* options) {
                            "wiredTigerCollectionBlockCompressor",
                            moe::String,
                            "block compression algorithm for collection data "
-                           "[none|snappy|zlib]")
-        .format("(:?none)|(:?snappy)|(:?zlib)", "(none/snappy/zlib)")
+                           "[none|snappy|zlib|dictionary]; 'dictionary' uses zlib with a "
+                           "per-collection dictionary trained from sampled documents on compact")
+        .format("(:?none)|(:?snappy)|(:?zlib)|(:?dictionary)", "(none/snappy/zlib/dictionary)")
         .setDefault(moe::Value(std::string("snappy")));
     wiredTigerOptions
         .addOptionChaining("storage.wiredTiger.collectionConfig.configString",
@@ -57,6 +57,9 @@ public:
     bool directoryForIndexes;
     std::string engineConfig;
 
+    // Value of 'collectionBlockCompressor' selecting per-collection dictionary compression.
+    static const char kDictionaryBlockCompressor[];
+
     std::string collectionBlockCompressor;
     std::string indexBlockCompressor;
     bool useCollectionPrefixCompression;
@@ -43,6 +43,7 @@
 #include "mongo/db/json.h"
 #include "mongo/db/mongod_options.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/storage_options.h"
@@ -87,8 +88,13 @@ static const WiredTigerItem emptyItem(NULL, 0);
 // Keystring format 7 was used in 3.3.6 - 3.3.8 development releases.
 static const int kKeyStringV0Version = 6;
 static const int kKeyStringV1Version = 8;
+static const int kKeyStringV2Version = 10;
 static const int kMinimumIndexVersion = kKeyStringV0Version;
-static const int kMaximumIndexVersion = kKeyStringV1Version;
+static const int kMaximumIndexVersion = kKeyStringV2Version;
+
+// KeyString version 2 indexes cannot be read by binaries that only understand versions 0 and 1,
+// so new v2 indexes only use it when explicitly enabled. Existing indexes keep their format.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerIndexUseKeyStringV2, bool, false);
 
 bool hasFieldNames(const BSONObj& obj) {
     BSONForEach(e, obj) {
@@ -209,10 +215,12 @@ StatusWith<std::string> WiredTigerIndex::generateCreateString(const std::string&
     }
     ss << ",value_format=u";
 
-    // Index versions greater than 2 use KeyString version 1.
-    const int keyStringVersion = desc.version() >= IndexDescriptor::IndexVersion::kV2
-        ? kKeyStringV1Version
-        : kKeyStringV0Version;
+    // Index versions greater than 2 use KeyString version 1, or version 2 if it is enabled.
+    int keyStringVersion = kKeyStringV0Version;
+    if (desc.version() >= IndexDescriptor::IndexVersion::kV2) {
+        keyStringVersion =
+            wiredTigerIndexUseKeyStringV2 ? kKeyStringV2Version : kKeyStringV1Version;
+    }
 
     // Index metadata
     ss << ",app_metadata=("
@@ -267,8 +275,27 @@ WiredTigerIndex::WiredTigerIndex(OperationContext* ctx,
                           << " instructions on how to handle this error.");
         fassertFailedWithStatusNoTrace(28579, indexVersionStatus);
     }
-    _keyStringVersion =
-        version.getValue() == kKeyStringV1Version ? KeyString::Version::V1 : KeyString::Version::V0;
+    switch (version.getValue()) {
+        case kKeyStringV0Version:
+            _keyStringVersion = KeyString::Version::V0;
+            break;
+        case kKeyStringV1Version:
+            _keyStringVersion = KeyString::Version::V1;
+            break;
+        case kKeyStringV2Version:
+            _keyStringVersion = KeyString::Version::V2;
+            break;
+        default:
+            fassertFailedWithStatusNoTrace(
+                40728,
+                Status(ErrorCodes::UnsupportedFormat,
+                       str::stream() << "Unknown index format version " << version.getValue()
+                                     << " for index: {name: "
+                                     << desc->indexName()
+                                     << ", ns: "
+                                     << desc->parentNS()
+                                     << "}"));
+    }
 
     if (!isReadOnly) {
         uassertStatusOK(WiredTigerUtil::setTableLogging(
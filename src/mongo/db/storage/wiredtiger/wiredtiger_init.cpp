@@ -44,6 +44,8 @@
 #include "mongo/db/storage/storage_engine_lock_file.h"
 #include "mongo/db/storage/storage_engine_metadata.h"
 #include "mongo/db/storage/storage_options.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_compression_dictionary.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_extensions.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_index.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
@@ -85,6 +87,16 @@ public:
         }
 #endif
 
+        // Dictionary compressors must be registered inside wiredtiger_open, because recovery may
+        // already need to decompress blocks of the tables using them.
+        auto dictionaries = WiredTigerCompressionDictionaries::get();
+        uassertStatusOK(dictionaries->open(params.dbpath, params.readOnly));
+        if (dictionaries->isInUse() || wiredTigerGlobalOptions.collectionBlockCompressor ==
+                WiredTigerGlobalOptions::kDictionaryBlockCompressor) {
+            WiredTigerExtensions::get(getGlobalServiceContext())
+                ->addExtension(WiredTigerCompressionDictionaries::kExtensionConfig);
+        }
+
         size_t cacheMB = WiredTigerUtil::getCacheSizeMB(wiredTigerGlobalOptions.cacheSizeGB);
         const bool ephemeral = false;
         WiredTigerKVEngine* kv =
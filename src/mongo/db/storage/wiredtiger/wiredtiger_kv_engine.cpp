@@ -62,6 +62,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/storage_options.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_compression_dictionary.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_extensions.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
@@ -93,6 +94,21 @@ using std::string;
 
 namespace dps = ::mongo::dotted_path_support;
 
+namespace {
+
+/**
+ * Removes the compression dictionary files of the tables dropped before 'dropMarker' was taken,
+ * which must be before the start of a checkpoint that has since completed.
+ */
+void removeDroppedCompressionDictionaries(uint64_t dropMarker) {
+    Status status = WiredTigerCompressionDictionaries::get()->removeDroppedFiles(dropMarker);
+    if (!status.isOK()) {
+        warning() << "Failed to remove the compression dictionaries of dropped tables: " << status;
+    }
+}
+
+}  // namespace
+
 class WiredTigerKVEngine::WiredTigerJournalFlusher : public BackgroundJob {
 public:
     explicit WiredTigerJournalFlusher(WiredTigerSessionCache* sessionCache)
@@ -167,11 +183,18 @@ public:
             const SnapshotName initialDataTimestamp(_initialDataTimestamp.load());
             const bool keepOldBehavior = true;
 
+            // The tables dropped so far are gone for good once the checkpoint completes, and so
+            // recovery no longer needs their compression dictionaries.
+            const uint64_t dictionaryDropMarker =
+                WiredTigerCompressionDictionaries::get()->getDropMarker();
+            bool checkpointed = false;
+
             try {
                 if (keepOldBehavior) {
                     const bool forceCheckpoint = true;
                     const bool stableCheckpoint = false;
                     _sessionCache->waitUntilDurable(forceCheckpoint, stableCheckpoint);
+                    checkpointed = true;
                 } else {
                     // Three cases:
                     //
@@ -190,6 +213,7 @@ public:
                         const bool forceCheckpoint = true;
                         const bool stableCheckpoint = false;
                         _sessionCache->waitUntilDurable(forceCheckpoint, stableCheckpoint);
+                        checkpointed = true;
                     } else if (stableTimestamp < initialDataTimestamp) {
                         LOG(1) << "Stable timestamp is behind the initial data timestamp, skipping "
                                   "a checkpoint. StableTimestamp: "
@@ -199,11 +223,16 @@ public:
                         const bool forceCheckpoint = true;
                         const bool stableCheckpoint = true;
                         _sessionCache->waitUntilDurable(forceCheckpoint, stableCheckpoint);
+                        checkpointed = true;
                     }
                 }
             } catch (const AssertionException& exc) {
                 invariant(exc.code() == ErrorCodes::ShutdownInProgress);
             }
+
+            if (checkpointed) {
+                removeDroppedCompressionDictionaries(dictionaryDropMarker);
+            }
         }
         LOG(1) << "stopping " << name() << " thread";
     }
@@ -258,15 +287,20 @@ private:
 
 namespace {
 
+AtomicUInt64 ticketPoolShrinks;
+AtomicUInt64 ticketPoolGrows;
+
 class TicketServerParameter : public ServerParameter {
     MONGO_DISALLOW_COPYING(TicketServerParameter);
 
 public:
     TicketServerParameter(TicketHolder* holder, const std::string& name)
-        : ServerParameter(ServerParameterSet::getGlobal(), name, true, true), _holder(holder) {}
+        : ServerParameter(ServerParameterSet::getGlobal(), name, true, true),
+          _holder(holder),
+          _configured(holder->outof()) {}
 
     virtual void append(OperationContext* opCtx, BSONObjBuilder& b, const std::string& name) {
-        b.append(name, _holder->outof());
+        b.append(name, configured());
     }
 
     virtual Status set(const BSONElement& newValueElement) {
@@ -288,11 +322,56 @@ public:
             return Status(ErrorCodes::BadValue, str::stream() << name() << " has to be > 0");
         }
 
-        return _holder->resize(newNum);
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        const int previous = _configured.swap(newNum);
+        Status status = _holder->resize(newNum);
+        if (!status.isOK()) {
+            _configured.store(previous);
+        }
+        return status;
+    }
+
+    /**
+     * Resizes the ticket pool to the size returned by 'computeTarget', which is passed the
+     * configured and current sizes. Serialized with setParameter, so that a new setting is never
+     * overwritten with a size computed from the previous one.
+     */
+    void resizeWith(stdx::function<int(int configured, int current)> computeTarget) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        const int current = _holder->outof();
+        const int target = computeTarget(_configured.load(), current);
+        if (target == current) {
+            return;
+        }
+
+        Status status = _holder->resize(target);
+        if (!status.isOK()) {
+            LOG(1) << "unable to resize " << name() << " ticket pool from " << current << " to "
+                   << target << ": " << status;
+            return;
+        }
+        if (target < current) {
+            ticketPoolShrinks.fetchAndAdd(1);
+        } else {
+            ticketPoolGrows.fetchAndAdd(1);
+        }
+        LOG(2) << "resized " << name() << " ticket pool from " << current << " to " << target;
+    }
+
+    /**
+     * The number of tickets requested by the user. With adaptive admission enabled the holder may
+     * temporarily have fewer tickets than this, but never more.
+     */
+    int configured() const {
+        return _configured.load();
     }
 
 private:
     TicketHolder* _holder;
+
+    // Serializes resizing '_holder' between setParameter and the ticket controller.
+    stdx::mutex _mutex;
+    AtomicInt32 _configured;
 };
 
 TicketHolder openWriteTransaction(128);
@@ -303,11 +382,130 @@ TicketHolder openReadTransaction(128);
 TicketServerParameter openReadTransactionParam(&openReadTransaction,
                                                "wiredTigerConcurrentReadTransactions");
 
+// When enabled, the concurrent transaction limits above are treated as ceilings, and the number of
+// tickets is lowered while the WiredTiger cache is under eviction pressure.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveTransactionAdmission, bool, false);
+
+const int kTicketControllerIntervalMillis = 200;
+
+// Ticket pools are never shrunk below this size (or the configured size, if smaller).
+const int kMinimumTickets = 16;
+
+// The cache and dirty fill ratios at which WiredTiger, by default, starts making application
+// threads evict pages.
+const double kCacheFillTrigger = 0.95;
+const double kDirtyFillTrigger = 0.20;
+
+// The fraction of the interval that operations holding a ticket may, on average, spend evicting or
+// waiting for cache space before the cache is considered under pressure.
+const double kStallFractionTrigger = 0.10;
+
+AtomicBool underEvictionPressure{false};
+
 stdx::function<bool(StringData)> initRsOplogBackgroundThreadCallback = [](StringData) -> bool {
     fassertFailed(40358);
 };
 }  // namespace
 
+/**
+ * Periodically resizes the read and write ticket pools based on WiredTiger cache pressure. Once
+ * eviction falls behind, every operation holding a ticket ends up doing eviction work itself, so
+ * admitting more operations only makes each one slower. Tickets are taken away multiplicatively
+ * while the cache is under pressure and given back additively, up to the configured limits, once
+ * it recovers. Internal operations which do not acquire tickets are unaffected.
+ */
+class WiredTigerKVEngine::WiredTigerTicketController : public BackgroundJob {
+public:
+    explicit WiredTigerTicketController(WiredTigerSessionCache* sessionCache)
+        : BackgroundJob(false /* deleteSelf */), _sessionCache(sessionCache) {}
+
+    virtual string name() const {
+        return "WTTicketController";
+    }
+
+    virtual void run() {
+        Client::initThread(name().c_str());
+
+        LOG(1) << "starting " << name() << " thread";
+
+        WiredTigerSession session(_sessionCache->conn());
+        while (!_shuttingDown.load()) {
+            // Cache pressure is sampled even when admission is not adaptive, since it is also
+            // reported to other consumers through isCacheUnderPressure().
+            const bool pressure = _underEvictionPressure(session.getSession());
+            underEvictionPressure.store(pressure);
+            const bool adaptive = wiredTigerAdaptiveTransactionAdmission.load();
+            // Operations opted out of tickets only bypass them while the pools may be shrunk.
+            Locker::setTicketBypassEnabled(adaptive);
+            if (adaptive) {
+                _adjust(&openReadTransactionParam, pressure);
+                _adjust(&openWriteTransactionParam, pressure);
+            } else {
+                openReadTransactionParam.resizeWith(
+                    [](int configured, int current) { return configured; });
+                openWriteTransactionParam.resizeWith(
+                    [](int configured, int current) { return configured; });
+            }
+
+            MONGO_IDLE_THREAD_BLOCK;
+            sleepmillis(kTicketControllerIntervalMillis);
+        }
+        LOG(1) << "stopping " << name() << " thread";
+    }
+
+    void shutdown() {
+        _shuttingDown.store(true);
+        wait();
+    }
+
+private:
+    bool _underEvictionPressure(WT_SESSION* session) {
+        auto stat = [session](int key) -> uint64_t {
+            auto value = WiredTigerUtil::getStatisticsValueAs<uint64_t>(
+                session, "statistics:", "statistics=(fast)", key);
+            return value.isOK() ? value.getValue() : 0;
+        };
+
+        const uint64_t cacheMax = stat(WT_STAT_CONN_CACHE_BYTES_MAX);
+        if (cacheMax == 0) {
+            return false;
+        }
+        const double cacheFill = double(stat(WT_STAT_CONN_CACHE_BYTES_INUSE)) / cacheMax;
+        const double dirtyFill = double(stat(WT_STAT_CONN_CACHE_BYTES_DIRTY)) / cacheMax;
+
+        // Time application threads spent on eviction is cumulative, so compare against the last
+        // sample.
+        const uint64_t stallMicros = stat(WT_STAT_CONN_APPLICATION_EVICT_TIME) +
+            stat(WT_STAT_CONN_APPLICATION_CACHE_TIME);
+        const uint64_t stallDelta =
+            stallMicros > _lastStallMicros ? stallMicros - _lastStallMicros : 0;
+        _lastStallMicros = stallMicros;
+
+        const int ticketsInUse =
+            std::max(1, openReadTransaction.used() + openWriteTransaction.used());
+        const double stallFraction =
+            double(stallDelta) / ticketsInUse / (kTicketControllerIntervalMillis * 1000.0);
+
+        return cacheFill >= kCacheFillTrigger || dirtyFill >= kDirtyFillTrigger ||
+            stallFraction >= kStallFractionTrigger;
+    }
+
+    void _adjust(TicketServerParameter* param, bool pressure) {
+        // Shrinking does not wait for tickets in use to be released, they are retired as the
+        // operations holding them finish.
+        param->resizeWith([pressure](int configured, int current) {
+            if (pressure) {
+                return std::max(std::min(configured, kMinimumTickets), current * 3 / 4);
+            }
+            return std::min(configured, current + std::max(1, configured / 16));
+        });
+    }
+
+    WiredTigerSessionCache* _sessionCache;
+    AtomicBool _shuttingDown{false};
+    uint64_t _lastStallMicros = 0;
+};
+
 WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
                                        const std::string& path,
                                        ClockSource* cs,
@@ -418,6 +616,9 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
         _checkpointThread->go();
     }
 
+    _ticketController = stdx::make_unique<WiredTigerTicketController>(_sessionCache.get());
+    _ticketController->go();
+
     _sizeStorerUri = "table:sizeStorer";
     WiredTigerSession session(_conn);
     if (!_readOnly && repair && _hasUri(session.getSession(), _sizeStorerUri)) {
@@ -458,6 +659,16 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("totalTickets", openReadTransaction.outof());
         bbb.done();
     }
+    {
+        BSONObjBuilder bbb(bb.subobjStart("adaptive"));
+        bbb.append("enabled", wiredTigerAdaptiveTransactionAdmission.load());
+        bbb.append("underEvictionPressure", underEvictionPressure.load());
+        bbb.append("configuredWriteTickets", openWriteTransactionParam.configured());
+        bbb.append("configuredReadTickets", openReadTransactionParam.configured());
+        bbb.append("shrinks", static_cast<long long>(ticketPoolShrinks.load()));
+        bbb.append("grows", static_cast<long long>(ticketPoolGrows.load()));
+        bbb.done();
+    }
     bb.done();
 }
 
@@ -471,6 +682,8 @@ void WiredTigerKVEngine::cleanShutdown() {
             _journalFlusher->shutdown();
         if (_checkpointThread)
             _checkpointThread->shutdown();
+        if (_ticketController)
+            _ticketController->shutdown();
         _sizeStorer.reset();
         _sessionCache->shuttingDown();
 
@@ -506,6 +719,12 @@ void WiredTigerKVEngine::cleanShutdown() {
         invariantWTOK(_conn->close(_conn, closeConfig));
         _conn = nullptr;
 
+        // Closing the connection took a final checkpoint
+        if (!_readOnly) {
+            removeDroppedCompressionDictionaries(
+                WiredTigerCompressionDictionaries::get()->getDropMarker());
+        }
+
         // If FCV 3.4, enable WT logging on all tables.
         if (!keepOldBehavior && needsDowngrade) {
             // Steps for downgrading:
@@ -649,6 +868,70 @@ void WiredTigerKVEngine::endBackup(OperationContext* opCtx) {
     _backupSession.reset();
 }
 
+StatusWith<std::vector<std::string>> WiredTigerKVEngine::beginNonBlockingBackup(
+    OperationContext* opCtx) {
+    invariant(!_backupSession);
+
+    // The inMemory Storage Engine has no files to copy.
+    if (_ephemeral) {
+        return Status(ErrorCodes::CommandNotSupported,
+                      "The in-memory storage engine has no data files to back up");
+    }
+
+    // This cursor will be freed by the backupSession being closed as the session is uncached
+    auto session = stdx::make_unique<WiredTigerSession>(_conn);
+    WT_CURSOR* c = NULL;
+    WT_SESSION* s = session->getSession();
+    int ret = WT_OP_CHECK(s->open_cursor(s, "backup:", NULL, NULL, &c));
+    if (ret != 0) {
+        return wtRCToStatus(ret);
+    }
+
+    // The backup cursor names log files without the journal directory they are configured in.
+    const StringData logFilePrefix = "WiredTigerLog."_sd;
+    std::vector<std::string> filenames;
+    while ((ret = c->next(c)) == 0) {
+        const char* filename;
+        invariantWTOK(c->get_key(c, &filename));
+        if (StringData(filename).startsWith(logFilePrefix)) {
+            filenames.emplace_back(str::stream() << "journal/" << filename);
+        } else {
+            filenames.emplace_back(filename);
+        }
+    }
+    if (ret != WT_NOTFOUND) {
+        return wtRCToStatus(ret);
+    }
+
+    // The compression dictionaries are kept outside of WiredTiger, and are needed to read the
+    // tables compressed with them.
+    const boost::filesystem::path dictionaryDir =
+        boost::filesystem::path(_path) / WiredTigerCompressionDictionaries::kDirectoryName;
+    boost::system::error_code ec;
+    if (boost::filesystem::is_directory(dictionaryDir, ec)) {
+        for (boost::filesystem::directory_iterator it(dictionaryDir, ec), end; !ec && it != end;
+             it.increment(ec)) {
+            if (boost::filesystem::is_regular_file(it->status())) {
+                filenames.emplace_back(str::stream()
+                                       << WiredTigerCompressionDictionaries::kDirectoryName << "/"
+                                       << it->path().filename().string());
+            }
+        }
+    }
+    if (ec) {
+        return Status(ErrorCodes::FileNotOpen,
+                      str::stream() << "Unable to list " << dictionaryDir.string() << ": "
+                                    << ec.message());
+    }
+
+    _backupSession = std::move(session);
+    return filenames;
+}
+
+void WiredTigerKVEngine::endNonBlockingBackup(OperationContext* opCtx) {
+    _backupSession.reset();
+}
+
 void WiredTigerKVEngine::syncSizeInfo(bool sync) const {
     if (!_sizeStorer)
         return;
@@ -784,6 +1067,52 @@ SortedDataInterface* WiredTigerKVEngine::getGroupedSortedDataInterface(Operation
     return new WiredTigerIndexStandard(opCtx, _uri(ident), desc, prefix, _readOnly);
 }
 
+namespace {
+
+/**
+ * Returns the id of the dictionary compressor used by table 'uri', or 0 if it does not use one.
+ */
+uint64_t getDictionaryCompressorId(WT_SESSION* session, const std::string& uri) {
+    if (!WiredTigerCompressionDictionaries::get()->isInUse()) {
+        return 0;
+    }
+
+    WT_CURSOR* cursor;
+    if (session->open_cursor(session, "metadata:create", nullptr, nullptr, &cursor) != 0) {
+        return 0;
+    }
+    ON_BLOCK_EXIT([cursor] { cursor->close(cursor); });
+
+    const char* metadata;
+    cursor->set_key(cursor, uri.c_str());
+    if (cursor->search(cursor) != 0 || cursor->get_value(cursor, &metadata) != 0) {
+        return 0;
+    }
+
+    WiredTigerConfigParser parser(metadata);
+    WT_CONFIG_ITEM compressor;
+    uint64_t id;
+    if (parser.get("block_compressor", &compressor) != 0 ||
+        !WiredTigerCompressionDictionaries::parseCompressorName(
+            StringData(compressor.str, compressor.len), &id)) {
+        return 0;
+    }
+    return id;
+}
+
+/**
+ * Drops the dictionaries of a table's compressor once the table itself has been dropped.
+ */
+void dropDictionaryCompressor(uint64_t id) {
+    if (id == 0) {
+        return;
+    }
+
+    WiredTigerCompressionDictionaries::get()->dropCompressor(id);
+}
+
+}  // namespace
+
 Status WiredTigerKVEngine::dropIdent(OperationContext* opCtx, StringData ident) {
     _drop(ident);
     return Status::OK();
@@ -796,12 +1125,15 @@ bool WiredTigerKVEngine::_drop(StringData ident) {
 
     WiredTigerSession session(_conn);
 
+    const uint64_t dictionaryId = getDictionaryCompressorId(session.getSession(), uri);
+
     int ret = session.getSession()->drop(
         session.getSession(), uri.c_str(), "force,checkpoint_wait=false");
     LOG(1) << "WT drop of  " << uri << " res " << ret;
 
     if (ret == 0) {
         // yay, it worked
+        dropDictionaryCompressor(dictionaryId);
         return true;
     }
 
@@ -886,6 +1218,8 @@ void WiredTigerKVEngine::dropSomeQueuedIdents() {
             uri = _identToDrop.front();
             _identToDrop.pop_front();
         }
+        const uint64_t dictionaryId = getDictionaryCompressorId(session.getSession(), uri);
+
         int ret = session.getSession()->drop(
             session.getSession(), uri.c_str(), "force,checkpoint_wait=false");
         LOG(1) << "WT queued drop of  " << uri << " res " << ret;
@@ -895,6 +1229,7 @@ void WiredTigerKVEngine::dropSomeQueuedIdents() {
             _identToDrop.push_back(uri);
         } else {
             invariantWTOK(ret);
+            dropDictionaryCompressor(dictionaryId);
         }
     }
 }
@@ -1030,4 +1365,8 @@ bool WiredTigerKVEngine::supportsRecoverToStableTimestamp() const {
 
     return _checkpointThread->supportsRecoverToStableTimestamp();
 }
+
+bool WiredTigerKVEngine::isCacheUnderPressure() const {
+    return underEvictionPressure.load();
+}
 }  // namespace mongo
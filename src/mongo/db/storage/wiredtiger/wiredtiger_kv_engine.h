@@ -144,6 +144,10 @@ public:
 
     virtual void endBackup(OperationContext* opCtx);
 
+    StatusWith<std::vector<std::string>> beginNonBlockingBackup(OperationContext* opCtx) override;
+
+    void endNonBlockingBackup(OperationContext* opCtx) override;
+
     virtual int64_t getIdentSize(OperationContext* opCtx, StringData ident);
 
     virtual Status repairIdent(OperationContext* opCtx, StringData ident);
@@ -166,6 +170,8 @@ public:
 
     virtual bool supportsRecoverToStableTimestamp() const override;
 
+    virtual bool isCacheUnderPressure() const override;
+
     // wiredtiger specific
     // Calls WT_CONNECTION::reconfigure on the underlying WT_CONNECTION
     // held by this class
@@ -201,6 +207,7 @@ public:
 private:
     class WiredTigerJournalFlusher;
     class WiredTigerCheckpointThread;
+    class WiredTigerTicketController;
 
     Status _salvageIfNeeded(const char* uri);
     void _checkIdentPath(StringData ident);
@@ -226,6 +233,7 @@ private:
     bool _readOnly;
     std::unique_ptr<WiredTigerJournalFlusher> _journalFlusher;  // Depends on _sizeStorer
     std::unique_ptr<WiredTigerCheckpointThread> _checkpointThread;
+    std::unique_ptr<WiredTigerTicketController> _ticketController;
 
     std::string _rsOptions;
     std::string _indexOptions;
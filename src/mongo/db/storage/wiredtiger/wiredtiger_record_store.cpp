@@ -44,8 +44,10 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/oplog_hack.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_compression_dictionary.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
@@ -88,6 +90,10 @@ bool shouldUseOplogHack(OperationContext* opCtx, const std::string& uri) {
     return (appMetadata.getValue().getIntField("oplogKeyExtractionVersion") == 1);
 }
 
+// Limits how quickly the oplog reclaim thread truncates old oplog entries, so that working through
+// a large backlog does not compete with user writes for I/O. Zero or less means no limit.
+MONGO_EXPORT_SERVER_PARAMETER(oplogTruncationMaxBytesPerSecond, long long, 0);
+
 }  // namespace
 
 MONGO_FP_DECLARE(WTWriteConflictException);
@@ -137,6 +143,8 @@ public:
 
         stdx::lock_guard<stdx::mutex> lk(_oplogStones->_mutex);
         _oplogStones->_stones.clear();
+        _oplogStones->_excessSince = Date_t();
+        _oplogStones->_persistStones_inlock();
     }
 
     void rollback() final {}
@@ -147,6 +155,8 @@ private:
 
 WiredTigerRecordStore::OplogStones::OplogStones(OperationContext* opCtx, WiredTigerRecordStore* rs)
     : _rs(rs) {
+    // Held throughout, since loading or computing the stones below also hands them to the size
+    // storer.
     stdx::lock_guard<stdx::mutex> lk(_mutex);
 
     invariant(rs->isCapped());
@@ -161,7 +171,10 @@ WiredTigerRecordStore::OplogStones::OplogStones(OperationContext* opCtx, WiredTi
     _minBytesPerStone = maxSize / numStonesToKeep;
     invariant(_minBytesPerStone > 0);
 
-    _calculateStones(opCtx, numStonesToKeep);
+    if (!_loadPersistedStones(opCtx)) {
+        _calculateStones(opCtx, numStonesToKeep);
+        _persistStones_inlock();
+    }
     _pokeReclaimThreadIfNeeded();  // Reclaim stones if over the limit.
 }
 
@@ -182,14 +195,21 @@ void WiredTigerRecordStore::OplogStones::awaitHasExcessStonesOrDead() {
     // Wait until kill() is called or there are too many oplog stones.
     stdx::unique_lock<stdx::mutex> lock(_oplogReclaimMutex);
     while (!_isDead) {
+        bool hasExcessStones;
         {
             MONGO_IDLE_THREAD_BLOCK;
             stdx::lock_guard<stdx::mutex> lk(_mutex);
-            if (hasExcessStones_inlock()) {
-                break;
-            }
+            hasExcessStones = hasExcessStones_inlock();
+        }
+
+        if (!hasExcessStones) {
+            _oplogReclaimCv.wait(lock);
+        } else if (Date_t::now() < _truncationAllowedAt) {
+            MONGO_IDLE_THREAD_BLOCK;
+            _oplogReclaimCv.wait_until(lock, _truncationAllowedAt.toSystemTimePoint());
+        } else {
+            break;
         }
-        _oplogReclaimCv.wait(lock);
     }
 }
 
@@ -204,9 +224,35 @@ WiredTigerRecordStore::OplogStones::peekOldestStoneIfNeeded() const {
     return _stones.front();
 }
 
+bool WiredTigerRecordStore::OplogStones::isTruncationAllowedNow() {
+    stdx::lock_guard<stdx::mutex> lk(_oplogReclaimMutex);
+    return Date_t::now() >= _truncationAllowedAt;
+}
+
 void WiredTigerRecordStore::OplogStones::popOldestStone() {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-    _stones.pop_front();
+    int64_t bytes;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        bytes = _stones.front().bytes;
+        _stones.pop_front();
+        if (!hasExcessStones_inlock()) {
+            _excessSince = Date_t();
+        }
+        _persistStones_inlock();
+    }
+
+    _stonesTruncated.addAndFetch(1);
+    _bytesTruncated.addAndFetch(bytes);
+
+    const long long maxBytesPerSecond = oplogTruncationMaxBytesPerSecond.load();
+    if (maxBytesPerSecond > 0) {
+        // Charge the truncated bytes against the rate limit. Starting from the later of now and the
+        // previous deadline lets an idle reclaim thread truncate one stone immediately without
+        // building up credit for a burst.
+        stdx::lock_guard<stdx::mutex> lk(_oplogReclaimMutex);
+        const Milliseconds cost(bytes * 1000 / maxBytesPerSecond);
+        _truncationAllowedAt = std::max(Date_t::now(), _truncationAllowedAt) + cost;
+    }
 }
 
 void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRecord) {
@@ -232,6 +278,7 @@ void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRec
     LOG(2) << "create new oplogStone, current stones:" << _stones.size();
     OplogStones::Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), lastRecord};
     _stones.push_back(stone);
+    _persistStones_inlock();
 
     _pokeReclaimThreadIfNeeded();
 }
@@ -276,6 +323,10 @@ void WiredTigerRecordStore::OplogStones::updateStonesAfterCappedTruncateAfter(
     // being filled.
     _currentRecords.addAndFetch(recordsInStonesToRemove - recordsRemoved);
     _currentBytes.addAndFetch(bytesInStonesToRemove - bytesRemoved);
+
+    if (numStonesToRemove > 0) {
+        _persistStones_inlock();
+    }
 }
 
 void WiredTigerRecordStore::OplogStones::setMinBytesPerStone(int64_t size) {
@@ -318,6 +369,81 @@ void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* opCt
     _calculateStonesBySampling(opCtx, int64_t(estRecordsPerStone), int64_t(estBytesPerStone));
 }
 
+bool WiredTigerRecordStore::OplogStones::_loadPersistedStones(OperationContext* opCtx) {
+    if (!_rs->_sizeStorer) {
+        return false;
+    }
+
+    const BSONObj persisted = _rs->_sizeStorer->loadOplogStonesFromCache(_rs->_uri);
+    if (persisted.isEmpty()) {
+        return false;
+    }
+
+    // The size storer is only synced periodically, so after an unclean shutdown the stones may
+    // refer to records which were truncated since, or which never became durable. Only keep the
+    // stones that fall within the current bounds of the oplog.
+    RecordId earliest;
+    RecordId latest;
+    {
+        auto record = _rs->getCursor(opCtx, /*forward=*/true)->next();
+        if (!record) {
+            return false;
+        }
+        earliest = record->id;
+    }
+    {
+        auto record = _rs->getCursor(opCtx, /*forward=*/false)->next();
+        if (!record) {
+            return false;
+        }
+        latest = record->id;
+    }
+
+    int64_t recordsInStones = 0;
+    int64_t bytesInStones = 0;
+    for (auto&& elem : persisted) {
+        const BSONObj obj = elem.type() == Object ? elem.Obj() : BSONObj();
+        OplogStones::Stone stone = {obj["records"].safeNumberLong(),
+                                    obj["bytes"].safeNumberLong(),
+                                    RecordId(obj["lastRecord"].safeNumberLong())};
+        if (stone.records < 0 || stone.bytes < 0 || !stone.lastRecord.isNormal() ||
+            (!_stones.empty() && stone.lastRecord <= _stones.back().lastRecord)) {
+            log() << "Ignoring invalid persisted oplog truncation markers: " << redact(persisted);
+            _stones.clear();
+            return false;
+        }
+
+        if (stone.lastRecord < earliest) {
+            continue;
+        }
+        if (stone.lastRecord > latest) {
+            break;
+        }
+
+        _stones.push_back(stone);
+        recordsInStones += stone.records;
+        bytesInStones += stone.bytes;
+    }
+
+    // Whatever the stones do not account for is in the stone being filled. If that is much more
+    // than a single stone holds, too many stones were lost for truncation to remain gradual, so
+    // recompute them instead.
+    const int64_t currentRecords = std::max<int64_t>(0, _rs->numRecords(opCtx) - recordsInStones);
+    const int64_t currentBytes = std::max<int64_t>(0, _rs->dataSize(opCtx) - bytesInStones);
+    if (currentBytes > 2 * _minBytesPerStone) {
+        log() << "Persisted oplog truncation markers account for only " << bytesInStones
+              << " of " << _rs->dataSize(opCtx) << " bytes, recomputing them";
+        _stones.clear();
+        return false;
+    }
+
+    _currentRecords.store(currentRecords);
+    _currentBytes.store(currentBytes);
+
+    log() << "Loaded " << _stones.size() << " persisted oplog truncation markers";
+    return true;
+}
+
 void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationContext* opCtx) {
     log() << "Scanning the oplog to determine where to place markers for truncation";
 
@@ -428,10 +554,49 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(OperationCon
 
 void WiredTigerRecordStore::OplogStones::_pokeReclaimThreadIfNeeded() {
     if (hasExcessStones_inlock()) {
+        if (_excessSince == Date_t()) {
+            _excessSince = Date_t::now();
+        }
         _oplogReclaimCv.notify_one();
     }
 }
 
+void WiredTigerRecordStore::OplogStones::_persistStones_inlock() {
+    if (!_rs->_sizeStorer) {
+        return;
+    }
+
+    BSONArrayBuilder builder;
+    for (auto&& stone : _stones) {
+        builder.append(BSON("records" << static_cast<long long>(stone.records) << "bytes"
+                                      << static_cast<long long>(stone.bytes)
+                                      << "lastRecord"
+                                      << static_cast<long long>(stone.lastRecord.repr())));
+    }
+    _rs->_sizeStorer->storeOplogStonesToCache(_rs->_uri, builder.arr());
+}
+
+void WiredTigerRecordStore::OplogStones::appendStats(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    int64_t bytesInStones = 0;
+    for (auto&& stone : _stones) {
+        bytesInStones += stone.bytes;
+    }
+    const int64_t excessBytes = bytesInStones + _currentBytes.load() - _rs->cappedMaxSize();
+
+    builder->append("numStones", static_cast<long long>(_stones.size()));
+    builder->append("excessBytes", static_cast<long long>(std::max(int64_t(0), excessBytes)));
+    long long truncationLagMillis = 0;
+    if (hasExcessStones_inlock() && _excessSince != Date_t()) {
+        truncationLagMillis = durationCount<Milliseconds>(Date_t::now() - _excessSince);
+    }
+    builder->append("truncationLagMillis", truncationLagMillis);
+    builder->append("stonesTruncated", static_cast<long long>(_stonesTruncated.load()));
+    builder->append("bytesTruncated", static_cast<long long>(_bytesTruncated.load()));
+    builder->append("maxBytesPerSecond", oplogTruncationMaxBytesPerSecond.load());
+}
+
 void WiredTigerRecordStore::OplogStones::adjust(int64_t maxSize) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     const unsigned long long kMinStonesToKeep = 10ULL;
@@ -560,18 +725,38 @@ StatusWith<std::string> WiredTigerRecordStore::generateCreateString(
         ss << "prefix_compression,";
     }
 
-    ss << "block_compressor=" << wiredTigerGlobalOptions.collectionBlockCompressor << ",";
-
-    ss << WiredTigerCustomizationHooks::get(getGlobalServiceContext())->getTableCreateConfig(ns);
-
-    ss << extraStrings << ",";
-
     StatusWith<std::string> customOptions =
         parseOptionsField(options.storageEngine.getObjectField(engineName));
     if (!customOptions.isOK())
         return customOptions;
 
-    ss << customOptions.getValue();
+    // Configuration which overrides the defaults above.
+    const std::string overrides = str::stream()
+        << WiredTigerCustomizationHooks::get(getGlobalServiceContext())->getTableCreateConfig(ns)
+        << extraStrings << "," << customOptions.getValue();
+
+    if (wiredTigerGlobalOptions.collectionBlockCompressor ==
+        WiredTigerGlobalOptions::kDictionaryBlockCompressor) {
+        WT_CONFIG_ITEM overriddenCompressor;
+        if (NamespaceString::oplog(ns) || options.temp || ns.find('.') == std::string::npos) {
+            // The oplog is never compacted, so it would never get a trained dictionary. Temporary
+            // collections and internal tables such as the catalog are not worth one either.
+            ss << "block_compressor=zlib,";
+        } else if (WiredTigerConfigParser(overrides).get("block_compressor",
+                                                         &overriddenCompressor) != 0) {
+            // Each collection gets its own compressor, and with it its own dictionaries. If the
+            // create fails after this point the compressor is simply never used.
+            StatusWith<std::string> compressorName =
+                WiredTigerCompressionDictionaries::get()->createCompressor();
+            if (!compressorName.isOK())
+                return compressorName;
+            ss << "block_compressor=" << compressorName.getValue() << ",";
+        }
+    } else {
+        ss << "block_compressor=" << wiredTigerGlobalOptions.collectionBlockCompressor << ",";
+    }
+
+    ss << overrides;
 
     if (NamespaceString::oplog(ns)) {
         // force file for oplog
@@ -1053,6 +1238,12 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx) {
     while (auto stone = _oplogStones->peekOldestStoneIfNeeded()) {
         invariant(stone->lastRecord.isNormal());
 
+        if (!_oplogStones->isTruncationAllowedNow()) {
+            // Leave the rest to a later pass of the reclaim thread, which waits without holding
+            // any locks until the rate limit allows it to continue.
+            break;
+        }
+
         LOG(1) << "Truncating the oplog between " << _oplogStones->firstRecord << " and "
                << stone->lastRecord << " to remove approximately " << stone->records
                << " records totaling to " << stone->bytes << " bytes";
@@ -1376,6 +1567,12 @@ Status WiredTigerRecordStore::compact(OperationContext* opCtx,
                                       CompactStats* stats) {
     WiredTigerSessionCache* cache = WiredTigerRecoveryUnit::get(opCtx)->getSessionCache();
     if (!cache->isEphemeral()) {
+        Status status = _trainCompressionDictionary(opCtx);
+        if (!status.isOK()) {
+            warning() << "Failed to train a compression dictionary for " << ns() << ": "
+                      << status;
+        }
+
         WT_SESSION* s = WiredTigerRecoveryUnit::get(opCtx)->getSession(opCtx)->getSession();
         opCtx->recoveryUnit()->abandonSnapshot();
         int ret = s->compact(s, getURI().c_str(), "timeout=0");
@@ -1384,6 +1581,38 @@ Status WiredTigerRecordStore::compact(OperationContext* opCtx,
     return Status::OK();
 }
 
+Status WiredTigerRecordStore::_trainCompressionDictionary(OperationContext* opCtx) {
+    StatusWith<std::string> metadata = WiredTigerUtil::getMetadata(opCtx, _uri);
+    if (!metadata.isOK()) {
+        return metadata.getStatus();
+    }
+
+    WiredTigerConfigParser parser(metadata.getValue());
+    WT_CONFIG_ITEM compressor;
+    uint64_t dictionaryId;
+    if (parser.get("block_compressor", &compressor) != 0 ||
+        !WiredTigerCompressionDictionaries::parseCompressorName(
+            StringData(compressor.str, compressor.len), &dictionaryId)) {
+        return Status::OK();
+    }
+
+    // Sample with a random cursor so the dictionary reflects the whole collection rather than
+    // its oldest documents. Pages rewritten by the following compaction, and all pages written
+    // after that, use the new dictionary.
+    std::vector<BSONObj> samples;
+    auto cursor = getRandomCursor(opCtx);
+    while (samples.size() < WiredTigerCompressionDictionaries::kTrainingSampleSize) {
+        auto record = cursor->next();
+        if (!record) {
+            break;
+        }
+        samples.push_back(record->data.toBson().getOwned());
+    }
+    cursor.reset();
+
+    return WiredTigerCompressionDictionaries::get()->train(dictionaryId, samples);
+}
+
 Status WiredTigerRecordStore::validate(OperationContext* opCtx,
                                        ValidateCmdLevel level,
                                        ValidateAdaptor* adaptor,
@@ -1460,6 +1689,10 @@ void WiredTigerRecordStore::appendCustomStats(OperationContext* opCtx,
         result->appendIntOrLL("sleepCount", _cappedSleep.load());
         result->appendIntOrLL("sleepMS", _cappedSleepMS.load());
     }
+    if (_oplogStones) {
+        BSONObjBuilder truncation(result->subobjStart("oplogTruncation"));
+        _oplogStones->appendStats(&truncation);
+    }
     WiredTigerSession* session = WiredTigerRecoveryUnit::get(opCtx)->getSession(opCtx);
     WT_SESSION* s = session->getSession();
     BSONObjBuilder bob(result->subobjStart(_engineName));
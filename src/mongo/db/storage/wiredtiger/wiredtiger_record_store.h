@@ -313,6 +313,12 @@ private:
     void _oplogSetStartHack(WiredTigerRecoveryUnit* wru) const;
     void _oplogJournalThreadLoop(WiredTigerSessionCache* sessionCache);
 
+    /**
+     * Trains a new compression dictionary from sampled documents if this table uses dictionary
+     * compression. A no-op for any other block compressor.
+     */
+    Status _trainCompressionDictionary(OperationContext* opCtx);
+
     const std::string _uri;
     const uint64_t _tableId;  // not persisted
 
@@ -35,9 +35,11 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
 class OperationContext;
 class RecordId;
 
@@ -67,10 +69,18 @@ public:
         return total_bytes > _rs->cappedMaxSize();
     }
 
+    // Waits until kill() is called, or there are too many oplog stones and the truncation rate
+    // limit allows removing another one.
     void awaitHasExcessStonesOrDead();
 
     boost::optional<OplogStones::Stone> peekOldestStoneIfNeeded() const;
 
+    // Returns false if the oplogTruncationMaxBytesPerSecond rate limit requires the reclaim thread
+    // to wait before truncating another stone.
+    bool isTruncationAllowedNow();
+
+    // Removes the oldest stone after its records were truncated, and accounts for them against
+    // the truncation rate limit.
     void popOldestStone();
 
     void createNewStoneIfNeeded(RecordId lastRecord);
@@ -90,6 +100,9 @@ public:
     // Resize oplog size
     void adjust(int64_t maxSize);
 
+    // Reports how far oplog truncation is behind the configured maximum size.
+    void appendStats(BSONObjBuilder* builder) const;
+
     // The start point of where to truncate next. Used by the background reclaim thread to
     // efficiently truncate records with WiredTiger by skipping over tombstones, etc.
     RecordId firstRecord;
@@ -118,6 +131,7 @@ private:
     class TruncateChange;
 
     void _calculateStones(OperationContext* opCtx, size_t size);
+    bool _loadPersistedStones(OperationContext* opCtx);
     void _calculateStonesByScanning(OperationContext* opCtx);
     void _calculateStonesBySampling(OperationContext* opCtx,
                                     int64_t estRecordsPerStone,
@@ -125,6 +139,10 @@ private:
 
     void _pokeReclaimThreadIfNeeded();
 
+    // Hands the current stones to the size storer, which persists them with the next sync so that
+    // they need not be recomputed on startup. Must be called with '_mutex' held.
+    void _persistStones_inlock();
+
     static const uint64_t kRandomSamplesPerStone = 10;
 
     WiredTigerRecordStore* _rs;
@@ -136,6 +154,10 @@ private:
     // database, and false otherwise.
     bool _isDead = false;
 
+    // The reclaim thread may not truncate another stone before this point in time. Protected by
+    // '_oplogReclaimMutex'.
+    Date_t _truncationAllowedAt;
+
     // Minimum number of bytes the stone being filled should contain before it gets added to the
     // deque of oplog stones.
     int64_t _minBytesPerStone;
@@ -145,6 +167,13 @@ private:
 
     mutable stdx::mutex _mutex;  // Protects against concurrent access to the deque of oplog stones.
     std::deque<OplogStones::Stone> _stones;  // front = oldest, back = newest.
+
+    // When the stones first exceeded the maximum size without having been truncated since, or
+    // Date_t() if they do not. Protected by '_mutex'.
+    Date_t _excessSince;
+
+    AtomicInt64 _stonesTruncated;  // Number of stones removed by truncation.
+    AtomicInt64 _bytesTruncated;   // Approximate number of bytes removed by truncation.
 };
 
 }  // namespace mongo
@@ -40,6 +40,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/kv/kv_prefix.h"
 #include "mongo/db/storage/record_store_test_harness.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
@@ -1120,6 +1121,64 @@ TEST(WiredTigerRecordStoreTest, OplogStones_ReclaimStones) {
     }
 }
 
+// Verify that the reclaim pass stops truncating stones once oplogTruncationMaxBytesPerSecond has
+// been used up.
+TEST(WiredTigerRecordStoreTest, OplogStones_ReclaimStonesRateLimited) {
+    std::unique_ptr<RecordStoreHarnessHelper> harnessHelper = newRecordStoreHarnessHelper();
+
+    auto param =
+        ServerParameterSet::getGlobal()->getMap().find("oplogTruncationMaxBytesPerSecond")->second;
+    ASSERT_OK(param->setFromString("1"));
+    ON_BLOCK_EXIT([param] { ASSERT_OK(param->setFromString("0")); });
+
+    const int64_t cappedMaxSize = 10 * 1024;  // 10KB
+    unique_ptr<RecordStore> rs(
+        harnessHelper->newCappedRecordStore("local.oplog.stones", cappedMaxSize, -1));
+
+    WiredTigerRecordStore* wtrs = static_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wtrs->oplogStones();
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT_OK(wtrs->updateCappedSize(opCtx.get(), 120U));
+    }
+
+    oplogStones->setMinBytesPerStone(100);
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 1), 100), RecordId(1, 1));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 2), 110), RecordId(1, 2));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 3), 120), RecordId(1, 3));
+        ASSERT_EQ(3U, oplogStones->numStones());
+        ASSERT_TRUE(oplogStones->isTruncationAllowedNow());
+    }
+
+    // Only the first stone is truncated, after which its 100 bytes use up the next 100 seconds.
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        wtrs->reclaimOplog(opCtx.get());
+
+        ASSERT_EQ(2, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(230, rs->dataSize(opCtx.get()));
+        ASSERT_EQ(2U, oplogStones->numStones());
+        ASSERT_TRUE(oplogStones->peekOldestStoneIfNeeded());
+        ASSERT_FALSE(oplogStones->isTruncationAllowedNow());
+    }
+
+    // Later passes leave the excess stones alone until then.
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        wtrs->reclaimOplog(opCtx.get());
+
+        ASSERT_EQ(2, rs->numRecords(opCtx.get()));
+        ASSERT_EQ(2U, oplogStones->numStones());
+    }
+}
+
 // Verify that an oplog stone isn't created if it would cause the logical representation of the
 // records to not be in increasing order.
 TEST(WiredTigerRecordStoreTest, OplogStones_AscendingOrder) {
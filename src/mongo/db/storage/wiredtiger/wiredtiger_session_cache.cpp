@@ -35,7 +35,11 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include <algorithm>
+#include <functional>
+
 #include "mongo/base/error_codes.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/mongod_options.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/storage/journal_listener.h"
@@ -44,6 +48,7 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -153,7 +158,23 @@ void WiredTigerSession::closeCursorsForQueuedDrops(WiredTigerKVEngine* engine) {
 
 namespace {
 AtomicUInt64 nextTableId(1);
+
+// Upper bound on the number of session cache partitions, regardless of the number of cores.
+const size_t kMaxSessionCachePartitions = 64;
+
+/**
+ * Returns the number of session cache partitions to use: the number of cores rounded up to a
+ * power of two, so that a partition can be selected with a mask.
+ */
+size_t numSessionCachePartitions() {
+    const size_t numCores = std::max(ProcessInfo().getNumCores(), 1u);
+    size_t numPartitions = 1;
+    while (numPartitions < numCores && numPartitions < kMaxSessionCachePartitions) {
+        numPartitions <<= 1;
+    }
+    return numPartitions;
 }
+}  // namespace
 // static
 uint64_t WiredTigerSession::genTableId() {
     return nextTableId.fetchAndAdd(1);
@@ -162,10 +183,18 @@ uint64_t WiredTigerSession::genTableId() {
 // -----------------------
 
 WiredTigerSessionCache::WiredTigerSessionCache(WiredTigerKVEngine* engine)
-    : _engine(engine), _conn(engine->getConnection()), _snapshotManager(_conn), _shuttingDown(0) {}
+    : WiredTigerSessionCache(engine->getConnection()) {
+    _engine = engine;
+}
 
 WiredTigerSessionCache::WiredTigerSessionCache(WT_CONNECTION* conn)
-    : _engine(NULL), _conn(conn), _snapshotManager(_conn), _shuttingDown(0) {}
+    : _engine(NULL), _conn(conn), _snapshotManager(_conn), _shuttingDown(0) {
+    const size_t numPartitions = numSessionCachePartitions();
+    _partitions.reserve(numPartitions);
+    for (size_t i = 0; i < numPartitions; ++i) {
+        _partitions.push_back(stdx::make_unique<Partition>());
+    }
+}
 
 WiredTigerSessionCache::~WiredTigerSessionCache() {
     shuttingDown();
@@ -269,9 +298,11 @@ void WiredTigerSessionCache::waitUntilDurable(bool forceCheckpoint, bool stableC
 }
 
 void WiredTigerSessionCache::closeAllCursors(const std::string& uri) {
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeAllCursors(uri);
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lock(partition->lock);
+        for (auto&& session : partition->sessions) {
+            session->closeAllCursors(uri);
+        }
     }
 }
 
@@ -279,24 +310,31 @@ void WiredTigerSessionCache::closeCursorsForQueuedDrops() {
     // Increment the cursor epoch so that all cursors from this epoch are closed.
     _cursorEpoch.fetchAndAdd(1);
 
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeCursorsForQueuedDrops(_engine);
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lock(partition->lock);
+        for (auto&& session : partition->sessions) {
+            session->closeCursorsForQueuedDrops(_engine);
+        }
     }
 }
 
 void WiredTigerSessionCache::closeAll() {
     // Increment the epoch as we are now closing all sessions with this epoch.
-    SessionCache swap;
+    // The epoch must be bumped before any partition is emptied: releaseSession checks the epoch
+    // under the partition lock, so a session released with the old epoch is always cached before
+    // its partition is emptied below.
+    _epoch.fetchAndAdd(1);
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        _epoch.fetchAndAdd(1);
-        _sessions.swap(swap);
-    }
+    for (auto&& partition : _partitions) {
+        SessionCache swap;
+        {
+            stdx::lock_guard<stdx::mutex> lock(partition->lock);
+            partition->sessions.swap(swap);
+        }
 
-    for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
-        delete (*i);
+        for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
+            delete (*i);
+        }
     }
 }
 
@@ -309,18 +347,36 @@ UniqueWiredTigerSession WiredTigerSessionCache::getSession() {
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        if (!_sessions.empty()) {
+    // Start with this thread's own partition, waiting for its lock if necessary. Other partitions
+    // are only visited if their lock is free, as opening a new session is preferable to queueing
+    // behind threads that the partition belongs to.
+    const size_t home = _partitionIndexForCurrentThread();
+    const size_t mask = _partitions.size() - 1;
+    for (size_t visited = 0; visited < _partitions.size(); ++visited) {
+        Partition& partition = *_partitions[(home + visited) & mask];
+        stdx::unique_lock<stdx::mutex> lock;
+        if (!_lockPartition(partition, &lock, visited == 0)) {
+            continue;
+        }
+
+        if (!partition.sessions.empty()) {
             // Get the most recently used session so that if we discard sessions, we're
             // discarding older ones
-            WiredTigerSession* cachedSession = _sessions.back();
-            _sessions.pop_back();
+            WiredTigerSession* cachedSession = partition.sessions.back();
+            partition.sessions.pop_back();
+            lock.unlock();
+
+            if (visited == 0) {
+                _sessionsReused.fetchAndAdd(1);
+            } else {
+                _sessionsStolen.fetchAndAdd(1);
+            }
             return UniqueWiredTigerSession(cachedSession);
         }
     }
 
     // Outside of the cache partition lock, but on release will be put back on the cache
+    _sessionsOpened.fetchAndAdd(1);
     return UniqueWiredTigerSession(
         new WiredTigerSession(_conn, this, _epoch.load(), _cursorEpoch.load()));
 }
@@ -364,10 +420,12 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
     uint64_t currentEpoch = _epoch.load();
 
     if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
+        Partition& partition = *_partitions[_partitionIndexForCurrentThread()];
+        stdx::unique_lock<stdx::mutex> lock;
+        _lockPartition(partition, &lock, true);
         if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
             returnedToCache = true;
-            _sessions.push_back(session);
+            partition.sessions.push_back(session);
         }
     } else
         invariant(session->_getEpoch() < currentEpoch);
@@ -379,6 +437,43 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
         _engine->dropSomeQueuedIdents();
 }
 
+size_t WiredTigerSessionCache::_partitionIndexForCurrentThread() const {
+    const size_t hash = std::hash<stdx::thread::id>()(stdx::this_thread::get_id());
+    return hash & (_partitions.size() - 1);
+}
+
+bool WiredTigerSessionCache::_lockPartition(Partition& partition,
+                                            stdx::unique_lock<stdx::mutex>* lock,
+                                            bool wait) {
+    *lock = stdx::unique_lock<stdx::mutex>(partition.lock, stdx::try_to_lock);
+    if (lock->owns_lock()) {
+        return true;
+    }
+
+    _partitionLocksContended.fetchAndAdd(1);
+    if (!wait) {
+        return false;
+    }
+    lock->lock();
+    return true;
+}
+
+void WiredTigerSessionCache::appendStats(BSONObjBuilder* builder) const {
+    size_t sessionsCached = 0;
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lock(partition->lock);
+        sessionsCached += partition->sessions.size();
+    }
+
+    BSONObjBuilder bob(builder->subobjStart("sessionCache"));
+    bob.append("partitions", static_cast<int>(_partitions.size()));
+    bob.append("sessionsCached", static_cast<long long>(sessionsCached));
+    bob.append("sessionsReused", static_cast<long long>(_sessionsReused.load()));
+    bob.append("sessionsStolen", static_cast<long long>(_sessionsStolen.load()));
+    bob.append("sessionsOpened", static_cast<long long>(_sessionsOpened.load()));
+    bob.append("partitionLocksContended", static_cast<long long>(_partitionLocksContended.load()));
+    bob.done();
+}
 
 void WiredTigerSessionCache::setJournalListener(JournalListener* jl) {
     stdx::unique_lock<stdx::mutex> lk(_journalListenerMutex);
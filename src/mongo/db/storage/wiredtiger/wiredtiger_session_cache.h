@@ -32,7 +32,9 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <wiredtiger.h>
 
@@ -44,6 +46,7 @@
 
 namespace mongo {
 
+class BSONObjBuilder;
 class WiredTigerKVEngine;
 class WiredTigerSessionCache;
 
@@ -139,6 +142,10 @@ private:
 /**
  *  This cache implements a shared pool of WiredTiger sessions with the goal to amortize the
  *  cost of session creation and destruction over multiple uses.
+ *
+ *  Idle sessions are spread over a number of independently locked partitions. A thread always
+ *  releases sessions into, and first tries to acquire sessions from, the partition its thread id
+ *  hashes to, only taking sessions from other partitions when its own is empty.
  */
 class WiredTigerSessionCache {
 public:
@@ -210,7 +217,33 @@ public:
         return _cursorEpoch.load();
     }
 
+    /**
+     * Appends counters describing session reuse and partition lock contention to 'builder'.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
 private:
+    typedef std::vector<WiredTigerSession*> SessionCache;
+
+    /**
+     * A subset of the cached sessions, protected by its own lock.
+     */
+    struct Partition {
+        stdx::mutex lock;
+        SessionCache sessions;
+    };
+
+    /**
+     * Returns the index of the partition that the calling thread caches its sessions in.
+     */
+    size_t _partitionIndexForCurrentThread() const;
+
+    /**
+     * Acquires the lock of 'partition' into 'lock', counting the acquisition as contended if the
+     * lock was already held. Blocks only if 'wait' is true; returns whether the lock is held.
+     */
+    bool _lockPartition(Partition& partition, stdx::unique_lock<stdx::mutex>* lock, bool wait);
+
     WiredTigerKVEngine* _engine;  // not owned, might be NULL
     WT_CONNECTION* _conn;         // not owned
     WiredTigerSnapshotManager _snapshotManager;
@@ -221,9 +254,16 @@ private:
     AtomicUInt32 _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
-    stdx::mutex _cacheLock;
-    typedef std::vector<WiredTigerSession*> SessionCache;
-    SessionCache _sessions;
+    // Fixed after construction. Always a power of two.
+    std::vector<std::unique_ptr<Partition>> _partitions;
+
+    // Sessions handed out from the cache, from the caller's own partition or another one.
+    AtomicUInt64 _sessionsReused;
+    AtomicUInt64 _sessionsStolen;
+    // Sessions that had to be opened because no partition had one cached.
+    AtomicUInt64 _sessionsOpened;
+    // Partition lock acquisitions that found the lock already held.
+    AtomicUInt64 _partitionLocksContended;
 
     // Bumped when all open sessions need to be closed
     AtomicUInt64 _epoch;  // atomic so we can check it outside of the lock
@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class WiredTigerSessionCacheTest : public unittest::Test {
+public:
+    WiredTigerSessionCacheTest() : _dbpath("wt_test") {
+        int ret = wiredtiger_open(_dbpath.path().c_str(), NULL, "create", &_conn);
+        ASSERT_OK(wtRCToStatus(ret));
+        _sessionCache = stdx::make_unique<WiredTigerSessionCache>(_conn);
+    }
+
+    ~WiredTigerSessionCacheTest() {
+        _sessionCache.reset();
+        _conn->close(_conn, NULL);
+    }
+
+    WiredTigerSessionCache* sessionCache() {
+        return _sessionCache.get();
+    }
+
+    BSONObj stats() {
+        BSONObjBuilder builder;
+        _sessionCache->appendStats(&builder);
+        return builder.obj().getObjectField("sessionCache").getOwned();
+    }
+
+private:
+    unittest::TempDir _dbpath;
+    WT_CONNECTION* _conn = nullptr;
+    std::unique_ptr<WiredTigerSessionCache> _sessionCache;
+};
+
+TEST_F(WiredTigerSessionCacheTest, ReleasedSessionIsReused) {
+    WiredTigerSession* first = nullptr;
+    {
+        UniqueWiredTigerSession session = sessionCache()->getSession();
+        first = session.get();
+    }
+    ASSERT_EQ(1, stats()["sessionsOpened"].numberLong());
+    ASSERT_EQ(1, stats()["sessionsCached"].numberLong());
+
+    UniqueWiredTigerSession session = sessionCache()->getSession();
+    ASSERT_EQ(first, session.get());
+    ASSERT_EQ(1, stats()["sessionsOpened"].numberLong());
+    ASSERT_EQ(1, stats()["sessionsReused"].numberLong());
+    ASSERT_EQ(0, stats()["sessionsCached"].numberLong());
+}
+
+TEST_F(WiredTigerSessionCacheTest, ConcurrentSessionsAreAllCached) {
+    {
+        UniqueWiredTigerSession first = sessionCache()->getSession();
+        UniqueWiredTigerSession second = sessionCache()->getSession();
+        ASSERT_NOT_EQUALS(first.get(), second.get());
+    }
+    ASSERT_EQ(2, stats()["sessionsOpened"].numberLong());
+    ASSERT_EQ(2, stats()["sessionsCached"].numberLong());
+}
+
+TEST_F(WiredTigerSessionCacheTest, SessionReleasedByAnotherThreadCanBeAcquired) {
+    WiredTigerSession* released = nullptr;
+    stdx::thread thread([&] {
+        UniqueWiredTigerSession session = sessionCache()->getSession();
+        released = session.get();
+    });
+    thread.join();
+
+    // Whether the session is found in this thread's partition or taken from another one depends
+    // on how the two thread ids hash, but it must be reused rather than a new one being opened.
+    UniqueWiredTigerSession session = sessionCache()->getSession();
+    ASSERT_EQ(released, session.get());
+    ASSERT_EQ(1, stats()["sessionsOpened"].numberLong());
+    ASSERT_EQ(1, stats()["sessionsReused"].numberLong() + stats()["sessionsStolen"].numberLong());
+}
+
+TEST_F(WiredTigerSessionCacheTest, CloseAllDiscardsCachedAndOutstandingSessions) {
+    { UniqueWiredTigerSession cached = sessionCache()->getSession(); }
+    UniqueWiredTigerSession outstanding = sessionCache()->getSession();
+    ASSERT_EQ(0, stats()["sessionsCached"].numberLong());
+
+    sessionCache()->closeAll();
+    outstanding.reset();
+    ASSERT_EQ(0, stats()["sessionsCached"].numberLong());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -36,6 +36,7 @@
 #include <wiredtiger.h>
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/stdx/mutex.h"
 
@@ -59,6 +60,18 @@ public:
 
     void loadFromCache(StringData uri, long long* numRecords, long long* dataSize) const;
 
+    /**
+     * Caches the serialized oplog truncation markers of the record store with 'uri', to be written
+     * out by the next syncCache(). Passing an empty array removes them.
+     */
+    void storeOplogStonesToCache(StringData uri, BSONArray oplogStones);
+
+    /**
+     * Returns the oplog truncation markers last stored for 'uri', or an empty object if there are
+     * none.
+     */
+    BSONObj loadOplogStonesFromCache(StringData uri) const;
+
     /**
      * Loads from the underlying table.
      */
@@ -76,6 +89,7 @@ private:
         Entry() : numRecords(0), dataSize(0), dirty(false), rs(NULL) {}
         long long numRecords;
         long long dataSize;
+        BSONObj oplogStones;
         bool dirty;
         WiredTigerRecordStore* rs;  // not owned
     };
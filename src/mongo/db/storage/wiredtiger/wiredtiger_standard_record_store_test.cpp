@@ -300,6 +300,111 @@ TEST(WiredTigerRecordStoreTest, SizeStorer1) {
     rs.reset(NULL);  // this has to be deleted before ss
 }
 
+TEST(WiredTigerRecordStoreTest, SizeStorerPersistsOplogStones) {
+    unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+
+    const string uri = "table:oplog";
+    const string sizeStorerUri = "table:sizeStorer";
+    const bool enableWtLogging = false;
+    BSONArrayBuilder builder;
+    builder.append(BSON("records" << 10LL << "bytes" << 100LL << "lastRecord" << 1LL));
+    builder.append(BSON("records" << 20LL << "bytes" << 200LL << "lastRecord" << 2LL));
+    const BSONArray stones = builder.arr();
+
+    {
+        WiredTigerSizeStorer ss(harnessHelper->conn(), sizeStorerUri, enableWtLogging);
+        ASSERT_TRUE(ss.loadOplogStonesFromCache(uri).isEmpty());
+        ss.storeToCache(uri, 30, 300);
+        ss.storeOplogStonesToCache(uri, stones);
+        ss.syncCache(true);
+    }
+
+    {
+        WiredTigerSizeStorer ss(harnessHelper->conn(), sizeStorerUri, enableWtLogging);
+        ss.fillCache();
+        ASSERT_BSONOBJ_EQ(stones, ss.loadOplogStonesFromCache(uri));
+
+        // Storing an empty set of stones removes them.
+        ss.storeOplogStonesToCache(uri, BSONArray());
+        ss.syncCache(true);
+    }
+
+    {
+        WiredTigerSizeStorer ss(harnessHelper->conn(), sizeStorerUri, enableWtLogging);
+        ss.fillCache();
+        ASSERT_TRUE(ss.loadOplogStonesFromCache(uri).isEmpty());
+
+        long long numRecords;
+        long long dataSize;
+        ss.loadFromCache(uri, &numRecords, &dataSize);
+        ASSERT_EQUALS(30, numRecords);
+        ASSERT_EQUALS(300, dataSize);
+    }
+}
+
+// The oplog stones handed to the size storer are loaded when the oplog is opened again, rather than
+// being recomputed.
+TEST(WiredTigerRecordStoreTest, OplogStonesReloadedFromSizeStorer) {
+    unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+
+    const string ns = "local.oplog.stones";
+    const int64_t cappedMaxSize = 10 * 1024;  // 10KB
+    unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore(ns, cappedMaxSize, -1));
+    auto wtrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+    const string uri = wtrs->getURI();
+
+    const string sizeStorerUri = "table:sizeStorer";
+    const bool enableWtLogging = false;
+    WiredTigerSizeStorer ss(harnessHelper->conn(), sizeStorerUri, enableWtLogging);
+    wtrs->setSizeStorer(&ss);
+
+    auto oplogStones = wtrs->oplogStones();
+    oplogStones->setMinBytesPerStone(100);
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        for (int i = 1; i <= 3; i++) {
+            const Timestamp ts(1, i);
+            const BSONObj obj = BSON("ts" << ts << "str" << string(100, 'x'));
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_OK(wtrs->oplogDiskLocRegister(opCtx.get(), ts));
+            ASSERT_OK(
+                rs->insertRecord(opCtx.get(), obj.objdata(), obj.objsize(), false).getStatus());
+            uow.commit();
+        }
+    }
+    ASSERT_EQ(3U, oplogStones->numStones());
+    ASSERT_EQ(3, ss.loadOplogStonesFromCache(uri).nFields());
+
+    rs.reset(NULL);
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        WiredTigerRecordStore::Params params;
+        params.ns = ns;
+        params.uri = uri;
+        params.engineName = kWiredTigerEngineName;
+        params.isCapped = true;
+        params.isEphemeral = false;
+        params.cappedMaxSize = cappedMaxSize;
+        params.cappedMaxDocs = -1;
+        params.cappedCallback = nullptr;
+        params.sizeStorer = &ss;
+
+        auto ret = new StandardWiredTigerRecordStore(opCtx.get(), params);
+        ret->postConstructorInit(opCtx.get());
+        rs.reset(ret);
+    }
+
+    // Recomputing the stones of a 10KB oplog would not have placed any in its few hundred bytes.
+    oplogStones = checked_cast<WiredTigerRecordStore*>(rs.get())->oplogStones();
+    ASSERT_EQ(3U, oplogStones->numStones());
+    ASSERT_EQ(0, oplogStones->currentRecords());
+    ASSERT_EQ(0, oplogStones->currentBytes());
+
+    rs.reset(NULL);  // this has to be deleted before ss
+}
+
 class GoodValidateAdaptor : public ValidateAdaptor {
 public:
     virtual Status validate(const RecordId& recordId, const RecordData& record, size_t* dataSize) {
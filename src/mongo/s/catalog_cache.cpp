@@ -352,13 +352,17 @@ void CatalogCache::_scheduleCollectionRefresh_inlock(
         std::shared_ptr<ChunkManager> newRoutingInfo;
         try {
             newRoutingInfo = refreshCollectionRoutingInfo(
-                opCtx, nss, std::move(existingRoutingInfo), std::move(swCollAndChunks));
+                opCtx, nss, existingRoutingInfo, std::move(swCollAndChunks));
         } catch (const DBException& ex) {
             stdx::lock_guard<stdx::mutex> lg(_mutex);
             refreshFailed_inlock(ex.toStatus());
             return;
         }
 
+        if (newRoutingInfo != existingRoutingInfo) {
+            _cacheLoader.onRoutingTableRefreshed(nss, newRoutingInfo);
+        }
+
         stdx::lock_guard<stdx::mutex> lg(_mutex);
         auto& collections = dbEntry->collections;
         auto it = collections.find(nss.ns());
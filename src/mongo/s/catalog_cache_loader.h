@@ -41,6 +41,7 @@
 
 namespace mongo {
 
+class ChunkManager;
 class NamespaceString;
 class OperationContext;
 
@@ -122,6 +123,15 @@ public:
         stdx::function<void(OperationContext*, StatusWith<CollectionAndChangedChunks>)>
             callbackFn) = 0;
 
+    /**
+     * Invoked by the catalog cache, on the thread which ran the callback of getChunksSince, after
+     * it has built a new routing table for 'nss'. The 'routingInfo' is null if the collection was
+     * found not to be sharded. Loaders which keep their own copy of the routing table can use this
+     * to update it. The default implementation does nothing.
+     */
+    virtual void onRoutingTableRefreshed(const NamespaceString& nss,
+                                         const std::shared_ptr<ChunkManager>& routingInfo) {}
+
     /**
      * Waits for any pending changes for the specified collection to be persisted locally (not
      * necessarily replicated). If newer changes come after this method has started running, they
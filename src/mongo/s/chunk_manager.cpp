@@ -32,15 +32,18 @@
 
 #include "mongo/s/chunk_manager.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/matcher/extensions_callback_noop.h"
 #include "mongo/db/query/collation/collation_index_key.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -49,6 +52,10 @@ namespace {
 // Used to generate sequence numbers to assign to each newly created ChunkManager
 AtomicUInt32 nextCMSequenceNumber(0);
 
+// Ordering under which the KeyString encodings of the chunks' max keys sort in the same order as
+// the simple BSONObj comparison of the keys
+const Ordering kAllAscending = Ordering::make(BSONObj());
+
 void checkAllElementsAreOfType(BSONType type, const BSONObj& o) {
     for (const auto&& element : o) {
         uassert(ErrorCodes::ConflictingOperationInProgress,
@@ -59,6 +66,253 @@ void checkAllElementsAreOfType(BSONType type, const BSONObj& o) {
 
 }  // namespace
 
+ChunkMap::ConstIterator ChunkMap::upperBound(const BSONObj& key) const {
+    const auto encodedKey = _encodeKey(key);
+
+    const auto blockIt = std::upper_bound(_blockMaxKeys.begin(), _blockMaxKeys.end(), encodedKey);
+    if (blockIt == _blockMaxKeys.end()) {
+        return end();
+    }
+
+    const size_t block = blockIt - _blockMaxKeys.begin();
+    const auto& maxKeys = _blocks[block]->maxKeys;
+    return {this, block, size_t(std::upper_bound(maxKeys.begin(), maxKeys.end(), encodedKey) -
+                                maxKeys.begin())};
+}
+
+std::vector<ChunkMap::ConstIterator> ChunkMap::upperBounds(const std::vector<BSONObj>& keys) const {
+    std::vector<std::string> encodedKeys;
+    encodedKeys.reserve(keys.size());
+    for (const auto& key : keys) {
+        encodedKeys.push_back(_encodeKey(key));
+    }
+
+    std::vector<size_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&encodedKeys](size_t lhs, size_t rhs) {
+        return encodedKeys[lhs] < encodedKeys[rhs];
+    });
+
+    std::vector<ConstIterator> results(keys.size(), end());
+
+    size_t block = 0;
+    size_t pos = 0;
+    for (const size_t i : order) {
+        const auto& encodedKey = encodedKeys[i];
+
+        if (block < _blocks.size() && !(encodedKey < _blocks[block]->maxKeys[pos])) {
+            // The key is past the chunk of the previous key, so search onwards from it
+            const auto blockIt =
+                std::upper_bound(_blockMaxKeys.begin() + block, _blockMaxKeys.end(), encodedKey);
+            const size_t nextBlock = blockIt - _blockMaxKeys.begin();
+            if (nextBlock != block) {
+                block = nextBlock;
+                pos = 0;
+            }
+
+            if (block < _blocks.size()) {
+                const auto& maxKeys = _blocks[block]->maxKeys;
+                pos = std::upper_bound(maxKeys.begin() + pos, maxKeys.end(), encodedKey) -
+                    maxKeys.begin();
+            }
+        }
+
+        if (block == _blocks.size()) {
+            // All the remaining keys are past the last chunk
+            break;
+        }
+
+        results[i] = {this, block, pos};
+    }
+
+    return results;
+}
+
+ChunkMap ChunkMap::makeUpdated(const std::vector<std::shared_ptr<Chunk>>& changedChunks) const {
+    // Applying the changes to each other first leaves the changed chunks which end up in the
+    // updated map
+    auto newChunks =
+        SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>();
+
+    // Ranges [first, second) of the indexes of the chunks of this map which a change overlaps
+    std::vector<std::pair<size_t, size_t>> overlapped;
+
+    for (const auto& chunk : changedChunks) {
+        newChunks.erase(newChunks.upper_bound(chunk->getMin()),
+                        newChunks.upper_bound(chunk->getMax()));
+        newChunks.insert(std::make_pair(chunk->getMax(), chunk));
+
+        const size_t low = _upperBoundIndex(_encodeKey(chunk->getMin()));
+        const size_t high = _upperBoundIndex(_encodeKey(chunk->getMax()));
+        if (low < high) {
+            overlapped.emplace_back(low, high);
+        }
+    }
+
+    std::sort(overlapped.begin(), overlapped.end());
+
+    std::vector<std::pair<size_t, size_t>> removed;
+    for (const auto& range : overlapped) {
+        if (!removed.empty() && range.first <= removed.back().second) {
+            removed.back().second = std::max(removed.back().second, range.second);
+        } else {
+            removed.push_back(range);
+        }
+    }
+
+    struct NewChunk {
+        std::string maxKey;
+        std::shared_ptr<Chunk> chunk;
+
+        // The block of this map that the chunk is inserted into
+        size_t block;
+    };
+
+    std::vector<NewChunk> inserted;
+    inserted.reserve(newChunks.size());
+
+    for (const auto& entry : newChunks) {
+        auto maxKey = _encodeKey(entry.first);
+        // The chunk goes into the block of the first chunk after it, or the last block if it goes
+        // past the end of the map
+        const size_t index = std::min(_upperBoundIndex(maxKey), _size ? _size - 1 : 0);
+        const auto blockIt = std::upper_bound(_blockStarts.begin(), _blockStarts.end(), index);
+        const size_t block =
+            blockIt == _blockStarts.begin() ? 0 : blockIt - _blockStarts.begin() - 1;
+        inserted.push_back({std::move(maxKey), entry.second, block});
+    }
+
+    ChunkMap updated;
+
+    if (_blocks.empty()) {
+        std::vector<std::string> maxKeys;
+        std::vector<std::shared_ptr<Chunk>> chunks;
+        for (auto& newChunk : inserted) {
+            maxKeys.push_back(std::move(newChunk.maxKey));
+            chunks.push_back(std::move(newChunk.chunk));
+        }
+
+        updated._appendBlocks(std::move(maxKeys), std::move(chunks));
+        return updated;
+    }
+
+    // Chunks of consecutive blocks which the changes touch, which are merged and split again into
+    // new blocks
+    std::vector<std::string> pendingMaxKeys;
+    std::vector<std::shared_ptr<Chunk>> pendingChunks;
+
+    auto nextRemoved = removed.begin();
+    auto nextInserted = inserted.begin();
+
+    for (size_t block = 0; block < _blocks.size(); block++) {
+        const auto& oldBlock = *_blocks[block];
+        const size_t blockStart = _blockStarts[block];
+        const size_t blockEnd = blockStart + oldBlock.chunks.size();
+
+        while (nextRemoved != removed.end() && nextRemoved->second <= blockStart) {
+            ++nextRemoved;
+        }
+
+        const bool hasRemoved = nextRemoved != removed.end() && nextRemoved->first < blockEnd;
+        const bool hasInserted = nextInserted != inserted.end() && nextInserted->block == block;
+
+        if (!hasRemoved && !hasInserted) {
+            updated._appendBlocks(std::move(pendingMaxKeys), std::move(pendingChunks));
+            pendingMaxKeys.clear();
+            pendingChunks.clear();
+
+            updated._appendSharedBlock(_blocks[block]);
+            continue;
+        }
+
+        for (size_t pos = 0; pos < oldBlock.chunks.size(); pos++) {
+            const size_t index = blockStart + pos;
+
+            while (nextInserted != inserted.end() && nextInserted->block == block &&
+                   nextInserted->maxKey < oldBlock.maxKeys[pos]) {
+                pendingMaxKeys.push_back(std::move(nextInserted->maxKey));
+                pendingChunks.push_back(std::move(nextInserted->chunk));
+                ++nextInserted;
+            }
+
+            while (nextRemoved != removed.end() && nextRemoved->second <= index) {
+                ++nextRemoved;
+            }
+
+            if (nextRemoved == removed.end() || index < nextRemoved->first) {
+                pendingMaxKeys.push_back(oldBlock.maxKeys[pos]);
+                pendingChunks.push_back(oldBlock.chunks[pos]);
+            }
+        }
+
+        // Only the last block receives chunks past its end
+        while (nextInserted != inserted.end() && nextInserted->block == block) {
+            pendingMaxKeys.push_back(std::move(nextInserted->maxKey));
+            pendingChunks.push_back(std::move(nextInserted->chunk));
+            ++nextInserted;
+        }
+    }
+
+    invariant(nextInserted == inserted.end());
+
+    updated._appendBlocks(std::move(pendingMaxKeys), std::move(pendingChunks));
+    return updated;
+}
+
+std::string ChunkMap::_encodeKey(const BSONObj& key) {
+    const KeyString keyString(KeyString::Version::V1, key, kAllAscending);
+    return std::string(keyString.getBuffer(), keyString.getSize());
+}
+
+size_t ChunkMap::_upperBoundIndex(const std::string& encodedKey) const {
+    const auto blockIt = std::upper_bound(_blockMaxKeys.begin(), _blockMaxKeys.end(), encodedKey);
+    if (blockIt == _blockMaxKeys.end()) {
+        return _size;
+    }
+
+    const size_t block = blockIt - _blockMaxKeys.begin();
+    const auto& maxKeys = _blocks[block]->maxKeys;
+    return _blockStarts[block] +
+        (std::upper_bound(maxKeys.begin(), maxKeys.end(), encodedKey) - maxKeys.begin());
+}
+
+void ChunkMap::_appendBlocks(std::vector<std::string> maxKeys,
+                             std::vector<std::shared_ptr<Chunk>> chunks) {
+    invariant(maxKeys.size() == chunks.size());
+    if (chunks.empty()) {
+        return;
+    }
+
+    // Spread the chunks evenly over the fewest blocks of at most kBlockSize chunks
+    const size_t numBlocks = (chunks.size() + kBlockSize - 1) / kBlockSize;
+
+    size_t begin = 0;
+    for (size_t i = 0; i < numBlocks; i++) {
+        const size_t end = chunks.size() * (i + 1) / numBlocks;
+
+        auto block = std::make_shared<Block>();
+        block->maxKeys.assign(std::make_move_iterator(maxKeys.begin() + begin),
+                              std::make_move_iterator(maxKeys.begin() + end));
+        block->chunks.assign(std::make_move_iterator(chunks.begin() + begin),
+                             std::make_move_iterator(chunks.begin() + end));
+        _appendSharedBlock(std::move(block));
+
+        begin = end;
+    }
+}
+
+void ChunkMap::_appendSharedBlock(std::shared_ptr<const Block> block) {
+    invariant(!block->chunks.empty());
+    invariant(_blockMaxKeys.empty() || _blockMaxKeys.back() < block->maxKeys.front());
+
+    _blockMaxKeys.push_back(block->maxKeys.back());
+    _blockStarts.push_back(_size);
+    _size += block->chunks.size();
+    _blocks.push_back(std::move(block));
+}
+
 ChunkManager::ChunkManager(NamespaceString nss,
                            KeyPattern shardKeyPattern,
                            std::unique_ptr<CollatorInterface> defaultCollator,
@@ -87,12 +341,12 @@ std::shared_ptr<Chunk> ChunkManager::findIntersectingChunk(const BSONObj& shardK
         }
     }
 
-    const auto it = _chunkMap.upper_bound(shardKey);
+    const auto it = _chunkMap.upperBound(shardKey);
     uassert(ErrorCodes::ShardKeyNotFound,
             str::stream() << "Cannot target single shard using key " << shardKey,
-            it != _chunkMap.end() && it->second->containsKey(shardKey));
+            it != _chunkMap.end() && (*it)->containsKey(shardKey));
 
-    return it->second;
+    return *it;
 }
 
 std::shared_ptr<Chunk> ChunkManager::findIntersectingChunkWithSimpleCollation(
@@ -100,6 +354,24 @@ std::shared_ptr<Chunk> ChunkManager::findIntersectingChunkWithSimpleCollation(
     return findIntersectingChunk(shardKey, CollationSpec::kSimpleSpec);
 }
 
+std::vector<std::shared_ptr<Chunk>> ChunkManager::findIntersectingChunksWithSimpleCollation(
+    const std::vector<BSONObj>& shardKeys) const {
+    const auto its = _chunkMap.upperBounds(shardKeys);
+
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    chunks.reserve(shardKeys.size());
+
+    for (size_t i = 0; i < shardKeys.size(); i++) {
+        uassert(ErrorCodes::ShardKeyNotFound,
+                str::stream() << "Cannot target single shard using key " << shardKeys[i],
+                its[i] != _chunkMap.end() && (*its[i])->containsKey(shardKeys[i]));
+
+        chunks.push_back(*its[i]);
+    }
+
+    return chunks;
+}
+
 void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
                                        const BSONObj& query,
                                        const BSONObj& collation,
@@ -330,8 +602,8 @@ std::string ChunkManager::toString() const {
     StringBuilder sb;
     sb << "ChunkManager: " << _nss.ns() << " key:" << _shardKeyPattern.toString() << '\n';
 
-    for (const auto& entry : _chunkMap) {
-        sb << "\t" << entry.second->toString() << '\n';
+    for (const auto& chunk : _chunkMap) {
+        sb << "\t" << chunk->toString() << '\n';
     }
 
     return sb.str();
@@ -345,10 +617,10 @@ ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epo
 
     ShardVersionMap shardVersions;
 
-    ChunkMap::const_iterator current = chunkMap.cbegin();
+    ChunkMap::ConstIterator current = chunkMap.begin();
 
-    while (current != chunkMap.cend()) {
-        const auto& firstChunkInRange = current->second;
+    while (current != chunkMap.end()) {
+        const auto& firstChunkInRange = *current;
 
         // Tracks the max shard version for the shard on which the current range will reside
         auto shardVersionIt = shardVersions.find(firstChunkInRange->getShardId());
@@ -360,25 +632,22 @@ ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epo
 
         auto& maxShardVersion = shardVersionIt->second;
 
-        current = std::find_if(
-            current,
-            chunkMap.cend(),
-            [&firstChunkInRange, &maxShardVersion](const ChunkMap::value_type& chunkMapEntry) {
-                const auto& currentChunk = chunkMapEntry.second;
-
-                if (currentChunk->getShardId() != firstChunkInRange->getShardId())
-                    return true;
+        // The chunk map iterators only go forward, so remember the last chunk of the range
+        std::shared_ptr<Chunk> lastChunkInRange;
+        for (; current != chunkMap.end(); ++current) {
+            const auto& currentChunk = *current;
 
-                if (currentChunk->getLastmod() > maxShardVersion)
-                    maxShardVersion = currentChunk->getLastmod();
+            if (currentChunk->getShardId() != firstChunkInRange->getShardId())
+                break;
 
-                return false;
-            });
+            if (currentChunk->getLastmod() > maxShardVersion)
+                maxShardVersion = currentChunk->getLastmod();
 
-        const auto rangeLast = std::prev(current);
+            lastChunkInRange = currentChunk;
+        }
 
         const BSONObj rangeMin = firstChunkInRange->getMin();
-        const BSONObj rangeMax = rangeLast->second->getMax();
+        const BSONObj rangeMax = lastChunkInRange->getMax();
 
         const auto oldSize = chunkRangeMap.size();
         const auto insertIterator = chunkRangeMap.insert(
@@ -427,20 +696,21 @@ std::shared_ptr<ChunkManager> ChunkManager::makeNew(
     OID epoch,
     const std::vector<ChunkType>& chunks) {
 
-    return ChunkManager(
-               std::move(nss),
-               std::move(shardKeyPattern),
-               std::move(defaultCollator),
-               std::move(unique),
-               SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>(),
-               {0, 0, epoch})
+    return ChunkManager(std::move(nss),
+                        std::move(shardKeyPattern),
+                        std::move(defaultCollator),
+                        std::move(unique),
+                        ChunkMap(),
+                        {0, 0, epoch})
         .makeUpdated(chunks);
 }
 
 std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
     const std::vector<ChunkType>& changedChunks) {
     const auto startingCollectionVersion = getVersion();
-    auto chunkMap = _chunkMap;
+
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    chunks.reserve(changedChunks.size());
 
     ChunkVersion collectionVersion = startingCollectionVersion;
     for (const auto& chunk : changedChunks) {
@@ -456,19 +726,7 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
         invariant(chunkVersion >= collectionVersion);
         collectionVersion = chunkVersion;
 
-        // Returns the first chunk with a max key that is > min - implies that the chunk overlaps
-        // min
-        const auto low = chunkMap.upper_bound(chunk.getMin());
-
-        // Returns the first chunk with a max key that is > max - implies that the next chunk cannot
-        // not overlap max
-        const auto high = chunkMap.upper_bound(chunk.getMax());
-
-        // Erase all chunks from the map, which overlap the chunk we got from the persistent store
-        chunkMap.erase(low, high);
-
-        // Insert only the chunk itself
-        chunkMap.insert(std::make_pair(chunk.getMax(), std::make_shared<Chunk>(chunk)));
+        chunks.push_back(std::make_shared<Chunk>(chunk));
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -482,6 +740,10 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
         return shared_from_this();
     }
 
+    // Erases all chunks from the map which overlap the chunks we got from the persistent store and
+    // inserts the chunks themselves, copying only the parts of the map which they fall in
+    auto chunkMap = _chunkMap.makeUpdated(chunks);
+
     return std::shared_ptr<ChunkManager>(
         new ChunkManager(_nss,
                          KeyPattern(getShardKeyPattern().getKeyPattern()),
@@ -28,9 +28,12 @@
 
 #pragma once
 
+#include <iterator>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/namespace_string.h"
@@ -47,8 +50,138 @@ class CanonicalQuery;
 struct QuerySolutionNode;
 class OperationContext;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
-using ChunkMap = BSONObjIndexedMap<std::shared_ptr<Chunk>>;
+/**
+ * Sorted array of the chunks of a collection, ordered by their max key.
+ *
+ * Lookups binary search the KeyString encodings of the chunks' max keys rather than compare
+ * BSONObjs. The chunks are stored in blocks of limited size, which successive versions of the
+ * routing table share, so that applying the changes from a refresh only copies the blocks which
+ * the changed chunks fall in.
+ */
+class ChunkMap {
+public:
+    // The maximum number of chunks in a block. The chunks of the blocks which an update touches are
+    // spread evenly over as few blocks as fit them.
+    static const size_t kBlockSize = 512;
+
+    class ConstIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::shared_ptr<Chunk>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        ConstIterator() = default;
+        ConstIterator(const ChunkMap* map, size_t block, size_t pos)
+            : _map(map), _block(block), _pos(pos) {}
+
+        ConstIterator& operator++() {
+            if (++_pos == _map->_blocks[_block]->chunks.size()) {
+                ++_block;
+                _pos = 0;
+            }
+            return *this;
+        }
+        ConstIterator operator++(int) {
+            ConstIterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const ConstIterator& other) const {
+            return _block == other._block && _pos == other._pos;
+        }
+        bool operator!=(const ConstIterator& other) const {
+            return !(*this == other);
+        }
+        reference operator*() const {
+            return _map->_blocks[_block]->chunks[_pos];
+        }
+        pointer operator->() const {
+            return &**this;
+        }
+
+    private:
+        const ChunkMap* _map = nullptr;
+        size_t _block = 0;
+        size_t _pos = 0;
+    };
+
+    ConstIterator begin() const {
+        return {this, 0, 0};
+    }
+
+    ConstIterator end() const {
+        return {this, _blocks.size(), 0};
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * Returns an iterator to the first chunk whose max key is greater than "key", under the simple
+     * BSONObj comparison.
+     */
+    ConstIterator upperBound(const BSONObj& key) const;
+
+    /**
+     * Returns what upperBound() would return for each of "keys", in the same order. The keys are
+     * looked up in sorted order, so that each search starts where the previous one left off and
+     * keys which fall in the same chunk as the previous key need no search at all.
+     */
+    std::vector<ConstIterator> upperBounds(const std::vector<BSONObj>& keys) const;
+
+    /**
+     * Returns a map in which, for each chunk of "changedChunks" in order, the chunks overlapping it
+     * are replaced with it. The blocks of this map which no change falls in are shared with the
+     * returned map.
+     */
+    ChunkMap makeUpdated(const std::vector<std::shared_ptr<Chunk>>& changedChunks) const;
+
+private:
+    struct Block {
+        // Encodings of the max keys of "chunks", in the same order
+        std::vector<std::string> maxKeys;
+        std::vector<std::shared_ptr<Chunk>> chunks;
+    };
+
+    /**
+     * Returns the KeyString encoding that the max keys are searched by.
+     */
+    static std::string _encodeKey(const BSONObj& key);
+
+    /**
+     * Returns the index in the whole map of the first chunk whose encoded max key is greater than
+     * "encodedKey".
+     */
+    size_t _upperBoundIndex(const std::string& encodedKey) const;
+
+    /**
+     * Appends a block built from "chunks" and their encoded max keys, split into blocks of
+     * kBlockSize chunks.
+     */
+    void _appendBlocks(std::vector<std::string> maxKeys,
+                       std::vector<std::shared_ptr<Chunk>> chunks);
+
+    /**
+     * Appends a block shared with another map.
+     */
+    void _appendSharedBlock(std::shared_ptr<const Block> block);
+
+    std::vector<std::shared_ptr<const Block>> _blocks;
+
+    // The encoded max key of the last chunk of each block, and the index in the whole map of the
+    // first chunk of each block. Kept outside of the blocks for the search over the blocks.
+    std::vector<std::string> _blockMaxKeys;
+    std::vector<size_t> _blockStarts;
+
+    size_t _size = 0;
+};
 
 // Map from a shard is to the max chunk version on that shard
 using ShardVersionMap = std::map<ShardId, ChunkVersion>;
@@ -63,7 +196,7 @@ public:
     class ConstChunkIterator {
     public:
         ConstChunkIterator() = default;
-        explicit ConstChunkIterator(ChunkMap::const_iterator iter) : _iter{iter} {}
+        explicit ConstChunkIterator(ChunkMap::ConstIterator iter) : _iter{iter} {}
 
         ConstChunkIterator& operator++() {
             ++_iter;
@@ -78,12 +211,12 @@ public:
         bool operator!=(const ConstChunkIterator& other) const {
             return !(*this == other);
         }
-        const ChunkMap::mapped_type& operator*() const {
-            return _iter->second;
+        const std::shared_ptr<Chunk>& operator*() const {
+            return *_iter;
         }
 
     private:
-        ChunkMap::const_iterator _iter;
+        ChunkMap::ConstIterator _iter;
     };
 
     class ConstRangeOfChunks {
@@ -160,7 +293,7 @@ public:
     ChunkVersion getVersion(const ShardId& shardId) const;
 
     ConstRangeOfChunks chunks() const {
-        return {ConstChunkIterator{_chunkMap.cbegin()}, ConstChunkIterator{_chunkMap.cend()}};
+        return {ConstChunkIterator{_chunkMap.begin()}, ConstChunkIterator{_chunkMap.end()}};
     }
 
     int numChunks() const {
@@ -187,6 +320,14 @@ public:
      */
     std::shared_ptr<Chunk> findIntersectingChunkWithSimpleCollation(const BSONObj& shardKey) const;
 
+    /**
+     * Same as findIntersectingChunkWithSimpleCollation, but for a batch of shard keys, which are
+     * resolved against the routing table in a single pass. Returns the chunks in the order of
+     * 'shardKeys'.
+     */
+    std::vector<std::shared_ptr<Chunk>> findIntersectingChunksWithSimpleCollation(
+        const std::vector<BSONObj>& shardKeys) const;
+
     /**
      * Finds the shard IDs for a given filter and collation. If collation is empty, we use the
      * collection default collation for targeting.
@@ -297,8 +438,8 @@ private:
     // Whether the sharding key is unique
     const bool _unique;
 
-    // Map from the max for each chunk to an entry describing the chunk. The union of all chunks'
-    // ranges must cover the complete space from [MinKey, MaxKey).
+    // The chunks, ordered by their max key. The union of all chunks' ranges must cover the
+    // complete space from [MinKey, MaxKey).
     const ChunkMap _chunkMap;
 
     // Different transformations of the chunk map for efficient querying
@@ -0,0 +1,210 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/s/chunk_manager.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("TestDB", "TestColl");
+const KeyPattern kShardKeyPattern(BSON("a" << 1));
+
+// Enough chunks to span several blocks of the chunk map
+const int kNumChunks = 3 * ChunkMap::kBlockSize + 17;
+
+BSONObj keyAt(int i) {
+    if (i == 0) {
+        return kShardKeyPattern.globalMin();
+    }
+    if (i == kNumChunks) {
+        return kShardKeyPattern.globalMax();
+    }
+    return BSON("a" << i * 10);
+}
+
+ShardId shardFor(int i) {
+    return ShardId(str::stream() << (i % 3));
+}
+
+std::shared_ptr<ChunkManager> makeChunkManager(const OID& epoch, ChunkVersion* version) {
+    std::vector<ChunkType> chunks;
+    for (int i = 0; i < kNumChunks; i++) {
+        chunks.emplace_back(kNss, ChunkRange{keyAt(i), keyAt(i + 1)}, *version, shardFor(i));
+        version->incMajor();
+    }
+
+    return ChunkManager::makeNew(kNss, kShardKeyPattern, nullptr, false, epoch, chunks);
+}
+
+void assertChunksAreSortedAndContiguous(const ChunkManager& cm) {
+    BSONObj lastMax = kShardKeyPattern.globalMin();
+    int count = 0;
+    for (const auto& chunk : cm.chunks()) {
+        ASSERT_BSONOBJ_EQ(lastMax, chunk->getMin());
+        lastMax = chunk->getMax();
+        count++;
+    }
+
+    ASSERT_BSONOBJ_EQ(kShardKeyPattern.globalMax(), lastMax);
+    ASSERT_EQ(cm.numChunks(), count);
+}
+
+TEST(ChunkMapTest, FindIntersectingChunkAcrossBlocks) {
+    const OID epoch = OID::gen();
+    ChunkVersion version(1, 0, epoch);
+    const auto cm = makeChunkManager(epoch, &version);
+
+    ASSERT_EQ(kNumChunks, cm->numChunks());
+    assertChunksAreSortedAndContiguous(*cm);
+
+    for (int i = 0; i < kNumChunks; i++) {
+        // The chunk's min, a key inside it and a key just below its max
+        for (int offset : {0, 5, 9}) {
+            if (i == 0 && offset == 0) {
+                continue;
+            }
+
+            const auto chunk = cm->findIntersectingChunkWithSimpleCollation(
+                BSON("a" << i * 10 + offset));
+            ASSERT_BSONOBJ_EQ(keyAt(i), chunk->getMin());
+            ASSERT_EQ(shardFor(i), chunk->getShardId());
+        }
+    }
+
+    ASSERT_BSONOBJ_EQ(keyAt(0),
+                      cm->findIntersectingChunkWithSimpleCollation(BSON("a" << MINKEY))->getMin());
+    ASSERT_BSONOBJ_EQ(keyAt(0),
+                      cm->findIntersectingChunkWithSimpleCollation(BSON("a" << -1))->getMin());
+    ASSERT_BSONOBJ_EQ(
+        keyAt(kNumChunks - 1),
+        cm->findIntersectingChunkWithSimpleCollation(BSON("a" << "string"))->getMin());
+
+    // Numbers of different types which compare equal find the same chunk
+    ASSERT_BSONOBJ_EQ(keyAt(2),
+                      cm->findIntersectingChunkWithSimpleCollation(BSON("a" << 20.0))->getMin());
+    ASSERT_BSONOBJ_EQ(keyAt(2),
+                      cm->findIntersectingChunkWithSimpleCollation(BSON("a" << 20LL))->getMin());
+}
+
+TEST(ChunkMapTest, FindIntersectingChunksOfUnsortedKeys) {
+    const OID epoch = OID::gen();
+    ChunkVersion version(1, 0, epoch);
+    const auto cm = makeChunkManager(epoch, &version);
+
+    // Keys in descending order, several of which fall in the same chunk, followed by keys which
+    // were already looked up and keys at the ends of the key space
+    std::vector<BSONObj> shardKeys;
+    for (int i = kNumChunks * 10 - 1; i >= 0; i -= 7) {
+        shardKeys.push_back(BSON("a" << i));
+    }
+    shardKeys.push_back(shardKeys[3]);
+    shardKeys.push_back(BSON("a" << "string"));
+    shardKeys.push_back(BSON("a" << MINKEY));
+
+    const auto chunks = cm->findIntersectingChunksWithSimpleCollation(shardKeys);
+    ASSERT_EQ(shardKeys.size(), chunks.size());
+
+    for (size_t i = 0; i < shardKeys.size(); i++) {
+        ASSERT_EQ(cm->findIntersectingChunkWithSimpleCollation(shardKeys[i]), chunks[i]);
+    }
+}
+
+TEST(ChunkMapTest, MakeUpdatedSplitsAndMergesChunks) {
+    const OID epoch = OID::gen();
+    ChunkVersion version(1, 0, epoch);
+    const auto cm = makeChunkManager(epoch, &version);
+
+    // Split a chunk in the middle of a block and merge chunks which straddle two blocks
+    const int splitChunk = ChunkMap::kBlockSize / 2;
+    const int mergeStart = ChunkMap::kBlockSize - 1;
+
+    std::vector<ChunkType> changedChunks;
+    changedChunks.emplace_back(kNss,
+                               ChunkRange{keyAt(splitChunk), BSON("a" << splitChunk * 10 + 5)},
+                               version,
+                               ShardId("0"));
+    version.incMinor();
+    changedChunks.emplace_back(kNss,
+                               ChunkRange{BSON("a" << splitChunk * 10 + 5), keyAt(splitChunk + 1)},
+                               version,
+                               ShardId("0"));
+    version.incMajor();
+    changedChunks.emplace_back(
+        kNss, ChunkRange{keyAt(mergeStart), keyAt(mergeStart + 3)}, version, ShardId("1"));
+
+    const auto updatedCm = cm->makeUpdated(changedChunks);
+    ASSERT_EQ(cm->numChunks() + 1 - 2, updatedCm->numChunks());
+    assertChunksAreSortedAndContiguous(*updatedCm);
+
+    auto chunk = updatedCm->findIntersectingChunkWithSimpleCollation(
+        BSON("a" << splitChunk * 10 + 2));
+    ASSERT_BSONOBJ_EQ(BSON("a" << splitChunk * 10 + 5), chunk->getMax());
+
+    chunk = updatedCm->findIntersectingChunkWithSimpleCollation(BSON("a" << splitChunk * 10 + 7));
+    ASSERT_BSONOBJ_EQ(BSON("a" << splitChunk * 10 + 5), chunk->getMin());
+
+    for (int i = mergeStart; i < mergeStart + 3; i++) {
+        chunk = updatedCm->findIntersectingChunkWithSimpleCollation(BSON("a" << i * 10 + 5));
+        ASSERT_BSONOBJ_EQ(keyAt(mergeStart), chunk->getMin());
+        ASSERT_BSONOBJ_EQ(keyAt(mergeStart + 3), chunk->getMax());
+        ASSERT_EQ(ShardId("1"), chunk->getShardId());
+    }
+
+    ASSERT_EQ(version.toLong(), updatedCm->getVersion().toLong());
+
+    // The chunk manager which was updated is left as it was
+    ASSERT_EQ(kNumChunks, cm->numChunks());
+    assertChunksAreSortedAndContiguous(*cm);
+    chunk = cm->findIntersectingChunkWithSimpleCollation(BSON("a" << (mergeStart + 1) * 10));
+    ASSERT_BSONOBJ_EQ(keyAt(mergeStart + 1), chunk->getMin());
+    ASSERT_EQ(shardFor(mergeStart + 1), chunk->getShardId());
+}
+
+TEST(ChunkMapTest, MakeUpdatedReplacesAllChunks) {
+    const OID epoch = OID::gen();
+    ChunkVersion version(1, 0, epoch);
+    const auto cm = makeChunkManager(epoch, &version);
+
+    const auto updatedCm = cm->makeUpdated(
+        {ChunkType(kNss,
+                   ChunkRange{kShardKeyPattern.globalMin(), kShardKeyPattern.globalMax()},
+                   version,
+                   ShardId("2"))});
+    ASSERT_EQ(1, updatedCm->numChunks());
+    assertChunksAreSortedAndContiguous(*updatedCm);
+    ASSERT_EQ(ShardId("2"),
+              updatedCm->findIntersectingChunkWithSimpleCollation(BSON("a" << 1000))->getShardId());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -317,6 +317,96 @@ Status ChunkManagerTargeter::targetInsert(OperationContext* opCtx,
     return Status::OK();
 }
 
+void ChunkManagerTargeter::targetInserts(OperationContext* opCtx,
+                                         const std::vector<BSONObj>& docs,
+                                         std::vector<StatusWith<ShardEndpoint>>* endpoints,
+                                         std::vector<BSONObj>* chunkMins) const {
+    endpoints->clear();
+    endpoints->reserve(docs.size());
+    chunkMins->clear();
+    chunkMins->resize(docs.size());
+
+    if (!_routingInfo->cm()) {
+        for (const auto& doc : docs) {
+            ShardEndpoint* endpoint = nullptr;
+            Status status = targetInsert(opCtx, doc, &endpoint);
+            if (!status.isOK()) {
+                endpoints->push_back(status);
+                continue;
+            }
+
+            endpoints->push_back(*std::unique_ptr<ShardEndpoint>(endpoint));
+        }
+
+        return;
+    }
+
+    const auto& cm = _routingInfo->cm();
+
+    // Extract the shard keys of all the documents up front, so that they can be looked up in the
+    // routing table together. The statuses of the documents which cannot be targeted are kept
+    // aside, in the order of the documents.
+    std::vector<BSONObj> shardKeys;
+    shardKeys.reserve(docs.size());
+
+    std::vector<Status> keyStatuses;
+    keyStatuses.reserve(docs.size());
+
+    for (const auto& doc : docs) {
+        BSONObj shardKey = cm->getShardKeyPattern().extractShardKeyFromDoc(doc);
+
+        if (shardKey.isEmpty()) {
+            keyStatuses.push_back({ErrorCodes::ShardKeyNotFound,
+                                   str::stream() << "document " << doc
+                                                 << " does not contain shard key for pattern "
+                                                 << cm->getShardKeyPattern().toString()});
+            continue;
+        }
+
+        Status status = ShardKeyPattern::checkShardKeySize(shardKey);
+        if (!status.isOK()) {
+            keyStatuses.push_back(std::move(status));
+            continue;
+        }
+
+        keyStatuses.push_back(Status::OK());
+        shardKeys.push_back(std::move(shardKey));
+    }
+
+    const auto chunks = cm->findIntersectingChunksWithSimpleCollation(shardKeys);
+
+    // Consecutive documents frequently go to the same chunk, which then shares the endpoint
+    auto chunkIt = chunks.begin();
+    const Chunk* lastChunk = nullptr;
+    boost::optional<ShardEndpoint> lastEndpoint;
+
+    for (size_t i = 0; i < docs.size(); i++) {
+        if (!keyStatuses[i].isOK()) {
+            endpoints->push_back(std::move(keyStatuses[i]));
+            continue;
+        }
+
+        const auto& chunk = *chunkIt++;
+        (*chunkMins)[i] = chunk->getMin();
+
+        if (chunk.get() != lastChunk) {
+            lastChunk = chunk.get();
+            lastEndpoint.emplace(chunk->getShardId(), cm->getVersion(chunk->getShardId()));
+        }
+
+        endpoints->push_back(*lastEndpoint);
+    }
+}
+
+void ChunkManagerTargeter::noteInsertAdded(const BSONObj& chunkMin, int docSizeBytes) const {
+    if (chunkMin.isEmpty())
+        return;
+
+    // Track autosplit stats for sharded collections
+    // Note: this is only best effort accounting and is not accurate.
+    _stats->chunkSizeDelta[chunkMin] += docSizeBytes;
+}
+
 Status ChunkManagerTargeter::targetUpdate(
     OperationContext* opCtx,
     const write_ops::UpdateOpEntry& updateDoc,
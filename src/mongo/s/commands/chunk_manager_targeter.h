@@ -80,6 +80,16 @@ public:
                         const BSONObj& doc,
                         ShardEndpoint** endpoint) const;
 
+    // Extracts the shard keys of all the documents first and resolves them against the routing
+    // table in one pass.
+    void targetInserts(OperationContext* opCtx,
+                       const std::vector<BSONObj>& docs,
+                       std::vector<StatusWith<ShardEndpoint>>* endpoints,
+                       std::vector<BSONObj>* chunkMins) const override;
+
+    // Tracks the autosplit stats of the chunk starting at 'chunkMin'.
+    void noteInsertAdded(const BSONObj& chunkMin, int docSizeBytes) const override;
+
     // Returns ShardKeyNotFound if the update can't be targeted without a shard key.
     Status targetUpdate(OperationContext* opCtx,
                         const write_ops::UpdateOpEntry& updateDoc,
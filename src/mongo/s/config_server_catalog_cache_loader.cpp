@@ -26,6 +26,8 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
 #include "mongo/platform/basic.h"
 
 #include "mongo/s/config_server_catalog_cache_loader.h"
@@ -33,8 +35,10 @@
 #include "mongo/db/client.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/s/catalog/sharding_catalog_client.h"
+#include "mongo/s/chunk_manager.h"
 #include "mongo/s/grid.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/log.h"
 
 namespace mongo {
 
@@ -132,7 +136,11 @@ CollectionAndChangedChunks getChangedChunks(OperationContext* opCtx,
 }  // namespace
 
 ConfigServerCatalogCacheLoader::ConfigServerCatalogCacheLoader()
-    : _threadPool(makeDefaultThreadPoolOptions()) {
+    : ConfigServerCatalogCacheLoader(nullptr) {}
+
+ConfigServerCatalogCacheLoader::ConfigServerCatalogCacheLoader(
+    std::unique_ptr<RoutingTableSnapshotStore> snapshotStore)
+    : _snapshotStore(std::move(snapshotStore)), _threadPool(makeDefaultThreadPoolOptions()) {
     _threadPool.startup();
 }
 
@@ -174,7 +182,7 @@ std::shared_ptr<Notification<void>> ConfigServerCatalogCacheLoader::getChunksSin
 
         auto swCollAndChunks = [&]() -> StatusWith<CollectionAndChangedChunks> {
             try {
-                return getChangedChunks(opCtx.get(), nss, version);
+                return _getChangedChunks(opCtx.get(), nss, version);
             } catch (const DBException& ex) {
                 return ex.toStatus();
             }
@@ -187,4 +195,112 @@ std::shared_ptr<Notification<void>> ConfigServerCatalogCacheLoader::getChunksSin
     return notify;
 }
 
+void ConfigServerCatalogCacheLoader::onRoutingTableRefreshed(
+    const NamespaceString& nss, const std::shared_ptr<ChunkManager>& routingInfo) {
+    if (!_snapshotStore) {
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_snapshotMutex);
+
+    // If a write is already scheduled or in progress for the collection, it will pick up this
+    // routing table once it is done
+    auto it = _pendingSnapshots.find(nss.ns());
+    if (it != _pendingSnapshots.end()) {
+        it->second = routingInfo;
+        return;
+    }
+
+    Status status = _threadPool.schedule([this, nss]() { _writePendingSnapshot(nss); });
+    if (!status.isOK()) {
+        warning() << "Failed to schedule the routing table snapshot update for " << nss
+                  << causedBy(redact(status));
+        return;
+    }
+
+    _pendingSnapshots.emplace(nss.ns(), routingInfo);
+}
+
+void ConfigServerCatalogCacheLoader::_writePendingSnapshot(const NamespaceString& nss) {
+    stdx::unique_lock<stdx::mutex> lk(_snapshotMutex);
+
+    while (true) {
+        auto it = _pendingSnapshots.find(nss.ns());
+        invariant(it != _pendingSnapshots.end());
+        const auto routingInfo = it->second;
+
+        lk.unlock();
+        const Status status =
+            routingInfo ? _snapshotStore->save(*routingInfo) : _snapshotStore->remove(nss);
+        if (!status.isOK()) {
+            warning() << "Failed to update the routing table snapshot for " << nss
+                      << causedBy(redact(status));
+        }
+        lk.lock();
+
+        it = _pendingSnapshots.find(nss.ns());
+        invariant(it != _pendingSnapshots.end());
+        if (it->second == routingInfo) {
+            _pendingSnapshots.erase(it);
+            return;
+        }
+    }
+}
+
+CollectionAndChangedChunks ConfigServerCatalogCacheLoader::_getChangedChunks(
+    OperationContext* opCtx, const NamespaceString& nss, ChunkVersion sinceVersion) {
+    if (!_snapshotStore || sinceVersion.isSet()) {
+        return getChangedChunks(opCtx, nss, sinceVersion);
+    }
+
+    auto swSnapshot = _snapshotStore->load(nss);
+    if (!swSnapshot.isOK()) {
+        if (swSnapshot != ErrorCodes::NamespaceNotFound) {
+            warning() << "Ignoring the routing table snapshot for " << nss
+                      << causedBy(redact(swSnapshot.getStatus()));
+        }
+        return getChangedChunks(opCtx, nss, sinceVersion);
+    }
+
+    auto& snapshot = swSnapshot.getValue();
+    const auto snapshotVersion = snapshot.changedChunks.back().getVersion();
+
+    // If the collection was dropped and recreated since the snapshot was taken, this is a full
+    // reload under the new epoch and the snapshot is of no use.
+    auto collAndChunks = getChangedChunks(opCtx, nss, snapshotVersion);
+    if (collAndChunks.epoch != snapshot.epoch) {
+        return collAndChunks;
+    }
+
+    LOG(1) << "Resuming the routing table for " << nss << " from its snapshot at version "
+           << snapshotVersion << ", with " << collAndChunks.changedChunks.size()
+           << " chunks changed since";
+
+    // The chunks in the snapshot all have versions no greater than those which changed since, so
+    // the combined list is still sorted. The routing table replaces any snapshot chunks which the
+    // changed chunks overlap.
+    collAndChunks.changedChunks.insert(collAndChunks.changedChunks.begin(),
+                                       std::make_move_iterator(snapshot.changedChunks.begin()),
+                                       std::make_move_iterator(snapshot.changedChunks.end()));
+
+    // A snapshot whose chunks do not fit together, for example because they leave a gap in the
+    // key space, would fail every routing table built from it until it is replaced. Make sure the
+    // resumed routing table can be built, and otherwise discard the snapshot and load in full.
+    try {
+        ChunkManager::makeNew(nss,
+                              KeyPattern(collAndChunks.shardKeyPattern),
+                              nullptr,
+                              collAndChunks.shardKeyIsUnique,
+                              collAndChunks.epoch,
+                              collAndChunks.changedChunks);
+    } catch (const DBException& ex) {
+        warning() << "Discarding the routing table snapshot for " << nss
+                  << " and loading it in full" << causedBy(redact(ex.toStatus()));
+        onRoutingTableRefreshed(nss, nullptr);
+        return getChangedChunks(opCtx, nss, sinceVersion);
+    }
+
+    return collAndChunks;
+}
+
 }  // namespace mongo
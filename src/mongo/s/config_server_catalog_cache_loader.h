@@ -28,7 +28,12 @@
 
 #pragma once
 
+#include <map>
+#include <string>
+
 #include "mongo/s/catalog_cache_loader.h"
+#include "mongo/s/routing_table_snapshot_store.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/thread_pool.h"
 
 namespace mongo {
@@ -36,6 +41,13 @@ namespace mongo {
 class ConfigServerCatalogCacheLoader final : public CatalogCacheLoader {
 public:
     ConfigServerCatalogCacheLoader();
+
+    /**
+     * Constructs a loader which persists the routing tables it refreshes to 'snapshotStore' and
+     * resumes from them. Only used by mongos.
+     */
+    explicit ConfigServerCatalogCacheLoader(
+        std::unique_ptr<RoutingTableSnapshotStore> snapshotStore);
     ~ConfigServerCatalogCacheLoader();
 
     /**
@@ -53,7 +65,42 @@ public:
         stdx::function<void(OperationContext*, StatusWith<CollectionAndChangedChunks>)> callbackFn)
         override;
 
+    /**
+     * Schedules the refreshed routing table to be saved to the snapshot store, if one is
+     * configured. Refreshes of a collection which arrive while its snapshot is being written are
+     * coalesced, so that only the latest routing table is written next.
+     */
+    void onRoutingTableRefreshed(const NamespaceString& nss,
+                                 const std::shared_ptr<ChunkManager>& routingInfo) override;
+
 private:
+    /**
+     * Blocking method, which returns the chunks which changed since the specified version. If
+     * there is no routing table for the collection yet, resumes from its persisted snapshot, if
+     * any, so that only the chunks which changed since the snapshot are read from the config
+     * server.
+     */
+    CollectionAndChangedChunks _getChangedChunks(OperationContext* opCtx,
+                                                 const NamespaceString& nss,
+                                                 ChunkVersion sinceVersion);
+
+    /**
+     * Blocking method, which writes the pending routing table of the specified collection to the
+     * snapshot store, repeating until no newer one has been queued in the meantime.
+     */
+    void _writePendingSnapshot(const NamespaceString& nss);
+
+    // Persisted copies of the routing tables, only set on mongos if 'routingTableSnapshotPath' is
+    // set
+    std::unique_ptr<RoutingTableSnapshotStore> _snapshotStore;
+
+    // Protects _pendingSnapshots
+    stdx::mutex _snapshotMutex;
+
+    // Latest routing table of each collection whose snapshot is scheduled or being written. A null
+    // routing table means the snapshot should be removed.
+    std::map<std::string, std::shared_ptr<ChunkManager>> _pendingSnapshots;
+
     // Thread pool to be used to perform metadata load
     ThreadPool _threadPool;
 };
@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/namespace_string.h"
@@ -88,6 +89,27 @@ public:
                                 const BSONObj& doc,
                                 ShardEndpoint** endpoint) const = 0;
 
+    /**
+     * Returns a ShardEndpoint for each of a batch of documents to insert, in the same order, or the
+     * status describing why the document could not be targeted. Gives the same result as calling
+     * targetInsert() for each document, but lets the targeter resolve the documents together.
+     *
+     * Unlike targetInsert(), does not account for the documents in the targeter's statistics,
+     * since the caller may not send all of them. Instead, 'chunkMins' receives, for each document,
+     * the min key of the chunk it was targeted at (empty if there is none), to be passed to
+     * noteInsertAdded() for the documents which actually get added to a batch.
+     */
+    virtual void targetInserts(OperationContext* opCtx,
+                               const std::vector<BSONObj>& docs,
+                               std::vector<StatusWith<ShardEndpoint>>* endpoints,
+                               std::vector<BSONObj>* chunkMins) const = 0;
+
+    /**
+     * Informs the targeter that a document, targeted through targetInserts() at the chunk starting
+     * at 'chunkMin', was added to a batch.
+     */
+    virtual void noteInsertAdded(const BSONObj& chunkMin, int docSizeBytes) const = 0;
+
     /**
      * Returns a vector of ShardEndpoints for a potentially multi-shard update.
      *
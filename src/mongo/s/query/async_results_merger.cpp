@@ -36,6 +36,8 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/s/client/shard_registry.h"
@@ -50,13 +52,23 @@ namespace {
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+// Maximum number of fields of a sort, under which the sort keys can be encoded as KeyStrings.
+const int kMaxEncodedSortKeyFields = 32;
+
+// When positive, a non-tailable ARM attached to an OperationContext asks a remote for its next
+// batch as soon as fewer than this many of the remote's results remain buffered, rather than once
+// they have all been returned. When zero, getMores are only issued from nextEvent().
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMergerPrefetchWatermark, int, 0);
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(executor::TaskExecutor* executor,
                                        ClusterClientCursorParams* params)
     : _executor(executor),
       _params(params),
-      _mergeQueue(MergingComparator(_remotes, _params->sort)) {
+      _useEncodedSortKeys(!_params->sort.isEmpty() &&
+                          _params->sort.nFields() <= kMaxEncodedSortKeyFields),
+      _sortKeyOrdering(Ordering::make(_useEncodedSortKeys ? _params->sort : BSONObj())) {
     size_t remoteIndex = 0;
     for (const auto& remote : _params->remotes) {
         _remotes.emplace_back(remote.hostAndPort, remote.cursorResponse.getCursorId());
@@ -85,6 +97,17 @@ bool AsyncResultsMerger::remotesExhausted() {
     return remotesExhausted_inlock();
 }
 
+void AsyncResultsMerger::reattachToOperationContext(OperationContext* opCtx) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(!_opCtx);
+    _opCtx = opCtx;
+}
+
+void AsyncResultsMerger::detachFromOperationContext() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _opCtx = nullptr;
+}
+
 bool AsyncResultsMerger::remotesExhausted_inlock() {
     for (const auto& remote : _remotes) {
         if (!remote.exhausted()) {
@@ -187,28 +210,104 @@ ClusterQueryResult AsyncResultsMerger::nextReadySorted() {
     // Tailable cursors cannot have a sort.
     invariant(!_params->isTailable);
 
-    if (_mergeQueue.empty()) {
+    if (_remotes.empty()) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
+    if (_mergeTreeNeedsRebuild) {
+        rebuildMergeTree();
+        _mergeTreeNeedsRebuild = false;
+    }
+
+    // Remotes without buffered results lose every match, so if the winner has none, then all the
+    // remotes are exhausted
+    if (!_remotes[_mergeTreeWinner].hasNext()) {
+        return {};
+    }
 
-    invariant(!_remotes[smallestRemote].docBuffer.empty());
-    invariant(_remotes[smallestRemote].status.isOK());
+    const size_t smallestRemote = _mergeTreeWinner;
+    auto& remote = _remotes[smallestRemote];
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    invariant(remote.status.isOK());
 
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
+    ClusterQueryResult front = remote.docBuffer.front();
+    remote.docBuffer.pop();
+    if (_useEncodedSortKeys) {
+        remote.encodedSortKeys.pop();
     }
 
+    // Let the next result from 'smallestRemote', if it has one, compete for the next spot.
+    replayMergeTree(smallestRemote);
+
+    prefetchIfBelowWatermark_inlock(smallestRemote);
+
     return front;
 }
 
+bool AsyncResultsMerger::remoteSortsBefore(size_t lhs, size_t rhs) const {
+    const auto& leftRemote = _remotes[lhs];
+    const auto& rightRemote = _remotes[rhs];
+
+    if (!leftRemote.hasNext() || !rightRemote.hasNext()) {
+        return leftRemote.hasNext() || (!rightRemote.hasNext() && lhs < rhs);
+    }
+
+    int cmp;
+    if (_useEncodedSortKeys) {
+        cmp = leftRemote.encodedSortKeys.front().compare(rightRemote.encodedSortKeys.front());
+    } else {
+        const ClusterQueryResult& leftDoc = leftRemote.docBuffer.front();
+        const ClusterQueryResult& rightDoc = rightRemote.docBuffer.front();
+
+        BSONObj leftDocKey = (*leftDoc.getResult())[ClusterClientCursorParams::kSortKeyField].Obj();
+        BSONObj rightDocKey =
+            (*rightDoc.getResult())[ClusterClientCursorParams::kSortKeyField].Obj();
+
+        // This does not need to sort with a collator, since mongod has already mapped strings to
+        // their ICU comparison keys as part of the $sortKey meta projection.
+        cmp = leftDocKey.woCompare(rightDocKey, _params->sort, false /*considerFieldName*/);
+    }
+
+    return cmp < 0 || (cmp == 0 && lhs < rhs);
+}
+
+void AsyncResultsMerger::rebuildMergeTree() {
+    const size_t numRemotes = _remotes.size();
+
+    // The remote, which won the match at each node, with the leaves being won by their own remote
+    std::vector<size_t> winners(2 * numRemotes);
+    for (size_t i = 0; i < numRemotes; ++i) {
+        winners[numRemotes + i] = i;
+    }
+
+    _mergeTreeLosers.assign(numRemotes, 0);
+    for (size_t node = numRemotes - 1; node > 0; --node) {
+        const size_t left = winners[2 * node];
+        const size_t right = winners[2 * node + 1];
+
+        if (remoteSortsBefore(right, left)) {
+            winners[node] = right;
+            _mergeTreeLosers[node] = left;
+        } else {
+            winners[node] = left;
+            _mergeTreeLosers[node] = right;
+        }
+    }
+
+    _mergeTreeWinner = (numRemotes > 1) ? winners[1] : 0;
+}
+
+void AsyncResultsMerger::replayMergeTree(size_t remoteIndex) {
+    size_t candidate = remoteIndex;
+    for (size_t node = (remoteIndex + _remotes.size()) / 2; node > 0; node /= 2) {
+        if (remoteSortsBefore(_mergeTreeLosers[node], candidate)) {
+            std::swap(_mergeTreeLosers[node], candidate);
+        }
+    }
+
+    _mergeTreeWinner = candidate;
+}
+
 ClusterQueryResult AsyncResultsMerger::nextReadyUnsorted() {
     size_t remotesAttempted = 0;
     while (remotesAttempted < _remotes.size()) {
@@ -226,6 +325,8 @@ ClusterQueryResult AsyncResultsMerger::nextReadyUnsorted() {
                 _eofNext = true;
             }
 
+            prefetchIfBelowWatermark_inlock(_gettingFromRemote);
+
             return front;
         }
 
@@ -279,6 +380,26 @@ Status AsyncResultsMerger::askForNextBatch_inlock(OperationContext* opCtx, size_
     return Status::OK();
 }
 
+void AsyncResultsMerger::prefetchIfBelowWatermark_inlock(size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+
+    // Batches received from remote tailable cursors are passed through to the client as they are
+    const int watermark = internalQueryMergerPrefetchWatermark.load();
+    if (watermark <= 0 || !_opCtx || _params->isTailable) {
+        return;
+    }
+
+    if (!remote.status.isOK() || remote.exhausted() || remote.cbHandle.isValid() ||
+        remote.docBuffer.size() >= static_cast<size_t>(watermark)) {
+        return;
+    }
+
+    // The response may arrive after the current operation has detached from this merger and its
+    // OperationContext has been destroyed, so the prefetch must not carry it. An error is reported
+    // by the next call to ready(), just like for a failed getMore.
+    remote.status = askForNextBatch_inlock(nullptr, remoteIndex);
+}
+
 /*
  * Note: When nextEvent() is called to do retries, only the remotes with retriable errors will
  * be rescheduled because:
@@ -410,7 +531,12 @@ void AsyncResultsMerger::handleBatchResponse(
             // Clear the results buffer and cursor id.
             std::queue<ClusterQueryResult> emptyBuffer;
             std::swap(remote.docBuffer, emptyBuffer);
+            std::queue<std::string> emptyEncodedSortKeys;
+            std::swap(remote.encodedSortKeys, emptyEncodedSortKeys);
             remote.cursorId = 0;
+
+            // The remote may have had results buffered if its next batch was prefetched
+            _mergeTreeNeedsRebuild = true;
         }
 
         return;
@@ -456,6 +582,13 @@ void AsyncResultsMerger::handleBatchResponse(
 
 bool AsyncResultsMerger::addBatchToBuffer(size_t remoteIndex, const std::vector<BSONObj>& batch) {
     auto& remote = _remotes[remoteIndex];
+
+    // A remote, which had buffered results already, keeps the same next result, so its position in
+    // the merge tree does not change
+    if (!_params->sort.isEmpty() && !batch.empty() && !remote.hasNext()) {
+        _mergeTreeNeedsRebuild = true;
+    }
+
     for (const auto& obj : batch) {
         // If there's a sort, we're expecting the remote node to have given us back a sort key.
         if (!_params->sort.isEmpty() &&
@@ -468,16 +601,18 @@ bool AsyncResultsMerger::addBatchToBuffer(size_t remoteIndex, const std::vector<
             return false;
         }
 
+        if (_useEncodedSortKeys) {
+            const KeyString encodedSortKey(KeyString::Version::V1,
+                                           obj[ClusterClientCursorParams::kSortKeyField].Obj(),
+                                           _sortKeyOrdering);
+            remote.encodedSortKeys.emplace(encodedSortKey.getBuffer(), encodedSortKey.getSize());
+        }
+
         ClusterQueryResult result(obj);
         remote.docBuffer.push(result);
         ++remote.fetchedCount;
     }
 
-    // If we're doing a sorted merge, then we have to make sure to put this remote onto the
-    // merge queue.
-    if (!_params->sort.isEmpty() && !batch.empty()) {
-        _mergeQueue.push(remoteIndex);
-    }
     return true;
 }
 
@@ -591,20 +726,4 @@ std::shared_ptr<Shard> AsyncResultsMerger::RemoteCursorData::getShard() {
     return grid.shardRegistry()->getShardNoReload(shardHostAndPort.toString());
 }
 
-//
-// AsyncResultsMerger::MergingComparator
-//
-
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
-    const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
-    const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
-
-    BSONObj leftDocKey = (*leftDoc.getResult())[ClusterClientCursorParams::kSortKeyField].Obj();
-    BSONObj rightDocKey = (*rightDoc.getResult())[ClusterClientCursorParams::kSortKeyField].Obj();
-
-    // This does not need to sort with a collator, since mongod has already mapped strings to their
-    // ICU comparison keys as part of the $sortKey meta projection.
-    return leftDocKey.woCompare(rightDocKey, _sort, false /*considerFieldName*/) > 0;
-}
-
 }  // namespace mongo
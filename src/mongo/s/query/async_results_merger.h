@@ -30,11 +30,13 @@
 
 #include <boost/optional.hpp>
 #include <queue>
+#include <string>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
@@ -66,6 +68,14 @@ class CursorResponse;
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
  *
+ * Sorted streams are merged through a tournament tree of the remotes, which compares the KeyString
+ * encodings of the documents' sort keys, so that each returned result costs a number of byte-wise
+ * comparisons logarithmic in the number of remotes.
+ *
+ * While attached to an OperationContext, the ARM may ask a remote for its next batch before the
+ * remote's buffered results have all been returned, so that the slowest remote does not hold up the
+ * merge once per batch. See internalQueryMergerPrefetchWatermark.
+ *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
  * Does not throw exceptions.
@@ -79,8 +89,8 @@ public:
      * the hosts on which they exist in _remotes.
      *
      * Additionally copies each remote's first batch of results, if one exists, into that remote's
-     * docBuffer. If a sort is specified in the ClusterClientCursorParams, places the remotes with
-     * buffered results onto _mergeQueue.
+     * docBuffer. If a sort is specified in the ClusterClientCursorParams, also encodes the sort
+     * keys of these results.
      *
      * The TaskExecutor* must remain valid for the lifetime of the ARM.
      */
@@ -97,6 +107,19 @@ public:
      */
     bool remotesExhausted();
 
+    /**
+     * Sets the OperationContext on behalf of which getMore requests are issued ahead of time, while
+     * results are returned through nextReady(). Without one the ARM only schedules remote work from
+     * nextEvent().
+     */
+    void reattachToOperationContext(OperationContext* opCtx);
+
+    /**
+     * Discards the OperationContext set through reattachToOperationContext(). Must be called before
+     * that OperationContext is destroyed.
+     */
+    void detachFromOperationContext();
+
     /**
      * Sets the maxTimeMS value that the ARM should forward with any internally issued getMore
      * requests.
@@ -214,6 +237,10 @@ private:
         // The buffer of results that have been retrieved but not yet returned to the caller.
         std::queue<ClusterQueryResult> docBuffer;
 
+        // The KeyString encodings of the sort keys of the results in 'docBuffer', in the same
+        // order. Used only if there is a sort, which the sort keys can be encoded under.
+        std::queue<std::string> encodedSortKeys;
+
         // Is valid if there is currently a pending request to this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
 
@@ -226,19 +253,6 @@ private:
         long long fetchedCount = 0;
     };
 
-    class MergingComparator {
-    public:
-        MergingComparator(const std::vector<RemoteCursorData>& remotes, const BSONObj& sort)
-            : _remotes(remotes), _sort(sort) {}
-
-        bool operator()(const size_t& lhs, const size_t& rhs);
-
-    private:
-        const std::vector<RemoteCursorData>& _remotes;
-
-        const BSONObj& _sort;
-    };
-
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
 
     /**
@@ -285,6 +299,31 @@ private:
     ClusterQueryResult nextReadySorted();
     ClusterQueryResult nextReadyUnsorted();
 
+    /**
+     * Returns true if the next buffered result of the remote at 'lhs' sorts before that of the
+     * remote at 'rhs'. A remote without buffered results sorts after every remote with some and
+     * ties are broken by the position of the remotes, so that the merge is deterministic.
+     */
+    bool remoteSortsBefore(size_t lhs, size_t rhs) const;
+
+    /**
+     * Plays all the matches of the merge tree from scratch.
+     */
+    void rebuildMergeTree();
+
+    /**
+     * Replays the matches on the path from the leaf of the remote at 'remoteIndex' to the root of
+     * the merge tree. Must only be called for the winner of the tree, after its next buffered
+     * result has changed.
+     */
+    void replayMergeTree(size_t remoteIndex);
+
+    /**
+     * Asks the remote at 'remoteIndex' for its next batch if fewer than the prefetch watermark of
+     * its results remain buffered and no request is outstanding for it already.
+     */
+    void prefetchIfBelowWatermark_inlock(size_t remoteIndex);
+
     /**
      * When nextEvent() schedules remote work, it passes this method as a callback. The TaskExecutor
      * will call this function, passing the response from the remote.
@@ -338,9 +377,26 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
-    // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    // The OperationContext set through reattachToOperationContext(), if any. Not owned here.
+    OperationContext* _opCtx = nullptr;
+
+    // Whether the sort keys of the results are compared through their KeyString encodings under
+    // '_sortKeyOrdering' rather than as BSON. Set if there is a sort with at most 32 fields.
+    const bool _useEncodedSortKeys;
+    const Ordering _sortKeyOrdering;
+
+    // Tournament tree over '_remotes', which is used to merge the results if there is a sort. The
+    // leaf of the remote at index i is node i + _remotes.size() and node n has children 2n and
+    // 2n + 1. Each internal node n in [1, _remotes.size()) holds in '_mergeTreeLosers[n]' the
+    // remote, which lost the match played there, while '_mergeTreeWinner' is the remote with the
+    // next document to return according to the sort order.
+    std::vector<size_t> _mergeTreeLosers;
+    size_t _mergeTreeWinner = 0;
+
+    // Set when a remote without buffered results receives some or loses its buffered results, which
+    // changes the outcome of matches off the winner's path. The tree is rebuilt before the next
+    // sorted result is returned.
+    bool _mergeTreeNeedsRebuild = true;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
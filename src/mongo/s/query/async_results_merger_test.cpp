@@ -36,6 +36,7 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/query_request.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/network_interface_mock.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/executor/thread_pool_task_executor_test_fixture.h"
@@ -44,6 +45,7 @@
 #include "mongo/s/sharding_test_fixture.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -597,6 +599,56 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortedMergeOfMixedNumericTypesBreaksTiesByRemote) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1}}");
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, {}));
+    cursors.emplace_back(kTestShardIds[1], kTestShardHosts[1], CursorResponse(_nss, 6, {}));
+    cursors.emplace_back(kTestShardIds[2], kTestShardHosts[2], CursorResponse(_nss, 7, {}));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent(nullptr));
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 'a', $sortKey: {'': 10}}"),
+                                   fromjson("{_id: 'b', $sortKey: {'': 7.5}}")};
+    responses.emplace_back(_nss, CursorId(5), batch1);
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 'c', $sortKey: {'': NumberLong(9)}}"),
+                                   fromjson("{_id: 'd', $sortKey: {'': 7}}"),
+                                   fromjson("{_id: 'e', $sortKey: {'': 3.0}}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    std::vector<BSONObj> batch3 = {fromjson("{_id: 'f', $sortKey: {'': 10.0}}"),
+                                   fromjson("{_id: 'g', $sortKey: {'': 2}}")};
+    responses.emplace_back(_nss, CursorId(0), batch3);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    // Equal sort keys of different numeric types are returned in the order of their remotes.
+    for (auto id : {"a", "f", "c", "b"}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_EQ(id, (*unittest::assertGet(arm->nextReady()).getResult())["_id"].String());
+    }
+
+    // The first remote has run out of buffered results, so the merge waits for its next batch.
+    ASSERT_FALSE(arm->ready());
+    readyEvent = unittest::assertGet(arm->nextEvent(nullptr));
+    responses.clear();
+    std::vector<BSONObj> batch4 = {fromjson("{_id: 'h', $sortKey: {'': 3}}")};
+    responses.emplace_back(_nss, CursorId(0), batch4);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    for (auto id : {"d", "h", "e", "g"}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_EQ(id, (*unittest::assertGet(arm->nextReady()).getResult())["_id"].String());
+    }
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
@@ -1212,6 +1264,110 @@ TEST_F(AsyncResultsMergerTest, GetMoreBatchSizes) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, PrefetchesNextBatchBelowWatermark) {
+    auto setWatermark = [](StringData value) {
+        auto param = ServerParameterSet::getGlobal()->getMap().find(
+            "internalQueryMergerPrefetchWatermark");
+        ASSERT_OK(param->second->setFromString(value.toString()));
+    };
+    setWatermark("2");
+    ON_BLOCK_EXIT([&] { setWatermark("0"); });
+
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 1, {}));
+    makeCursorFromExistingCursors(std::move(cursors));
+    arm->reattachToOperationContext(operationContext());
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent(nullptr));
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {
+        fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}")};
+    responses.emplace_back(_nss, CursorId(1), batch1);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+
+    // Returning the second result leaves fewer than two buffered, so the next batch is requested
+    // before the buffer drains.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+
+    auto request = GetMoreRequest::parseFromBSON("anydbname", getFirstPendingRequest().cmdObj);
+    ASSERT_OK(request.getStatus());
+    ASSERT_EQ(1LL, request.getValue().cursorid);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()).getResult());
+
+    responses.clear();
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 4}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 4}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+
+    arm->detachFromOperationContext();
+}
+
+TEST_F(AsyncResultsMergerTest, PrefetchResponseAfterDetachingFromOperationContext) {
+    auto setWatermark = [](StringData value) {
+        auto param = ServerParameterSet::getGlobal()->getMap().find(
+            "internalQueryMergerPrefetchWatermark");
+        ASSERT_OK(param->second->setFromString(value.toString()));
+    };
+    setWatermark("2");
+    ON_BLOCK_EXIT([&] { setWatermark("0"); });
+
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 1, {}));
+    makeCursorFromExistingCursors(std::move(cursors));
+    arm->reattachToOperationContext(operationContext());
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent(nullptr));
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1}")};
+    responses.emplace_back(_nss, CursorId(1), batch1);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+
+    // The prefetch does not carry the operation context, which is about to go away
+    ASSERT_FALSE(getFirstPendingRequest().opCtx);
+    arm->detachFromOperationContext();
+
+    // An empty batch makes the merger ask again while no operation context is attached
+    responses.clear();
+    responses.emplace_back(_nss, CursorId(1), std::vector<BSONObj>());
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    ASSERT_FALSE(getFirstPendingRequest().opCtx);
+
+    responses.clear();
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 2}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+
+    arm->reattachToOperationContext(operationContext());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+    arm->detachFromOperationContext();
+}
+
 TEST_F(AsyncResultsMergerTest, SendsSecondaryOkAsMetadata) {
     std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
     cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 1, {}));
@@ -72,4 +72,12 @@ Status RouterStageMerge::setAwaitDataTimeout(Milliseconds awaitDataTimeout) {
     return _arm.setAwaitDataTimeout(awaitDataTimeout);
 }
 
+void RouterStageMerge::doReattachToOperationContext() {
+    _arm.reattachToOperationContext(getOpCtx());
+}
+
+void RouterStageMerge::doDetachFromOperationContext() {
+    _arm.detachFromOperationContext();
+}
+
 }  // namespace mongo
@@ -53,6 +53,11 @@ public:
 
     Status setAwaitDataTimeout(Milliseconds awaitDataTimeout) final;
 
+protected:
+    void doReattachToOperationContext() final;
+
+    void doDetachFromOperationContext() final;
+
 private:
     // Not owned here.
     executor::TaskExecutor* _executor;
@@ -0,0 +1,342 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/routing_table_snapshot_store.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <vector>
+
+#include "mongo/base/data_view.h"
+#include "mongo/bson/bson_validate.h"
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/s/chunk_manager.h"
+#include "mongo/util/file.h"
+#include "mongo/util/hex.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+const char kNs[] = "ns";
+const char kEpoch[] = "epoch";
+const char kKeyPattern[] = "key";
+const char kDefaultCollation[] = "defaultCollation";
+const char kUnique[] = "unique";
+const char kNumChunks[] = "numChunks";
+
+/**
+ * Splits the contents of a snapshot file into the BSON objects it is made of. Fails if the data
+ * does not consist of a whole number of valid BSON objects.
+ */
+StatusWith<std::vector<BSONObj>> splitIntoObjects(const std::vector<char>& buffer,
+                                                  const std::string& path) {
+    std::vector<BSONObj> objs;
+
+    size_t offset = 0;
+    while (offset < buffer.size()) {
+        const size_t remaining = buffer.size() - offset;
+        if (remaining < sizeof(int32_t)) {
+            return {ErrorCodes::FailedToParse,
+                    str::stream() << "Routing table snapshot " << path << " is truncated"};
+        }
+
+        const int32_t objSize = ConstDataView(&buffer[offset]).read<LittleEndian<int32_t>>();
+        if (objSize < BSONObj::kMinBSONLength || static_cast<size_t>(objSize) > remaining) {
+            return {ErrorCodes::FailedToParse,
+                    str::stream() << "Routing table snapshot " << path
+                                  << " contains an object of invalid size "
+                                  << objSize
+                                  << " at offset "
+                                  << offset};
+        }
+
+        Status status = validateBSON(&buffer[offset], objSize, BSONVersion::kLatest);
+        if (!status.isOK()) {
+            return {status.code(),
+                    str::stream() << "Routing table snapshot " << path
+                                  << " contains invalid BSON at offset "
+                                  << offset
+                                  << causedBy(status)};
+        }
+
+        objs.push_back(BSONObj(&buffer[offset]).getOwned());
+        offset += objSize;
+    }
+
+    return objs;
+}
+
+}  // namespace
+
+RoutingTableSnapshotStore::RoutingTableSnapshotStore(std::string directory)
+    : _directory(std::move(directory)) {}
+
+StatusWith<CatalogCacheLoader::CollectionAndChangedChunks> RoutingTableSnapshotStore::load(
+    const NamespaceString& nss) const {
+    const std::string path = _getSnapshotPath(nss);
+
+    std::vector<char> buffer;
+    try {
+        if (!boost::filesystem::exists(path)) {
+            return {ErrorCodes::NamespaceNotFound,
+                    str::stream() << "No routing table snapshot for " << nss.ns()};
+        }
+
+        buffer.resize(boost::filesystem::file_size(path));
+
+        std::ifstream ifs(path.c_str(), std::ios_base::in | std::ios_base::binary);
+        if (!ifs) {
+            return {ErrorCodes::FileNotOpen,
+                    str::stream() << "Failed to open routing table snapshot " << path};
+        }
+
+        ifs.read(buffer.data(), buffer.size());
+        if (!ifs) {
+            return {ErrorCodes::FileStreamFailed,
+                    str::stream() << "Unable to read routing table snapshot " << path};
+        }
+    } catch (const std::exception& ex) {
+        return {ErrorCodes::FileStreamFailed,
+                str::stream() << "Unexpected error reading routing table snapshot " << path << ": "
+                              << ex.what()};
+    }
+
+    auto swObjs = splitIntoObjects(buffer, path);
+    if (!swObjs.isOK()) {
+        return swObjs.getStatus();
+    }
+
+    const auto& objs = swObjs.getValue();
+    if (objs.empty()) {
+        return {ErrorCodes::FailedToParse,
+                str::stream() << "Routing table snapshot " << path << " is empty"};
+    }
+
+    const BSONObj& header = objs.front();
+
+    std::string ns;
+    Status status = bsonExtractStringField(header, kNs, &ns);
+    if (status.isOK() && ns != nss.ns()) {
+        status = {ErrorCodes::FailedToParse,
+                  str::stream() << "Routing table snapshot " << path << " belongs to " << ns};
+    }
+
+    OID epoch;
+    if (status.isOK()) {
+        status = bsonExtractOIDField(header, kEpoch, &epoch);
+    }
+
+    BSONElement keyPatternElem;
+    if (status.isOK()) {
+        status = bsonExtractTypedField(header, kKeyPattern, Object, &keyPatternElem);
+    }
+
+    BSONElement defaultCollationElem;
+    if (status.isOK()) {
+        status = bsonExtractTypedField(header, kDefaultCollation, Object, &defaultCollationElem);
+    }
+
+    bool unique = false;
+    if (status.isOK()) {
+        status = bsonExtractBooleanField(header, kUnique, &unique);
+    }
+
+    long long numChunks = 0;
+    if (status.isOK()) {
+        status = bsonExtractIntegerField(header, kNumChunks, &numChunks);
+    }
+
+    if (!status.isOK()) {
+        return {status.code(),
+                str::stream() << "Routing table snapshot " << path << " has an invalid header"
+                              << causedBy(status)};
+    }
+
+    if (numChunks <= 0 || static_cast<size_t>(numChunks) != objs.size() - 1) {
+        return {ErrorCodes::FailedToParse,
+                str::stream() << "Routing table snapshot " << path << " should contain "
+                              << numChunks
+                              << " chunks, but contains "
+                              << objs.size() - 1};
+    }
+
+    std::vector<ChunkType> chunks;
+    chunks.reserve(numChunks);
+
+    for (auto it = std::next(objs.begin()); it != objs.end(); ++it) {
+        auto swChunk = ChunkType::fromConfigBSON(*it);
+        if (!swChunk.isOK()) {
+            return swChunk.getStatus();
+        }
+
+        auto& chunk = swChunk.getValue();
+        const auto& version = chunk.getVersion();
+
+        // A snapshot which does not satisfy the invariants of the routing table must be ignored
+        // rather than retried, since loading it again would fail the same way.
+        if (version.epoch() != epoch ||
+            (!chunks.empty() && version < chunks.back().getVersion())) {
+            return {ErrorCodes::FailedToParse,
+                    str::stream() << "Routing table snapshot " << path
+                                  << " contains out of order chunk "
+                                  << it->toString()};
+        }
+
+        chunks.push_back(std::move(chunk));
+    }
+
+    return CatalogCacheLoader::CollectionAndChangedChunks{epoch,
+                                                          keyPatternElem.Obj().getOwned(),
+                                                          defaultCollationElem.Obj().getOwned(),
+                                                          unique,
+                                                          std::move(chunks)};
+}
+
+Status RoutingTableSnapshotStore::save(const ChunkManager& routingInfo) {
+    const auto& nss = routingInfo.getns();
+
+    std::vector<ChunkType> chunks;
+    chunks.reserve(routingInfo.numChunks());
+    for (const auto& chunk : routingInfo.chunks()) {
+        chunks.emplace_back(NamespaceString(nss),
+                            ChunkRange(chunk->getMin(), chunk->getMax()),
+                            chunk->getLastmod(),
+                            chunk->getShardId());
+    }
+
+    std::stable_sort(chunks.begin(), chunks.end(), [](const ChunkType& a, const ChunkType& b) {
+        return a.getVersion() < b.getVersion();
+    });
+
+    const BSONObj header =
+        BSON(kNs << nss << kEpoch << routingInfo.getVersion().epoch() << kKeyPattern
+                 << routingInfo.getShardKeyPattern().toBSON()
+                 << kDefaultCollation
+                 << (routingInfo.getDefaultCollator()
+                         ? routingInfo.getDefaultCollator()->getSpec().toBSON()
+                         : BSONObj())
+                 << kUnique
+                 << routingInfo.isUnique()
+                 << kNumChunks
+                 << static_cast<long long>(chunks.size()));
+
+    const std::string path = _getSnapshotPath(NamespaceString(nss));
+    const std::string tempPath = path + ".tmp";
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(_directory, ec);
+    if (ec) {
+        return {ErrorCodes::FileNotOpen,
+                str::stream() << "Failed to create routing table snapshot directory " << _directory
+                              << ": "
+                              << ec.message()};
+    }
+
+    {
+        BufBuilder contents;
+        contents.appendBuf(header.objdata(), header.objsize());
+        for (const auto& chunk : chunks) {
+            const BSONObj obj = chunk.toConfigBSON();
+            contents.appendBuf(obj.objdata(), obj.objsize());
+        }
+
+        File file;
+        file.open(tempPath.c_str());
+        if (file.bad()) {
+            return {ErrorCodes::FileNotOpen,
+                    str::stream() << "Failed to open routing table snapshot " << tempPath};
+        }
+
+        file.truncate(0);
+        if (!file.bad()) {
+            file.write(0, contents.buf(), contents.len());
+        }
+
+        // The contents must be on disk before the rename is, or a crash could leave a truncated
+        // snapshot in place of the previous one.
+        if (!file.bad()) {
+            file.fsync();
+        }
+
+        if (file.bad()) {
+            return {ErrorCodes::OperationFailed,
+                    str::stream() << "Failed to write routing table snapshot to " << tempPath};
+        }
+    }
+
+    try {
+        boost::filesystem::rename(tempPath, path);
+    } catch (const std::exception& ex) {
+        return {ErrorCodes::FileRenameFailed,
+                str::stream() << "Unexpected error while renaming routing table snapshot "
+                              << tempPath
+                              << " to "
+                              << path
+                              << ": "
+                              << ex.what()};
+    }
+
+    return Status::OK();
+}
+
+Status RoutingTableSnapshotStore::remove(const NamespaceString& nss) {
+    const std::string path = _getSnapshotPath(nss);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    boost::system::error_code ec;
+    boost::filesystem::remove(path, ec);
+    if (ec) {
+        return {ErrorCodes::OperationFailed,
+                str::stream() << "Failed to remove routing table snapshot " << path << ": "
+                              << ec.message()};
+    }
+
+    return Status::OK();
+}
+
+std::string RoutingTableSnapshotStore::_getSnapshotPath(const NamespaceString& nss) const {
+    // Collection names may contain characters which are not valid in file names, so the file is
+    // named after the hex encoding of the namespace instead
+    const auto& ns = nss.ns();
+    return (boost::filesystem::path(_directory) / (toHexLower(ns.c_str(), ns.size()) + ".bson"))
+        .string();
+}
+
+}  // namespace mongo
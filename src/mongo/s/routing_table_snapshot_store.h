@@ -0,0 +1,86 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/s/catalog_cache_loader.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class ChunkManager;
+class NamespaceString;
+
+/**
+ * Keeps a copy of the routing table of each sharded collection in a local directory, so that a
+ * router which restarts or has its routing information flushed can resume from the last routing
+ * table it saw and only request from the config server the chunks which changed since then.
+ *
+ * Each collection is stored in its own file as a sequence of BSON objects: a header describing the
+ * collection, followed by its chunks in ascending version order. Files are written under a
+ * temporary name and renamed into place, so a reader never observes a partially written snapshot.
+ */
+class RoutingTableSnapshotStore {
+    MONGO_DISALLOW_COPYING(RoutingTableSnapshotStore);
+
+public:
+    explicit RoutingTableSnapshotStore(std::string directory);
+
+    /**
+     * Returns the persisted routing table for 'nss', with its chunks sorted by ascending version.
+     * Returns NamespaceNotFound if there is no snapshot for the collection, or another error if
+     * the snapshot could not be read or is not internally consistent.
+     */
+    StatusWith<CatalogCacheLoader::CollectionAndChangedChunks> load(
+        const NamespaceString& nss) const;
+
+    /**
+     * Replaces the snapshot for the collection of 'routingInfo' with its current contents.
+     */
+    Status save(const ChunkManager& routingInfo);
+
+    /**
+     * Removes the snapshot for 'nss', if there is one.
+     */
+    Status remove(const NamespaceString& nss);
+
+private:
+    std::string _getSnapshotPath(const NamespaceString& nss) const;
+
+    const std::string _directory;
+
+    // Serializes writers, which all go through the same temporary file name for a collection
+    stdx::mutex _mutex;
+};
+
+}  // namespace mongo
@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem.hpp>
+
+#include "mongo/s/chunk_manager.h"
+#include "mongo/s/routing_table_snapshot_store.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("TestDB", "TestColl");
+const KeyPattern kShardKeyPattern(BSON("a" << 1));
+
+/**
+ * Makes a routing table of three chunks, whose versions are not in the same order as their ranges.
+ */
+std::shared_ptr<ChunkManager> makeChunkManager(const OID& epoch) {
+    const std::vector<ChunkType> chunks{
+        ChunkType(kNss,
+                  {kShardKeyPattern.globalMin(), BSON("a" << 0)},
+                  ChunkVersion(1, 0, epoch),
+                  ShardId("0")),
+        ChunkType(kNss,
+                  {BSON("a" << 100), kShardKeyPattern.globalMax()},
+                  ChunkVersion(1, 1, epoch),
+                  ShardId("1")),
+        ChunkType(
+            kNss, {BSON("a" << 0), BSON("a" << 100)}, ChunkVersion(2, 0, epoch), ShardId("1"))};
+
+    return ChunkManager::makeNew(kNss, kShardKeyPattern, nullptr, true, epoch, chunks);
+}
+
+/**
+ * Returns the path of the only file in 'directory'.
+ */
+boost::filesystem::path onlyFileIn(const std::string& directory) {
+    std::vector<boost::filesystem::path> files(
+        boost::filesystem::directory_iterator{directory}, boost::filesystem::directory_iterator{});
+    ASSERT_EQ(1U, files.size());
+    return files.front();
+}
+
+TEST(RoutingTableSnapshotStore, SavedRoutingTableLoadsInVersionOrder) {
+    unittest::TempDir tempDir("routing_table_snapshot_store_test");
+    RoutingTableSnapshotStore store(tempDir.path());
+
+    const OID epoch = OID::gen();
+    ASSERT_OK(store.save(*makeChunkManager(epoch)));
+
+    const auto snapshot = unittest::assertGet(store.load(kNss));
+    ASSERT_EQ(epoch, snapshot.epoch);
+    ASSERT_BSONOBJ_EQ(kShardKeyPattern.toBSON(), snapshot.shardKeyPattern);
+    ASSERT_BSONOBJ_EQ(BSONObj(), snapshot.defaultCollation);
+    ASSERT(snapshot.shardKeyIsUnique);
+
+    ASSERT_EQ(3U, snapshot.changedChunks.size());
+    ASSERT_EQ(ChunkVersion(1, 0, epoch), snapshot.changedChunks[0].getVersion());
+    ASSERT_EQ(ChunkVersion(1, 1, epoch), snapshot.changedChunks[1].getVersion());
+    ASSERT_EQ(ChunkVersion(2, 0, epoch), snapshot.changedChunks[2].getVersion());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 0), snapshot.changedChunks[2].getMin());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 100), snapshot.changedChunks[2].getMax());
+    ASSERT_EQ(ShardId("1"), snapshot.changedChunks[2].getShard());
+
+    // The snapshot rebuilds the routing table it was taken from
+    const auto rebuilt = ChunkManager::makeNew(
+        kNss, kShardKeyPattern, nullptr, true, snapshot.epoch, snapshot.changedChunks);
+    ASSERT_EQ(ChunkVersion(2, 0, epoch), rebuilt->getVersion());
+    ASSERT_EQ(3, rebuilt->numChunks());
+}
+
+TEST(RoutingTableSnapshotStore, SaveReplacesPreviousSnapshot) {
+    unittest::TempDir tempDir("routing_table_snapshot_store_test");
+    RoutingTableSnapshotStore store(tempDir.path());
+
+    ASSERT_OK(store.save(*makeChunkManager(OID::gen())));
+
+    const OID epoch = OID::gen();
+    ASSERT_OK(store.save(*makeChunkManager(epoch)));
+
+    const auto snapshot = unittest::assertGet(store.load(kNss));
+    ASSERT_EQ(epoch, snapshot.epoch);
+    ASSERT_EQ(3U, snapshot.changedChunks.size());
+}
+
+TEST(RoutingTableSnapshotStore, MissingAndRemovedSnapshotsAreNotFound) {
+    unittest::TempDir tempDir("routing_table_snapshot_store_test");
+    RoutingTableSnapshotStore store(tempDir.path());
+
+    ASSERT_EQ(ErrorCodes::NamespaceNotFound, store.load(kNss).getStatus());
+
+    ASSERT_OK(store.save(*makeChunkManager(OID::gen())));
+    ASSERT_OK(store.remove(kNss));
+    ASSERT_EQ(ErrorCodes::NamespaceNotFound, store.load(kNss).getStatus());
+
+    // Removing a snapshot which does not exist is not an error
+    ASSERT_OK(store.remove(kNss));
+}
+
+TEST(RoutingTableSnapshotStore, TruncatedSnapshotIsRejected) {
+    unittest::TempDir tempDir("routing_table_snapshot_store_test");
+    RoutingTableSnapshotStore store(tempDir.path());
+
+    ASSERT_OK(store.save(*makeChunkManager(OID::gen())));
+
+    const auto path = onlyFileIn(tempDir.path());
+    boost::filesystem::resize_file(path, boost::filesystem::file_size(path) - 10);
+
+    const auto status = store.load(kNss).getStatus();
+    ASSERT_NOT_OK(status);
+    ASSERT_NE(ErrorCodes::NamespaceNotFound, status.code());
+}
+
+}  // namespace
+}  // namespace mongo
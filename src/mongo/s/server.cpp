@@ -61,6 +61,7 @@
 #include "mongo/db/logical_time_validator.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/db/session_killer.h"
@@ -131,6 +132,11 @@ boost::optional<ShardingUptimeReporter> shardingUptimeReporter;
 
 static constexpr auto kRetryInterval = Seconds{1};
 
+// Directory in which the routing table of each sharded collection is persisted, so that it does not
+// have to be read in full from the config server after a restart or a flushRouterConfig. Disabled
+// if empty.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(routingTableSnapshotPath, std::string, "");
+
 Status waitForSigningKeys(OperationContext* opCtx) {
     while (true) {
         // this should be true when shard registry is up
@@ -255,8 +261,14 @@ static Status initializeSharding(OperationContext* opCtx) {
     auto shardFactory =
         stdx::make_unique<ShardFactory>(std::move(buildersMap), std::move(targeterFactory));
 
-    CatalogCacheLoader::set(opCtx->getServiceContext(),
-                            stdx::make_unique<ConfigServerCatalogCacheLoader>());
+    std::unique_ptr<RoutingTableSnapshotStore> snapshotStore;
+    if (!routingTableSnapshotPath.empty()) {
+        snapshotStore = stdx::make_unique<RoutingTableSnapshotStore>(routingTableSnapshotPath);
+    }
+
+    CatalogCacheLoader::set(
+        opCtx->getServiceContext(),
+        stdx::make_unique<ConfigServerCatalogCacheLoader>(std::move(snapshotStore)));
 
     Status status = initializeGlobalShardingState(
         opCtx,
@@ -226,5 +226,82 @@ StatusWith<boost::optional<ChunkRange>> splitChunkAtMultiplePoints(
     return boost::optional<ChunkRange>();
 }
 
+StatusWith<long long> retrieveChunkDataSize(OperationContext* opCtx,
+                                            const ShardId& shardId,
+                                            const NamespaceString& nss,
+                                            const ShardKeyPattern& shardKeyPattern,
+                                            const ChunkRange& chunkRange,
+                                            long long maxSizeBytes) {
+    BSONObjBuilder cmd;
+    cmd.append("dataSize", nss.ns());
+    cmd.append("keyPattern", shardKeyPattern.toBSON());
+    chunkRange.append(&cmd);
+    cmd.append("estimate", true);
+    cmd.append("maxSize", maxSizeBytes);
+
+    auto shardStatus = Grid::get(opCtx)->shardRegistry()->getShard(opCtx, shardId);
+    if (!shardStatus.isOK()) {
+        return shardStatus.getStatus();
+    }
+
+    auto cmdStatus = shardStatus.getValue()->runCommandWithFixedRetryAttempts(
+        opCtx,
+        ReadPreferenceSetting{ReadPreference::PrimaryOnly},
+        nss.db().toString(),
+        cmd.obj(),
+        Shard::RetryPolicy::kIdempotent);
+    if (!cmdStatus.isOK()) {
+        return std::move(cmdStatus.getStatus());
+    }
+    if (!cmdStatus.getValue().commandStatus.isOK()) {
+        return std::move(cmdStatus.getValue().commandStatus);
+    }
+
+    BSONElement sizeElem = cmdStatus.getValue().response["size"];
+    if (!sizeElem.isNumber()) {
+        return {ErrorCodes::NoSuchKey, "size field not found in dataSize"};
+    }
+
+    return sizeElem.numberLong();
+}
+
+Status mergeChunks(OperationContext* opCtx,
+                   const ShardId& shardId,
+                   const NamespaceString& nss,
+                   ChunkVersion collectionVersion,
+                   const ChunkRange& chunkRange) {
+    BSONObjBuilder cmd;
+    cmd.append("mergeChunks", nss.ns());
+    {
+        BSONArrayBuilder bounds(cmd.subarrayStart("bounds"));
+        bounds.append(chunkRange.getMin());
+        bounds.append(chunkRange.getMax());
+    }
+    cmd.append("epoch", collectionVersion.epoch());
+
+    BSONObj cmdObj = cmd.obj();
+
+    auto shardStatus = Grid::get(opCtx)->shardRegistry()->getShard(opCtx, shardId);
+    if (!shardStatus.isOK()) {
+        return shardStatus.getStatus();
+    }
+
+    auto cmdStatus = shardStatus.getValue()->runCommandWithFixedRetryAttempts(
+        opCtx,
+        ReadPreferenceSetting{ReadPreference::PrimaryOnly},
+        "admin",
+        cmdObj,
+        Shard::RetryPolicy::kNotIdempotent);
+
+    Status status = cmdStatus.isOK() ? std::move(cmdStatus.getValue().commandStatus)
+                                     : std::move(cmdStatus.getStatus());
+    if (!status.isOK()) {
+        log() << "Merge chunks " << redact(cmdObj) << " failed" << causedBy(redact(status));
+        return {status.code(), str::stream() << "merge failed due to " << status.toString()};
+    }
+
+    return Status::OK();
+}
+
 }  // namespace shardutil
 }  // namespace mongo
@@ -100,5 +100,37 @@ StatusWith<boost::optional<ChunkRange>> splitChunkAtMultiplePoints(
     const ChunkRange& chunkRange,
     const std::vector<BSONObj>& splitPoints);
 
+/**
+ * Asks the specified shard for an estimate of the amount of data in bytes, which falls within the
+ * specified chunk range. The shard stops counting once 'maxSizeBytes' is exceeded, in which case
+ * the returned size is only a lower bound.
+ *
+ * Returns OK with the size or an error. Known errors are:
+ *  ShardNotFound if shard by that id is not available on the registry
+ *  NoSuchKey if the size could not be retrieved
+ */
+StatusWith<long long> retrieveChunkDataSize(OperationContext* opCtx,
+                                            const ShardId& shardId,
+                                            const NamespaceString& nss,
+                                            const ShardKeyPattern& shardKeyPattern,
+                                            const ChunkRange& chunkRange,
+                                            long long maxSizeBytes);
+
+/**
+ * Asks the specified shard to merge all of its chunks, which fall within the specified range, into
+ * a single chunk. The range must start at the lower bound of a chunk and end at the upper bound of
+ * a chunk, and must not contain any chunks owned by another shard.
+ *
+ * shardId The shard, which currently owns the chunks.
+ * nss Namespace, which owns the chunks.
+ * collectionVersion The expected collection version when doing the merge.
+ * chunkRange Bounds of the chunks to be merged.
+ */
+Status mergeChunks(OperationContext* opCtx,
+                   const ShardId& shardId,
+                   const NamespaceString& nss,
+                   ChunkVersion collectionVersion,
+                   const ChunkRange& chunkRange);
+
 }  // namespace shardutil
 }  // namespace mongo
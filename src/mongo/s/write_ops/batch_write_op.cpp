@@ -68,6 +68,11 @@ struct WriteErrorDetailComp {
 const int kEstUpdateOverheadBytes = (BSONObjMaxInternalSize - BSONObjMaxUserSize) / 100;
 const int kEstDeleteOverheadBytes = (BSONObjMaxInternalSize - BSONObjMaxUserSize) / 100;
 
+// The number of inserts of an ordered batch which are first targeted together. An ordered batch
+// stops at the first insert which goes to another shard, so the inserts are targeted in windows,
+// which double in size every time one is used up.
+const size_t kOrderedInsertTargetingWindow = 16;
+
 /**
  * Returns a new write concern that has the copy of every field from the original
  * document but with a w set to 1. This is intended for upgrading { w: 0 } write
@@ -272,6 +277,16 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
 
     const size_t numWriteOps = _clientRequest.sizeWriteOps();
 
+    // Inserts are targeted in bulk, for a window of the ready write ops at a time. The endpoints
+    // are consumed in order as the loop below reaches the write ops of the window.
+    const bool targetInsertsInBulk =
+        _clientRequest.getBatchType() == BatchedCommandRequest::BatchType_Insert &&
+        !_clientRequest.isInsertIndexRequest();
+    size_t insertWindowSize = ordered ? kOrderedInsertTargetingWindow : numWriteOps;
+    std::vector<StatusWith<ShardEndpoint>> insertEndpoints;
+    std::vector<BSONObj> insertChunkMins;
+    size_t nextInsertEndpoint = 0;
+
     for (size_t i = 0; i < numWriteOps; ++i) {
         WriteOp& writeOp = _writeOps[i];
 
@@ -287,7 +302,31 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
         OwnedPointerVector<TargetedWrite> writesOwned;
         vector<TargetedWrite*>& writes = writesOwned.mutableVector();
 
-        Status targetStatus = writeOp.targetWrites(_opCtx, targeter, &writes);
+        Status targetStatus = Status::OK();
+        if (targetInsertsInBulk) {
+            if (nextInsertEndpoint == insertEndpoints.size()) {
+                std::vector<BSONObj> docs;
+                for (size_t j = i; j < numWriteOps && docs.size() < insertWindowSize; ++j) {
+                    if (_writeOps[j].getWriteState() == WriteOpState_Ready)
+                        docs.push_back(_writeOps[j].getWriteItem().getDocument());
+                }
+
+                targeter.targetInserts(_opCtx, docs, &insertEndpoints, &insertChunkMins);
+                invariant(insertEndpoints.size() == docs.size());
+                invariant(insertChunkMins.size() == docs.size());
+                nextInsertEndpoint = 0;
+                insertWindowSize *= 2;
+            }
+
+            const auto& swEndpoint = insertEndpoints[nextInsertEndpoint++];
+            if (swEndpoint.isOK()) {
+                writeOp.targetInsert(swEndpoint.getValue(), &writes);
+            } else {
+                targetStatus = swEndpoint.getStatus();
+            }
+        } else {
+            targetStatus = writeOp.targetWrites(_opCtx, targeter, &writes);
+        }
 
         if (!targetStatus.isOK()) {
             WriteErrorDetail targetError;
@@ -369,6 +408,13 @@ Status BatchWriteOp::targetBatch(const NSTargeter& targeter,
         // Relinquish ownership of TargetedWrites, now the TargetedBatches own them
         writesOwned.mutableVector().clear();
 
+        // Only the inserts which made it into a batch count towards the autosplit stats, since the
+        // rest of the targeting window is targeted again in the next round
+        if (targetInsertsInBulk) {
+            targeter.noteInsertAdded(insertChunkMins[nextInsertEndpoint - 1],
+                                     writeOp.getWriteItem().getDocument().objsize());
+        }
+
         //
         // Break if we're ordered and we have more than one endpoint - later writes cannot be
         // enforced as ordered across multiple shard endpoints.
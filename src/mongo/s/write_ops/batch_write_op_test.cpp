@@ -468,6 +468,60 @@ TEST_F(BatchWriteOpTest, MultiOpTwoShardsOrdered) {
     ASSERT_EQUALS(clientResponse.getN(), 2);
 }
 
+// Ordered multi-op targeting test with runs of inserts to each shard which span several of the
+// windows the inserts are targeted in. Each run should be sent as a single batch.
+TEST_F(BatchWriteOpTest, ManyOpsTwoShardsOrdered) {
+    NamespaceString nss("foo.bar");
+    ShardEndpoint endpointA(ShardId("shardA"), ChunkVersion::IGNORED());
+    ShardEndpoint endpointB(ShardId("shardB"), ChunkVersion::IGNORED());
+    MockNSTargeter targeter;
+    initTargeterSplitRange(nss, endpointA, endpointB, &targeter);
+
+    std::vector<BSONObj> docs;
+    for (int i = 0; i < 40; i++) {
+        docs.push_back(BSON("x" << -1 - i));
+    }
+    for (int i = 0; i < 40; i++) {
+        docs.push_back(BSON("x" << 1 + i));
+    }
+    for (int i = 0; i < 5; i++) {
+        docs.push_back(BSON("x" << -1 - i));
+    }
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setDocuments(docs);
+        return insertOp;
+    }());
+
+    BatchWriteOp batchOp(operationContext(), request);
+
+    const std::vector<std::pair<ShardEndpoint, size_t>> expectedBatches{
+        {endpointA, 40u}, {endpointB, 40u}, {endpointA, 5u}};
+
+    for (const auto& expectedBatch : expectedBatches) {
+        ASSERT(!batchOp.isFinished());
+
+        OwnedPointerMap<ShardId, TargetedWriteBatch> targetedOwned;
+        std::map<ShardId, TargetedWriteBatch*>& targeted = targetedOwned.mutableMap();
+        ASSERT_OK(batchOp.targetBatch(targeter, false, &targeted));
+        ASSERT_EQUALS(targeted.size(), 1u);
+        ASSERT_EQUALS(targeted.begin()->second->getWrites().size(), expectedBatch.second);
+        assertEndpointsEqual(targeted.begin()->second->getEndpoint(), expectedBatch.first);
+
+        BatchedCommandResponse response;
+        buildResponse(expectedBatch.second, &response);
+        batchOp.noteBatchResponse(*targeted.begin()->second, response, NULL);
+    }
+
+    ASSERT(batchOp.isFinished());
+
+    BatchedCommandResponse clientResponse;
+    batchOp.buildClientResponse(&clientResponse);
+    ASSERT(clientResponse.getOk());
+    ASSERT_EQUALS(clientResponse.getN(), 85);
+}
+
 void verifyTargetedBatches(std::map<ShardId, size_t> expected,
                            const std::map<ShardId, TargetedWriteBatch*>& targeted) {
     // 'expected' contains each ShardId that was expected to be targeted and the size of the batch
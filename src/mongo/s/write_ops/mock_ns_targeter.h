@@ -98,6 +98,32 @@ public:
         return Status::OK();
     }
 
+    /**
+     * Returns a ShardEndpoint for each doc from the mock ranges
+     */
+    void targetInserts(OperationContext* opCtx,
+                       const std::vector<BSONObj>& docs,
+                       std::vector<StatusWith<ShardEndpoint>>* endpoints,
+                       std::vector<BSONObj>* chunkMins) const override {
+        endpoints->clear();
+        chunkMins->assign(docs.size(), BSONObj());
+        for (const auto& doc : docs) {
+            ShardEndpoint* endpoint = nullptr;
+            Status status = targetInsert(opCtx, doc, &endpoint);
+            if (!status.isOK()) {
+                endpoints->push_back(status);
+                continue;
+            }
+
+            ASSERT(endpoint);
+            endpoints->push_back(*std::unique_ptr<ShardEndpoint>(endpoint));
+        }
+    }
+
+    void noteInsertAdded(const BSONObj& chunkMin, int docSizeBytes) const override {
+        // No-op
+    }
+
     /**
      * Returns the first ShardEndpoint for the query from the mock ranges.  Only can handle
      * queries of the form { field : { $gte : <value>, $lt : <value> } }.
@@ -121,6 +121,12 @@ public:
                         const NSTargeter& targeter,
                         std::vector<TargetedWrite*>* targetedWrites);
 
+    /**
+     * Same as targetWrites, but for an insert which was already targeted at 'endpoint', through
+     * NSTargeter::targetInserts.
+     */
+    void targetInsert(const ShardEndpoint& endpoint, std::vector<TargetedWrite*>* targetedWrites);
+
     /**
      * Returns the number of child writes that were last targeted.
      */
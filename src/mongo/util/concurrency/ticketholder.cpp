@@ -47,6 +47,20 @@ void _check(int ret) {
     severe() << "error in Ticketholder: " << errnoWithDescription(err);
     fassertFailed(28604);
 }
+
+/**
+ * Decrements 'counter' if it is positive. Returns whether it was decremented.
+ */
+bool _tryDecrement(AtomicInt32* counter) {
+    int value = counter->load();
+    while (value > 0) {
+        const int previous = counter->compareAndSwap(value, value - 1);
+        if (previous == value)
+            return true;
+        value = previous;
+    }
+    return false;
+}
 }
 
 TicketHolder::TicketHolder(int num) : _outof(num) {
@@ -91,6 +105,8 @@ bool TicketHolder::waitForTicketUntil(Date_t until) {
 }
 
 void TicketHolder::release() {
+    if (_tryDecrement(&_pendingRetirements))
+        return;
     _check(sem_post(&_sem));
 }
 
@@ -108,12 +124,16 @@ Status TicketHolder::resize(int newSize) {
                                     << newSize);
 
     while (_outof.load() < newSize) {
-        release();
+        // Keep a ticket in use rather than retiring it, or else add a new one.
+        if (!_tryDecrement(&_pendingRetirements))
+            _check(sem_post(&_sem));
         _outof.fetchAndAdd(1);
     }
 
     while (_outof.load() > newSize) {
-        waitForTicket();
+        // Take back a free ticket, or else retire the next one to be released.
+        if (!tryAcquire())
+            _pendingRetirements.fetchAndAdd(1);
         _outof.subtractAndFetch(1);
     }
 
@@ -128,7 +148,7 @@ int TicketHolder::available() const {
 }
 
 int TicketHolder::used() const {
-    return outof() - available();
+    return outof() + _pendingRetirements.load() - available();
 }
 
 int TicketHolder::outof() const {
@@ -171,17 +191,9 @@ void TicketHolder::release() {
 Status TicketHolder::resize(int newSize) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
 
+    // If more tickets are in use than 'newSize', '_num' goes negative until enough of them have
+    // been released.
     int used = _outof.load() - _num;
-    if (used > newSize) {
-        std::stringstream ss;
-        ss << "can't resize since we're using (" << used << ") "
-           << "more than newSize(" << newSize << ")";
-
-        std::string errmsg = ss.str();
-        log() << errmsg;
-        return Status(ErrorCodes::BadValue, errmsg);
-    }
-
     _outof.store(newSize);
     _num = _outof.load() - used;
 
@@ -204,9 +216,6 @@ int TicketHolder::outof() const {
 
 bool TicketHolder::_tryAcquire() {
     if (_num <= 0) {
-        if (_num < 0) {
-            std::cerr << "DISASTER! in TicketHolder" << std::endl;
-        }
         return false;
     }
     _num--;
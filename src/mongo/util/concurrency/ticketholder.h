@@ -53,6 +53,10 @@ public:
 
     void release();
 
+    /**
+     * Changes the number of tickets to 'newSize' without waiting for any tickets to be released. If
+     * more than 'newSize' tickets are in use, the excess tickets are retired as they are released.
+     */
     Status resize(int newSize);
 
     int available() const;
@@ -68,6 +72,10 @@ private:
     // You can read _outof without a lock, but have to hold _resizeMutex to change.
     AtomicInt32 _outof;
     stdx::mutex _resizeMutex;
+
+    // Number of tickets in use which will not be returned to the semaphore when released, because
+    // the holder was shrunk while they were in use.
+    AtomicInt32 _pendingRetirements{0};
 #else
     bool _tryAcquire();
 
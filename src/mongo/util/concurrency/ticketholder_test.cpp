@@ -71,4 +71,36 @@ TEST(TicketholderTest, BasicTimeout) {
     holder.release();
     ASSERT_EQ(holder.used(), 0);
 }
+
+TEST(TicketholderTest, ShrinkBelowUsedDoesNotBlock) {
+    TicketHolder holder(6);
+    for (int i = 0; i < 6; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    ASSERT_OK(holder.resize(5));
+    ASSERT_EQ(holder.outof(), 5);
+    ASSERT_EQ(holder.used(), 6);
+    ASSERT_EQ(holder.available(), 0);
+
+    // The first ticket released is retired, the next one becomes available again.
+    holder.release();
+    ASSERT_EQ(holder.used(), 5);
+    ASSERT_EQ(holder.available(), 0);
+    holder.release();
+    ASSERT_EQ(holder.used(), 4);
+    ASSERT_EQ(holder.available(), 1);
+
+    // Growing the holder keeps tickets which would otherwise be retired.
+    ASSERT_OK(holder.resize(5));
+    ASSERT_OK(holder.resize(6));
+    ASSERT_EQ(holder.available(), 2);
+
+    for (int i = 0; i < 4; i++) {
+        holder.release();
+    }
+    ASSERT_EQ(holder.used(), 0);
+    ASSERT_EQ(holder.available(), 6);
+    ASSERT_EQ(holder.outof(), 6);
+}
 }  // namespace